@@ -0,0 +1,28 @@
+"""
+Build configuration for the optional native collectors and benchmark kernels.
+Project metadata lives in pyproject.toml; this file only declares the C extensions,
+which are skipped (and statz falls back to psutil and Python kernels) if they cannot be compiled.
+"""
+
+import sys
+
+from setuptools import Extension, setup
+
+ext_modules = [
+    Extension(
+        "statz.internal._nativeBench",
+        sources=["statz/internal/_nativeBench.c"],
+        optional=True,
+    )
+]
+
+if sys.platform.startswith("linux"):
+    ext_modules.append(
+        Extension(
+            "statz.internal._nativeLinux",
+            sources=["statz/internal/_nativeLinux.c"],
+            optional=True,
+        )
+    )
+
+setup(ext_modules=ext_modules)
@@ -30,39 +30,114 @@ Example Usage:
     health = statz.system_health_score()
 """
 
-from . import stats
-from .stats import (
-    get_system_specs,
-    get_hardware_usage, 
-    get_top_n_processes,
-    connected_device_monitoring,
-    __version__
-)
+__version__ = "2.4.0"
 
-from .temp import get_system_temps
-from .health import system_health_score
-from .benchmark import cpu_benchmark, mem_benchmark, disk_benchmark
-from .file import export_into_file, compare, secure_delete
-from .network import internet_speed_test, scan_open_ports
+# Public names and the submodule they live in. Submodules are imported on first access (PEP 562), so
+# "import statz" or the CLI only pay for what they use; "stats" and "aio" are the submodules themselves.
+_EXPORTS = {
+    "get_system_specs": "stats",
+    "get_hardware_usage": "stats",
+    "stream_hardware_usage": "stats",
+    "get_gpu_usage": "stats",
+    "get_top_n_processes": "stats",
+    "get_top_n_processes_multi": "stats",
+    "get_cgroup_usage": "stats",
+    "get_top_n_cgroups": "stats",
+    "connected_device_monitoring": "stats",
+    "start_usb_monitor": "stats",
+    "stop_usb_monitor": "stats",
+    "start_background_sampler": "stats",
+    "stop_background_sampler": "stats",
+    "set_specs_cache_file": "stats",
+    "clear_specs_cache": "stats",
+    "enable_usage_history": "stats",
+    "disable_usage_history": "stats",
+    "get_usage_history": "stats",
+    "enable_profiling": "stats",
+    "disable_profiling": "stats",
+    "get_profile": "stats",
+    "get_system_temps": "temp",
+    "system_health_score": "health",
+    "start_health_monitor": "health",
+    "stop_health_monitor": "health",
+    "cpu_benchmark": "benchmark",
+    "mem_benchmark": "benchmark",
+    "disk_benchmark": "benchmark",
+    "run_benchmark_suite": "benchmark",
+    "startup_benchmark": "benchmark",
+    "export_into_file": "file",
+    "export_stream": "file",
+    "compare": "file",
+    "compare_snapshots": "file",
+    "secure_delete": "file",
+    "secure_delete_tree": "file",
+    "internet_speed_test": "network",
+    "scan_open_ports": "network",
+    "iter_open_ports": "network",
+    "serve_metrics": "exporter",
+    "record_usage": "recording",
+    "open_recording": "recording",
+    "stats": None,
+    "aio": None,
+}
 
 __all__ = [
     "get_system_specs",
     "get_hardware_usage", 
+    "stream_hardware_usage",
+    "get_gpu_usage",
     "get_system_temps",
     "get_top_n_processes",
+    "get_top_n_processes_multi",
+    "get_cgroup_usage",
+    "get_top_n_cgroups",
     "system_health_score",
+    "start_health_monitor",
+    "stop_health_monitor",
     "cpu_benchmark", 
     "mem_benchmark",
     "disk_benchmark",
+    "run_benchmark_suite",
+    "startup_benchmark",
     "export_into_file",
+    "export_stream",
     "compare",
+    "compare_snapshots",
     "__version__",
     "stats",
     "internet_speed_test",
     "connected_device_monitoring",
+    "start_usb_monitor",
+    "stop_usb_monitor",
     "scan_open_ports",
-    "secure_delete"
+    "iter_open_ports",
+    "secure_delete",
+    "secure_delete_tree",
+    "start_background_sampler",
+    "stop_background_sampler",
+    "set_specs_cache_file",
+    "clear_specs_cache",
+    "serve_metrics",
+    "enable_usage_history",
+    "disable_usage_history",
+    "get_usage_history",
+    "enable_profiling",
+    "disable_profiling",
+    "get_profile",
+    "record_usage",
+    "open_recording",
+    "aio"
 ]
 
-# Version information
-__version__ = __version__
\ No newline at end of file
+def __getattr__(name):
+    if name not in _EXPORTS:
+        raise AttributeError(f"module 'statz' has no attribute {name!r}")
+    import importlib
+    module = importlib.import_module(f".{_EXPORTS[name] or name}", __name__)
+    value = module if _EXPORTS[name] is None else getattr(module, name)
+    # cache it, later lookups do not go through __getattr__ again
+    globals()[name] = value
+    return value
+
+def __dir__():
+    return sorted(set(globals()) | set(__all__))
@@ -0,0 +1,431 @@
+'''Asynchronous API.
+Coroutine versions of the statz functions for programs that run an asyncio event loop.
+Sampling windows are awaited with asyncio.sleep and external tools (lsusb, system_profiler,
+sensors, iSMC, wmic...) are run with asyncio subprocesses, so a call never blocks the loop.
+Work that only exists as a blocking library call (WMI, speedtest, the system specs readers)
+runs on the loop's default thread pool instead.'''
+
+import asyncio
+import functools
+import platform
+import shutil
+import subprocess
+import threading
+import time
+
+# import like this so i can test it easily
+try:
+    from .internal._crossPlatform import _take_usage_snapshot, _usage_from_snapshots, _get_process_tracker, _format_top_processes, _system_health_score
+    from .internal._usageSampler import _get_sampler, _start_sampler, _select_components, UsageSample
+    from .internal._usbWatcher import _get_usb_watcher
+    from .internal import _getLinuxInfo, _connectedDevicesMonitoring as _devices
+    from .internal._getMacInfo import _parse_ismc_output, ISMC_TEMP_COMMAND
+    from .internal._portScanner import _expand_targets, _iter_scan
+    from . import stats, temp, network
+except:
+    from internal._crossPlatform import _take_usage_snapshot, _usage_from_snapshots, _get_process_tracker, _format_top_processes, _system_health_score
+    from internal._usageSampler import _get_sampler, _start_sampler, _select_components, UsageSample
+    from internal._usbWatcher import _get_usb_watcher
+    from internal import _getLinuxInfo, _connectedDevicesMonitoring as _devices
+    from internal._getMacInfo import _parse_ismc_output, ISMC_TEMP_COMMAND
+    from internal._portScanner import _expand_targets, _iter_scan
+    import stats, temp, network
+
+async def _in_thread(function, *args, **kwargs):
+    '''Run a blocking function on the default executor and await its result.'''
+    loop = asyncio.get_running_loop()
+    return await loop.run_in_executor(None, functools.partial(function, *args, **kwargs))
+
+async def _run_command(command, timeout=None):
+    '''
+    Run an external command without blocking the event loop.
+
+    Returns:
+        str or None: The command's stdout, or None if it could not be started, timed out or exited with an error.
+    '''
+    kwargs = {}
+    if platform.system() == "Windows":
+        kwargs["creationflags"] = subprocess.CREATE_NO_WINDOW
+
+    try:
+        process = await asyncio.create_subprocess_exec(
+            *command, stdout=asyncio.subprocess.PIPE, stderr=asyncio.subprocess.DEVNULL, **kwargs)
+    except NotImplementedError:
+        # event loops without subprocess support (the selector loop on Windows)
+        try:
+            result = await _in_thread(subprocess.run, command, capture_output=True, text=True, timeout=timeout, **kwargs)
+        except:
+            return None
+        return result.stdout if result.returncode == 0 else None
+    except OSError:
+        # the tool is not installed
+        return None
+
+    try:
+        stdout, _ = await asyncio.wait_for(process.communicate(), timeout)
+    except asyncio.TimeoutError:
+        process.kill()
+        await process.wait()
+        return None
+    if process.returncode != 0:
+        return None
+    return stdout.decode("utf-8", errors="replace")
+
+async def get_hardware_usage(get_cpu=True, get_ram=True, get_disk=True, get_network=True, get_battery=True, get_totcpu=False, interval=None, cached=False, get_gpu=False, **kwargs):
+    '''
+    Get real-time usage data for specified system components, see statz.get_hardware_usage.
+
+    The sampling window is awaited, so other tasks keep running while the counters accumulate.
+
+    Args:
+        get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu (bool): Components to fetch.
+        interval (float): Length of the shared sampling window in seconds. Defaults to 1 second when disk or network
+                          data is requested and 0.1 seconds otherwise.
+        cached (bool): If True, return the newest values from the background sampler, starting it if needed.
+        get_gpu (bool): Whether to fetch per-GPU usage data (see get_gpu_usage). Defaults to False.
+        **kwargs: Additional keyword arguments to ensure compatibility with CLI logic.
+
+    Returns:
+        list: [cpu_usage (dict), ram_usage (dict), disk_usages (list of dicts), network_usage (dict), battery_usage (dict)],
+        followed by gpu_usages (list of dicts) when get_gpu is True.
+    '''
+    operatingSystem = platform.system()
+    if operatingSystem not in ("Darwin", "Linux", "Windows"):
+        raise OSError("Unsupported operating system")
+
+    if cached:
+        sampler = _get_sampler() or _start_sampler()
+        sample = sampler.latest(wait=False)
+        deadline = time.monotonic() + sampler.interval * 3 + 1
+        # the sampler signals a threading.Event, poll it instead so the loop is not blocked
+        while sample is None and sampler.is_running and time.monotonic() < deadline:
+            await asyncio.sleep(min(0.05, sampler.interval))
+            sample = sampler.latest(wait=False)
+        if sample is None:
+            return UsageSample([None] * (6 if get_gpu else 5), time.time(), time.monotonic(), sampler.interval)
+        return _select_components(sample, get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu, get_gpu)
+
+    if interval is None:
+        interval = 1 if (get_disk or get_network) else 0.1
+
+    before = _take_usage_snapshot(get_cpu, get_disk, get_network, get_totcpu)
+    if get_cpu or get_totcpu or get_disk or get_network:
+        await asyncio.sleep(interval)
+    after = _take_usage_snapshot(get_cpu, get_disk, get_network, get_totcpu)
+
+    return _usage_from_snapshots(before, after, get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu, get_gpu)
+
+async def stream_hardware_usage(get_cpu=True, get_ram=True, get_disk=True, get_network=True, get_battery=True, get_totcpu=False, interval=1.0, count=None, get_gpu=False):
+    '''
+    Asynchronous generator version of statz.stream_hardware_usage.
+
+    Use it with `async for usage in statz.aio.stream_hardware_usage(): ...`. Each sample reuses the previous
+    sample's counters and ticks are scheduled on a fixed clock, so samples arrive exactly `interval` seconds apart.
+
+    Args:
+        get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu (bool): Components to sample.
+        interval (float): Seconds between samples. Defaults to 1.
+        count (int): Number of samples to yield. Defaults to None (forever).
+        get_gpu (bool): Whether to fetch per-GPU usage data, as a sixth element of every list. Defaults to False.
+
+    Yields:
+        list: One usage list per interval, in the same format get_hardware_usage returns.
+    '''
+    if interval <= 0:
+        raise ValueError(f"interval must be positive, not {interval}")
+    if count is not None and count < 1:
+        raise ValueError(f"count must be positive int, not {count}")
+
+    before = _take_usage_snapshot(get_cpu, get_disk, get_network, get_totcpu)
+    next_tick = time.monotonic()
+    produced = 0
+
+    while count is None or produced < count:
+        next_tick += interval
+        delay = next_tick - time.monotonic()
+        if delay > 0:
+            await asyncio.sleep(delay)
+        else:
+            next_tick = time.monotonic()
+
+        after = _take_usage_snapshot(get_cpu, get_disk, get_network, get_totcpu)
+        usage = _usage_from_snapshots(before, after, get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu, get_gpu)
+        before = after
+        produced += 1
+        yield usage
+
+async def get_top_n_processes_multi(n=5, keys=("cpu", "mem")):
+    '''
+    Get the top N processes for several metrics at once, see statz.get_top_n_processes_multi.
+
+    Walking the process list takes a few milliseconds per hundred processes, so it runs on the thread pool;
+    the priming window of the first call is awaited.
+
+    Returns:
+        dict: { key: list of process dicts } for each requested key, or { "error": message }.
+    '''
+    try:
+        try:
+            int(n)
+        except:
+            raise TypeError(f"n must be int, not {type(n)}")
+
+        if n < 1:
+            raise ValueError(f"n must be positive int, not {n}")
+
+        for key in keys:
+            if key not in ("cpu", "mem", "io"):
+                raise TypeError(f"Keys must be cpu, mem or io, not {key}")
+
+        tracker = _get_process_tracker()
+        with_io = "io" in keys
+        if ("cpu" in keys or with_io) and tracker.needs_priming(with_io):
+            await _in_thread(tracker.refresh, with_io)
+            # Wait a bit for accurate CPU readings
+            await asyncio.sleep(0.1)
+        await _in_thread(tracker.refresh, with_io)
+        return {key: _format_top_processes(tracker.top(n, key), key) for key in keys}
+    except Exception as e:
+        return {"error": str(e)}
+
+async def get_top_n_processes(n=5, type="cpu"):
+    '''
+    Get the top N processes sorted by CPU, memory or I/O usage, see statz.get_top_n_processes.
+
+    Returns:
+        list: List of {"pid", "name", "usage"} dicts, or { "error": message }.
+    '''
+    result = await get_top_n_processes_multi(n, (type,))
+    if "error" in result:
+        return result
+    return result[type]
+
+async def get_system_specs(get_os=True, get_cpu=True, get_gpu=True, get_ram=True, get_disk=True, get_network=True, get_battery=True, use_cache=True):
+    '''
+    Get system specs, see statz.get_system_specs.
+
+    The platform readers mix file reads, WMI queries and helper commands, so the whole call runs on the
+    thread pool. With the specs cache warm it returns almost immediately.
+    '''
+    return await _in_thread(stats.get_system_specs, get_os, get_cpu, get_gpu, get_ram, get_disk, get_network, get_battery, use_cache)
+
+async def get_system_temps():
+    '''
+    Get temperature readings from system sensors, see statz.get_system_temps.
+
+    On Linux the sysfs sensor files are read directly (the reads do not block) and the lm-sensors fallback is
+    run as a subprocess. On macOS iSMC is run as a subprocess. Windows reads WMI on the thread pool.
+
+    Returns:
+        dict: Sensor names mapped to temperatures in Celsius as floats, or {"error": "..."}.
+    '''
+    operatingSystem = platform.system()
+
+    if operatingSystem == "Linux":
+        backend = _getLinuxInfo._temp_backend
+        if backend == "sensors":
+            output = await _run_command(_getLinuxInfo.SENSORS_COMMAND)
+            temps = _getLinuxInfo._parse_sensors_output(output) if output else {}
+            return temps if temps else {"error": "No temperature sensors found"}
+        if backend is None:
+            # the first call probes every sensor source
+            return await _in_thread(_getLinuxInfo._get_linux_temps)
+        return _getLinuxInfo._get_linux_temps()
+    elif operatingSystem == "Darwin":
+        if not shutil.which("iSMC"):
+            return {"error": "iSMC not found. Install it by following the instructions in the README.md"}
+        output = await _run_command(ISMC_TEMP_COMMAND)
+        if output is None:
+            return {"error": "Failed to run iSMC"}
+        try:
+            temps = _parse_ismc_output(output)
+        except Exception as e:
+            return {"error": f"Error parsing iSMC output: {e}"}
+        return temps if temps else {"error": "No temperature data found after parsing"}
+    else:
+        return await _in_thread(temp.get_system_temps)
+
+async def system_health_score(cliVersion=False):
+    '''
+    Calculate a system health score, see statz.system_health_score.
+
+    The one second CPU sample (skipped when the background sampler is running) and the temperature
+    readings are awaited, and the scores are computed from them.
+
+    Returns:
+        float or dict: The total score, or every sub-score when cliVersion is True.
+    '''
+    try:
+        sampler = _get_sampler()
+        sample = sampler.latest(wait=False) if sampler else None
+        if sample is not None:
+            usage = _select_components(sample, True, True, False, False, True)
+            temps = await get_system_temps()
+        else:
+            # read the temperatures while the CPU sample is being taken
+            usage, temps = await asyncio.gather(get_hardware_usage(True, True, False, False, True, interval=1), get_system_temps())
+        return _system_health_score(cliVersion, usage, temps)
+    except Exception as e:
+        if cliVersion:
+            return {"error": str(e)}
+        return 0
+
+async def _get_usb_devices():
+    '''Run the platform's USB listing tools as subprocesses and parse their output with the sync module's parsers.'''
+    operatingSystem = _devices.CURRENT_OS
+    devices = []
+
+    if operatingSystem == "linux":
+        output = await _run_command(_devices.LSUSB_COMMAND)
+        if output:
+            devices = _devices.parse_lsusb_output(output)
+        if not devices:
+            devices = _devices.get_usb_devices_sysfs()
+        return devices, "Linux lsusb/sysfs"
+    elif operatingSystem == "darwin":
+        output = await _run_command(_devices.SYSTEM_PROFILER_COMMAND)
+        if output:
+            devices = _devices.parse_system_profiler_output(output)
+        return devices, "macOS system_profiler"
+    elif operatingSystem == "windows":
+        output = await _run_command(_devices.WMIC_USB_COMMAND)
+        if output:
+            devices = _devices.parse_wmic_output(output)
+        if not devices:
+            output = await _run_command(_devices.POWERSHELL_USB_COMMAND)
+            if output and output.strip():
+                devices = _devices.parse_powershell_output(output)
+        return devices, "Windows Setup API/WMI"
+
+    raise OSError(f"Unsupported operating system: {operatingSystem}")
+
+async def connected_device_monitoring():
+    '''
+    Get information on connected USB devices, see statz.connected_device_monitoring.
+    While statz.start_usb_monitor runs, this returns its inventory without running anything.
+
+    Returns:
+        dict: { "total_usb_devices", "devices", "summary", "method_used", "platform" }, or the same keys with "error".
+    '''
+    try:
+        watcher = _get_usb_watcher()
+        if watcher is not None:
+            return watcher.snapshot()
+        devices, method_used = await _get_usb_devices()
+        return _devices.summarize_usb_devices(devices, method_used)
+    except Exception as e:
+        return {
+            'total_usb_devices': 0,
+            'devices': [],
+            'summary': {},
+            'error': f"Failed to get connected devices: {str(e)}",
+            'platform': platform.system().lower()
+        }
+
+async def get_connected_device_by_name(device_name):
+    '''
+    Get a specific connected USB device by name, see statz.get_connected_device_by_name.
+
+    Returns:
+        dict or None: Device information dictionary if found, None otherwise
+    '''
+    try:
+        watcher = _get_usb_watcher()
+        if watcher is not None:
+            return watcher.find_by_name(device_name)
+        return _devices.find_device_by_name(await connected_device_monitoring(), device_name)
+    except Exception:
+        return None
+
+async def get_connected_devices_by_type(device_type):
+    '''
+    Get connected USB devices filtered by type, see statz.get_connected_devices_by_type.
+
+    Returns:
+        dict: { "device_type", "count", "devices", "platform" }
+    '''
+    try:
+        watcher = _get_usb_watcher()
+        if watcher is not None:
+            return watcher.filter_by_type(device_type)
+        return _devices.filter_devices_by_type(await connected_device_monitoring(), device_type)
+    except Exception as e:
+        return {'device_type': device_type, 'count': 0, 'devices': [], 'error': str(e), 'platform': platform.system().lower()}
+
+async def get_connected_devices_by_id(vendor_id, product_id=None):
+    '''
+    Get connected USB devices by vendor id and optionally product id, see statz.stats.get_connected_devices_by_id.
+
+    Returns:
+        dict: { "vendor_id", "product_id", "count", "devices", "platform" }
+    '''
+    try:
+        watcher = _get_usb_watcher()
+        if watcher is not None:
+            return watcher.filter_by_usb_id(vendor_id, product_id)
+        return _devices.filter_devices_by_usb_id(await connected_device_monitoring(), vendor_id, product_id)
+    except Exception as e:
+        return {'vendor_id': vendor_id, 'product_id': product_id, 'count': 0, 'devices': [], 'error': str(e), 'platform': platform.system().lower()}
+
+async def internet_speed_test(roundResult=True, threads=None, duration=None, server_id=None, refresh_server=False, detailed=False):
+    '''
+    Run an internet speed test, see statz.network.internet_speed_test.
+    speedtest-cli only has a blocking API, so the test runs on the thread pool.
+
+    Returns:
+        tuple or dict: (download_speed in mbps, upload_speed in mbps, ping in ms), or the detailed results dict.
+    '''
+    return await _in_thread(network.internet_speed_test, roundResult, threads, duration, server_id, refresh_server, detailed)
+
+async def iter_open_ports(starting=1, ending=1024, targetIP="127.0.0.1", concurrency=256, timeout=1.0, adaptive=True):
+    '''
+    Asynchronous generator version of statz.network.iter_open_ports.
+    The selector driven scanner runs on the thread pool and every open port is handed to the loop as soon as it answers.
+
+    Yields:
+        tuple: (host, port) for every open port, in the order they answer.
+    '''
+    if starting < 1 or ending > 65535 or starting > ending:
+        raise ValueError(f"Invalid port range {starting}-{ending}")
+
+    loop = asyncio.get_running_loop()
+    queue = asyncio.Queue()
+    done = object()
+    # checked by the scanner on every selector wake-up, so leaving early does not wait for the rest of the scan
+    cancelled = threading.Event()
+
+    def run():
+        try:
+            # hostnames are resolved here too, off the loop
+            scan = _iter_scan(_expand_targets(targetIP), range(starting, ending + 1), concurrency, timeout, adaptive, stop_event=cancelled)
+            try:
+                for found in scan:
+                    loop.call_soon_threadsafe(queue.put_nowait, found)
+            finally:
+                scan.close()
+            loop.call_soon_threadsafe(queue.put_nowait, done)
+        except Exception as e:
+            loop.call_soon_threadsafe(queue.put_nowait, e)
+
+    worker = loop.run_in_executor(None, run)
+    try:
+        while True:
+            item = await queue.get()
+            if item is done:
+                break
+            if isinstance(item, Exception):
+                raise item
+            yield item
+    finally:
+        # stop the scanner if the caller leaves the loop early
+        cancelled.set()
+        await worker
+
+async def scan_open_ports(starting=1, ending=1024, targetIP="127.0.0.1", concurrency=256, timeout=1.0, adaptive=True):
+    '''
+    Find the open TCP ports on targetIP, see statz.network.scan_open_ports.
+
+    Returns:
+        list or dict: Sorted open ports for a single host, or { host: sorted open ports } for a range or list.
+    '''
+    return await _in_thread(network.scan_open_ports, starting, ending, targetIP, concurrency, timeout, adaptive)
@@ -1,49 +1,155 @@
 '''
-Benchmarking module for CPU, memory, and disk performance.'''
+Benchmarking module for CPU, memory, and disk performance, and for statz's own start-up time.'''
 
-from .internal._crossPlatform import _cpu_benchmark, _mem_benchmark, _disk_benchmark
+from .internal._cpuBenchmark import _cpu_benchmark
+from .internal._memBenchmark import _mem_benchmark
+from .internal._diskBenchmark import _disk_benchmark
+from .internal._startupBenchmark import _startup_benchmark
+from .internal._benchmarkHarness import _run_benchmark_suite
 
-def cpu_benchmark():
+def cpu_benchmark(duration=1.0, warmup=0.25, multicore=False, max_processes=None, kernels=None):
     '''
-    Get CPU performance with some computational tasks, such as:\n
-    - Calculating large Fibonacci numbers\n
-    - Calculating large primes\n
+    Measure CPU performance with a suite of native-speed kernels:\n
+    - integer: 64-bit shift/xor/multiply streams\n
+    - bigint: 2048-bit modular exponentiation\n
+    - float: y = a * x + y over cache-resident arrays (vectorized by the compiler)\n
+    - hash: SHA-256\n
+    - compression: zlib level 6\n
+
+    Every kernel is calibrated, warmed up and then run repeatedly for `duration` seconds.
+
+    Args:
+     duration (float): Seconds of timed runs per kernel. Defaults to 1.
+     warmup (float): Seconds of untimed runs per kernel first. Defaults to 0.25.
+     multicore (bool): Also run the kernels in 1, 2, 4 ... N processes at once and report the scaling. Defaults to False.
+     max_processes (int): Largest process count for multicore. Defaults to the number of logical CPUs.
+     kernels (list): Only run these kernels. Defaults to all of them.
 
     Returns:
      dict: {\n
-     "execution_time": time taken to execute (lower is better),\n
-     "fibonacci_10000th": fibonacci number computed,\n
-     "prime_count": prime number calculated in benchmark,\n
-     "score": score calculated (higher is better)\n
+     "execution_time": time the whole suite took in seconds,\n
+     "backend": "native", or "python" if the optional C kernels are not built,\n
+     "score": score against a 2020 desktop core, which scores 100 (higher is better),\n
+     "kernels": { name: {"throughput", "unit", "median_ms", "p95_ms", "runs", "size"} },\n
+     "scaling": [ {"processes", "throughput", "speedup", "efficiency"}, ... ] (only with multicore)\n
      }
+
+    Note:
+     multicore starts worker processes. In scripts, call it under `if __name__ == "__main__":`.
      '''
     
-    return _cpu_benchmark()
+    return _cpu_benchmark(duration, warmup, multicore, max_processes, kernels)
+
+def mem_benchmark(duration=0.5, warmup=0.1, threads=1, array_mb=None, latency=True):
+    '''
+    Measure memory bandwidth and latency:\n
+    - bandwidth: the STREAM copy, scale, add and triad kernels over arrays larger than the last level cache\n
+    - latency: a random pointer chase with working sets that fit in L1, L2 and L3, and one that only fits in DRAM\n
+
+    Args:
+     duration (float): Seconds of timed runs per kernel and working set. Defaults to 0.5.
+     warmup (float): Seconds of untimed runs first. Defaults to 0.1.
+     threads (int): Also measure bandwidth with this many threads, each on memory it allocated itself, so it lands on its own NUMA node. Defaults to 1 (off).
+     array_mb (float): Size of each of the three STREAM arrays in MiB. Defaults to 4x the last level cache (at least 64 MiB).
+     latency (bool): Run the latency test. Defaults to True.
 
-def mem_benchmark():
-    '''Benchmark memory allocation and access speed using large lists
     Returns:
      dict: {\n
-     "execution_time": time taken to execute the program (lower is better),\n
-     "sum_calculated": total sum calculated during the test,\n
-     "score": the performance score on your ram (higher is better)\n
+     "execution_time": time the benchmark took in seconds,\n
+     "backend": "native", or "python" if the optional C kernels are not built (only copy bandwidth, no latency),\n
+     "score": score against a 2020 desktop, which scores 100 (higher is better),\n
+     "array_mb": size of each STREAM array, "caches": { level: bytes }, "numa_nodes": NUMA node count,\n
+     "bandwidth": { kernel: {"throughput" (MB/s), "unit", "median_ms", "p95_ms", "runs", "size"} },\n
+     "latency": { "L1" / "L2" / "L3" / "DRAM": {"working_set", "bytes", "ns", "median_ms", "p95_ms", "runs", "size"} },\n
+     "multithreaded": {"threads", "bandwidth", "speedup"} (only with threads > 1)\n
      }
     '''
 
-    return _mem_benchmark()
+    return _mem_benchmark(duration, warmup, threads, array_mb, latency)
 
-def disk_benchmark():
+def disk_benchmark(path=None, size_mb=256, block_kb=4, seq_block_kb=1024, queue_depth=16, duration=3.0, direct=True, tests=None):
     '''
-    Benchmark disk I/O performance by writing and reading a 10MB test file.
-    
+    Measure disk performance with a test file, bypassing the page cache:\n
+    - seq_write / seq_read: one pass in seq_block_kb blocks\n
+    - rand_read / rand_write: block_kb blocks at random offsets with queue_depth I/Os outstanding\n
+
+    Args:
+     path (str): Directory to create the test file in, to benchmark a specific mount. Defaults to the temp directory.
+     size_mb (int): Size of the test file in MiB. Defaults to 256.
+     block_kb (int): Block size of the random tests in KiB (multiple of 4). Defaults to 4.
+     seq_block_kb (int): Block size of the sequential tests in KiB (multiple of 4). Defaults to 1024.
+     queue_depth (int): Outstanding I/Os in the random tests. Defaults to 16.
+     duration (float): Seconds per random test. Defaults to 3.
+     direct (bool): Read with O_DIRECT (Linux), F_NOCACHE (macOS) or after dropping the file from the page cache. Defaults to True.
+     tests (list): Only run these tests. Defaults to all of them.
+
     Returns:
-     dict: {
-     "write_speed": Write speed in MB/s,
-     "read_speed": Read speed in MB/s, 
-     "write_score": Write performance score (higher is better),
-     "read_score": Read performance score (higher is better),
-     "overall_score": Overall disk performance score (higher is better)
+     dict: {\n
+     "execution_time", "path", "size_mb",\n
+     "cache_bypass": "O_DIRECT", "F_NOCACHE", "fadvise", or None if reads may come from the page cache,\n
+     "tests": { test: {"throughput" (MB/s), "unit", "iops", "p50_ms", "p99_ms", "block_kb", "queue_depth", "ops", "seconds", "cache_bypass"} },\n
+     "write_speed", "read_speed": sequential speeds in MB/s,\n
+     "write_score", "read_score": sequential scores,\n
+     "score": score against a 2020 SATA SSD, which scores 100 (higher is better)\n
      }
     '''
 
-    return _disk_benchmark()
\ No newline at end of file
+    return _disk_benchmark(path, size_mb, block_kb, seq_block_kb, queue_depth, duration, direct, tests)
+
+def startup_benchmark(runs=10, commands=None):
+    '''
+    Measure how long the statz CLI takes to start, the cost scripts and cron jobs pay on every call.
+
+    Every command runs `runs` times in a fresh interpreter after an untimed run, and a bare `python -c pass`
+    is timed the same way, so statz's own part ("overhead_ms") can be told apart from the interpreter's.
+
+    Args:
+     runs (int): Processes started per command. Defaults to 10.
+     commands (dict): { name: list of CLI arguments }. Defaults to {"version": ["--version"], "usage_json": ["--usage", "--ram", "--json"]}.
+
+    Returns:
+     dict: {\n
+     "interpreter_ms": median start-up of a bare interpreter,\n
+     "commands": { name: {"arguments", "median_ms", "p90_ms", "min_ms", "overhead_ms", "runs"} },\n
+     "import_ms": import time of statz.cli, "slowest_imports": [(module, self ms)] from python -X importtime,\n
+     "target_ms": 50, "score": target_ms / median_ms as a geometric mean, times 100 (higher is better)\n
+     }
+    '''
+
+    return _startup_benchmark(runs, commands)
+
+def run_benchmark_suite(components=None, runs=5, warmup_runs=1, pin_cpu=True, options=None,
+                        baseline=None, save_baseline=False, alpha=0.05, threshold=3.0, progress=None):
+    '''
+    Run benchmarks repeatedly, record the environment and check the results against a saved baseline.
+
+    Every benchmark gets `warmup_runs` untimed runs and then `runs` timed ones. Single-threaded benchmarks are pinned
+    to one CPU. A metric counts as a regression only if Welch's t-test against the baseline runs gives p < alpha
+    and the median got worse by more than `threshold` percent.
+
+    Args:
+     components (list): Any of "cpu", "memory", "disk" and "startup". Defaults to cpu, memory and disk.
+     runs (int): Timed runs of every benchmark. Defaults to 5.
+     warmup_runs (int): Untimed runs first. Defaults to 1.
+     pin_cpu (bool): Pin single-threaded benchmarks to one CPU. Defaults to True.
+     options (dict): Keyword arguments per benchmark, e.g. {"disk": {"path": "/mnt/data"}, "cpu": {"duration": 2}}.
+     baseline (str): Baseline file to compare against, or "default" for the per-user baseline. Defaults to None.
+     save_baseline (bool): Save this run as the baseline (into `baseline`, or the per-user file). Defaults to False.
+     alpha (float): Significance level. Defaults to 0.05.
+     threshold (float): Smallest change in percent worth reporting. Defaults to 3.
+     progress (callable): Called with (component, run, total runs) before each run.
+
+    Returns:
+     dict: {\n
+     "environment": governor, frequency, load, power source, versions... and "warnings",\n
+     "settings": runs, warm-up runs, the CPU each benchmark was pinned to,\n
+     "metrics": { component: { metric: {"median", "mean", "stdev", "cv_percent", "min", "max", "unit", "higher_is_better", "samples"} } },\n
+     "comparison": { "metrics": { "component.metric": {"status", "baseline_median", "current_median", "change_percent", "p_value"} },\n
+     "counts", "environment_changes", "baseline", "baseline_timestamp" } (only with a baseline)\n
+     }
+
+    Note:
+     Saved baselines and reports are plain JSON, so two of them can also be diffed with statz.compare.
+     '''
+
+    return _run_benchmark_suite(components, runs, warmup_runs, pin_cpu, options, baseline, save_baseline, alpha, threshold, progress)
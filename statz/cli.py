@@ -1,19 +1,58 @@
-from statz import stats
-from statz.benchmark import cpu_benchmark, mem_benchmark, disk_benchmark
-from statz.temp import get_system_temps
-from statz.health import system_health_score
-from statz.file import export_into_file, compare, secure_delete
-from statz.network import internet_speed_test
+import atexit
+import importlib
+import json
+import os
+import sys
+import glob
+import platform
 from datetime import date, datetime
+from time import sleep
+
 from colorama import Fore, Style, init
-from .dashboard import run_dashboard
-from rich.console import Console
-from rich.table import Table
-from rich import box
 
-import platform
-import json
-import argparse
+from statz import __version__
+
+# Everything below is imported on first use, so a command only loads the modules it runs:
+# `statz --usage --ram --json` never imports Rich, the benchmarks, speedtest or the dashboard.
+class _LazyModule:
+    """Stand-in for `import module` that imports it on the first attribute access."""
+    def __init__(self, name):
+        self._name = name
+
+    def __getattr__(self, attribute):
+        return getattr(importlib.import_module(self._name), attribute)
+
+class _LazyFunction:
+    """Stand-in for `from module import name` that imports module on the first call or attribute access (e.g. export_schema)."""
+    def __init__(self, module, name):
+        self._module = module
+        self.__name__ = name
+
+    def __call__(self, *args, **kwargs):
+        return getattr(importlib.import_module(self._module), self.__name__)(*args, **kwargs)
+
+    def __getattr__(self, attribute):
+        return getattr(getattr(importlib.import_module(self._module), self.__name__), attribute)
+
+stats = _LazyModule("statz.stats")
+cpu_benchmark = _LazyFunction("statz.benchmark", "cpu_benchmark")
+mem_benchmark = _LazyFunction("statz.benchmark", "mem_benchmark")
+disk_benchmark = _LazyFunction("statz.benchmark", "disk_benchmark")
+run_benchmark_suite = _LazyFunction("statz.benchmark", "run_benchmark_suite")
+startup_benchmark = _LazyFunction("statz.benchmark", "startup_benchmark")
+get_system_temps = _LazyFunction("statz.temp", "get_system_temps")
+system_health_score = _LazyFunction("statz.health", "system_health_score")
+export_into_file = _LazyFunction("statz.file", "export_into_file")
+compare = _LazyFunction("statz.file", "compare")
+compare_snapshots = _LazyFunction("statz.file", "compare_snapshots")
+secure_delete = _LazyFunction("statz.file", "secure_delete")
+secure_delete_tree = _LazyFunction("statz.file", "secure_delete_tree")
+internet_speed_test = _LazyFunction("statz.network", "internet_speed_test")
+run_dashboard = _LazyFunction("statz.dashboard", "run_dashboard")
+run_watch = _LazyFunction("statz.watch", "run_watch")
+serve_metrics = _LazyFunction("statz.exporter", "serve_metrics")
+record_usage = _LazyFunction("statz.recording", "record_usage")
+open_recording = _LazyFunction("statz.recording", "open_recording")
 
 def create_export_function_for_specs(args):
     """Create a function that can be used with export_into_file for specs data."""
@@ -28,7 +67,7 @@ def create_export_function_for_specs(args):
 
 def create_export_function_for_usage(args):
     """Create a function that can be used with export_into_file for usage data."""
-    if any([args.os, args.cpu, getattr(args, 'totcpu', False), args.gpu, args.ram, args.disk, args.network, args.battery, args.temp, args.processes, args.health, args.benchmark]):
+    if any([args.os, args.cpu, getattr(args, 'totcpu', False), args.gpu, args.ram, args.disk, args.network, args.battery, args.temp, args.processes, args.cgroups, args.health, args.benchmark]):
         # Component-specific usage
         def get_usage():
             return get_component_usage(args)
@@ -41,13 +80,205 @@ def create_export_function_for_processes(args):
     """Create a function that can be used with export_into_file for process data."""
     return lambda: stats.get_top_n_processes(args.process_count, args.process_type)
 
+def create_export_function_for_cgroups(args):
+    """Create a function that can be used with export_into_file for cgroup data."""
+    return lambda: stats.get_top_n_cgroups(args.process_count, args.cgroup_type, args.cgroup_level)
+
 def create_export_function_for_temps():
     """Create a function that can be used with export_into_file for temperature data."""
     return get_system_temps
 
-def create_export_function_for_health():
+def create_export_function_for_health(args):
     """Create a function that can be used with export_into_file for health data."""
-    return lambda: system_health_score(cliVersion=True)
+    return lambda: system_health_score(cliVersion=True, **health_options(args))
+
+def export_with_schema(args, specsOrUsage, file_format):
+    """Export the data of the command through export_into_file, with the schema of the collector it came from."""
+    schema = None
+    # Determine which export function to use based on the command
+    if args.benchmark and not args.specs and not args.usage and not args.temp and not args.processes and not args.health:
+        # Standalone benchmark command
+        export_func = create_export_function_for_benchmark(args)
+    elif args.health and not args.specs and not args.usage and not args.temp and not args.processes:
+        # Standalone health command
+        export_func = create_export_function_for_health(args)
+        schema = "health"
+    elif args.temp and not args.specs and not args.usage and not args.processes:
+        # Standalone temperature command
+        export_func = create_export_function_for_temps()
+    elif args.processes and not args.specs and not args.usage and not args.temp:
+        # Standalone processes command
+        export_func = create_export_function_for_processes(args)
+        schema = "processes"
+    elif args.cgroups and not args.specs and not args.usage and not args.temp:
+        # Standalone cgroups command
+        export_func = create_export_function_for_cgroups(args)
+        schema = "cgroups"
+    elif args.specs:
+        # Specs command
+        export_func = create_export_function_for_specs(args)
+    elif args.usage:
+        # Usage command
+        export_func = create_export_function_for_usage(args)
+        if export_func is not stats.get_hardware_usage and not any([args.os, args.gpu, args.temp, args.processes, args.cgroups, args.health, args.benchmark]):
+            # {"cpu", "ram", "disk", "network", "battery"}, the same record --watch writes
+            schema = "usage_sample"
+    else:
+        # Fallback - create a lambda function that returns the current data
+        export_func = lambda: specsOrUsage
+    
+    # Use custom path if provided, with the extension of the format
+    custom_path = None
+    if args.path:
+        from .internal._exportWriter import FORMATS as EXPORT_EXTENSIONS
+        extension = EXPORT_EXTENSIONS[file_format]
+        custom_path = args.path if args.path.endswith(extension) else f"{args.path}{extension}"
+    
+    try:
+        export_into_file(export_func, path=custom_path, params=(False, None), file_format=file_format, schema=schema)
+    except Exception as e:
+        print(f"{Fore.RED}Error during {file_format} export: {str(e)}{Style.RESET_ALL}")
+
+def health_options(args):
+    """Keyword arguments for system_health_score from the --health-weight COMPONENT=WEIGHT flags."""
+    weights = {}
+    for entry in args.health_weight or []:
+        component, separator, weight = entry.partition("=")
+        try:
+            weights[component.strip()] = float(weight)
+        except ValueError:
+            raise ValueError(f"--health-weight expects COMPONENT=WEIGHT, not {entry!r}")
+    return {"weights": weights} if weights else {}
+
+def cpu_benchmark_options(args):
+    """Keyword arguments for cpu_benchmark from the --duration and --multicore flags."""
+    options = {"multicore": args.multicore}
+    if args.duration:
+        options["duration"] = args.duration
+    return options
+
+def mem_benchmark_options(args):
+    """Keyword arguments for mem_benchmark from the --duration and --multicore flags."""
+    options = {"threads": (os.cpu_count() or 1) if args.multicore else 1}
+    if args.duration:
+        options["duration"] = args.duration
+    return options
+
+def disk_benchmark_options(args):
+    """Keyword arguments for disk_benchmark from the --disk-path, --disk-size, --block-size, --queue-depth and --duration flags."""
+    options = {}
+    if args.disk_path:
+        options["path"] = args.disk_path
+    if args.disk_size:
+        options["size_mb"] = args.disk_size
+    if args.block_size:
+        options["block_kb"] = args.block_size
+    if args.queue_depth:
+        options["queue_depth"] = args.queue_depth
+    if args.duration:
+        options["duration"] = args.duration
+    return options
+
+def run_benchmark_suite_command(args):
+    """Run --benchmark with --runs/--baseline/--save-baseline, print the summary and return the number of regressions."""
+    from rich.console import Console
+    components = [name for name, flag in (("cpu", args.cpu), ("memory", args.ram), ("disk", args.disk), ("startup", args.startup)) if flag] or None
+    options = {
+        "cpu": cpu_benchmark_options(args),
+        "memory": mem_benchmark_options(args),
+        "disk": disk_benchmark_options(args),
+    }
+
+    def progress(component, run, total):
+        if not args.json:
+            print(f"Running {component} benchmark, run {run}/{total}...")
+
+    report = run_benchmark_suite(components, runs=args.runs or 5, options=options, baseline=args.baseline,
+                                 save_baseline=args.save_baseline, progress=progress)
+
+    if args.out:
+        path = args.path or f"statz_benchmark_{datetime.now().strftime('%Y%m%d_%H%M%S')}.json"
+        with open(path, "w") as f:
+            json.dump(report, f, indent=2)
+        if not args.json:
+            print(f"Benchmark report written to {path}")
+
+    if args.json:
+        print(json.dumps(report, indent=2))
+    elif args.table:
+        Console().print(format_benchmark_suite_table(report))
+    else:
+        print(format_benchmark_suite(report))
+
+    comparison = report.get("comparison")
+    return comparison["counts"]["regression"] if comparison else 0
+
+def benchmark_suite_rows(report):
+    """(component, metric, median, spread, baseline, change, status) rows of a run_benchmark_suite report."""
+    compared = report.get("comparison", {}).get("metrics", {})
+    rows = []
+    for component, metrics in report["metrics"].items():
+        for metric, summary in metrics.items():
+            entry = compared.get(f"{component}.{metric}", {})
+            change = entry.get("change_percent")
+            rows.append((
+                component,
+                metric,
+                f"{summary['median']} {summary['unit']}".strip(),
+                f"±{summary['cv_percent']}%" if summary["cv_percent"] is not None else "",
+                str(entry["baseline_median"]) if "baseline_median" in entry else "",
+                f"{change:+.2f}%" if change is not None else "",
+                entry.get("status", ""),
+            ))
+    return rows
+
+def format_benchmark_suite(report):
+    """Format a run_benchmark_suite report for display with colors."""
+    status_colors = {"regression": Fore.RED, "improvement": Fore.GREEN}
+    settings = report["settings"]
+    lines = [f"\n  Benchmark suite: {settings['runs']} runs after {settings['warmup_runs']} warm-up runs ({settings['execution_time']}s)"]
+    for warning in report["environment"].get("warnings", []):
+        lines.append(f"  {Fore.YELLOW}Warning: {warning}{Style.RESET_ALL}")
+
+    current = None
+    for component, metric, median, spread, baseline, change, status in benchmark_suite_rows(report):
+        if component != current:
+            current = component
+            pinned = settings["pinned_cpu"].get(component)
+            lines.append(f"\n  {component.upper()}" + (f" (pinned to CPU {pinned})" if pinned is not None else "") + ":")
+        line = f"    {metric}: {median} {spread}"
+        if status:
+            line += f"  {status_colors.get(status, '')}[{status}" + (f", baseline {baseline}, {change}" if baseline else "") + f"]{Style.RESET_ALL}"
+        lines.append(line)
+
+    comparison = report.get("comparison")
+    if comparison:
+        counts = comparison["counts"]
+        lines.append(f"\n  Against {comparison['baseline']}: {counts['regression']} regressions, {counts['improvement']} improvements, {counts['unchanged']} unchanged")
+        for field, values in comparison["environment_changes"].items():
+            lines.append(f"  {Fore.YELLOW}Environment changed: {field} {values['from']} -> {values['to']}{Style.RESET_ALL}")
+    if report.get("baseline_saved"):
+        lines.append(f"\n  Baseline saved to {report['baseline_saved']}")
+    return "\n".join(lines)
+
+def format_benchmark_suite_table(report):
+    """Format a run_benchmark_suite report into a table."""
+    from rich.table import Table
+    from rich import box
+    table = Table(title="Benchmark Suite Results", box=box.ROUNDED, title_style="bold cyan")
+    for column, style in (("Component", "bold blue"), ("Metric", "blue"), ("Median", "green"), ("Spread", "white"),
+                          ("Baseline", "white"), ("Change", "white"), ("Status", "yellow")):
+        table.add_column(column, style=style)
+
+    status_styles = {"regression": "red", "improvement": "green"}
+    previous = None
+    for component, metric, median, spread, baseline, change, status in benchmark_suite_rows(report):
+        style = status_styles.get(status)
+        table.add_row(component.upper() if component != previous else "", metric, median, spread, baseline,
+                      f"[{style}]{change}[/{style}]" if style else change,
+                      f"[{style}]{status}[/{style}]" if style else status)
+        previous = component
+    return table
 
 def create_export_function_for_benchmark(args):
     """Create a function that can be used with export_into_file for benchmark data."""
@@ -60,9 +291,9 @@ def create_export_function_for_benchmark(args):
         # All benchmarks
         def get_all_benchmarks():
             return {
-                "cpu": cpu_benchmark(),
-                "memory": mem_benchmark(),
-                "disk": disk_benchmark()
+                "cpu": cpu_benchmark(**cpu_benchmark_options(args)),
+                "memory": mem_benchmark(**mem_benchmark_options(args)),
+                "disk": disk_benchmark(**disk_benchmark_options(args))
             }
         return get_all_benchmarks
 
@@ -208,11 +439,51 @@ def format_health_data(health_data):
                 else:
                     comp_color = Fore.RED
                 formatted_output.append(f"    {comp_color}{label}: {score}/100{Style.RESET_ALL}")
+                if key == 'disk':
+                    # every mounted disk, the fullest one sets the disk score
+                    for mount, disk_score in health_data.items():
+                        if mount.startswith("disk:"):
+                            formatted_output.append(f"      {mount[5:]}: {disk_score}/100")
         
         return "\n".join(formatted_output)
     else:
         return str(health_data)
 
+def benchmark_metric_rows(data):
+    """Flatten one component's benchmark results into (metric, value) pairs for display."""
+    rows = []
+    for key, value in data.items():
+        if key == "kernels" and isinstance(value, dict):
+            for kernel, result in value.items():
+                rows.append((f"{kernel} kernel", f"{result['throughput']} {result['unit']} (median {result['median_ms']} ms, p95 {result['p95_ms']} ms)"))
+        elif key == "bandwidth" and isinstance(value, dict):
+            for kernel, result in value.items():
+                rows.append((f"{kernel} bandwidth", f"{result['throughput']} {result['unit']} (median {result['median_ms']} ms)"))
+        elif key == "latency" and isinstance(value, dict):
+            for level, result in value.items():
+                rows.append((f"{level} latency", f"{result['ns']} ns ({result['working_set']} working set)"))
+        elif key == "multithreaded" and isinstance(value, dict):
+            for kernel, result in value["bandwidth"].items():
+                rows.append((f"{kernel} bandwidth, {value['threads']} threads", f"{result['throughput']} {result['unit']} (x{value['speedup'][kernel]})"))
+        elif key == "caches" and isinstance(value, dict):
+            rows.append(("caches", ", ".join(f"{level} {size // 1024} KiB" for level, size in value.items())))
+        elif key == "tests" and isinstance(value, dict):
+            for test, result in value.items():
+                rows.append((f"{test} ({result['block_kb']} KiB, QD{result['queue_depth']})",
+                             f"{result['throughput']} {result['unit']}, {result['iops']} IOPS (p50 {result['p50_ms']} ms, p99 {result['p99_ms']} ms)"))
+        elif key == "commands" and isinstance(value, dict):
+            for command, result in value.items():
+                rows.append((f"statz {result['arguments']}", f"{result['median_ms']} ms (p90 {result['p90_ms']} ms, +{result['overhead_ms']} ms over bare python)"))
+        elif key == "slowest_imports" and isinstance(value, list):
+            rows.append(("slowest imports", ", ".join(f"{module} {ms} ms" for module, ms in value[:5])))
+        elif key == "scaling" and isinstance(value, list):
+            for entry in value:
+                speedups = ", ".join(f"{kernel} x{speedup}" for kernel, speedup in entry["speedup"].items())
+                rows.append((f"{entry['processes']} processes", f"{speedups} (efficiency {entry['efficiency']})"))
+        else:
+            rows.append((key, value))
+    return rows
+
 def format_benchmark_data(benchmark_data):
     """Format benchmark data for display with colors."""
     if isinstance(benchmark_data, dict) and "error" in benchmark_data:
@@ -244,7 +515,7 @@ def format_benchmark_data(benchmark_data):
                     rating = "Poor 🔴"
                 
                 # Display results
-                for key, value in data.items():
+                for key, value in benchmark_metric_rows(data):
                     if key == 'score':
                         formatted_output.append(f"    {color}{key}: {value} ({rating}){Style.RESET_ALL}")
                     else:
@@ -261,24 +532,31 @@ def get_component_benchmarks(args):
     if args.cpu:
         print("Running CPU benchmark...")
         try:
-            result["cpu"] = cpu_benchmark()
+            result["cpu"] = cpu_benchmark(**cpu_benchmark_options(args))
         except Exception as e:
             result["cpu"] = {"error": f"CPU benchmark failed: {str(e)}"}
     
     if args.ram:
         print("Running memory benchmark...")
         try:
-            result["memory"] = mem_benchmark()
+            result["memory"] = mem_benchmark(**mem_benchmark_options(args))
         except Exception as e:
             result["memory"] = {"error": f"Memory benchmark failed: {str(e)}"}
     
     if args.disk:
         print("Running disk benchmark...")
         try:
-            result["disk"] = disk_benchmark()
+            result["disk"] = disk_benchmark(**disk_benchmark_options(args))
         except Exception as e:
             result["disk"] = {"error": f"Disk benchmark failed: {str(e)}"}
     
+    if getattr(args, 'startup', False):
+        print("Timing statz start-up...")
+        try:
+            result["startup"] = startup_benchmark()
+        except Exception as e:
+            result["startup"] = {"error": f"Start-up benchmark failed: {str(e)}"}
+    
     return result
 
 def get_component_specs(args):
@@ -331,7 +609,7 @@ def get_component_specs(args):
                 result["processes"] = {"error": f"Process monitoring failed: {str(e)}"}
         if args.health:
             try:
-                health_data = system_health_score(cliVersion=True)
+                health_data = system_health_score(cliVersion=True, **health_options(args))
                 if health_data:
                     result["health"] = health_data
                 else:
@@ -387,7 +665,7 @@ def get_component_specs(args):
                 result["processes"] = {"error": f"Process monitoring failed: {str(e)}"}
         if args.health:
             try:
-                health_data = system_health_score(cliVersion=True)
+                health_data = system_health_score(cliVersion=True, **health_options(args))
                 if health_data:
                     result["health"] = health_data
                 else:
@@ -418,7 +696,8 @@ def get_component_usage(args):
             get_disk=args.disk,
             get_network=args.network,
             get_battery=args.battery,
-            get_totcpu=getattr(args, 'totcpu', False)
+            get_totcpu=getattr(args, 'totcpu', False),
+            get_gpu=args.gpu
         )
         
         result = {}
@@ -427,8 +706,7 @@ def get_component_usage(args):
         if args.cpu or getattr(args, 'totcpu', False):
             result["cpu"] = all_usage[0]
         if args.gpu:
-            # GPU usage functionality removed
-            result["gpu"] = {"error": "GPU usage not available"}
+            result["gpu"] = all_usage[5] if all_usage[5] else {"error": "No supported GPU found (NVIDIA via NVML, AMD via amdgpu, or a Mac GPU)"}
         if args.ram:
             result["ram"] = all_usage[1]
         if args.disk:
@@ -455,9 +733,12 @@ def get_component_usage(args):
                     result["processes"] = {"error": "Process information not available on this system"}
             except Exception as e:
                 result["processes"] = {"error": f"Process monitoring failed: {str(e)}"}
+        if args.cgroups:
+            cgroup_data = stats.get_top_n_cgroups(args.process_count, args.cgroup_type, args.cgroup_level)
+            result["cgroups"] = cgroup_data if cgroup_data else {"error": f"No cgroup with {args.cgroup_type} usage found"}
         if args.health:
             try:
-                health_data = system_health_score(cliVersion=True)
+                health_data = system_health_score(cliVersion=True, **health_options(args))
                 if health_data:
                     result["health"] = health_data
                 else:
@@ -481,6 +762,9 @@ def get_component_usage(args):
 
 def format_table_data(data, title="System Information"):
     """Format data into a Rich table for display."""
+    from rich.console import Console
+    from rich.table import Table
+    from rich import box
     console = Console()
     table = Table(title=title, box=box.ROUNDED, title_style="bold cyan")
     table.add_column("Property", style="bold blue", no_wrap=True)
@@ -559,6 +843,7 @@ def format_table_data(data, title="System Information"):
 
 def format_component_tables(component_data):
     """Format component-specific data into multiple tables."""
+    from rich.console import Console
     console = Console()
     
     for component, data in component_data.items():
@@ -575,6 +860,8 @@ def format_component_tables(component_data):
             table = format_benchmark_table(data)
         elif component.lower() == "processes":
             table = format_processes_table(data)
+        elif component.lower() == "cgroups":
+            table = format_cgroups_table(data)
         elif component.lower() == "gpu" and isinstance(data, list):
             table = format_gpu_table(data)
         else:
@@ -585,6 +872,8 @@ def format_component_tables(component_data):
 
 def format_health_table(health_data):
     """Format health score data into a table."""
+    from rich.table import Table
+    from rich import box
     table = Table(title="System Health Score", box=box.ROUNDED, title_style="bold cyan")
     table.add_column("Component", style="bold blue", no_wrap=True)
     table.add_column("Score", style="green")
@@ -610,7 +899,8 @@ def format_health_table(health_data):
                         color = "red"
                         status = "Poor 🔴"
                     
-                    table.add_row(component.replace('_', ' ').title(), f"[{color}]{score}[/{color}]", status)
+                    label = f"  Disk {component[5:]}" if component.startswith("disk:") else component.replace('_', ' ').title()
+                    table.add_row(label, f"[{color}]{score}[/{color}]", status)
             
             # Add overall score if present
             if "overall_score" in health_data:
@@ -634,6 +924,8 @@ def format_health_table(health_data):
 
 def format_benchmark_table(benchmark_data):
     """Format benchmark data into a table."""
+    from rich.table import Table
+    from rich import box
     table = Table(title="System Benchmark Results", box=box.ROUNDED, title_style="bold cyan")
     table.add_column("Component", style="bold blue", no_wrap=True)
     table.add_column("Metric", style="blue")
@@ -650,7 +942,7 @@ def format_benchmark_table(benchmark_data):
                         table.add_row(component.upper(), "Error", f"[red]{data['error']}[/red]", "")
                     else:
                         first_row = True
-                        for metric, value in data.items():
+                        for metric, value in benchmark_metric_rows(data):
                             if metric == 'score':
                                 # Color code scores
                                 score = value
@@ -689,6 +981,8 @@ def format_benchmark_table(benchmark_data):
 
 def format_processes_table(process_data):
     """Format process data into a table."""
+    from rich.table import Table
+    from rich import box
     table = Table(title="Top Processes", box=box.ROUNDED, title_style="bold cyan")
     table.add_column("PID", style="bold blue")
     table.add_column("Name", style="green")
@@ -716,8 +1010,29 @@ def format_processes_table(process_data):
     
     return table
 
+def format_cgroups_table(cgroup_data):
+    """Format cgroup data into a table."""
+    from rich.table import Table
+    from rich import box
+    table = Table(title="Top Cgroups", box=box.ROUNDED, title_style="bold cyan")
+    table.add_column("Cgroup", style="green")
+    table.add_column("Container", style="bold blue")
+    table.add_column("Usage", style="yellow")
+
+    if isinstance(cgroup_data, list):
+        for cgroup in cgroup_data:
+            usage = cgroup.get('usage', 0)
+            # CPU and pressure are numbers, memory and I/O come formatted
+            table.add_row(cgroup.get('name', 'N/A'), cgroup.get('container') or "-", usage if isinstance(usage, str) else f"{usage:.1f}%")
+    elif isinstance(cgroup_data, dict) and "error" in cgroup_data:
+        table.add_row("Error", "", f"[red]{cgroup_data['error']}[/red]")
+
+    return table
+
 def format_gpu_table(gpu_data):
     """Format GPU data into a table."""
+    from rich.table import Table
+    from rich import box
     table = Table(title="GPU Information", box=box.ROUNDED, title_style="bold cyan")
     table.add_column("GPU", style="bold blue")
     table.add_column("Property", style="blue")
@@ -804,6 +1119,7 @@ def format_gpu_table(gpu_data):
 
 def format_full_system_table(specs_data):
     """Format full system specs into organized tables."""
+    from rich.console import Console
     console = Console()
     
     if isinstance(specs_data, (tuple, list)):
@@ -847,14 +1163,168 @@ def format_full_system_table(specs_data):
             console.print(table)
             console.print()  # Add spacing between tables
 
+def parse_tolerances(entries):
+    """Turn --tolerance FIELD=VALUE entries into the tolerances dict of compare."""
+    tolerances = {}
+    for entry in entries or []:
+        field, separator, value = entry.rpartition("=")
+        if not separator or not field.strip():
+            raise ValueError(f"--tolerance expects FIELD=VALUE, not {entry!r}")
+        tolerances[field.strip()] = value.strip()
+    return tolerances or None
+
+def compare_batch(args, tolerances):
+    """Compare every snapshot in the --path1 directory or glob against the --path2 baseline."""
+    try:
+        result = compare_snapshots(args.path1, args.path2, tolerances, args.jobs)
+    except Exception as e:
+        print(f"{Fore.RED}Error during file comparison: {str(e)}{Style.RESET_ALL}")
+        return
+
+    if args.json:
+        print(json.dumps(result, indent=2, default=str))
+        return
+
+    print(f"{Fore.CYAN}Comparison Summary:{Style.RESET_ALL}")
+    print(f"  Baseline: {result['baseline_file']}")
+    print(f"  Snapshots: {result['total']}")
+    print(f"  Unchanged: {result['unchanged']}")
+    print(f"  Changed: {result['changed']}")
+    print(f"  Failed: {result['failed']}")
+
+    if result['results']:
+        print(f"\n{Fore.YELLOW}Changed Snapshots:{Style.RESET_ALL}")
+        for path, differences in result['results'].items():
+            summary = differences['summary']
+            print(f"  ~ {path}: +{summary['total_added']} -{summary['total_removed']} ~{summary['total_changed']}")
+    if result['errors']:
+        print(f"\n{Fore.RED}Failed Snapshots:{Style.RESET_ALL}")
+        for path, error in result['errors'].items():
+            print(f"  ! {path}: {error}")
+    if result['total'] and not result['changed'] and not result['failed']:
+        print(f"\n{Fore.GREEN}✓ All snapshots match the baseline{Style.RESET_ALL}")
+
+def print_json_output(specsOrUsage):
+    """Print specs or usage as JSON, naming the parts of the tuples get_system_specs and get_hardware_usage return."""
+    if isinstance(specsOrUsage, tuple):
+        # Handle tuple format (full system specs)
+        if len(specsOrUsage) == 4:
+            # macOS/Linux format
+            output = {
+                "os": specsOrUsage[0],
+                "cpu": specsOrUsage[1],
+                "memory": specsOrUsage[2],
+                "disk": specsOrUsage[3]
+            }
+        elif len(specsOrUsage) == 5:
+            # Usage format
+            output = {
+                "cpu": specsOrUsage[0],
+                "memory": specsOrUsage[1],
+                "disk": specsOrUsage[2],
+                "network": specsOrUsage[3],
+                "battery": specsOrUsage[4]
+            }
+        elif len(specsOrUsage) == 6:
+            # Windows format (old)
+            output = {
+                "cpu": specsOrUsage[0],
+                "gpu": specsOrUsage[1],
+                "memory": specsOrUsage[2],
+                "disk": specsOrUsage[3],
+                "network": specsOrUsage[4],
+                "battery": specsOrUsage[5]
+            }
+        elif len(specsOrUsage) == 7:
+            # Windows format (new with OS info)
+            output = {
+                "os": specsOrUsage[0],
+                "cpu": specsOrUsage[1],
+                "gpu": specsOrUsage[2],
+                "memory": specsOrUsage[3],
+                "disk": specsOrUsage[4],
+                "network": specsOrUsage[5],
+                "battery": specsOrUsage[6]
+            }
+        else:
+            output = specsOrUsage
+    else:
+        # Handle dictionary format (component-specific data)
+        output = specsOrUsage
+    print(json.dumps(output, indent=2))
+
+# flags `statz --usage/--specs [components] --json` may use for the fast path, anything else goes through the full parser
+FAST_PATH_COMPONENTS = ("os", "cpu", "totcpu", "gpu", "ram", "disk", "network", "battery", "temp")
+
+def print_profile_report(as_json=False):
+    """Print the collector profile to stderr, so it never mixes with JSON or CSV on stdout."""
+    profile = stats.get_profile()
+    if as_json:
+        print(json.dumps(profile, indent=2), file=sys.stderr)
+        return
+    stages = profile["stages"]
+    print(f"\n{Fore.CYAN}Collector profile ({len(stages)} stages, slowest first){Style.RESET_ALL}", file=sys.stderr)
+    if not stages:
+        print("  Nothing was collected.", file=sys.stderr)
+        return
+    for name, stage in stages.items():
+        details = [f"{stage['calls']} calls", f"total {stage['total_ms']:.1f} ms", f"p50 {stage['p50_ms']:.2f} ms",
+                   f"p90 {stage['p90_ms']:.2f} ms", f"max {stage['max_ms']:.2f} ms", f"cpu {stage['cpu_ms']:.1f} ms"]
+        if stage["syscalls"] is not None:
+            details.append(f"{stage['syscalls']} syscalls")
+        if stage["subprocesses"]:
+            details.append(f"{stage['subprocesses']} subprocesses ({', '.join(f'{command} x{count}' for command, count in stage['commands'].items())})")
+        if stage["errors"]:
+            details.append(f"{Fore.RED}{stage['errors']} errors{Style.RESET_ALL}")
+        print(f"  {Fore.GREEN}{name}{Style.RESET_ALL}: {', '.join(details)}", file=sys.stderr)
+        if stage["fallbacks"]:
+            print(f"    paths: {', '.join(f'{path} x{count}' for path, count in stage['fallbacks'].items())}", file=sys.stderr)
+        buckets = [f"<={bound} ms: {count}" if bound != "+Inf" else f">10000 ms: {count}" for bound, count in stage["histogram"].items() if count]
+        print(f"    histogram: {', '.join(buckets)}", file=sys.stderr)
+
+def fast_path(argv):
+    """
+    Answer `--version` and plain `--usage`/`--specs` JSON calls, which scripts and cron jobs run over and over,
+    without importing argparse and building the full parser. Returns False to fall back to the full parser.
+    """
+    if argv == ["--version"]:
+        print(f"{os.path.basename(sys.argv[0])} {__version__}")
+        return True
+
+    flags = set(argv)
+    modes = flags & {"--usage", "--specs"}
+    if len(flags) != len(argv) or "--json" not in flags or len(modes) != 1:
+        return False
+    components = {flag[2:] for flag in flags - {"--json", "--usage", "--specs"}}
+    if not all(flag.startswith("--") for flag in flags) or not components <= set(FAST_PATH_COMPONENTS):
+        return False
+
+    from types import SimpleNamespace
+    args = SimpleNamespace(processes=False, cgroups=False, health=False, benchmark=False, process_count=5, process_type="cpu",
+                           **{name: name in components for name in FAST_PATH_COMPONENTS})
+    if "--specs" in modes:
+        stats.set_specs_cache_file("default")
+        specsOrUsage = get_component_specs(args) if components else stats.get_system_specs()
+    else:
+        specsOrUsage = get_component_usage(args) if components else stats.get_hardware_usage()
+    print_json_output(specsOrUsage)
+    return True
+
 def main():
+    if fast_path(sys.argv[1:]):
+        return
+
     # Initialize colorama
     init()
-    
+
+    import argparse
+    from .internal._exportWriter import FORMATS as EXPORT_EXTENSIONS
+
     parser = argparse.ArgumentParser(description="Get system info with statz.")
     parser.add_argument("--specs", action="store_true", help="Get system specs")
     parser.add_argument("--usage", action="store_true", help="Get system utilization")
     parser.add_argument("--processes", action="store_true", help="Get top processes")
+    parser.add_argument("--cgroups", action="store_true", help="Get top cgroups (containers, services and slices) on Linux with cgroup v2")
 
     parser.add_argument("--os", action="store_true", help="Get OS specs/usage")
     parser.add_argument("--cpu", action="store_true", help="Get CPU specs/usage")
@@ -866,38 +1336,166 @@ def main():
     parser.add_argument("--battery", action="store_true", help="Get battery specs/usage")
     parser.add_argument("--temp", action="store_true", help="Get temperature readings")
     parser.add_argument("--health", action="store_true", help="Get system health score")
+    parser.add_argument("--health-weight", action="append", metavar="COMPONENT=WEIGHT", help="Weight of a health component (cpu, memory, disk, temperature, battery), e.g. 'disk=0.5' (repeatable)")
     parser.add_argument("--benchmark", action="store_true", help="Run system performance benchmark")
     parser.add_argument("--internetspeedtest", action="store_true", help="Run an internet speed test and get the upload/download speed as well as ping")
+    parser.add_argument("--threads", type=int, help="Parallel connections per direction for --internetspeedtest (default: server recommendation)")
+    parser.add_argument("--duration", type=float, help="Seconds to run each direction of --internetspeedtest (default: server setting) or each --benchmark kernel (default: 1 for CPU, 0.5 for memory, 3 for random disk tests)")
+    parser.add_argument("--multicore", action="store_true", help="Also run the CPU benchmark in 1 to N processes and the memory benchmark in N threads, and show how they scale")
+    parser.add_argument("--server", type=int, metavar="ID", help="speedtest.net server ID to use for --internetspeedtest")
+    parser.add_argument("--runs", type=int, help="Run every --benchmark this many times after a warm-up run and show the spread (default: 5 with --baseline/--save-baseline)")
+    parser.add_argument("--baseline", type=str, nargs="?", const="default", metavar="FILE", help="Compare --benchmark results against a saved baseline and flag significant regressions (default: per-user baseline)")
+    parser.add_argument("--startup", action="store_true", help="With --benchmark, time how long the statz CLI takes to start in fresh interpreters")
+    parser.add_argument("--save-baseline", action="store_true", help="Save the --benchmark results as the baseline (into --baseline FILE if given)")
+    parser.add_argument("--disk-path", type=str, metavar="DIR", help="Directory to run the --benchmark --disk test file in (default: temp directory)")
+    parser.add_argument("--disk-size", type=int, metavar="MB", help="Size of the disk benchmark test file in MiB (default: 256)")
+    parser.add_argument("--block-size", type=int, metavar="KB", help="Block size of the random disk benchmark tests in KiB (default: 4)")
+    parser.add_argument("--queue-depth", type=int, help="Outstanding I/Os in the random disk benchmark tests (default: 16)")
 
     parser.add_argument("--json", action="store_true", help="Output specs/usage as a JSON")
     parser.add_argument("--out", action="store_true", help="Write specs/usage into a JSON file")
     parser.add_argument("--csv", action="store_true", help="Write specs/usage into a CSV file")
+    parser.add_argument("--format", choices=list(EXPORT_EXTENSIONS), help="File format for --out (default: json), or write --watch samples as typed jsonl/csv/parquet/arrow rows (parquet and arrow need pyarrow)")
     parser.add_argument("--table", action="store_true", help="Output specs/usage as a table")
     parser.add_argument("--path", type=str, help="Specify custom export path (works with --out and --csv)")
     parser.add_argument("--securedelete", action="store_true", help="Securely delete a file by doing multiple overwrites and renamings.")
+    parser.add_argument("--recursive", action="store_true", help="Let --securedelete delete a directory and every file in it")
+    parser.add_argument("--passes", type=int, default=5, help="Overwrite passes for --securedelete (default: 5)")
 
     parser.add_argument("--compare", action="store_true", help="Compare 2 JSON or CSV files (need to specify --path1 and --path2)")
 
-    parser.add_argument("--path1", type=str, help="Specify compare path 1 (use --compare first)")
+    parser.add_argument("--path1", type=str, help="Specify compare path 1 (use --compare first). A directory or glob pattern compares every snapshot in it against --path2")
     parser.add_argument("--path2", type=str, help="Specify compare path 2 (use --compare first)")
+    parser.add_argument("--tolerance", action="append", metavar="FIELD=VALUE", help="Ignore numeric changes of a field (glob allowed) within an absolute or percentage tolerance, e.g. 'CPU.cpuFrequency=50' or 'Storage *.free=5%%' (repeatable)")
+    parser.add_argument("--jobs", type=int, help="Worker processes for directory or glob comparisons (default: CPU count), or files deleted at once by --securedelete --recursive (default: 4)")
 
-    parser.add_argument("--process-count", type=int, default=5, help="Number of top processes to show (default: 5)")
-    parser.add_argument("--process-type", choices=["cpu", "mem"], default="cpu", help="Sort processes by CPU or memory usage (default: cpu)")
+    parser.add_argument("--process-count", type=int, default=5, help="Number of top processes (or cgroups with --cgroups) to show (default: 5)")
+    parser.add_argument("--process-type", choices=["cpu", "mem", "io"], default="cpu", help="Sort processes by CPU, memory or disk I/O usage (default: cpu)")
+    parser.add_argument("--cgroup-type", choices=["cpu", "mem", "io", "pressure"], default="cpu", help="Sort --cgroups by CPU, memory, disk I/O or pressure stall time (default: cpu)")
+    parser.add_argument("--cgroup-level", choices=["leaf", "slice", "all"], default="leaf", help="Rank containers and services (leaf), systemd/Kubernetes slices (slice) or every cgroup (all) with --cgroups (default: leaf)")
 
     parser.add_argument("--dashboard", action="store_true", help="Create a live dashboard")
+    parser.add_argument("--watch", action="store_true", help="Keep sampling usage and print one line per sample until interrupted")
+    parser.add_argument("--interval", type=float, help="Seconds between samples for --watch, --record and --serve (default: 1), or between --dashboard updates (default: 2)")
+    parser.add_argument("--count", type=int, help="Stop --watch after this many samples")
+    parser.add_argument("--serve", type=str, metavar="ADDRESS", help="Serve Prometheus metrics on ADDRESS, e.g. :9100 (sampled every --interval seconds)")
+    parser.add_argument("--record", type=str, metavar="FILE", help="Record usage samples into a compact binary .statz file until interrupted")
+    parser.add_argument("--compression", choices=["none", "zlib", "zstd"], default="none", help="Compress --record chunks (default: none)")
+    parser.add_argument("--replay", type=str, metavar="FILE", help="Print the samples of a .statz recording as newline-delimited JSON")
+    parser.add_argument("--ndjson", action="store_true", help="Write --watch samples as newline-delimited JSON (appends to --path if given)")
+
+    parser.add_argument("--refresh-specs", action="store_true", help="Ignore cached specs and look everything up again (use with --specs)")
+    parser.add_argument("--profile", action="store_true", help="Time every collector stage, subprocess and fallback of the command and print the profile to stderr when it exits")
 
-    parser.add_argument("--version", action="version", version=f"%(prog)s {stats.__version__}", help="Show the version of statz")
+    parser.add_argument("--version", action="version", version=f"%(prog)s {__version__}", help="Show the version of statz")
 
     args = parser.parse_args()
 
+    if args.profile:
+        stats.enable_profiling()
+        # registered before anything runs, so the profile is printed however the command exits (Ctrl+C, sys.exit)
+        atexit.register(print_profile_report, args.json)
+
+    # the dashboard keeps its slower default, everything else samples once a second
+    dashboard_interval = args.interval or 2
+    if args.interval is None:
+        args.interval = 1.0
+
+    # Static specs are cached on disk until the next reboot so repeated --specs calls start instantly
+    if args.specs:
+        stats.set_specs_cache_file("default")
+        if args.refresh_specs:
+            stats.clear_specs_cache()
+
+    if args.serve:
+        if args.interval <= 0:
+            print(f"{Fore.RED}Error: --interval must be positive.{Style.RESET_ALL}")
+            return
+        try:
+            server = serve_metrics(args.serve, args.interval, block=False)
+        except (ValueError, OSError) as e:
+            print(f"{Fore.RED}Error starting metrics server: {e}{Style.RESET_ALL}")
+            return
+        print(f"Serving Prometheus metrics on http://{args.serve if not args.serve.startswith(':') else 'localhost' + args.serve}/metrics (press Ctrl+C to stop)")
+        try:
+            while True:
+                sleep(3600)
+        except KeyboardInterrupt:
+            pass
+        finally:
+            server.shutdown()
+            server.server_close()
+        return
+
+    if args.record:
+        if args.interval <= 0 or (args.count is not None and args.count < 1):
+            print(f"{Fore.RED}Error: --interval and --count must be positive.{Style.RESET_ALL}")
+            return
+        try:
+            print(f"Recording usage into {args.record} every {args.interval}s (press Ctrl+C to stop)")
+            written = record_usage(args.record, args.interval, args.count, args.compression)
+            print(f"Recorded {written} samples")
+        except (ValueError, RuntimeError, OSError) as e:
+            print(f"{Fore.RED}Error recording usage: {e}{Style.RESET_ALL}")
+        return
+
+    if args.replay:
+        try:
+            with open_recording(args.replay) as recording:
+                for sample in recording.samples():
+                    print(json.dumps(sample, separators=(",", ":")))
+        except BrokenPipeError:
+            pass
+        except (ValueError, RuntimeError, OSError) as e:
+            print(f"{Fore.RED}Error reading recording: {e}{Style.RESET_ALL}")
+        return
+
+    if args.watch:
+        if args.interval <= 0 or (args.count is not None and args.count < 1):
+            print(f"{Fore.RED}Error: --interval and --count must be positive.{Style.RESET_ALL}")
+            return
+        # Sample every usage component unless specific ones were requested
+        usage_flags = [args.cpu, args.ram, args.disk, args.network, args.battery, args.totcpu]
+        watch_all = not any(usage_flags)
+        run_watch(
+            get_cpu=watch_all or args.cpu,
+            get_ram=watch_all or args.ram,
+            get_disk=watch_all or args.disk,
+            get_network=watch_all or args.network,
+            get_battery=watch_all or args.battery,
+            get_totcpu=watch_all or args.totcpu,
+            interval=args.interval,
+            ndjson=args.ndjson,
+            path=args.path,
+            count=args.count,
+            process_count=args.process_count if args.processes else 0,
+            process_types=(args.process_type,),
+            export_format=args.format if args.format != "json" else None
+        )
+        return
+
+    if args.benchmark and (args.runs or args.baseline or args.save_baseline):
+        if args.runs is not None and args.runs < 1:
+            print(f"{Fore.RED}Error: --runs must be positive.{Style.RESET_ALL}")
+            return
+        try:
+            regressions = run_benchmark_suite_command(args)
+        except (ValueError, OSError) as e:
+            print(f"{Fore.RED}Error running benchmark suite: {e}{Style.RESET_ALL}")
+            sys.exit(2)
+        # a non-zero exit status lets scripts stop a rollout on a regression
+        if regressions:
+            sys.exit(1)
+        return
+
     # Check if any component flags are used
-    component_flags = [args.os, args.cpu, args.totcpu, args.gpu, args.ram, args.disk, args.network, args.battery, args.temp, args.processes, args.health, args.benchmark]
+    component_flags = [args.os, args.cpu, args.totcpu, args.gpu, args.ram, args.disk, args.network, args.battery, args.temp, args.processes, args.cgroups, args.health, args.benchmark]
     any_component_requested = any(component_flags)
 
     # Determine what data to retrieve
     if args.benchmark and not args.specs and not args.usage and not args.temp and not args.processes and not args.health and not args.internetspeedtest:
         # Handle standalone benchmark command
-        if any([args.cpu, args.ram, args.disk]):
+        if any([args.cpu, args.ram, args.disk, args.startup]):
             # Run specific component benchmarks
             print("Starting component benchmarks...")
             specsOrUsage = get_component_benchmarks(args)
@@ -906,16 +1504,16 @@ def main():
             print("Starting comprehensive system benchmark...")
             try:
                 specsOrUsage = {
-                    "cpu": stats.cpu_benchmark(),
-                    "memory": stats.mem_benchmark(),
-                    "disk": stats.disk_benchmark()
+                    "cpu": cpu_benchmark(**cpu_benchmark_options(args)),
+                    "memory": mem_benchmark(**mem_benchmark_options(args)),
+                    "disk": disk_benchmark(**disk_benchmark_options(args))
                 }
             except Exception as e:
                 specsOrUsage = {"benchmark": {"error": f"Benchmark failed: {str(e)}"}}
     elif args.health and not args.specs and not args.usage and not args.temp and not args.processes and not args.internetspeedtest:
         # Handle standalone health score command
         try:
-            specsOrUsage = {"health": stats.system_health_score(cliVersion=True)}
+            specsOrUsage = {"health": system_health_score(cliVersion=True, **health_options(args))}
             if not specsOrUsage["health"]:
                 specsOrUsage["health"] = {"error": "Health score calculation failed"}
         except Exception as e:
@@ -936,6 +1534,11 @@ def main():
                 specsOrUsage["processes"] = {"error": "Process information not available on this system"}
         except Exception as e:
             specsOrUsage = {"processes": {"error": f"Process monitoring failed: {str(e)}"}}
+    elif args.cgroups and not args.specs and not args.usage and not args.temp and not args.dashboard and not args.internetspeedtest:
+        # Handle standalone cgroups command
+        specsOrUsage = {"cgroups": stats.get_top_n_cgroups(args.process_count, args.cgroup_type, args.cgroup_level)}
+        if not specsOrUsage["cgroups"]:
+            specsOrUsage["cgroups"] = {"error": f"No cgroup with {args.cgroup_type} usage found"}
     elif args.specs:
         if any_component_requested:
             # Get specific component specs
@@ -952,7 +1555,7 @@ def main():
             specsOrUsage = stats.get_hardware_usage()
     elif args.dashboard and not args.specs and not args.usage and not args.temp and not args.processes and not args.internetspeedtest:
         try:
-            run_dashboard()
+            run_dashboard(dashboard_interval)
             return
         except Exception as e:
             print(f"{Fore.RED} Error starting dashboard: {e}{Style.RESET_ALL}")
@@ -961,13 +1564,26 @@ def main():
         try:
             print("Running internet speed test...")
 
-            results = internet_speed_test()
+            results = internet_speed_test(threads=args.threads, duration=args.duration, server_id=args.server, detailed=True)
+
+            if args.json:
+                print(json.dumps(results, indent=2))
+                return
 
             print("Test Successful! Results:")
 
-            print(f"    Download Speed: {results[0]} Mbps")
-            print(f"    Upload Speed: {results[1]} Mbps")
-            print(f"    Ping: {results[2]} ms")
+            print(f"    Download Speed: {results['download']} Mbps")
+            print(f"    Upload Speed: {results['upload']} Mbps")
+            print(f"    Ping: {results['ping']} ms")
+            if results["jitter"] is not None:
+                print(f"    Jitter: {results['jitter']} ms")
+            print(f"    Failed Latency Probes: {results['probe_loss']}%")
+            print(f"    Server: {results['server']['sponsor']} ({results['server']['name']}, {results['server']['country']})")
+            print(f"    Threads: {results['threads'].get('download')} down / {results['threads'].get('upload')} up")
+            if results["download_series"]:
+                print(f"    Download per second: {', '.join(str(value) for value in results['download_series'])} Mbps")
+            if results["upload_series"]:
+                print(f"    Upload per second: {', '.join(str(value) for value in results['upload_series'])} Mbps")
             return
 
         except Exception as e:
@@ -980,13 +1596,23 @@ def main():
             print("Usage: statz --compare --path1 file1.json --path2 file2.json")
             return
         
+        try:
+            tolerances = parse_tolerances(args.tolerance)
+        except ValueError as e:
+            print(f"{Fore.RED}Error: {e}{Style.RESET_ALL}")
+            return
+
+        if os.path.isdir(args.path1) or glob.has_magic(args.path1):
+            compare_batch(args, tolerances)
+            return
+
         try:
             print(f"Comparing files:")
             print(f"  File 1: {args.path1}")
             print(f"  File 2: {args.path2}")
             print()
             
-            comparison_result = compare(args.path1, args.path2)
+            comparison_result = compare(args.path1, args.path2, tolerances)
             
             if args.json:
                 # Output comparison results as JSON
@@ -1022,8 +1648,9 @@ def main():
                 if changed and not ('error' in str(changed)):
                     print(f"\n{Fore.YELLOW}Changed Items:{Style.RESET_ALL}")
                     for key, values in changed.items():
-                        if isinstance(values, dict) and 'old' in values and 'new' in values:
-                            print(f"  ~ {key}: {values['old']} → {values['new']}")
+                        if isinstance(values, dict) and 'from' in values and 'to' in values:
+                            delta = f" ({values['delta']:+g})" if 'delta' in values else ""
+                            print(f"  ~ {key}: {values['from']} → {values['to']}{delta}")
                         else:
                             print(f"  ~ {key}: {values}")
                 
@@ -1038,7 +1665,28 @@ def main():
             return
     elif args.securedelete and args.path:
         print(f"Securely deleting {args.path}")
-        exit_code = secure_delete(args.path)
+        if os.path.isdir(args.path) and not os.path.islink(args.path):
+            # deleting a whole tree is never implied by a path, it has to be asked for
+            if not args.recursive:
+                print(f"{Fore.RED} {args.path} is a directory, add --recursive to delete it and every file in it {Style.RESET_ALL}")
+                return
+            try:
+                result = secure_delete_tree(args.path, args.passes, workers=args.jobs)
+            except Exception as e:
+                print(f"{Fore.RED} Error deleting directory {args.path}: {e} {Style.RESET_ALL}")
+                return
+            print(f"Deleted {result['deleted']} of {result['files']} files ({result['bytes'] / 1024 / 1024:.1f} MiB, {result['trimmed']} trimmed)")
+            for path, error in result['errors'].items():
+                print(f"{Fore.RED} Error deleting {path}: {error} {Style.RESET_ALL}")
+            return
+
+        def progress(path, done, total, current_pass, passes):
+            if total:
+                print(f"\r  Pass {current_pass}/{passes}: {done * 100 // total}%", end="", flush=True)
+
+        exit_code = secure_delete(args.path, args.passes, progress=progress if sys.stdout.isatty() else None)
+        if sys.stdout.isatty():
+            print()
         if exit_code == 0:
             print(f"File {args.path} successfully deleted!")
         else:
@@ -1050,52 +1698,13 @@ def main():
         return
 
     if args.json:
-        if isinstance(specsOrUsage, tuple):
-            # Handle tuple format (full system specs)
-            if len(specsOrUsage) == 4:
-                # macOS/Linux format
-                output = {
-                    "os": specsOrUsage[0],
-                    "cpu": specsOrUsage[1],
-                    "memory": specsOrUsage[2],
-                    "disk": specsOrUsage[3]
-                }
-            elif len(specsOrUsage) == 5:
-                # Usage format
-                output = {
-                    "cpu": specsOrUsage[0],
-                    "memory": specsOrUsage[1],
-                    "disk": specsOrUsage[2],
-                    "network": specsOrUsage[3],
-                    "battery": specsOrUsage[4]
-                }
-            elif len(specsOrUsage) == 6:
-                # Windows format (old)
-                output = {
-                    "cpu": specsOrUsage[0],
-                    "gpu": specsOrUsage[1],
-                    "memory": specsOrUsage[2],
-                    "disk": specsOrUsage[3],
-                    "network": specsOrUsage[4],
-                    "battery": specsOrUsage[5]
-                }
-            elif len(specsOrUsage) == 7:
-                # Windows format (new with OS info)
-                output = {
-                    "os": specsOrUsage[0],
-                    "cpu": specsOrUsage[1],
-                    "gpu": specsOrUsage[2],
-                    "memory": specsOrUsage[3],
-                    "disk": specsOrUsage[4],
-                    "network": specsOrUsage[5],
-                    "battery": specsOrUsage[6]
-                }
-            else:
-                output = specsOrUsage
+        print_json_output(specsOrUsage)
+    elif args.out and args.format not in (None, "json"):
+        if args.path:
+            print(f"exporting specs/usage into a {args.format} file at: {args.path}")
         else:
-            # Handle dictionary format (component-specific data)
-            output = specsOrUsage
-        print(json.dumps(output, indent=2))
+            print(f"exporting specs/usage into a {args.format} file...")
+        export_with_schema(args, specsOrUsage, args.format)
     elif args.out:
         if args.path:
             print(f"exporting specs/usage into a JSON file at: {args.path}")
@@ -1176,44 +1785,7 @@ def main():
             print(f"exporting specs/usage into a CSV file at: {args.path}")
         else:
             print("exporting specs/usage into a CSV file...")
-        
-        # Determine which export function to use based on the command
-        if args.benchmark and not args.specs and not args.usage and not args.temp and not args.processes and not args.health:
-            # Standalone benchmark command
-            export_func = create_export_function_for_benchmark(args)
-        elif args.health and not args.specs and not args.usage and not args.temp and not args.processes:
-            # Standalone health command
-            export_func = create_export_function_for_health()
-        elif args.temp and not args.specs and not args.usage and not args.processes:
-            # Standalone temperature command
-            export_func = create_export_function_for_temps()
-        elif args.processes and not args.specs and not args.usage and not args.temp:
-            # Standalone processes command
-            export_func = create_export_function_for_processes(args)
-        elif args.specs:
-            # Specs command
-            export_func = create_export_function_for_specs(args)
-        elif args.usage:
-            # Usage command
-            export_func = create_export_function_for_usage(args)
-        else:
-            # Fallback - create a lambda function that returns the current data
-            export_func = lambda: specsOrUsage
-        
-        # Use the stats export function for CSV
-        # Use custom path if provided
-        custom_path = None
-        if args.path:
-            # Ensure the path has .csv extension for CSV export
-            if not args.path.endswith('.csv'):
-                custom_path = f"{args.path}.csv"
-            else:
-                custom_path = args.path
-        
-        try:
-            export_into_file(export_func, path=custom_path, csv=True, params=(False, None))
-        except Exception as e:
-            print(f"{Fore.RED}Error during CSV export: {str(e)}{Style.RESET_ALL}")
+        export_with_schema(args, specsOrUsage, "csv")
     elif args.table:
         # Handle table output format
         if isinstance(specsOrUsage, (tuple, list)):
@@ -1344,7 +1916,8 @@ def main():
                     formatted_benchmark = format_benchmark_data(data)
                     print(formatted_benchmark)
                 elif isinstance(data, dict):
-                    for k, v in data.items():
+                    # CPU and memory benchmark results have nested per-kernel and scaling results
+                    for k, v in (benchmark_metric_rows(data) if "kernels" in data or "bandwidth" in data or "tests" in data else data.items()):
                         formatted_value = format_value(k, v)
                         print(f"  {k}: {formatted_value}")
                 elif isinstance(data, list):
@@ -2,18 +2,24 @@ from rich.live import Live
 from rich.table import Table
 from rich.progress import Progress, SpinnerColumn, TextColumn, BarColumn, MofNCompleteColumn
 from rich.columns import Columns
+from rich.text import Text
 from time import sleep
 from colorama import Fore, init
 
 import platform
 import psutil
+import threading
 import time
 
 # import like this so i can test it easily
 try:
-    from .internal._crossPlatform import _get_usage
+    from .internal._crossPlatform import _get_usage, _get_top_n_cgroups
+    from .internal._cgroupCollector import _get_cgroup_tracker
+    from .internal._usageSampler import _get_sampler, _start_sampler, _stop_sampler
 except:
-    from internal._crossPlatform import _get_usage
+    from internal._crossPlatform import _get_usage, _get_top_n_cgroups
+    from internal._cgroupCollector import _get_cgroup_tracker
+    from internal._usageSampler import _get_sampler, _start_sampler, _stop_sampler
 
 init(autoreset=True)
 
@@ -136,6 +142,12 @@ def calculate_battery_usage():
 def safe_get_usage():
     """Safely get usage data with error handling"""
     try:
+        # Read from the background sampler when one is running
+        sampler = _get_sampler()
+        sample = sampler.latest() if sampler else None
+        if sample is not None:
+            return sample
+
         # Use the new _get_usage function with parameters
         # Get all components for the dashboard
         usage_data = _get_usage(
@@ -143,12 +155,13 @@ def safe_get_usage():
             get_ram=True, 
             get_disk=True,
             get_network=True,
-            get_battery=True
+            get_battery=True,
+            get_gpu=True
         )
         return usage_data
     except Exception as e:
         print(f"Error getting usage data: {e}")
-        return [{"error": "CPU data unavailable"}, {"error": "RAM data unavailable"}, {"error": "Disk data unavailable"}, {"error": "Network data unavailable"}, {"error": "Battery data unavailable"}]
+        return [{"error": "CPU data unavailable"}, {"error": "RAM data unavailable"}, {"error": "Disk data unavailable"}, {"error": "Network data unavailable"}, {"error": "Battery data unavailable"}, {"error": "GPU data unavailable"}]
 
 def get_top_processes(type="cpu"):
     try:
@@ -163,17 +176,38 @@ def get_top_processes(type="cpu"):
     else:
         return [{"error": "invalid type"}]
 
-def make_table():
-    """Create the dashboard specs_table with real usage data"""
-    specs_table = Table(title=f"🖥️  System Usage Dashboard - {platform.node()}")
-    specs_table.add_column("Component", style="cyan", width=12)
-    specs_table.add_column("Usage", style="magenta", width=25)
-    specs_table.add_column("Visual", style="green", width=30)
+def get_top_processes_multi(n=5, keys=("cpu", "mem")):
+    """Get the top processes for several metrics from a single process scan"""
+    try:
+        from .internal._crossPlatform import _get_top_n_processes_multi
+    except:
+        from statz.internal._crossPlatform import _get_top_n_processes_multi
 
-    # Get real usage data - returns [cpu_usage, ram_usage, disk_usages, network_usage, battery_usage]
-    usage_data = safe_get_usage()
-    
-    components = ["CPU", "RAM", "Disk", "Network", "Battery"]
+    top_processes = _get_top_n_processes_multi(n, keys)
+    if "error" in top_processes:
+        return {key: [] for key in keys}
+    return top_processes
+
+def get_top_cgroups(n=5):
+    """Get the containers and services using the most CPU, empty where cgroup v2 is not available"""
+    top_cgroups = _get_top_n_cgroups(n, "cpu")
+    if isinstance(top_cgroups, dict):
+        return []
+    return top_cgroups
+
+def _cgroup_row(cgroup):
+    """(name, usage, slice) cells of a cgroup, containers are shown by their short ID"""
+    parent, _, name = cgroup["name"].rpartition("/")
+    return (cgroup["container"] or name, cgroup["usage"], parent.rpartition("/")[2] or "-")
+
+def _has_data(usage_data, index):
+    """Whether a usage list has an error-free entry at index (components that were not sampled are None)"""
+    return len(usage_data) > index and usage_data[index] is not None and not "error" in usage_data[index]
+
+def format_usage_rows(usage_data):
+    """Turn usage data ([cpu_usage, ram_usage, disk_usages, network_usage, battery_usage, gpu_usages]) into (component, usage, visual bar) rows"""
+    components = ["CPU", "RAM", "Disk", "Network", "Battery", "GPU"]
+    rows = []
     
     for component in components:
         usage_value = "N/A"
@@ -182,7 +216,7 @@ def make_table():
         try:
             match component:
                 case "CPU":
-                    if len(usage_data) > 0 and not "error" in usage_data[0]:
+                    if _has_data(usage_data, 0):
                         cpu_avg = calculate_cpu_average(usage_data[0])
                         usage_value = f"{cpu_avg:.1f}%"
                         # Create visual bar
@@ -192,7 +226,7 @@ def make_table():
                         usage_value = "Error"
                         
                 case "RAM":
-                    if len(usage_data) > 1 and not "error" in usage_data[1]:
+                    if _has_data(usage_data, 1):
                         ram_percent = calculate_ram_percentage(usage_data[1])
                         usage_value = f"{ram_percent:.1f}%"
                         # Create visual bar
@@ -202,7 +236,7 @@ def make_table():
                         usage_value = "Error"
                         
                 case "Disk":
-                    if len(usage_data) > 2 and not "error" in usage_data[2]:
+                    if _has_data(usage_data, 2):
                         # Use data from _get_usage instead of psutil directly
                         disk_data = usage_data[2]
                         if isinstance(disk_data, list) and len(disk_data) > 0:
@@ -227,7 +261,7 @@ def make_table():
                         visual_bar = "█" * filled_blocks + "░" * (20 - filled_blocks)
                     
                 case "Network":
-                    if len(usage_data) > 3 and not "error" in usage_data[3]:
+                    if _has_data(usage_data, 3):
                         # Use data from _get_usage instead of calculating manually
                         network_data = usage_data[3]
                         if isinstance(network_data, dict):
@@ -250,7 +284,7 @@ def make_table():
                         visual_bar = "█" * filled_blocks + "░" * (20 - filled_blocks)
                     
                 case "Battery":
-                    if len(usage_data) > 4 and not "error" in usage_data[4]:
+                    if _has_data(usage_data, 4):
                         # Use data from _get_usage instead of psutil directly
                         battery_data = usage_data[4]
                         if isinstance(battery_data, dict):
@@ -277,11 +311,44 @@ def make_table():
                         usage_value = battery_info
                         filled_blocks = int(battery_percent / 5)
                         visual_bar = "█" * filled_blocks + "░" * (20 - filled_blocks)
+
+                case "GPU":
+                    if _has_data(usage_data, 5) and usage_data[5]:
+                        gpus = usage_data[5]
+                        busy = [gpu["usage"] for gpu in gpus if gpu.get("usage") is not None]
+                        gpu_percent = sum(busy) / len(busy) if busy else 0
+                        if len(gpus) > 1:
+                            # average over every GPU, the per-GPU values are in the exporter and --usage --gpu
+                            usage_value = f"{gpu_percent:.1f}% avg of {len(gpus)} GPUs"
+                        elif gpus[0].get("memoryUsed") is not None and gpus[0].get("memoryTotal"):
+                            usage_value = f"{gpu_percent:.1f}% {gpus[0]['memoryUsed'] / 1024:.1f}/{gpus[0]['memoryTotal'] / 1024:.1f} GB"
+                        else:
+                            usage_value = f"{gpu_percent:.1f}%"
+                        filled_blocks = int(gpu_percent / 5)
+                        visual_bar = "█" * filled_blocks + "░" * (20 - filled_blocks)
+                    else:
+                        usage_value = "No GPU"
                     
         except Exception as e:
             usage_value = f"Error: {str(e)[:20]}"
             visual_bar = "░" * 20
             
+        rows.append((component, usage_value, visual_bar))
+
+    return rows
+    
+
+def make_table():
+    """Create the dashboard specs_table with real usage data"""
+    specs_table = Table(title=f"🖥️  System Usage Dashboard - {platform.node()}")
+    specs_table.add_column("Component", style="cyan", width=12)
+    specs_table.add_column("Usage", style="magenta", width=25)
+    specs_table.add_column("Visual", style="green", width=30)
+
+    # Get real usage data - returns [cpu_usage, ram_usage, disk_usages, network_usage, battery_usage, gpu_usages]
+    usage_data = safe_get_usage()
+
+    for component, usage_value, visual_bar in format_usage_rows(usage_data):
         specs_table.add_row(component, usage_value, visual_bar)
     
     # top cpu processes
@@ -291,7 +358,10 @@ def make_table():
     top_cpu_processes_table.add_column("CPU Usage", style="magenta", width=12)
     top_cpu_processes_table.add_column("PID", style="green", width=12)
 
-    top_cpu_processes = get_top_processes()
+    # scan the process list once for both tables
+    top_processes = get_top_processes_multi(keys=("cpu", "mem"))
+
+    top_cpu_processes = top_processes["cpu"]
     for cpu_process in top_cpu_processes:
         top_cpu_processes_table.add_row(str(cpu_process["name"]), str(cpu_process["usage"]), str(cpu_process["pid"]))
     
@@ -302,7 +372,7 @@ def make_table():
     top_mem_processes_table.add_column("CPU Usage", style="magenta", width=12)
     top_mem_processes_table.add_column("PID", style="green", width=12)
 
-    top_mem_processes = get_top_processes("mem")
+    top_mem_processes = top_processes["mem"]
     for mem_process in top_mem_processes:
         top_mem_processes_table.add_row(str(mem_process["name"]), str(mem_process["usage"]), str(mem_process["pid"]))
 
@@ -314,19 +384,158 @@ def get_dashboard_columns():
     specs_table, top_cpu_processes_table, top_mem_processes_table = make_table()
     return Columns([specs_table, top_cpu_processes_table, top_mem_processes_table])
 
+class LiveDashboard:
+    """
+    Dashboard whose tables are built once and then updated in place.
+
+    Usage data comes from the background sampler and process (and, with cgroup v2, cgroup) rankings
+    from a worker thread, so redrawing never waits on a measurement. Each row's cells are rich Text
+    objects whose contents are replaced when new data arrives, and the screen is only redrawn when
+    something changed.
+    """
+    def __init__(self, process_count=5, process_interval=2.0):
+        self.process_count = process_count
+        self.process_interval = process_interval
+
+        self.specs_table = Table(title=f"🖥️  System Usage Dashboard - {platform.node()}")
+        self.specs_table.add_column("Component", style="cyan", width=12)
+        self.specs_table.add_column("Usage", style="magenta", width=25)
+        self.specs_table.add_column("Visual", style="green", width=30)
+        self._usage_cells = []
+        for component in ["CPU", "RAM", "Disk", "Network", "Battery", "GPU"]:
+            cells = (Text(component), Text("Waiting..."), Text("░" * 20))
+            self.specs_table.add_row(*cells)
+            self._usage_cells.append(cells)
+
+        self.cpu_table, self._cpu_cells = self._process_table("🧠 Top CPU Processes", "CPU Usage")
+        self.mem_table, self._mem_cells = self._process_table("🗄️  Top RAM Processes", "RAM Usage")
+
+        tables = [self.specs_table, self.cpu_table, self.mem_table]
+        self.cgroup_table = self._cgroup_cells = None
+        if _get_cgroup_tracker().available:
+            self.cgroup_table, self._cgroup_cells = self._process_table("📦 Top CPU Cgroups", "CPU Usage", "Slice")
+            tables.append(self.cgroup_table)
+        self.renderable = Columns(tables)
+
+        self._last_sample = None
+        self._top_processes = None
+        self._top_cgroups = None
+        self._processes_changed = False
+        self._lock = threading.Lock()
+        self._stop_event = threading.Event()
+        self._process_thread = None
+
+    def _process_table(self, title, usage_title, id_title="PID"):
+        table = Table(title=title)
+        table.add_column("Name", style="cyan", width=12)
+        table.add_column(usage_title, style="magenta", width=12)
+        table.add_column(id_title, style="green", width=12)
+        # fixed number of rows, blank ones are filled in when enough processes show up
+        rows = []
+        for _ in range(self.process_count):
+            cells = (Text(""), Text(""), Text(""))
+            table.add_row(*cells)
+            rows.append(cells)
+        return table, rows
+
+    def start(self):
+        self._process_thread = threading.Thread(target=self._collect_processes, name="statz-dashboard-processes", daemon=True)
+        self._process_thread.start()
+
+    def stop(self):
+        self._stop_event.set()
+        if self._process_thread is not None:
+            self._process_thread.join()
+            self._process_thread = None
+
+    def _collect_processes(self):
+        while not self._stop_event.is_set():
+            # scan the process list once for both tables
+            top_processes = get_top_processes_multi(self.process_count, keys=("cpu", "mem"))
+            top_cgroups = get_top_cgroups(self.process_count) if self.cgroup_table is not None else None
+            with self._lock:
+                self._top_processes = top_processes
+                self._top_cgroups = top_cgroups
+                self._processes_changed = True
+            self._stop_event.wait(self.process_interval)
+
+    @staticmethod
+    def _set(cell, value):
+        value = str(value)
+        if cell.plain != value:
+            cell.plain = value
+            return True
+        return False
+
+    def update(self, sample):
+        """
+        Copy new data into the tables.
+
+        Args:
+            sample (list): Newest usage data, or None if none is available yet.
+
+        Returns:
+            bool: True if anything on screen changed.
+        """
+        changed = False
+
+        if sample is not None and sample is not self._last_sample:
+            self._last_sample = sample
+            for cells, (component, usage_value, visual_bar) in zip(self._usage_cells, format_usage_rows(sample)):
+                changed |= self._set(cells[1], usage_value)
+                changed |= self._set(cells[2], visual_bar)
+
+        with self._lock:
+            processes_changed, self._processes_changed = self._processes_changed, False
+            top_processes, top_cgroups = self._top_processes, self._top_cgroups
+
+        if processes_changed:
+            rankings = [(rows, [(entry["name"], entry["usage"], entry["pid"]) for entry in top_processes.get(key, [])])
+                        for key, rows in (("cpu", self._cpu_cells), ("mem", self._mem_cells))]
+            if top_cgroups is not None:
+                rankings.append((self._cgroup_cells, [_cgroup_row(cgroup) for cgroup in top_cgroups]))
+            for rows, entries in rankings:
+                for i, cells in enumerate(rows):
+                    values = entries[i] if i < len(entries) else ("", "", "")
+                    for cell, value in zip(cells, values):
+                        changed |= self._set(cell, value)
+
+        return changed
+
 def run_dashboard(refresh_rate=2):
-    """Run dashboard until user stops it with Ctrl+C."""
+    """
+    Run dashboard until user stops it with Ctrl+C.
+
+    Args:
+        refresh_rate (float): Seconds between screen updates. Usage is sampled at the same rate by the
+                              background sampler (an already running sampler is reused), so rates as low as
+                              0.25 seconds work without the dashboard blocking on measurements.
+    """
     print(f"🚀 Starting dashboard with {refresh_rate}s refresh rate...")
     print("Press Ctrl+C to stop")
+
+    sampler = _get_sampler()
+    started_sampler = sampler is None
+    if started_sampler:
+        sampler = _start_sampler(refresh_rate)
+
+    dashboard = LiveDashboard()
+    dashboard.start()
     try:
-        with Live(get_dashboard_columns(), refresh_per_second=1/refresh_rate) as live:
+        # redraws happen only in live.refresh() below, when some cell actually changed
+        with Live(dashboard.renderable, auto_refresh=False) as live:
             while True:
+                if dashboard.update(sampler.latest(wait=False)):
+                    live.refresh()
                 sleep(refresh_rate)
-                live.update(get_dashboard_columns())
     except KeyboardInterrupt:
         print(Fore.RED + "\n✋ Dashboard stopped by user.")
     except Exception as e:
         print(Fore.RED + f"\n❌ Dashboard error: {e}")
+    finally:
+        dashboard.stop()
+        if started_sampler:
+            _stop_sampler()
 
 if __name__ == "__main__":
-    run_dashboard()
\ No newline at end of file
+    run_dashboard()
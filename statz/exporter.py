@@ -0,0 +1,287 @@
+'''Prometheus exporter.
+Serves the background sampler's latest values in the Prometheus text exposition format.
+The metrics page is rendered once per sample on a worker thread, so a scrape only copies
+a prepared byte string and never touches the system itself.'''
+
+import threading
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+# import like this so i can test it easily
+try:
+    from .internal._usageSampler import _get_sampler, _start_sampler, _stop_sampler
+    from .internal._crossPlatform import _system_health_score, _get_cgroup_usage
+    from .temp import get_system_temps
+except:
+    from internal._usageSampler import _get_sampler, _start_sampler, _stop_sampler
+    from internal._crossPlatform import _system_health_score, _get_cgroup_usage
+    from temp import get_system_temps
+
+CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8"
+MEGABYTE = 1024 * 1024
+
+def _escape_label(value):
+    return str(value).replace("\\", "\\\\").replace("\n", "\\n").replace('"', '\\"')
+
+class _MetricsPage:
+    '''Accumulates metric families and renders them in the Prometheus text format.'''
+    def __init__(self):
+        self._lines = []
+
+    def family(self, name, help_text, samples, type="gauge"):
+        '''
+        Add one metric family.
+
+        Args:
+            name (str): Metric name, e.g. "statz_cpu_usage_percent".
+            help_text (str): Description shown in the HELP line.
+            samples (list): List of (labels dict, value) tuples. Families without samples are skipped.
+            type (str): Prometheus metric type. Defaults to "gauge".
+        '''
+        samples = [(labels, value) for labels, value in samples if isinstance(value, (int, float))]
+        if not samples:
+            return
+        self._lines.append(f"# HELP {name} {help_text}")
+        self._lines.append(f"# TYPE {name} {type}")
+        for labels, value in samples:
+            if labels:
+                label_text = ",".join(f'{key}="{_escape_label(label)}"' for key, label in labels.items())
+                self._lines.append(f"{name}{{{label_text}}} {float(value)}")
+            else:
+                self._lines.append(f"{name} {float(value)}")
+
+    def render(self):
+        return ("\n".join(self._lines) + "\n").encode("utf-8")
+
+def _render_metrics(sample, temps, health, cgroups=None):
+    '''
+    Build the metrics page for one sampler sample.
+
+    Args:
+        sample (UsageSample): A sample from the background sampler.
+        temps (dict): Temperature readings from get_system_temps.
+        health (dict): Sub-scores from _system_health_score(cliVersion=True).
+        cgroups (list): Per-cgroup usage from _get_cgroup_usage, None where cgroup v2 is not available.
+
+    Returns:
+        bytes: The page in the Prometheus text exposition format.
+    '''
+    page = _MetricsPage()
+    cpu, ram, disks, network, battery = sample[:5]
+    gpus = sample[5] if len(sample) > 5 else None
+
+    page.family("statz_sample_timestamp_seconds", "Unix time the newest usage sample was taken.", [({}, sample.timestamp)])
+    page.family("statz_sample_interval_seconds", "Length of the window usage rates are measured over.", [({}, sample.interval)])
+
+    if cpu:
+        page.family("statz_cpu_usage_percent", "CPU usage per core.",
+                    [({"core": key[len("core"):]}, value) for key, value in cpu.items() if key.startswith("core")])
+        for key, help_text in (("total_usage", "Total CPU usage."), ("user_usage", "CPU time spent in user mode."), ("system_usage", "CPU time spent in kernel mode.")):
+            if key in cpu:
+                page.family(f"statz_cpu_{key}_percent", help_text, [({}, cpu[key])])
+
+    if ram:
+        page.family("statz_memory_total_bytes", "Total physical memory.", [({}, round(ram["total"] * MEGABYTE))])
+        page.family("statz_memory_used_bytes", "Used physical memory.", [({}, round(ram["used"] * MEGABYTE))])
+        page.family("statz_memory_free_bytes", "Free physical memory.", [({}, round(ram["free"] * MEGABYTE))])
+        page.family("statz_memory_usage_percent", "Physical memory in use.", [({}, ram["percent"])])
+
+    if disks:
+        page.family("statz_disk_read_bytes_per_second", "Disk read rate.",
+                    [({"device": disk["device"]}, disk["readSpeed"] * MEGABYTE) for disk in disks])
+        page.family("statz_disk_write_bytes_per_second", "Disk write rate.",
+                    [({"device": disk["device"]}, disk["writeSpeed"] * MEGABYTE) for disk in disks])
+
+    if network:
+        page.family("statz_network_transmit_bytes_per_second", "Network upload rate.", [({}, network["up"] * MEGABYTE)])
+        page.family("statz_network_receive_bytes_per_second", "Network download rate.", [({}, network["down"] * MEGABYTE)])
+
+    if battery:
+        page.family("statz_battery_percent", "Battery charge left.", [({}, battery["percent"])])
+        page.family("statz_battery_plugged_in", "1 if the charger is connected.", [({}, int(bool(battery["pluggedIn"])))])
+        # 2147483640 means unlimited (plugged in), which is not a useful gauge value
+        if battery["timeLeftMins"] != 2147483640:
+            page.family("statz_battery_time_left_minutes", "Estimated battery time left.", [({}, battery["timeLeftMins"])])
+
+    if gpus:
+        labels = [{"gpu": str(gpu["index"]), "name": gpu["name"]} for gpu in gpus]
+        for key, name, help_text, scale in (("usage", "statz_gpu_usage_percent", "Percent of time the GPU was busy.", 1),
+                                            ("memoryUsed", "statz_gpu_memory_used_bytes", "GPU memory in use.", MEGABYTE),
+                                            ("memoryTotal", "statz_gpu_memory_total_bytes", "Total GPU memory.", MEGABYTE),
+                                            ("power", "statz_gpu_power_watts", "GPU board power draw.", 1),
+                                            ("temperature", "statz_gpu_temperature_celsius", "GPU temperature.", 1)):
+            # values the backend cannot read are None and left out by family()
+            page.family(name, help_text, [(label, gpu[key] * scale if gpu[key] is not None else None) for label, gpu in zip(labels, gpus)])
+
+    if isinstance(temps, dict):
+        readings = []
+        thresholds = []
+        for sensor, value in temps.items():
+            for kind in ("High", "Critical"):
+                if sensor.endswith(f" ({kind})"):
+                    thresholds.append(({"sensor": sensor[:-len(kind) - 3], "type": kind.lower()}, value))
+                    break
+            else:
+                readings.append(({"sensor": sensor}, value))
+        page.family("statz_temperature_celsius", "Temperature sensor reading.", readings)
+        page.family("statz_temperature_threshold_celsius", "Temperature sensor high/critical threshold.", thresholds)
+
+    if isinstance(cgroups, list):
+        labels = [{"cgroup": cgroup["name"], "container": cgroup["container"] or ""} for cgroup in cgroups]
+        for key, name, help_text, scale in (("cpu", "statz_cgroup_cpu_usage_percent", "CPU usage of the cgroup in percent of one core.", 1),
+                                            ("throttled", "statz_cgroup_cpu_throttled_percent", "Time the CPU quota throttled the cgroup.", 1),
+                                            ("memory", "statz_cgroup_memory_bytes", "Memory charged to the cgroup.", MEGABYTE),
+                                            ("memoryLimit", "statz_cgroup_memory_limit_bytes", "memory.max limit of the cgroup.", MEGABYTE),
+                                            ("readSpeed", "statz_cgroup_io_read_bytes_per_second", "Disk read rate of the cgroup.", MEGABYTE),
+                                            ("writeSpeed", "statz_cgroup_io_write_bytes_per_second", "Disk write rate of the cgroup.", MEGABYTE)):
+            page.family(name, help_text, [(label, round(cgroup[key] * scale, 2) if cgroup[key] is not None else None) for label, cgroup in zip(labels, cgroups)])
+        page.family("statz_cgroup_pressure_percent", "Time some task of the cgroup was stalled on the resource (PSI).",
+                    [(dict(label, resource=resource), cgroup[f"{resource}Pressure"]) for label, cgroup in zip(labels, cgroups) for resource in ("cpu", "memory", "io")])
+
+    if isinstance(health, dict) and "error" not in health:
+        page.family("statz_health_score", "System health sub-scores from 0 to 100.",
+                    [({"component": component}, score) for component, score in health.items()])
+
+    return page.render()
+
+class _MetricsRenderer:
+    '''Re-renders the metrics page on a worker thread every time the sampler produces a sample.'''
+    def __init__(self, sampler):
+        self._sampler = sampler
+        self._stop_event = threading.Event()
+        self._thread = None
+        self._cgroups = True
+        self.page = b""
+
+    def start(self):
+        # render the first page before serving so the first scrape is not empty
+        self._render(self._sampler.latest())
+        self._thread = threading.Thread(target=self._run, name="statz-metrics-renderer", daemon=True)
+        self._thread.start()
+
+    def stop(self):
+        self._stop_event.set()
+        if self._thread is not None:
+            self._thread.join()
+            self._thread = None
+
+    def _render(self, sample):
+        if sample is None:
+            return
+        try:
+            temps = get_system_temps()
+        except:
+            temps = None
+        health = _system_health_score(cliVersion=True, usage=sample, temps=temps)
+        # usage since the previous render, i.e. over about one sample interval
+        cgroups = _get_cgroup_usage() if self._cgroups else None
+        if isinstance(cgroups, dict):
+            # not Linux or no cgroup v2, stop asking
+            self._cgroups = False
+            cgroups = None
+        # swapping one reference is atomic, scrapes always see a complete page
+        self.page = _render_metrics(sample, temps, health, cgroups)
+
+    def _run(self):
+        sample = self._sampler.latest(wait=False)
+        while not self._stop_event.is_set() and self._sampler.is_running:
+            newer = self._sampler.wait_next(sample, timeout=self._sampler.interval * 3 + 1)
+            if newer is not None and newer is not sample:
+                sample = newer
+                self._render(sample)
+
+def _make_handler(renderer):
+    class _MetricsHandler(BaseHTTPRequestHandler):
+        def do_GET(self):
+            if self.path.split("?", 1)[0] == "/metrics":
+                body = renderer.page
+                self.send_response(200)
+                self.send_header("Content-Type", CONTENT_TYPE)
+            elif self.path == "/":
+                body = b'<html><body><h1>statz exporter</h1><a href="/metrics">Metrics</a></body></html>\n'
+                self.send_response(200)
+                self.send_header("Content-Type", "text/html; charset=utf-8")
+            else:
+                body = b"Not found\n"
+                self.send_response(404)
+                self.send_header("Content-Type", "text/plain; charset=utf-8")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def log_message(self, format, *args):
+            # scrapes every few seconds would flood the terminal
+            pass
+
+    return _MetricsHandler
+
+class _MetricsServer(ThreadingHTTPServer):
+    '''HTTP server that also stops the renderer, and the sampler if it started it, when it is closed.'''
+    daemon_threads = True
+    renderer = None
+    started_sampler = False
+
+    def server_close(self):
+        super().server_close()
+        if self.renderer is not None:
+            # stopping the sampler first wakes the renderer if it is waiting for a sample,
+            # a sampler someone else started wakes it with its next sample instead
+            if self.started_sampler:
+                _stop_sampler()
+                self.started_sampler = False
+            self.renderer.stop()
+            self.renderer = None
+
+def _parse_address(address):
+    '''
+    Split "host:port", ":port" or "port" into a (host, port) tuple.
+    '''
+    address = str(address)
+    host, _, port = address.rpartition(":")
+    if not port.isdigit():
+        raise ValueError(f"Invalid listen address {address}, expected host:port or :port")
+    return host.strip("[]"), int(port)
+
+def serve_metrics(address=":9100", interval=1.0, block=True):
+    '''
+    Serve usage, temperature, health and (on Linux with cgroup v2) per-cgroup metrics for Prometheus.
+
+    Starts the background sampler (if it is not running already) and an HTTP server that answers
+    GET /metrics with the newest values in the Prometheus text format. The page is prepared once per
+    sample, so a scrape takes well under a millisecond and causes no extra system calls.
+
+    Args:
+        address (str): Listen address, "host:port" or ":port" for every interface. Defaults to ":9100".
+        interval (float): Seconds between samples if the sampler has to be started. Defaults to 1.
+        block (bool): If True, serve until interrupted. If False, serve on a background thread and return the server.
+
+    Returns:
+        ThreadingHTTPServer or None: The running server when block is False. Call `.shutdown()` and then
+        `.server_close()` to stop it, which also stops the sampler if serve_metrics started it.
+
+    Raises:
+        ValueError: If the address cannot be parsed.
+        OSError: If the port cannot be bound.
+    '''
+    host, port = _parse_address(address)
+
+    # bind first so a busy port fails before any sampling threads are started
+    server = _MetricsServer((host, port), None)
+    # reuse a sampler the caller, health monitor or dashboard already runs instead of replacing it
+    sampler = _get_sampler()
+    server.started_sampler = sampler is None
+    if server.started_sampler:
+        sampler = _start_sampler(interval)
+    server.renderer = _MetricsRenderer(sampler)
+    server.RequestHandlerClass = _make_handler(server.renderer)
+    server.renderer.start()
+
+    if not block:
+        threading.Thread(target=server.serve_forever, name="statz-metrics-server", daemon=True).start()
+        return server
+
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.server_close()
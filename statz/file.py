@@ -4,146 +4,38 @@ import os
 import string
 import random
 
-def export_into_file(function, path=None, csv=False, params=(False, None)):
+from .internal._exportWriter import FORMATS, _export, _open_writer, _schema_for
+from .internal._compareEngine import _compare_files, _compare_many
+from .internal._secureDelete import _secure_delete_file, _secure_delete_tree
+
+def export_into_file(function, path=None, csv=False, params=(False, None), file_format=None, schema=None):
     '''
-    Export the output of a function to a JSON or CSV file.
+    Export the output of a function to a JSON, JSON Lines, CSV, Parquet or Arrow file.
     
     This utility function takes another function as input, executes it,
-    and writes the output to a file named "statz_export_{date}_{time}.json" or ".csv" or {path} if specified.
+    and writes the output to a file named "statz_export_{date}_{time}.{extension}" or {path} if specified.
     
     Args:
         function (callable): The function whose output is to be exported.
         path (str): The path to export to (Defaults to None)
-        csv (bool): If True, exports as CSV. If False, exports as JSON. Defaults to False.
+        csv (bool): If True, exports as CSV. Same as file_format="csv". Defaults to False.
         params (tuple): Additional parameters to pass to the function. Put (False, None) if no parameters are needed. Otherwise, put (True, [values, values, values, ...]).
+        file_format (str): "json" (one indented document), "jsonl", "csv", "parquet" or "arrow". The last two
+                           need pyarrow. Defaults to "csv" if csv is True, otherwise "json".
+        schema (str): Name of the export schema to use, e.g. "usage", "specs", "processes", "temps" or "health".
+                      Defaults to the one the function declares.
 
     Note:
-        CSV export works best with functions that return lists of dictionaries or simple data structures.
-        Complex nested data will be flattened or converted to strings for CSV compatibility.
+        statz collectors declare the typed columns their output is exported with, see the README.
+        Output of other functions is written as one row per dict for lists of flat dicts, and as
+        flattened key/value rows otherwise.
     '''
-    import csv as csv_module
-    
-    def flatten_for_csv(data, prefix=''):
-        """Flatten complex nested data structures for CSV export."""
-        flattened = {}
-        
-        if isinstance(data, dict):
-            for key, value in data.items():
-                new_key = f"{prefix}.{key}" if prefix else key
-                if isinstance(value, (dict, list)):
-                    flattened.update(flatten_for_csv(value, new_key))
-                else:
-                    flattened[new_key] = str(value)
-        elif isinstance(data, list):
-            for i, item in enumerate(data):
-                new_key = f"{prefix}[{i}]" if prefix else f"item_{i}"
-                if isinstance(item, (dict, list)):
-                    flattened.update(flatten_for_csv(item, new_key))
-                else:
-                    flattened[new_key] = str(item)
-        else:
-            key = prefix if prefix else 'value'
-            flattened[key] = str(data)
-            
-        return flattened
-
-    def format_hardware_usage_csv(data, writer):
-        """Special formatting for hardware usage data to make it more readable."""
-        if len(data) != 5:
-            # Not hardware usage format, use generic flattening
-            flattened = flatten_for_csv(data)
-            writer.writerow(['Key', 'Value'])
-            for key, value in flattened.items():
-                writer.writerow([key, value])
-            return
-        
-        # Hardware usage specific formatting
-        cpu_data, ram_data, disk_data, network_data, battery_data = data
-        
-        # Write a more structured CSV for hardware usage
-        writer.writerow(['Component', 'Metric', 'Value', 'Unit'])
-        
-        # CPU data
-        if cpu_data:
-            for core, usage in cpu_data.items():
-                writer.writerow(['CPU', core, str(usage), '%'])
-        
-        # RAM data  
-        if ram_data:
-            for metric, value in ram_data.items():
-                unit = 'MB' if metric in ['total', 'used', 'free'] else '%'
-                writer.writerow(['RAM', metric, str(value), unit])
-        
-        # Disk data
-        if disk_data:
-            for i, disk in enumerate(disk_data):
-                for metric, value in disk.items():
-                    unit = 'MB/s' if 'Speed' in metric else ''
-                    writer.writerow(['Disk', f"{disk.get('device', f'Disk{i+1}')}.{metric}", str(value), unit])
-        
-        # Network data
-        if network_data:
-            for metric, value in network_data.items():
-                writer.writerow(['Network', metric, str(value), 'MB/s'])
-        
-        # Battery data
-        if battery_data:
-            for metric, value in battery_data.items():
-                unit = '%' if metric == 'percent' else 'minutes' if metric == 'timeLeftMins' else ''
-                writer.writerow(['Battery', metric, str(value), unit])
-
-    def format_system_specs_csv(data, writer):
-        """Special formatting for system specs data to make it more readable."""
-        writer.writerow(['Component', 'Property', 'Value'])
-        
-        if len(data) == 4:
-            # macOS/Linux format: [os_info, cpu_info, mem_info, disk_info]
-            components = ['OS', 'CPU', 'Memory', 'Disk']
-        elif len(data) == 7:
-            # Windows format: [os_data, cpu_data, gpu_data_list, ram_data_list, storage_data_list, network_data, battery_data]
-            components = ['OS', 'CPU', 'GPU', 'Memory', 'Storage', 'Network', 'Battery']
-        else:
-            # Fallback to generic formatting
-            flattened = flatten_for_csv(data)
-            writer.writerow(['Key', 'Value'])
-            for key, value in flattened.items():
-                writer.writerow([key, value])
-            return
-        
-        for i, component_data in enumerate(data):
-            component_name = components[i]
-            
-            if isinstance(component_data, dict):
-                for prop, value in component_data.items():
-                    writer.writerow([component_name, prop, str(value)])
-            elif isinstance(component_data, list):
-                for j, item in enumerate(component_data):
-                    if isinstance(item, dict):
-                        for prop, value in item.items():
-                            writer.writerow([f"{component_name} {j+1}", prop, str(value)])
-                    else:
-                        writer.writerow([f"{component_name} {j+1}", 'value', str(item)])
-            else:
-                writer.writerow([component_name, 'value', str(component_data)])
-
-    def format_simple_dict_csv(data, writer, component_name='Temperature'):
-        """Format simple dictionaries like temperature data."""
-        writer.writerow(['Component', 'Sensor', 'Value', 'Unit'])
-        for sensor, value in data.items():
-            # Extract numeric value and determine unit
-            if isinstance(value, (int, float)):
-                temp_value = str(value)
-                unit = '°C'
-            elif isinstance(value, str) and '°C' in value:
-                temp_value = value.replace('°C', '').strip()
-                unit = '°C'
-            else:
-                temp_value = str(value)
-                unit = ''
-            
-            writer.writerow([component_name, sensor, temp_value, unit])
-    
     try:
+        file_format = file_format or ("csv" if csv else "json")
+        if file_format not in FORMATS:
+            raise ValueError(f"Unknown export format {file_format}, expected one of {', '.join(FORMATS)}")
+        declared = _schema_for(function, schema)
+        
         if params[0]:
             output = function(*params[1])
         else:
@@ -151,285 +43,58 @@ def export_into_file(function, path=None, csv=False, params=(False, None)):
         
         if not path:
             time = datetime.now().strftime("%H-%M-%S")
-            
-            if not csv:
-                # JSON Export
-                path_to_export = f"statz_export_{date.today()}_{time}.json"
-                with open(path_to_export, "w") as f:
-                    json.dump(output, f, indent=2)
-            else:
-                # CSV Export
-                path_to_export = f"statz_export_{date.today()}_{time}.csv"
-                with open(path_to_export, "w", newline='') as f:
-                    writer = csv_module.writer(f)
-                    
-                    if isinstance(output, list):
-                        # Check if it's a simple list of dictionaries
-                        if output and all(isinstance(item, dict) for item in output):
-                            # Standard case: list of dictionaries (like process data)
-                            keys = output[0].keys()
-                            writer.writerow(keys)
-                            for item in output:
-                                writer.writerow([str(item.get(key, '')) for key in keys])
-                        else:
-                            # Check if this looks like hardware usage data (list of 5 items with specific structure)
-                            if (len(output) == 5 and 
-                                isinstance(output[0], dict) and  # CPU data
-                                isinstance(output[1], dict) and  # RAM data
-                                isinstance(output[2], list)):    # Disk data
-                                format_hardware_usage_csv(output, writer)
-                            # Check if this looks like system specs data
-                            elif len(output) in [4, 7] and all(isinstance(item, (dict, list)) for item in output):
-                                format_system_specs_csv(output, writer)
-                            else:
-                                # Generic complex list with mixed types or nested structures
-                                flattened = flatten_for_csv(output)
-                                writer.writerow(['Key', 'Value'])
-                                for key, value in flattened.items():
-                                    writer.writerow([key, value])
-                    elif isinstance(output, dict):
-                        # Check if this looks like temperature data or other simple key-value dicts
-                        if all(isinstance(v, (int, float, str)) for v in output.values()):
-                            # Simple dictionary - likely temperature or similar sensor data
-                            format_simple_dict_csv(output, writer, 'Sensor')
-                        else:
-                            # Complex dictionary with nested structures
-                            flattened = flatten_for_csv(output)
-                            writer.writerow(['Key', 'Value'])
-                            for key, value in flattened.items():
-                                writer.writerow([key, value])
-                    elif isinstance(output, tuple):
-                        # Tuple - treat as multiple columns in one row
-                        writer.writerow([f'Column_{i+1}' for i in range(len(output))])
-                        writer.writerow([str(item) for item in output])
-                    else:
-                        # Single value or other types
-                        writer.writerow(['Value'])
-                        writer.writerow([str(output)])
-            
-            print(f"Export completed: {path_to_export}")
-        else:
-            if not csv:
-                # JSON Export
-                with open(path, "w") as f:
-                    json.dump(output, f, indent=2)
-            else:
-                # CSV Export
-                with open(path, "w", newline='') as f:
-                    writer = csv_module.writer(f)
-                    
-                    if isinstance(output, list):
-                        # Check if it's a simple list of dictionaries
-                        if output and all(isinstance(item, dict) for item in output):
-                            # Standard case: list of dictionaries (like process data)
-                            keys = output[0].keys()
-                            writer.writerow(keys)
-                            for item in output:
-                                writer.writerow([str(item.get(key, '')) for key in keys])
-                        else:
-                            # Check if this looks like hardware usage data (list of 5 items with specific structure)
-                            if (len(output) == 5 and 
-                                isinstance(output[0], dict) and  # CPU data
-                                isinstance(output[1], dict) and  # RAM data
-                                isinstance(output[2], list)):    # Disk data
-                                format_hardware_usage_csv(output, writer)
-                            # Check if this looks like system specs data
-                            elif len(output) in [4, 7] and all(isinstance(item, (dict, list)) for item in output):
-                                format_system_specs_csv(output, writer)
-                            else:
-                                # Generic complex list with mixed types or nested structures
-                                flattened = flatten_for_csv(output)
-                                writer.writerow(['Key', 'Value'])
-                                for key, value in flattened.items():
-                                    writer.writerow([key, value])
-                    elif isinstance(output, dict):
-                        # Check if this looks like temperature data or other simple key-value dicts
-                        if all(isinstance(v, (int, float, str)) for v in output.values()):
-                            # Simple dictionary - likely temperature or similar sensor data
-                            format_simple_dict_csv(output, writer, 'Sensor')
-                        else:
-                            # Complex dictionary with nested structures
-                            flattened = flatten_for_csv(output)
-                            writer.writerow(['Key', 'Value'])
-                            for key, value in flattened.items():
-                                writer.writerow([key, value])
-                    elif isinstance(output, tuple):
-                        # Tuple - treat as multiple columns in one row
-                        writer.writerow([f'Column_{i+1}' for i in range(len(output))])
-                        writer.writerow([str(item) for item in output])
-                    else:
-                        # Single value or other types
-                        writer.writerow(['Value'])
-                        writer.writerow([str(output)])
-            
-            print(f"Export completed: {path}")
-
+            path = f"statz_export_{date.today()}_{time}{FORMATS[file_format]}"
         
+        _export(output, path, file_format, declared)
+        print(f"Export completed: {path}")
+    
     except Exception as e:
         print(f"Error exporting to file: {e}")
 
-def compare(current_specs_path, baseline_specs_path):
+def export_stream(results, path=None, file_format="jsonl", schema="usage", append=False, flush_interval=1.0):
     '''
-    Compare current system specs against a baseline file (JSON or CSV).
+    Write results to a file as they are produced, e.g. the samples of stats.stream_hardware_usage.
+    
+    Rows go through a buffered writer and nothing is kept between results, so memory use stays flat
+    however long the stream runs.
     
     Args:
-        current_specs_path (str): Path to current specs file to compare.
-        baseline_specs_path (str): Path to baseline specs file to compare against.
+        results (iterable): Collector results, all of the same kind.
+        path (str): File to write. Defaults to None (stdout, JSON Lines and CSV only).
+        file_format (str): "jsonl", "csv", "parquet" or "arrow". Defaults to "jsonl".
+        schema (str): Export schema of the results. Defaults to "usage" (get_hardware_usage lists).
+        append (bool): Append to an existing JSON Lines or CSV file. Defaults to False.
+        flush_interval (float): Seconds between flushes to disk for JSON Lines and CSV. Defaults to 1.
     
     Returns:
-        dict: Dictionary with 'added', 'removed', and 'changed' keys showing differences.
+        int: Number of rows written.
     '''
-    import csv as csv_module
-    
-    def load_json_file(path):
-        """Load JSON file and return data."""
-        with open(path, 'r') as f:
-            return json.load(f)
-    
-    def load_csv_file(path):
-        """Load CSV file and convert to dictionary structure."""
-        data = {}
-        with open(path, 'r', newline='') as f:
-            reader = csv_module.DictReader(f)
-            for i, row in enumerate(reader):
-                component = row.get('Component', f'row_{i}')
-                property_name = row.get('Property', f'prop_{i}')
-                value = row.get('Value', '')
-                
-                if component not in data:
-                    data[component] = {}
-                
-                data[component][property_name] = value
-        return data
+    with _open_writer(path, _schema_for(None, schema), file_format, append, flush_interval) as writer:
+        try:
+            for result in results:
+                writer.write(result)
+        except KeyboardInterrupt:
+            pass
+        return writer.rows_written
+
+def compare(current_specs_path, baseline_specs_path, tolerances=None):
+    '''
+    Compare current system specs against a baseline file (JSON, JSON Lines or CSV).
     
-    def normalize_json_data(data):
-        """Convert JSON list format to comparable dictionary structure."""
-        if isinstance(data, list):
-            # Convert list of dictionaries to component-based structure
-            normalized = {}
-            component_counters = {}
-            
-            for item in data:
-                if isinstance(item, dict):
-                    # Try to determine component type from the data
-                    if 'system' in item or 'version' in item:
-                        component_name = 'OS'
-                    elif 'name' in item and ('Intel' in str(item.get('name', '')) or 'AMD' in str(item.get('name', '')) or 'Core' in str(item.get('name', ''))):
-                        if 'Graphics' in str(item.get('name', '')) or 'NVIDIA' in str(item.get('name', '')):
-                            component_counters['GPU'] = component_counters.get('GPU', 0) + 1
-                            component_name = f"GPU {component_counters['GPU']}"
-                        else:
-                            component_name = 'CPU'
-                    elif 'capacity' in item or ('speed' in item and 'name' not in item):
-                        component_counters['Memory'] = component_counters.get('Memory', 0) + 1
-                        component_name = f"Memory {component_counters['Memory']}"
-                    elif 'size' in item or 'model' in item:
-                        component_counters['Storage'] = component_counters.get('Storage', 0) + 1
-                        component_name = f"Storage {component_counters['Storage']}"
-                    elif 'adapter' in item or ('description' in item and 'Intel' not in str(item.get('description', ''))):
-                        component_counters['Network'] = component_counters.get('Network', 0) + 1
-                        component_name = f"Network {component_counters['Network']}"
-                    elif 'percent' in item or 'pluggedIn' in item:
-                        component_name = 'Battery'
-                    else:
-                        # Unknown component
-                        component_counters['Unknown'] = component_counters.get('Unknown', 0) + 1
-                        component_name = f"Unknown {component_counters['Unknown']}"
-                    
-                    # Convert all values to strings for consistent comparison
-                    string_item = {}
-                    for k, v in item.items():
-                        string_item[k] = str(v)
-                    
-                    normalized[component_name] = string_item
-                elif isinstance(item, list):
-                    # Handle nested lists (like GPU arrays)
-                    for j, subitem in enumerate(item):
-                        if isinstance(subitem, dict):
-                            component_counters['GPU'] = component_counters.get('GPU', 0) + 1
-                            # Convert all values to strings
-                            string_subitem = {}
-                            for k, v in subitem.items():
-                                string_subitem[k] = str(v)
-                            normalized[f"GPU {component_counters['GPU']}"] = string_subitem
-            
-            return normalized
-        return data
+    Both files are hashed section by section, so identical sections are skipped without comparing their fields.
     
-    def deep_compare(dict1, dict2, path=""):
-        """Recursively compare two dictionaries."""
-        differences = {'added': {}, 'removed': {}, 'changed': {}}
-        
-        # Ensure both inputs are dictionaries
-        if not isinstance(dict1, dict):
-            dict1 = {}
-        if not isinstance(dict2, dict):
-            dict2 = {}
-        
-        # Check for removed and changed items
-        for key in dict1:
-            # Ensure key is hashable (string)
-            key_str = str(key)
-            current_path = f"{path}.{key_str}" if path else key_str
-            
-            if key not in dict2:
-                differences['removed'][current_path] = str(dict1[key])[:100]
-            elif isinstance(dict1[key], dict) and isinstance(dict2[key], dict):
-                # Recursively compare nested dictionaries
-                nested_diff = deep_compare(dict1[key], dict2[key], current_path)
-                differences['added'].update(nested_diff['added'])
-                differences['removed'].update(nested_diff['removed'])
-                differences['changed'].update(nested_diff['changed'])
-            elif str(dict1[key]) != str(dict2[key]):  # Compare as strings for consistency
-                # Only add to changed if the values are actually different
-                val1 = str(dict1[key]).strip()
-                val2 = str(dict2[key]).strip()
-                if val1 != val2:
-                    differences['changed'][current_path] = {
-                        'from': val1[:100],  # Limit string length
-                        'to': val2[:100]     # Limit string length
-                    }
-        
-        # Check for added items
-        for key in dict2:
-            key_str = str(key)
-            current_path = f"{path}.{key_str}" if path else key_str
-            if key not in dict1:
-                differences['added'][current_path] = str(dict2[key])[:100]  # Limit string length
-        
-        return differences
+    Args:
+        current_specs_path (str): Path to current specs file to compare.
+        baseline_specs_path (str): Path to baseline specs file to compare against.
+        tolerances (dict): Per-field numeric tolerances, {field path or glob: tolerance}. Numbers are absolute,
+                           "N%" strings relative to the baseline, e.g. {"CPU.cpuFrequency": 50, "Storage *.free": "5%"}.
+                           Numeric changes within the tolerance are not reported. Defaults to None.
     
+    Returns:
+        dict: Dictionary with 'added', 'removed', and 'changed' keys showing differences.
+    '''
     try:
-        current_ext = current_specs_path.split(".")[-1].lower()
-        baseline_ext = baseline_specs_path.split(".")[-1].lower()
-        
-        if current_ext == "json":
-            current_data = load_json_file(current_specs_path)
-            current_data = normalize_json_data(current_data)
-        elif current_ext == "csv":
-            current_data = load_csv_file(current_specs_path)
-        else:
-            raise ValueError(f"Unsupported file type: {current_ext}")
-        
-        if baseline_ext == "json":
-            baseline_data = load_json_file(baseline_specs_path)
-            baseline_data = normalize_json_data(baseline_data)
-        elif baseline_ext == "csv":
-            baseline_data = load_csv_file(baseline_specs_path)
-        else:
-            raise ValueError(f"Unsupported file type: {baseline_ext}")
-        
-        differences = deep_compare(baseline_data, current_data)
-        
-        differences['summary'] = {
-            'total_added': len(differences['added']),
-            'total_removed': len(differences['removed']),
-            'total_changed': len(differences['changed']),
-            'current_file': current_specs_path,
-            'baseline_file': baseline_specs_path
-        }
-        
-        return differences
+        return _compare_files(current_specs_path, baseline_specs_path, tolerances)
         
     except FileNotFoundError as e:
         return {
@@ -444,45 +109,70 @@ def compare(current_specs_path, baseline_specs_path):
             "changed": {"error": f"Comparison failed: {str(e)}"}
         }
 
-def secure_delete(file):
+def compare_snapshots(snapshots, baseline_specs_path, tolerances=None, processes=None):
+    '''
+    Compare many spec snapshots against one baseline, e.g. a nightly fleet audit against a golden image.
+    
+    The baseline is hashed once per worker process, and only snapshots that differ are reported.
+    
+    Args:
+        snapshots (str or list): Directory of .json/.jsonl/.csv exports, a glob pattern like "audit/**/*.json", or a list of paths.
+        baseline_specs_path (str): Path to the baseline specs file.
+        tolerances (dict): Per-field numeric tolerances, see compare.
+        processes (int): Number of worker processes. Defaults to the CPU count (small sets run in this process).
+    
+    Returns:
+        dict: {
+            "baseline_file": baseline path,
+            "total", "unchanged", "changed", "failed": snapshot counts,
+            "results": { snapshot path: {"added", "removed", "changed", "summary"} } for the snapshots that differ,
+            "errors": { snapshot path: error message }
+        }
+    
+    Raises:
+        FileNotFoundError: If the baseline does not exist.
+        ValueError: If a tolerance or processes is invalid.
+    '''
+    return _compare_many(snapshots, baseline_specs_path, tolerances, processes)
+
+def secure_delete(file, passes=5, progress=None, trim="auto"):
     """
     Securely deletes a file, doing multiple overwrite passes on it to ensure it that it cannot be recovered.
+    
+    The file is overwritten in place in 4 MiB chunks, with an fsync after every pass, so memory use does not grow with
+    the file size. On SSDs, where overwriting cannot reach remapped blocks, the file's blocks are also discarded (TRIM).
 
     Args:
-     file (str): Path of the file to be deleted
+     file (str): Path of the file to be deleted. Directories are refused, use secure_delete_tree for them.
+     passes (int or list): Number of random passes, or a list of "random", "zeros" and "ones" passes. Defaults to 5.
+     progress (callable): Called with (path, bytes written, total bytes, pass, passes) after every chunk. Defaults to None.
+     trim (bool or str): Discard the file's blocks after overwriting, "auto" only on SSDs (Linux). Defaults to "auto".
     
     Returns:
-     exit_code (int): Exit code. If code is 0, the operation was successful. Otherwise, returns -1.
+     exit_code (int): Exit code. If code is 0, the operation was successful. Otherwise (also for a directory), returns -1.
     """
     try:
-        import random
-        import string
-        
-        # Get the file size and directory
-        file_path = os.path.abspath(file)
-        file_size = os.path.getsize(file_path)
-        file_dir = os.path.dirname(file_path)
-        
-        # Overwrite the file multiple times with random data
-        for _ in range(5):
-            with open(file_path, "wb") as f:
-                f.write(os.urandom(file_size))
-        
-        # Generate a random filename in the same directory
-        characters = string.ascii_letters + string.digits
-        random_filename = ''.join(random.choice(characters) for _ in range(16))
-        random_path = os.path.join(file_dir, random_filename)
-        
-        # Rename the file to the random name
-        os.rename(file_path, random_path)
-        
-        # Finally delete the renamed file
-        os.remove(random_path)
-        
+        _secure_delete_file(file, passes, progress=progress, trim=trim)
         return 0  # Success
     except Exception as e:
         return -1
 
+def secure_delete_tree(path, passes=5, progress=None, trim="auto", workers=None):
+    """
+    Securely deletes every file under a directory, then the directories themselves.
+
+    Args:
+     path (str): Directory to delete.
+     workers (int): Files overwritten at the same time. Defaults to 4.
+     passes, progress, trim: See secure_delete.
+    
+    Returns:
+     dict: {"path", "files", "deleted", "failed", "bytes", "trimmed", "errors": {path: error message}}
+    
+    Raises:
+     ValueError: If path is not a directory, or passes or workers is invalid.
+    """
+    return _secure_delete_tree(path, passes, progress=progress, trim=trim, workers=workers)
 
 if __name__ == "__main__":
     # print(compare("a.json", "b.json"))
@@ -2,8 +2,11 @@
 This module provides a unified interface to calculate system health scores based on various hardware metrics.'''
 
 from .internal._crossPlatform import _system_health_score
+from .internal._healthEngine import _start_health_monitor, _stop_health_monitor
+from .internal._exportWriter import _export_schema
 
-def system_health_score(cliVersion=False):
+@_export_schema("health")
+def system_health_score(cliVersion=False, weights=None, thresholds=None):
     '''
     Calculate a system health score based on various hardware metrics.
     
@@ -11,14 +14,22 @@ def system_health_score(cliVersion=False):
     temperature, battery (if available), and network usage. Each metric contributes to a total score
     that reflects the overall health of the system.
 
+    CPU, memory and battery are read from the background sampler when it is running (see
+    start_health_monitor), and every mounted disk is scored, the fullest one setting the disk score.
+    Disk space and temperatures are cached for 30 and 5 seconds, so calling this every second is cheap.
+
     Args:
         cliVersion (bool, optional): If True, returns a dictionary with individual scores for each metric.
                                      If False, returns a single health score. Defaults to False.
+        weights (dict, optional): Weight per component ("cpu", "memory", "disk", "temperature", "battery"),
+                                  merged over the defaults (0.3, 0.25, 0.25, 0.1, 0.1) and normalized. Defaults to None.
+        thresholds (dict, optional): (value, score) breakpoints for "cpu", "memory", "disk" (used %) and "temperature" (°C),
+                                     interpolated linearly, e.g. {"cpu": [(60, 100), (90, 40), (100, 0)]}. Defaults to None.
     
     Returns:
         float: A health score between 0 and 100, where 100 indicates optimal health.\n
         OR\n
-        dict: If cliVersion is True, returns a dictionary with individual scores for each metric.\n
+        dict: If cliVersion is True, returns a dictionary with individual scores for each metric, and "disk:<mount>" for every disk.\n
         OR\n
         exception: If any metric calculation fails.\n
     
@@ -26,4 +37,28 @@ def system_health_score(cliVersion=False):
         Exception: If any metric calculation fails.
     '''
 
-    return _system_health_score(cliVersion)
+    return _system_health_score(cliVersion, weights=weights, thresholds=thresholds)
+
+def start_health_monitor(callback=None, weights=None, thresholds=None, interval=1.0):
+    '''
+    Start updating health scores in the background, once per sample of the background sampler.
+
+    Each update only rescores from the new sample, so the monitor adds no measurements of its own, and
+    system_health_score with the same weights and thresholds then returns the latest scores at once.
+
+    Args:
+        callback (callable, optional): Called with the sub-scores dict (as with cliVersion=True) after every update. Defaults to None.
+        weights (dict, optional): See system_health_score.
+        thresholds (dict, optional): See system_health_score.
+        interval (float, optional): Sampling interval in seconds if the background sampler has to be started. Defaults to 1.0.
+
+    Raises:
+        ValueError: If a weight or threshold is invalid.
+    '''
+    _start_health_monitor(callback, weights, thresholds, interval)
+
+def stop_health_monitor():
+    '''
+    Stop the background health monitor. The background sampler keeps running.
+    '''
+    _stop_health_monitor()
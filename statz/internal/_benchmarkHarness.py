@@ -0,0 +1,423 @@
+'''
+Repeatable benchmark runs.
+Each benchmark is run several times after untimed warm-up runs, pinned to one CPU where that does not
+defeat the benchmark, and every metric is summarized over the runs. The environment (governor,
+frequency, load, power source...) is recorded next to the results, so a changed number can be told
+apart from a changed machine. Results can be saved as a baseline and later runs are checked against
+it with Welch's t-test, so only differences larger than the run-to-run noise are reported.
+'''
+
+import json
+import math
+import os
+import platform
+import statistics
+import time
+
+import psutil
+
+try:
+    from ._cpuBenchmark import _cpu_benchmark, NATIVE_AVAILABLE
+    from ._memBenchmark import _mem_benchmark
+    from ._diskBenchmark import _disk_benchmark
+    from ._startupBenchmark import _startup_benchmark
+except ImportError:
+    from _cpuBenchmark import _cpu_benchmark, NATIVE_AVAILABLE
+    from _memBenchmark import _mem_benchmark
+    from _diskBenchmark import _disk_benchmark
+    from _startupBenchmark import _startup_benchmark
+
+BENCHMARKS = {
+    "cpu": _cpu_benchmark,
+    "memory": _mem_benchmark,
+    "disk": _disk_benchmark,
+    "startup": _startup_benchmark,
+}
+
+# the hardware benchmarks; startup measures statz itself and only runs when asked for
+DEFAULT_COMPONENTS = ("cpu", "memory", "disk")
+
+BASELINE_VERSION = 1
+
+def _default_baseline_path():
+    '''Return the default baseline location for this platform.'''
+    if platform.system() == "Windows":
+        base = os.environ.get("LOCALAPPDATA") or os.path.expanduser("~")
+    elif platform.system() == "Darwin":
+        base = os.path.expanduser("~/Library/Application Support")
+    else:
+        base = os.environ.get("XDG_DATA_HOME") or os.path.expanduser("~/.local/share")
+    return os.path.join(base, "statz", "benchmark_baseline.json")
+
+def _read_first_line(path):
+    try:
+        with open(path, "r") as f:
+            return f.readline().strip()
+    except:
+        return None
+
+def _environment():
+    '''
+    Everything about the machine's state that moves benchmark numbers.
+
+    Returns:
+        dict: Platform, CPU and frequency scaling details, load and power source, plus "warnings" for states
+        known to make results noisy (powersave governor, busy machine, running on battery).
+    '''
+    environment = {
+        "hostname": platform.node(),
+        "os": f"{platform.system()} {platform.release()}",
+        "machine": platform.machine(),
+        "processor": platform.processor() or None,
+        "python": f"{platform.python_implementation()} {platform.python_version()}",
+        "native_kernels": NATIVE_AVAILABLE,
+        "logical_cpus": psutil.cpu_count(logical=True),
+        "physical_cpus": psutil.cpu_count(logical=False),
+        "governor": None,
+        "boost": None,
+        "frequency_mhz": None,
+        "load_average": None,
+        "cpu_percent": None,
+        "memory_available_mb": None,
+        "on_battery": None,
+    }
+    warnings = []
+
+    if platform.system() == "Linux":
+        governors = sorted({value for value in (_read_first_line(f"/sys/devices/system/cpu/cpu{i}/cpufreq/scaling_governor")
+                                                for i in range(environment["logical_cpus"] or 1)) if value})
+        environment["governor"] = ",".join(governors) or None
+        boost = _read_first_line("/sys/devices/system/cpu/cpufreq/boost")
+        no_turbo = _read_first_line("/sys/devices/system/cpu/intel_pstate/no_turbo")
+        if boost is not None:
+            environment["boost"] = boost == "1"
+        elif no_turbo is not None:
+            environment["boost"] = no_turbo == "0"
+        if governors and governors != ["performance"]:
+            warnings.append(f"CPU frequency governor is {environment['governor']}, 'performance' gives steadier results")
+
+    try:
+        frequency = psutil.cpu_freq()
+        if frequency:
+            environment["frequency_mhz"] = {"current": round(frequency.current), "min": round(frequency.min), "max": round(frequency.max)}
+    except:
+        pass
+
+    try:
+        environment["load_average"] = [round(value, 2) for value in os.getloadavg()]
+    except:
+        pass
+
+    try:
+        environment["cpu_percent"] = psutil.cpu_percent(interval=0.5)
+        if environment["cpu_percent"] > 10:
+            warnings.append(f"CPU was {environment['cpu_percent']}% busy before the run")
+    except:
+        pass
+
+    try:
+        environment["memory_available_mb"] = round(psutil.virtual_memory().available / 1024 / 1024)
+    except:
+        pass
+
+    try:
+        battery = psutil.sensors_battery()
+        if battery is not None:
+            environment["on_battery"] = not battery.power_plugged
+            if environment["on_battery"]:
+                warnings.append("Running on battery, power saving may throttle the CPU")
+    except:
+        pass
+
+    environment["warnings"] = warnings
+    return environment
+
+def _pick_cpu():
+    '''The CPU to pin to: the last one allowed, since CPU 0 usually services most interrupts.'''
+    try:
+        allowed = psutil.Process().cpu_affinity()
+        return allowed[-1] if allowed else None
+    except:
+        return None
+
+class _Pinned:
+    '''Context manager that pins this process to one CPU and restores the previous affinity.'''
+    def __init__(self, cpu):
+        self.cpu = cpu
+        self.previous = None
+
+    def __enter__(self):
+        if self.cpu is None:
+            return self
+        try:
+            process = psutil.Process()
+            self.previous = process.cpu_affinity()
+            process.cpu_affinity([self.cpu])
+        except:
+            self.cpu = None
+        return self
+
+    def __exit__(self, *exc):
+        if self.previous is not None:
+            try:
+                psutil.Process().cpu_affinity(self.previous)
+            except:
+                pass
+        return False
+
+def _can_pin(component, options):
+    '''Pinning would squeeze multi-process, multi-thread and queued I/O runs onto one CPU.'''
+    if component == "cpu":
+        return not options.get("multicore")
+    if component == "memory":
+        return (options.get("threads") or 1) == 1
+    return False
+
+def _metrics(component, result):
+    '''
+    The comparable numbers of one benchmark result.
+
+    Returns:
+        dict: { metric name: (value, unit, higher_is_better) }
+    '''
+    metrics = {"score": (result.get("score"), "", True)}
+    if component == "cpu":
+        for name, kernel in result.get("kernels", {}).items():
+            metrics[f"{name}.throughput"] = (kernel["throughput"], kernel["unit"], True)
+    elif component == "memory":
+        for name, kernel in result.get("bandwidth", {}).items():
+            metrics[f"{name}.bandwidth"] = (kernel["throughput"], kernel["unit"], True)
+        for level, entry in result.get("latency", {}).items():
+            metrics[f"{level}.latency"] = (entry["ns"], "ns", False)
+        multithreaded = result.get("multithreaded")
+        if multithreaded:
+            for name, kernel in multithreaded["bandwidth"].items():
+                metrics[f"{name}.bandwidth_{multithreaded['threads']}_threads"] = (kernel["throughput"], kernel["unit"], True)
+    elif component == "disk":
+        for name, test in result.get("tests", {}).items():
+            metrics[f"{name}.throughput"] = (test["throughput"], test["unit"], True)
+            metrics[f"{name}.iops"] = (test["iops"], "IOPS", True)
+            if test.get("p99_ms") is not None:
+                metrics[f"{name}.p99"] = (test["p99_ms"], "ms", False)
+    elif component == "startup":
+        for name, command in result.get("commands", {}).items():
+            metrics[f"{name}.median"] = (command["median_ms"], "ms", False)
+        metrics["import"] = (result.get("import_ms"), "ms", False)
+    return {name: metric for name, metric in metrics.items() if metric[0] is not None}
+
+def _summarize(samples, unit, higher_is_better):
+    mean = statistics.fmean(samples) if hasattr(statistics, "fmean") else statistics.mean(samples)
+    stdev = statistics.stdev(samples) if len(samples) > 1 else 0.0
+    return {
+        "median": round(statistics.median(samples), 3),
+        "mean": round(mean, 3),
+        "stdev": round(stdev, 3),
+        "cv_percent": round(stdev / mean * 100, 2) if mean else None,
+        "min": min(samples),
+        "max": max(samples),
+        "unit": unit,
+        "higher_is_better": higher_is_better,
+        "samples": samples,
+    }
+
+def _betacf(a, b, x):
+    '''Continued fraction of the incomplete beta function (Lentz's method).'''
+    tiny = 1e-300
+    qab, qap, qam = a + b, a + 1.0, a - 1.0
+    c, d = 1.0, 1.0 - qab * x / qap
+    d = 1.0 / (d if abs(d) > tiny else tiny)
+    h = d
+    for m in range(1, 201):
+        m2 = 2 * m
+        aa = m * (b - m) * x / ((qam + m2) * (a + m2))
+        d = 1.0 + aa * d
+        d = 1.0 / (d if abs(d) > tiny else tiny)
+        c = 1.0 + aa / c
+        c = c if abs(c) > tiny else tiny
+        h *= d * c
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2))
+        d = 1.0 + aa * d
+        d = 1.0 / (d if abs(d) > tiny else tiny)
+        c = 1.0 + aa / c
+        c = c if abs(c) > tiny else tiny
+        delta = d * c
+        h *= delta
+        if abs(delta - 1.0) < 1e-12:
+            break
+    return h
+
+def _regularized_beta(a, b, x):
+    if x <= 0.0:
+        return 0.0
+    if x >= 1.0:
+        return 1.0
+    front = math.exp(math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b) + a * math.log(x) + b * math.log(1.0 - x))
+    if x < (a + 1.0) / (a + b + 2.0):
+        return front * _betacf(a, b, x) / a
+    return 1.0 - front * _betacf(b, a, 1.0 - x) / b
+
+def _welch_t_test(baseline, current):
+    '''
+    Two-sided Welch's t-test of two independent samples with unequal variances.
+
+    Returns:
+        float: p-value, or None when either side has fewer than two samples.
+    '''
+    if len(baseline) < 2 or len(current) < 2:
+        return None
+    mean_1, mean_2 = statistics.mean(baseline), statistics.mean(current)
+    var_1, var_2 = statistics.variance(baseline) / len(baseline), statistics.variance(current) / len(current)
+    if var_1 + var_2 == 0:
+        return 1.0 if mean_1 == mean_2 else 0.0
+    t = (mean_1 - mean_2) / math.sqrt(var_1 + var_2)
+    df = (var_1 + var_2) ** 2 / ((var_1 ** 2 / (len(baseline) - 1) if var_1 else 0.0) + (var_2 ** 2 / (len(current) - 1) if var_2 else 0.0))
+    # P(|T| > |t|) for Student's t with df degrees of freedom
+    return _regularized_beta(df / 2.0, 0.5, df / (df + t * t))
+
+def _compare_to_baseline(metrics, baseline, alpha, threshold):
+    '''
+    Classify every metric against the baseline.
+
+    A metric is a regression (or improvement) only if the difference is statistically significant (p < alpha)
+    and the median moved by more than `threshold` percent, so noise and tiny but consistent shifts are both ignored.
+    '''
+    results = {}
+    counts = {"regression": 0, "improvement": 0, "unchanged": 0, "new": 0}
+    for component, component_metrics in metrics.items():
+        for name, summary in component_metrics.items():
+            key = f"{component}.{name}"
+            previous = baseline.get("metrics", {}).get(component, {}).get(name)
+            if not previous:
+                results[key] = {"status": "new"}
+                counts["new"] += 1
+                continue
+
+            change = (summary["median"] - previous["median"]) / previous["median"] * 100 if previous["median"] else 0.0
+            better = change > 0 if summary["higher_is_better"] else change < 0
+            p_value = _welch_t_test(previous["samples"], summary["samples"])
+            significant = (p_value is not None and p_value < alpha) or (p_value is None and abs(change) > 2 * threshold)
+            if significant and abs(change) > threshold:
+                status = "improvement" if better else "regression"
+            else:
+                status = "unchanged"
+            counts[status] += 1
+            results[key] = {
+                "status": status,
+                "baseline_median": previous["median"],
+                "current_median": summary["median"],
+                "change_percent": round(change, 2),
+                "p_value": round(p_value, 4) if p_value is not None else None,
+            }
+
+    return {"metrics": results, "counts": counts}
+
+def _environment_changes(before, after):
+    '''Environment fields that differ from the baseline and usually explain a shifted result.'''
+    fields = ("hostname", "os", "processor", "python", "native_kernels", "logical_cpus", "governor", "boost", "on_battery")
+    return {field: {"from": before.get(field), "to": after.get(field)} for field in fields if before.get(field) != after.get(field)}
+
+def _load_baseline(path):
+    with open(path, "r") as f:
+        baseline = json.load(f)
+    if not isinstance(baseline, dict) or "metrics" not in baseline:
+        raise ValueError(f"{path} is not a statz benchmark baseline")
+    return baseline
+
+def _save_report(report, path):
+    directory = os.path.dirname(path)
+    if directory:
+        os.makedirs(directory, exist_ok=True)
+    temp_path = f"{path}.tmp"
+    with open(temp_path, "w") as f:
+        json.dump(report, f, indent=2)
+    os.replace(temp_path, path)
+
+def _run_benchmark_suite(components=None, runs=5, warmup_runs=1, pin_cpu=True, options=None,
+                         baseline=None, save_baseline=False, alpha=0.05, threshold=3.0, progress=None):
+    '''
+    Run benchmarks repeatedly and summarize, record and optionally compare the results.
+
+    Args:
+        components (list): Any of "cpu", "memory", "disk" and "startup". Defaults to cpu, memory and disk.
+        runs (int): Timed runs of every benchmark. Defaults to 5.
+        warmup_runs (int): Untimed runs first, for caches, clocks and lazily loaded code. Defaults to 1.
+        pin_cpu (bool): Pin single-threaded benchmarks to one CPU. Defaults to True.
+        options (dict): { component: keyword arguments for that benchmark }.
+        baseline (str): Baseline file to compare against, "default" for the per-user one. Defaults to None.
+        save_baseline (bool): Write this run's results to the baseline file afterwards. Defaults to False.
+        alpha (float): Significance level of the regression test. Defaults to 0.05.
+        threshold (float): Smallest change in percent that is reported. Defaults to 3.
+        progress (callable): Called with (component, run number, total runs) before each run.
+
+    Returns:
+        dict: {"version", "timestamp", "environment", "settings", "metrics": { component: { metric: summary } },
+        "comparison": {"baseline", "baseline_timestamp", "environment_changes", "metrics", "counts"} (with a baseline)}
+    '''
+    names = list(components) if components else list(DEFAULT_COMPONENTS)
+    for name in names:
+        if name not in BENCHMARKS:
+            raise ValueError(f"Unknown benchmark {name}, expected one of {', '.join(BENCHMARKS)}")
+    if runs < 1 or warmup_runs < 0:
+        raise ValueError("runs must be positive and warmup_runs not negative")
+    options = options or {}
+    baseline_path = _default_baseline_path() if baseline == "default" or (save_baseline and not baseline) else baseline
+
+    previous = None
+    if baseline_path and os.path.exists(baseline_path):
+        previous = _load_baseline(baseline_path)
+    elif baseline and not save_baseline:
+        raise FileNotFoundError(f"Baseline file {baseline_path} does not exist, run with save_baseline=True first")
+
+    environment = _environment()
+    cpu = _pick_cpu() if pin_cpu else None
+    pinned = {}
+    metrics = {}
+    start_time = time.time()
+
+    for name in names:
+        component_options = options.get(name, {})
+        samples = {}
+        units = {}
+        with _Pinned(cpu if _can_pin(name, component_options) else None) as pin:
+            pinned[name] = pin.cpu
+            for run in range(warmup_runs + runs):
+                if progress:
+                    progress(name, run + 1, warmup_runs + runs)
+                result = BENCHMARKS[name](**component_options)
+                if run < warmup_runs:
+                    continue
+                for metric, (value, unit, higher_is_better) in _metrics(name, result).items():
+                    samples.setdefault(metric, []).append(value)
+                    units[metric] = (unit, higher_is_better)
+        metrics[name] = {metric: _summarize(values, *units[metric]) for metric, values in samples.items()}
+
+    report = {
+        "version": BASELINE_VERSION,
+        "timestamp": time.time(),
+        "environment": environment,
+        "settings": {
+            "runs": runs,
+            "warmup_runs": warmup_runs,
+            "pinned_cpu": pinned,
+            "options": options,
+            "execution_time": round(time.time() - start_time, 3),
+        },
+        "metrics": metrics,
+    }
+
+    if previous is not None:
+        comparison = _compare_to_baseline(metrics, previous, alpha, threshold)
+        comparison["baseline"] = baseline_path
+        comparison["baseline_timestamp"] = previous.get("timestamp")
+        comparison["environment_changes"] = _environment_changes(previous.get("environment", {}), environment)
+        report["comparison"] = comparison
+
+    if save_baseline:
+        saved = {key: value for key, value in report.items() if key != "comparison"}
+        if previous is not None:
+            # keep the baseline of components this run did not touch
+            saved["metrics"] = {**previous.get("metrics", {}), **metrics}
+        _save_report(saved, baseline_path)
+        report["baseline_saved"] = baseline_path
+
+    return report
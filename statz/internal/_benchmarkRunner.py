@@ -0,0 +1,153 @@
+'''
+Timing harness shared by the benchmarks.
+A kernel is calibrated so one run takes long enough to time precisely, warmed up, then run
+repeatedly for a fixed duration. Results are reported as the median and 95th percentile of the
+run times, with the throughput derived from the median. The multi-process mode runs the same
+kernel in 1..N processes at once, started together on a barrier, to measure scaling.
+'''
+
+import concurrent.futures
+import math
+import multiprocessing
+import os
+import time
+
+# a single run should take at least this long, so timer resolution and call overhead do not matter
+MIN_RUN_SECONDS = 0.01
+MIN_RUNS = 5
+
+def _percentile(values, percent):
+    '''Linear interpolation percentile of a list of numbers.'''
+    ordered = sorted(values)
+    if not ordered:
+        return None
+    position = (len(ordered) - 1) * percent / 100
+    lower = math.floor(position)
+    upper = math.ceil(position)
+    return ordered[lower] + (ordered[upper] - ordered[lower]) * (position - lower)
+
+def _calibrate(kernel):
+    '''Double the kernel's size until a single run takes at least MIN_RUN_SECONDS.'''
+    size = kernel.size
+    while True:
+        start = time.perf_counter()
+        kernel.run(size)
+        if time.perf_counter() - start >= MIN_RUN_SECONDS:
+            return size
+        size *= 2
+
+def _measure(kernel, duration=1.0, warmup=0.25):
+    '''
+    Time one kernel in this process.
+
+    Args:
+        kernel: Object with `size`, `unit`, `scale` and `run(size) -> work units done`.
+        duration (float): Seconds of timed runs (at least MIN_RUNS runs are always made).
+        warmup (float): Seconds of untimed runs first, to settle caches and clock speeds.
+
+    Returns:
+        dict: {"throughput": work per second / scale, "unit", "median_ms", "p95_ms", "runs", "size"}
+    '''
+    size = _calibrate(kernel)
+
+    deadline = time.perf_counter() + warmup
+    while time.perf_counter() < deadline:
+        kernel.run(size)
+
+    times = []
+    work = 0
+    deadline = time.perf_counter() + duration
+    while len(times) < MIN_RUNS or time.perf_counter() < deadline:
+        start = time.perf_counter()
+        work = kernel.run(size)
+        times.append(time.perf_counter() - start)
+
+    median = _percentile(times, 50)
+    return {
+        "throughput": round(work / median / kernel.scale, 2),
+        "unit": kernel.unit,
+        "median_ms": round(median * 1000, 3),
+        "p95_ms": round(_percentile(times, 95) * 1000, 3),
+        "runs": len(times),
+        "size": size,
+    }
+
+_barrier = None
+
+def _init_worker(barrier):
+    global _barrier
+    _barrier = barrier
+
+def _parallel_worker(factory, size, duration, warmup):
+    '''Warm up, wait for every other worker, then run for `duration` seconds. Returns (work done, seconds).'''
+    kernel = factory()
+    deadline = time.perf_counter() + warmup
+    while time.perf_counter() < deadline:
+        kernel.run(size)
+
+    _barrier.wait(timeout=60)
+    start = time.perf_counter()
+    work = 0
+    while True:
+        work += kernel.run(size)
+        elapsed = time.perf_counter() - start
+        if elapsed >= duration:
+            return work, elapsed
+
+def _process_counts(max_processes=None):
+    '''1, 2, 4, ... up to max_processes (default: every logical CPU), always ending at the maximum.'''
+    maximum = max_processes or os.cpu_count() or 1
+    counts = []
+    count = 1
+    while count < maximum:
+        counts.append(count)
+        count *= 2
+    counts.append(maximum)
+    return counts
+
+def _measure_scaling(factories, sizes, duration=1.0, warmup=0.25, max_processes=None):
+    '''
+    Run each kernel in 1, 2, 4 ... N processes at the same time.
+
+    Args:
+        factories (dict): { kernel name: picklable callable returning the kernel }.
+        sizes (dict): { kernel name: calibrated size } from the single-process measurement.
+
+    Returns:
+        list: One dict per process count:
+        {"processes": n, "throughput": {kernel: total}, "speedup": {kernel: vs 1 process}, "efficiency": mean speedup / n}
+    '''
+    results = []
+    single = {}
+
+    for processes in _process_counts(max_processes):
+        barrier = multiprocessing.Barrier(processes)
+        with concurrent.futures.ProcessPoolExecutor(max_workers=processes, initializer=_init_worker, initargs=(barrier,)) as pool:
+            throughput = {}
+            for name, factory in factories.items():
+                futures = [pool.submit(_parallel_worker, factory, sizes[name], duration, warmup) for _ in range(processes)]
+                finished = [future.result() for future in futures]
+                kernel = factory()
+                total = sum(work for work, _ in finished) / max(elapsed for _, elapsed in finished)
+                throughput[name] = round(total / kernel.scale, 2)
+
+        if not single:
+            single = dict(throughput)
+        speedup = {name: round(value / single[name], 2) if single[name] else None for name, value in throughput.items()}
+        speedups = [value for value in speedup.values() if value is not None]
+        results.append({
+            "processes": processes,
+            "throughput": throughput,
+            "speedup": speedup,
+            "efficiency": round(sum(speedups) / len(speedups) / processes, 2) if speedups else None,
+        })
+
+    return results
+
+def _score(results, references):
+    '''Geometric mean of throughput / reference throughput, times 100.'''
+    ratios = [results[name]["throughput"] / reference for name, reference in references.items()
+              if name in results and results[name]["throughput"] > 0]
+    if not ratios:
+        return 0.0
+    return round(math.exp(sum(math.log(ratio) for ratio in ratios) / len(ratios)) * 100, 1)
@@ -0,0 +1,398 @@
+'''
+Per-cgroup usage from the cgroup v2 (unified) hierarchy on Linux.
+The hierarchy is scanned once and cached, and every cgroup keeps its counter files (cpu.stat,
+memory.current, io.stat and the cpu/memory/io pressure files) open, so a refresh is one pread per file
+instead of an open, read and close. The tree is scanned again every few seconds, or as soon as a read
+shows a cgroup went away, to pick up new and removed containers. CPU, I/O and pressure are counters,
+and their usage is the change since the previous refresh divided by the time between refreshes.
+'''
+
+import heapq
+import os
+import re
+import threading
+import time
+
+try:
+    from ._profiler import _stage, _fallback
+except ImportError:
+    from _profiler import _stage, _fallback
+
+MOUNTS_PATH = "/proc/mounts"
+DEFAULT_ROOT = "/sys/fs/cgroup"
+# seconds between scans of the hierarchy for new and removed cgroups
+SCAN_INTERVAL = 10.0
+COUNTER_FILES = ("cpu.stat", "memory.current", "io.stat", "cpu.pressure", "memory.pressure", "io.pressure")
+# every counter file fits into this unless a cgroup does I/O on very many devices
+READ_SIZE = 8192
+# share of the RLIMIT_NOFILE soft limit that cached counter files may use, the rest are opened per read
+FD_SHARE = 0.25
+
+LEVELS = ("leaf", "slice", "all")
+# docker, containerd, CRI-O and podman name a container's cgroup after its 64 hex digit ID
+CONTAINER_PATTERN = re.compile(r"(?:^|[-/])([0-9a-f]{64})(?:\.scope)?$")
+
+def _find_root():
+    '''Mount point of the cgroup v2 hierarchy, or None where it is not mounted (cgroup v1 only, no Linux).'''
+    if os.path.exists(os.path.join(DEFAULT_ROOT, "cgroup.controllers")):
+        return DEFAULT_ROOT
+    try:
+        with open(MOUNTS_PATH, "rb") as f:
+            mounts = f.read()
+    except OSError:
+        return None
+    # hybrid setups mount it next to the v1 controllers, usually at /sys/fs/cgroup/unified
+    for line in mounts.splitlines():
+        fields = line.split()
+        if len(fields) > 2 and fields[2] == b"cgroup2":
+            return os.fsdecode(fields[1])
+    return None
+
+def _fd_budget():
+    try:
+        import resource
+        soft = resource.getrlimit(resource.RLIMIT_NOFILE)[0]
+    except:
+        return 256
+    if soft == resource.RLIM_INFINITY:
+        return 4096
+    return int(soft * FD_SHARE)
+
+def _parse_cpu_stat(data):
+    usage = throttled = None
+    for line in data.split(b"\n"):
+        key, _, value = line.partition(b" ")
+        if key == b"usage_usec":
+            usage = int(value)
+        elif key == b"throttled_usec":
+            throttled = int(value)
+    return usage, throttled
+
+def _parse_io_stat(data):
+    '''(read bytes, written bytes, read IOs, write IOs) summed over every device.'''
+    totals = [0, 0, 0, 0]
+    for line in data.split(b"\n"):
+        # "259:0 rbytes=... wbytes=... rios=... wios=... dbytes=... dios=..."
+        for field in line.split(b" ")[1:]:
+            key, _, value = field.partition(b"=")
+            if key == b"rbytes":
+                totals[0] += int(value)
+            elif key == b"wbytes":
+                totals[1] += int(value)
+            elif key == b"rios":
+                totals[2] += int(value)
+            elif key == b"wios":
+                totals[3] += int(value)
+    return totals
+
+def _parse_pressure(data):
+    '''Microseconds in which some task of the cgroup was stalled, from the "some ... total=" line.'''
+    if not data.startswith(b"some"):
+        return None
+    return int(data.split(b"total=", 1)[1].split(b"\n", 1)[0])
+
+def _delta(new, old):
+    # a counter that went backwards belongs to a new cgroup that got the old one's name
+    if new is None or old is None or new < old:
+        return None
+    return new - old
+
+class _CgroupGone(Exception):
+    '''A cgroup directory was removed between scans.'''
+
+class _Cgroup:
+    '''Cached counter files, last counter values and last usage of one cgroup.'''
+    __slots__ = ("name", "path", "inode", "container", "leaf", "files", "memory_max", "counters", "usage", "io_rate")
+
+    def __init__(self, name, path, inode):
+        self.name = name
+        self.path = path
+        self.inode = inode
+        match = CONTAINER_PATTERN.search(name)
+        self.container = match.group(1)[:12] if match else None
+        self.leaf = True
+        # { file name: open fd, or None when it is re-opened on every read }
+        self.files = {}
+        self.memory_max = None
+        self.counters = None
+        self.usage = None
+        # read + write bytes per second, unrounded for the I/O ranking
+        self.io_rate = None
+
+    def read(self, name):
+        '''Contents of a counter file, None if the controller is not enabled for this cgroup.'''
+        if name not in self.files:
+            return None
+        fd = self.files[name]
+        try:
+            if fd is None:
+                with open(os.path.join(self.path, name), "rb", buffering=0) as f:
+                    return f.read()
+            data = os.pread(fd, READ_SIZE, 0)
+            while len(data) % READ_SIZE == 0 and data:
+                more = os.pread(fd, READ_SIZE, len(data))
+                if not more:
+                    break
+                data += more
+            return data
+        except OSError:
+            # reads of a removed cgroup's files fail with ENODEV
+            raise _CgroupGone()
+
+    def close(self):
+        for fd in self.files.values():
+            if fd is not None:
+                os.close(fd)
+        self.files = {}
+
+class _CgroupTracker:
+    '''
+    Cached cgroup v2 hierarchy whose counters are re-read on every refresh.
+
+    Usage is computed from the previous refresh, so the first refresh only records counters and
+    reports no CPU, I/O or pressure values yet.
+    '''
+    def __init__(self, root=None):
+        self._root = root if root is not None else _find_root()
+        self._cgroups = {}
+        self._last_scan = None
+        self._last_refresh = None
+        self._open_files = 0
+        self._fd_budget = _fd_budget()
+        self._lock = threading.Lock()
+
+    @property
+    def available(self):
+        return self._root is not None
+
+    def refresh(self):
+        '''Re-read the counters of every cgroup, scanning the hierarchy first when it is due.'''
+        with self._lock:
+            now = time.monotonic()
+            if self._last_scan is None or now - self._last_scan >= SCAN_INTERVAL:
+                with _stage("scan"):
+                    self._scan()
+                self._last_scan = now
+            elapsed = now - self._last_refresh if self._last_refresh is not None else None
+            self._last_refresh = now
+
+            gone = []
+            for name, cgroup in self._cgroups.items():
+                try:
+                    self._update(cgroup, elapsed)
+                except _CgroupGone:
+                    gone.append(name)
+            if gone:
+                for name in gone:
+                    self._forget(name)
+                # containers usually start and stop in batches, look for the new ones right away
+                self._last_scan = None
+
+    def _scan(self):
+        cgroups = self._cgroups
+        seen = set()
+        stack = [("", self._root)]
+        while stack:
+            name, path = stack.pop()
+            try:
+                entries = list(os.scandir(path))
+            except OSError:
+                continue
+            children = 0
+            files = set()
+            for entry in entries:
+                try:
+                    if entry.is_dir(follow_symlinks=False):
+                        child = f"{name}/{entry.name}" if name else entry.name
+                        children += 1
+                        seen.add(child)
+                        existing = cgroups.get(child)
+                        # same name but a new directory: the old cgroup was removed and another one created
+                        if existing is not None and existing.inode != entry.inode():
+                            self._forget(child)
+                            existing = None
+                        if existing is None:
+                            cgroups[child] = _Cgroup(child, entry.path, entry.inode())
+                        stack.append((child, entry.path))
+                    else:
+                        files.add(entry.name)
+                except OSError:
+                    continue
+            cgroup = cgroups.get(name)
+            if cgroup is not None:
+                cgroup.leaf = children == 0
+                self._open(cgroup, files)
+                cgroup.memory_max = self._memory_max(cgroup, files)
+
+        # the root itself is left out, its usage is the host's usage
+        for name in cgroups.keys() - seen:
+            self._forget(name)
+
+    def _open(self, cgroup, files):
+        '''Open the counter files that exist now, controllers can be enabled after the cgroup was created.'''
+        for name in COUNTER_FILES:
+            if name in cgroup.files or name not in files:
+                continue
+            if self._open_files < self._fd_budget:
+                try:
+                    cgroup.files[name] = os.open(os.path.join(cgroup.path, name), os.O_RDONLY | getattr(os, "O_CLOEXEC", 0))
+                    self._open_files += 1
+                    continue
+                except OSError:
+                    pass
+            _fallback("open_per_read")
+            cgroup.files[name] = None
+
+    @staticmethod
+    def _memory_max(cgroup, files):
+        # limits rarely change, so they are read per scan rather than per refresh
+        if "memory.max" not in files:
+            return None
+        try:
+            with open(os.path.join(cgroup.path, "memory.max"), "rb") as f:
+                value = f.read().strip()
+        except OSError:
+            return None
+        return int(value) if value.isdigit() else None
+
+    def _forget(self, name):
+        cgroup = self._cgroups.pop(name, None)
+        if cgroup is not None:
+            self._open_files -= sum(fd is not None for fd in cgroup.files.values())
+            cgroup.close()
+
+    def _update(self, cgroup, elapsed):
+        cpu_usage = throttled = memory = None
+        io = None
+        pressure = [None, None, None]
+
+        data = cgroup.read("cpu.stat")
+        if data is not None:
+            cpu_usage, throttled = _parse_cpu_stat(data)
+        data = cgroup.read("memory.current")
+        if data is not None:
+            memory = int(data)
+        data = cgroup.read("io.stat")
+        if data is not None:
+            io = _parse_io_stat(data)
+        for index, name in enumerate(("cpu.pressure", "memory.pressure", "io.pressure")):
+            data = cgroup.read(name)
+            if data is not None:
+                pressure[index] = _parse_pressure(data)
+
+        counters = (cpu_usage, throttled, *(io or (None,) * 4), *pressure)
+        previous = cgroup.counters
+        cgroup.counters = counters
+
+        usage = {
+            "name": cgroup.name,
+            "container": cgroup.container,
+            "cpu": None,
+            "throttled": None,
+            "memory": round(memory / 1024 / 1024, 2) if memory is not None else None,
+            "memoryLimit": round(cgroup.memory_max / 1024 / 1024, 2) if cgroup.memory_max else None,
+            "memoryPercent": round(memory / cgroup.memory_max * 100, 2) if memory is not None and cgroup.memory_max else None,
+            "readSpeed": None,
+            "writeSpeed": None,
+            "readIops": None,
+            "writeIops": None,
+            "cpuPressure": None,
+            "memoryPressure": None,
+            "ioPressure": None,
+        }
+        cgroup.io_rate = None
+        if previous is not None and elapsed:
+            deltas = [_delta(new, old) for new, old in zip(counters, previous)]
+            if deltas[2] is not None and deltas[3] is not None:
+                cgroup.io_rate = (deltas[2] + deltas[3]) / elapsed
+            microseconds = elapsed * 1000000
+            # CPU time in percent of one core, like the process rankings, so a busy 4 core container shows 400
+            for key, delta, scale in (("cpu", deltas[0], 100 / microseconds),
+                                      ("throttled", deltas[1], 100 / microseconds),
+                                      ("readSpeed", deltas[2], 1 / elapsed / 1024 / 1024),
+                                      ("writeSpeed", deltas[3], 1 / elapsed / 1024 / 1024),
+                                      ("readIops", deltas[4], 1 / elapsed),
+                                      ("writeIops", deltas[5], 1 / elapsed),
+                                      ("cpuPressure", deltas[6], 100 / microseconds),
+                                      ("memoryPressure", deltas[7], 100 / microseconds),
+                                      ("ioPressure", deltas[8], 100 / microseconds)):
+                if delta is not None:
+                    usage[key] = round(delta * scale, 2)
+        cgroup.usage = usage
+
+    def usage(self, level="all"):
+        '''
+        Usage of every cgroup from the last refresh.
+
+        Args:
+            level (str): "leaf" (cgroups without children: containers, services), "slice" (systemd and Kubernetes
+                         slices) or "all". Defaults to "all".
+
+        Returns:
+            list: Usage dicts (see _get_cgroup_usage), sorted by cgroup name.
+        '''
+        with self._lock:
+            return [dict(cgroup.usage) for cgroup in self._select(level) if cgroup.usage is not None]
+
+    def top(self, n, type="cpu", level="leaf"):
+        '''
+        Get the top N cgroups from the last refresh.
+
+        Args:
+            n (int): Number of cgroups to return.
+            type (str): "cpu" (percent of one core), "mem" (MB), "io" (read + write bytes per second) or
+                        "pressure" (percent of time some task was stalled on CPU, memory or I/O, whichever is highest).
+            level (str): See usage. Defaults to "leaf".
+
+        Returns:
+            list: List of (name, container, value) tuples, highest value first.
+        '''
+        with self._lock:
+            candidates = []
+            for cgroup in self._select(level):
+                usage = cgroup.usage
+                if usage is None:
+                    continue
+                if type == "cpu":
+                    value = usage["cpu"] if usage["cpu"] is not None and usage["cpu"] > 0.1 else None
+                elif type == "mem":
+                    value = usage["memory"] if usage["memory"] is not None and usage["memory"] >= 1 else None
+                elif type == "io":
+                    value = cgroup.io_rate or None
+                else:
+                    stalls = [usage[key] for key in ("cpuPressure", "memoryPressure", "ioPressure") if usage[key]]
+                    value = max(stalls) if stalls else None
+                if value is not None:
+                    candidates.append((value, cgroup.name, cgroup.container))
+            return [(name, container, value) for value, name, container in heapq.nlargest(n, candidates)]
+
+    def _select(self, level):
+        cgroups = sorted(self._cgroups.values(), key=lambda cgroup: cgroup.name)
+        if level == "leaf":
+            return [cgroup for cgroup in cgroups if cgroup.leaf]
+        if level == "slice":
+            return [cgroup for cgroup in cgroups if cgroup.name.endswith(".slice")]
+        return cgroups
+
+    def needs_priming(self):
+        '''Whether there is no previous refresh to compute deltas against.'''
+        return self._last_refresh is None
+
+    def close(self):
+        '''Close every cached counter file.'''
+        with self._lock:
+            for name in list(self._cgroups):
+                self._forget(name)
+            self._last_scan = None
+            self._last_refresh = None
+
+_tracker = None
+_tracker_lock = threading.Lock()
+
+def _get_cgroup_tracker():
+    '''Return the shared cgroup tracker, finding the hierarchy on first use.'''
+    global _tracker
+    with _tracker_lock:
+        if _tracker is None:
+            _tracker = _CgroupTracker()
+        return _tracker
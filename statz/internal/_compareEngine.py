@@ -0,0 +1,361 @@
+'''
+Structural diff engine behind statz.file.compare.
+A snapshot is loaded into nested dicts and every subtree is content-hashed once (blake2b over its
+keys and the hashes of its children), so comparing against the baseline skips every section whose
+hash matches in O(1) and only walks the parts that actually differ. Many snapshots are compared
+against one baseline with a process pool whose workers load and hash the baseline once each.
+'''
+
+import csv
+import fnmatch
+import glob
+import hashlib
+import json
+import os
+import re
+
+# CSV exports from before typed schemas used capitalized headers
+CSV_COLUMNS = (("component", "Component"), ("property", "Property"), ("value", "Value"))
+
+# values are shown at most this long in the diff, like compare always did
+MAX_VALUE_LENGTH = 100
+
+# below this many snapshots starting worker processes costs more than it saves
+MIN_PARALLEL_SNAPSHOTS = 64
+
+NUMBER = re.compile(r'\s*(-?\d+(?:\.\d+)?(?:[eE][-+]?\d+)?)\s*(\S.*)?$')
+
+# ---------- loading ----------
+
+def _normalize_json_data(data):
+    '''Convert a get_system_specs list export to a component-keyed dict (other data is returned as is).'''
+    if not isinstance(data, list):
+        return data
+
+    normalized = {}
+    component_counters = {}
+
+    def numbered(component):
+        component_counters[component] = component_counters.get(component, 0) + 1
+        return f"{component} {component_counters[component]}"
+
+    for item in data:
+        if isinstance(item, dict):
+            # Try to determine component type from the data
+            name = str(item.get('name', ''))
+            if 'system' in item or 'version' in item:
+                component_name = 'OS'
+            elif 'name' in item and ('Intel' in name or 'AMD' in name or 'Core' in name):
+                if 'Graphics' in name or 'NVIDIA' in name:
+                    component_name = numbered('GPU')
+                else:
+                    component_name = 'CPU'
+            elif 'capacity' in item or ('speed' in item and 'name' not in item):
+                component_name = numbered('Memory')
+            elif 'size' in item or 'model' in item:
+                component_name = numbered('Storage')
+            elif 'adapter' in item or ('description' in item and 'Intel' not in str(item.get('description', ''))):
+                component_name = numbered('Network')
+            elif 'percent' in item or 'pluggedIn' in item:
+                component_name = 'Battery'
+            else:
+                component_name = numbered('Unknown')
+            normalized[component_name] = {k: str(v) for k, v in item.items()}
+        elif isinstance(item, list):
+            # Handle nested lists (like GPU arrays)
+            for subitem in item:
+                if isinstance(subitem, dict):
+                    normalized[numbered('GPU')] = {k: str(v) for k, v in subitem.items()}
+
+    return normalized
+
+def _column(row, names, default):
+    for name in names:
+        if name in row:
+            return row[name]
+    return default
+
+def _rows_to_tree(rows):
+    '''component/property/value rows (CSV or JSON Lines exports of specs) into {component: {property: value}}.'''
+    component_names, property_names, value_names = CSV_COLUMNS
+    data = {}
+    for i, row in enumerate(rows):
+        component = _column(row, component_names, f'row_{i}')
+        data.setdefault(component, {})[_column(row, property_names, f'prop_{i}')] = _column(row, value_names, '')
+    return data
+
+def _load_snapshot(path):
+    '''
+    Load a JSON, JSON Lines or CSV export into nested dicts.
+
+    Raises:
+        ValueError: For other file types.
+    '''
+    extension = path.rsplit(".", 1)[-1].lower()
+    if extension == "json":
+        with open(path, 'r') as f:
+            return _normalize_json_data(json.load(f))
+    if extension == "csv":
+        with open(path, 'r', newline='') as f:
+            return _rows_to_tree(csv.DictReader(f))
+    if extension == "jsonl":
+        with open(path, 'r') as f:
+            return _rows_to_tree(json.loads(line) for line in f if line.strip())
+    raise ValueError(f"Unsupported file type: {extension}")
+
+# ---------- hashing ----------
+
+class _Node:
+    '''A subtree with its content hash. Leaves keep their value, dicts and lists their children by key (value is then dict or list).'''
+    __slots__ = ("digest", "children", "value")
+
+    def __init__(self, digest, children=None, value=None):
+        self.digest = digest
+        self.children = children
+        self.value = value
+
+def _leaf_text(value):
+    # values compare as stripped strings, so a CSV "16" matches a JSON 16
+    return "" if value is None else str(value).strip()
+
+def _hash_tree(data):
+    '''Hash every subtree of data bottom-up. Returns the root _Node.'''
+    if isinstance(data, dict):
+        items = data.items()
+    elif isinstance(data, list):
+        items = ((f"[{index}]", item) for index, item in enumerate(data))
+    else:
+        text = _leaf_text(data)
+        return _Node(hashlib.blake2b(text.encode("utf-8", "replace"), digest_size=16).digest(), value=data)
+
+    children = {str(key): _hash_tree(value) for key, value in items}
+    digest = hashlib.blake2b(b"{" if isinstance(data, dict) else b"[", digest_size=16)
+    for key in sorted(children):
+        digest.update(key.encode("utf-8", "replace"))
+        digest.update(b"\0")
+        digest.update(children[key].digest)
+    return _Node(digest.digest(), children=children, value=type(data))
+
+# ---------- tolerances ----------
+
+class _Tolerances:
+    '''
+    Per-field numeric tolerances.
+
+    Args:
+        tolerances (dict): {field path or glob: tolerance}, e.g. {"CPU.cpuFrequency": 50, "Storage *.free": "5%"}.
+                           Numbers are absolute, "N%" strings relative to the baseline value.
+    '''
+    def __init__(self, tolerances=None):
+        self.exact = {}
+        self.patterns = []
+        for field, tolerance in (tolerances or {}).items():
+            parsed = self._parse(tolerance)
+            if any(character in field for character in "*?["):
+                self.patterns.append((re.compile(fnmatch.translate(field)), parsed))
+            else:
+                self.exact[field] = parsed
+
+    @staticmethod
+    def _parse(tolerance):
+        text = str(tolerance).strip()
+        try:
+            if text.endswith("%"):
+                return (float(text[:-1]) / 100, True)
+            return (float(text), False)
+        except ValueError:
+            raise ValueError(f"Tolerance must be a number or a percentage like '5%', not {tolerance!r}")
+
+    def __bool__(self):
+        return bool(self.exact or self.patterns)
+
+    def lookup(self, path):
+        if path in self.exact:
+            return self.exact[path]
+        for pattern, tolerance in self.patterns:
+            if pattern.match(path):
+                return tolerance
+        return None
+
+def _number(value):
+    '''(number, unit) for 16, "16" or "5.86 GB", None when the value is not a number.'''
+    if isinstance(value, bool):
+        return None
+    if isinstance(value, (int, float)):
+        return float(value), ""
+    match = NUMBER.match(str(value)) if value is not None else None
+    if match is None:
+        return None
+    return float(match.group(1)), (match.group(2) or "").strip()
+
+# ---------- diff ----------
+
+def _shown(value):
+    return _leaf_text(value)[:MAX_VALUE_LENGTH] if not isinstance(value, (dict, list)) else str(value)[:MAX_VALUE_LENGTH]
+
+def _node_value(node):
+    '''The plain value a node was built from, to show added and removed subtrees.'''
+    if node.children is None:
+        return node.value
+    if node.value is list:
+        return [_node_value(child) for child in node.children.values()]
+    return {key: _node_value(child) for key, child in node.children.items()}
+
+def _join(path, key):
+    if not path:
+        return key
+    return f"{path}{key}" if key.startswith("[") else f"{path}.{key}"
+
+def _diff(baseline, current, tolerances, differences, path=""):
+    '''Add the differences between two hashed trees to differences ({added, removed, changed}).'''
+    if baseline.digest == current.digest:
+        return
+
+    if baseline.children is not None and current.children is not None:
+        for key, child in baseline.children.items():
+            child_path = _join(path, key)
+            other = current.children.get(key)
+            if other is None:
+                differences['removed'][child_path] = _shown(_node_value(child))
+            else:
+                _diff(child, other, tolerances, differences, child_path)
+        for key, child in current.children.items():
+            if key not in baseline.children:
+                differences['added'][_join(path, key)] = _shown(_node_value(child))
+        return
+
+    change = {'from': _shown(_node_value(baseline)), 'to': _shown(_node_value(current))}
+    before, after = _number(_node_value(baseline)), _number(_node_value(current))
+    if before is not None and after is not None and before[1] == after[1]:
+        delta = after[0] - before[0]
+        change['delta'] = round(delta, 6)
+        tolerance = tolerances.lookup(path) if tolerances else None
+        if tolerance is not None:
+            allowed = tolerance[0] * abs(before[0]) if tolerance[1] else tolerance[0]
+            if abs(delta) <= allowed:
+                return
+    differences['changed'][path] = change
+
+def _compare_trees(baseline, current, tolerances):
+    differences = {'added': {}, 'removed': {}, 'changed': {}}
+    _diff(baseline, current, tolerances, differences)
+    return differences
+
+def _compare_files(current_path, baseline_path, tolerances=None):
+    '''
+    Compare one snapshot against a baseline file.
+
+    Returns:
+        dict: { "added", "removed", "changed", "summary" }
+    '''
+    differences = _compare_trees(_hash_tree(_load_snapshot(baseline_path)), _hash_tree(_load_snapshot(current_path)),
+                                 _Tolerances(tolerances))
+    differences['summary'] = _summary(differences)
+    differences['summary'].update({'current_file': current_path, 'baseline_file': baseline_path})
+    return differences
+
+def _summary(differences):
+    return {
+        'total_added': len(differences['added']),
+        'total_removed': len(differences['removed']),
+        'total_changed': len(differences['changed']),
+    }
+
+# ---------- many snapshots ----------
+
+def _expand_snapshots(snapshots, baseline_path=None):
+    '''
+    Paths for a directory (its .json, .jsonl and .csv files), a glob pattern, or a list of either.
+    The baseline is left out of directories and patterns, which would otherwise compare it against itself.
+    '''
+    if isinstance(snapshots, (list, tuple)):
+        paths = []
+        for entry in snapshots:
+            paths.extend(_expand_snapshots(entry, baseline_path))
+        return paths
+    if os.path.isdir(snapshots):
+        paths = [os.path.join(snapshots, name) for name in os.listdir(snapshots)
+                 if name.rsplit(".", 1)[-1].lower() in ("json", "jsonl", "csv")]
+    elif glob.has_magic(snapshots):
+        paths = [path for path in glob.glob(snapshots, recursive=True) if os.path.isfile(path)]
+    else:
+        return [snapshots]
+    if baseline_path is not None:
+        baseline = os.path.realpath(baseline_path)
+        paths = [path for path in paths if os.path.realpath(path) != baseline]
+    return sorted(paths)
+
+# each worker process hashes the baseline once, in _init_worker
+_worker_state = {}
+
+def _init_worker(baseline_path, tolerances):
+    _worker_state["baseline"] = _hash_tree(_load_snapshot(baseline_path))
+    _worker_state["tolerances"] = _Tolerances(tolerances)
+
+def _compare_one(path):
+    '''(path, differences or None if unchanged, error message or None) for one snapshot.'''
+    try:
+        differences = _compare_trees(_worker_state["baseline"], _hash_tree(_load_snapshot(path)), _worker_state["tolerances"])
+    except Exception as e:
+        return path, None, str(e)
+    if not (differences['added'] or differences['removed'] or differences['changed']):
+        return path, None, None
+    differences['summary'] = _summary(differences)
+    return path, differences, None
+
+def _compare_many(snapshots, baseline_path, tolerances=None, processes=None):
+    '''
+    Compare many snapshots against one baseline.
+
+    Args:
+        snapshots (str or list): Directory, glob pattern (e.g. "audit/**/*.json") or list of paths.
+        baseline_path (str): The golden snapshot.
+        tolerances (dict): Per-field numeric tolerances, see _Tolerances.
+        processes (int): Worker processes. Defaults to the CPU count; small sets are compared in this process.
+
+    Returns:
+        dict: {
+            "baseline_file", "total", "unchanged", "changed", "failed",
+            "results": { path: {"added", "removed", "changed", "summary"} } for the snapshots that differ,
+            "errors": { path: message }
+        }
+    '''
+    paths = _expand_snapshots(snapshots, baseline_path)
+    _Tolerances(tolerances)  # raises on a bad tolerance before any worker starts
+    if processes is not None and processes < 1:
+        raise ValueError(f"processes must be positive int, not {processes}")
+    workers = min(processes or os.cpu_count() or 1, len(paths))
+
+    results = {}
+    errors = {}
+    if workers <= 1 or (processes is None and len(paths) < MIN_PARALLEL_SNAPSHOTS):
+        _init_worker(baseline_path, tolerances)
+        outcomes = map(_compare_one, paths)
+        pool = None
+    else:
+        import multiprocessing
+        # the baseline is loaded before the pool starts, so a missing baseline fails here and not per worker
+        _load_snapshot(baseline_path)
+        pool = multiprocessing.Pool(workers, initializer=_init_worker, initargs=(baseline_path, tolerances))
+        outcomes = pool.imap_unordered(_compare_one, paths, chunksize=max(1, len(paths) // (workers * 8)))
+    try:
+        for path, differences, error in outcomes:
+            if error is not None:
+                errors[path] = error
+            elif differences is not None:
+                results[path] = differences
+    finally:
+        if pool is not None:
+            pool.close()
+            pool.join()
+        _worker_state.clear()
+
+    return {
+        "baseline_file": baseline_path,
+        "total": len(paths),
+        "unchanged": len(paths) - len(results) - len(errors),
+        "changed": len(results),
+        "failed": len(errors),
+        "results": dict(sorted(results.items())),
+        "errors": dict(sorted(errors.items())),
+    }
@@ -8,8 +8,15 @@ import json
 import re
 import platform
 import os
+import bisect
+from functools import lru_cache
 from typing import Dict, List, Optional, Any
 
+try:
+    from ._profiler import _profiled, _stage, _fallback
+except ImportError:
+    from _profiler import _profiled, _stage, _fallback
+
 # Platform-specific imports
 CURRENT_OS = platform.system().lower()
 
@@ -24,67 +31,125 @@ if CURRENT_OS == "windows":
 else:
     WINDOWS_API_AVAILABLE = False
 
+LSUSB_COMMAND = ['lsusb']
+
+def parse_lsusb_output(output):
+    """Parse lsusb output into device dicts, adding details from sysfs"""
+    devices = []
+    sysfs_dirs = sysfs_devices_by_number()
+    
+    for line in output.strip().split('\n'):
+        if line.strip():
+            # Parse lsusb output: Bus 001 Device 002: ID 1d6b:0002 Linux Foundation 2.0 root hub
+            match = re.match(r'Bus (\d+) Device (\d+): ID ([0-9a-fA-F]{4}):([0-9a-fA-F]{4}) (.+)', line)
+            if match:
+                bus, device, vid, pid, name = match.groups()
+                
+                device_info = {
+                    'device_id': f"USB\\VID_{vid.upper()}&PID_{pid.upper()}",
+                    'name': name.strip(),
+                    'manufacturer': 'Unknown',
+                    'device_class': 'USB Device',
+                    'status': 'OK',
+                    'connection_type': 'USB',
+                    'bus': bus,
+                    'device_number': device,
+                    'specs': {
+                        'vendor_id': vid.upper(),
+                        'product_id': pid.upper(),
+                        'bus_number': bus,
+                        'device_number': device,
+                        'interface_version': 'USB',
+                        'speed': 'Unknown'
+                    }
+                }
+                
+                # Get additional info from sysfs, including the class codes used to classify the device
+                sysfs_info = get_sysfs_info(bus, device, sysfs_dirs.get((int(bus), int(device))))
+                device_info['specs'].update(sysfs_info)
+                device_type = classify_device_linux(name, sysfs_info.get('bDeviceClass'), sysfs_info.get('interface_classes', '').split(','))
+                device_info['specs']['device_type'] = device_type
+                device_info['specs']['function'] = device_function(device_type)
+                
+                devices.append(device_info)
+    
+    return devices
+
 def get_usb_devices_linux():
     """Get USB devices on Linux using lsusb and sysfs"""
     devices = []
     
     try:
         # Method 1: Use lsusb command
-        result = subprocess.run(['lsusb'], capture_output=True, text=True)
-        if result.returncode == 0:
-            for line in result.stdout.strip().split('\n'):
-                if line.strip():
-                    # Parse lsusb output: Bus 001 Device 002: ID 1d6b:0002 Linux Foundation 2.0 root hub
-                    match = re.match(r'Bus (\d+) Device (\d+): ID ([0-9a-fA-F]{4}):([0-9a-fA-F]{4}) (.+)', line)
-                    if match:
-                        bus, device, vid, pid, name = match.groups()
-                        
-                        device_info = {
-                            'device_id': f"USB\\VID_{vid.upper()}&PID_{pid.upper()}",
-                            'name': name.strip(),
-                            'manufacturer': 'Unknown',
-                            'device_class': 'USB Device',
-                            'status': 'OK',
-                            'connection_type': 'USB',
-                            'bus': bus,
-                            'device_number': device,
-                            'specs': {
-                                'vendor_id': vid.upper(),
-                                'product_id': pid.upper(),
-                                'bus_number': bus,
-                                'device_number': device,
-                                'interface_version': 'USB',
-                                'speed': 'Unknown',
-                                'device_type': classify_device_linux(name),
-                                'function': get_device_function(name)
-                            }
-                        }
-                        
-                        # Get additional info from sysfs
-                        sysfs_info = get_sysfs_info(bus, device)
-                        device_info['specs'].update(sysfs_info)
-                        
-                        devices.append(device_info)
+        try:
+            with _stage("lsusb"):
+                result = subprocess.run(LSUSB_COMMAND, capture_output=True, text=True)
+                if result.returncode == 0:
+                    devices = parse_lsusb_output(result.stdout)
+        except OSError:
+            # lsusb is not installed
+            pass
         
         # Method 2: Parse /sys/bus/usb/devices/ directly
         if not devices:
-            devices = get_usb_devices_sysfs()
+            with _stage("sysfs"):
+                devices = get_usb_devices_sysfs()
+            _fallback("sysfs")
+        else:
+            _fallback("lsusb")
     
     except Exception as e:
         pass
     
     return devices
 
-def get_sysfs_info(bus, device):
+def sysfs_devices_by_number():
+    """Map (bus number, device number), which lsusb prints, to the device's directory in /sys/bus/usb/devices"""
+    devices = {}
+    try:
+        for device_dir in os.listdir(SYSFS_USB_DEVICES):
+            if ':' in device_dir:
+                continue
+            try:
+                with open(os.path.join(SYSFS_USB_DEVICES, device_dir, 'busnum')) as f:
+                    busnum = int(f.read())
+                with open(os.path.join(SYSFS_USB_DEVICES, device_dir, 'devnum')) as f:
+                    devnum = int(f.read())
+                devices[(busnum, devnum)] = device_dir
+            except (OSError, ValueError):
+                pass
+    except OSError:
+        pass
+    return devices
+
+def read_interface_classes(device_path, device_dir):
+    """bInterfaceClass of every interface of a sysfs USB device (its "<device_dir>:<config>.<interface>" children)"""
+    classes = []
+    try:
+        for entry in sorted(os.listdir(device_path)):
+            if entry.startswith(device_dir + ':'):
+                try:
+                    with open(os.path.join(device_path, entry, 'bInterfaceClass')) as f:
+                        classes.append(f.read().strip())
+                except OSError:
+                    pass
+    except OSError:
+        pass
+    return classes
+
+def get_sysfs_info(bus, device, device_dir=None):
     """Get additional USB device info from sysfs on Linux"""
     info = {}
     
     try:
         # Find device in sysfs
-        sysfs_paths = [
-            f"/sys/bus/usb/devices/{bus}-{device}",
-            f"/sys/bus/usb/devices/usb{bus}/{bus}-{device}"
-        ]
+        if device_dir:
+            sysfs_paths = [os.path.join(SYSFS_USB_DEVICES, device_dir)]
+        else:
+            sysfs_paths = [
+                f"/sys/bus/usb/devices/{bus}-{device}",
+                f"/sys/bus/usb/devices/usb{bus}/{bus}-{device}"
+            ]
         
         for sysfs_path in sysfs_paths:
             if os.path.exists(sysfs_path):
@@ -106,6 +171,10 @@ def get_sysfs_info(bus, device):
                             info[attr_name] = f.read().strip()
                     except:
                         pass
+                if device_dir:
+                    interface_classes = read_interface_classes(sysfs_path, device_dir)
+                    if interface_classes:
+                        info['interface_classes'] = ','.join(interface_classes)
                 break
     
     except Exception as e:
@@ -113,16 +182,25 @@ def get_sysfs_info(bus, device):
     
     return info
 
+SYSFS_USB_DEVICES = "/sys/bus/usb/devices"
+
+# bus-port[.port...] names are devices, names with a ":config.interface" suffix are their interfaces
+SYSFS_DEVICE_NAME = re.compile(r'\d+-\d+(\.\d+)*')
+
+def is_sysfs_usb_device(device_dir):
+    """Whether a /sys/bus/usb/devices entry is a device (not a root hub or an interface)"""
+    return SYSFS_DEVICE_NAME.fullmatch(device_dir) is not None
+
 def get_usb_devices_sysfs():
     """Get USB devices by parsing sysfs directly on Linux"""
     devices = []
     
     try:
-        usb_devices_path = "/sys/bus/usb/devices"
+        usb_devices_path = SYSFS_USB_DEVICES
         if os.path.exists(usb_devices_path):
             for device_dir in os.listdir(usb_devices_path):
                 device_path = os.path.join(usb_devices_path, device_dir)
-                if os.path.isdir(device_path) and re.match(r'\d+-\d+', device_dir):
+                if os.path.isdir(device_path) and is_sysfs_usb_device(device_dir):
                     device_info = parse_sysfs_device(device_path, device_dir)
                     if device_info:
                         devices.append(device_info)
@@ -158,7 +236,8 @@ def parse_sysfs_device(device_path, device_dir):
             'product': 'product',
             'serial': 'serial_number',
             'speed': 'speed',
-            'version': 'interface_version'
+            'version': 'interface_version',
+            'bDeviceClass': 'bDeviceClass'
         }
         
         for file_name, info_key in attributes.items():
@@ -175,30 +254,44 @@ def parse_sysfs_device(device_path, device_dir):
             except:
                 pass
         
+        interface_classes = read_interface_classes(device_path, device_dir)
+        if interface_classes:
+            device_info['specs']['interface_classes'] = ','.join(interface_classes)
+        
         # Classify device type
-        device_info['specs']['device_type'] = classify_device_linux(device_info['name'])
-        device_info['specs']['function'] = get_device_function(device_info['name'])
+        device_type = classify_device_linux(device_info['name'], device_info['specs'].get('bDeviceClass'), interface_classes)
+        device_info['specs']['device_type'] = device_type
+        device_info['specs']['function'] = device_function(device_type)
         
         return device_info
     
     except Exception as e:
         return None
 
+SYSTEM_PROFILER_COMMAND = ['system_profiler', 'SPUSBDataType', '-json']
+
+def parse_system_profiler_output(output):
+    """Parse the JSON output of system_profiler SPUSBDataType into device dicts"""
+    devices = []
+    data = json.loads(output)
+    usb_data = data.get('SPUSBDataType', [])
+    
+    for usb_controller in usb_data:
+        devices.extend(parse_macos_usb_tree(usb_controller))
+    
+    return devices
+
 def get_usb_devices_macos():
     """Get USB devices on macOS using system_profiler"""
     devices = []
     
     try:
         # Use system_profiler to get USB information
-        result = subprocess.run(['system_profiler', 'SPUSBDataType', '-json'], 
-                              capture_output=True, text=True)
+        with _stage("system_profiler"):
+            result = subprocess.run(SYSTEM_PROFILER_COMMAND, capture_output=True, text=True)
         
         if result.returncode == 0:
-            data = json.loads(result.stdout)
-            usb_data = data.get('SPUSBDataType', [])
-            
-            for usb_controller in usb_data:
-                devices.extend(parse_macos_usb_tree(usb_controller))
+            devices = parse_system_profiler_output(result.stdout)
     
     except Exception as e:
         pass
@@ -226,11 +319,12 @@ def parse_macos_usb_tree(usb_node, parent_path=""):
                     'speed': usb_node.get('speed', 'Unknown'),
                     'interface_version': f"USB {usb_node.get('usb_version', 'Unknown')}",
                     'location_id': usb_node.get('location_id', 'Unknown'),
-                    'device_type': classify_device_macos(usb_node.get('_name', '')),
-                    'function': get_device_function(usb_node.get('_name', ''))
+                    'device_type': classify_device_macos(usb_node.get('_name', ''))
                 }
             }
             
+            device_info['specs']['function'] = device_function(device_info['specs']['device_type'])
+            
             # Add power information if available
             if 'current_available' in usb_node:
                 device_info['specs']['current_available'] = f"{usb_node['current_available']} mA"
@@ -249,51 +343,146 @@ def parse_macos_usb_tree(usb_node, parent_path=""):
     
     return devices
 
-def classify_device_linux(device_name):
-    """Classify device type based on name for Linux"""
-    name_lower = device_name.lower()
-    
-    if 'hub' in name_lower or 'root hub' in name_lower:
-        return 'USB Hub'
-    elif 'storage' in name_lower or 'disk' in name_lower or 'mass storage' in name_lower:
-        return 'Mass Storage'
-    elif 'mouse' in name_lower:
-        return 'HID Device'
-    elif 'keyboard' in name_lower:
-        return 'HID Device'
-    elif 'camera' in name_lower or 'webcam' in name_lower:
-        return 'Video Device'
-    elif 'audio' in name_lower or 'sound' in name_lower:
-        return 'Audio Device'
-    elif 'network' in name_lower or 'ethernet' in name_lower or 'wifi' in name_lower:
-        return 'Network Adapter'
-    elif 'bluetooth' in name_lower:
-        return 'Bluetooth Adapter'
-    elif 'printer' in name_lower:
-        return 'Printer'
-    else:
-        return 'Generic USB Device'
+# device types in the order the name keywords were always checked, an earlier type wins
+DEVICE_TYPES = ('USB Hub', 'Mass Storage', 'HID Device', 'Video Device', 'Audio Device',
+                'Network Adapter', 'Bluetooth Adapter', 'Printer')
+
+DEVICE_FUNCTIONS = {
+    'USB Hub': 'Port Expansion',
+    'Mass Storage': 'Data Storage',
+    'HID Device': 'Human Interface',
+    'Video Device': 'Video Capture',
+    'Audio Device': 'Audio Processing',
+    'Network Adapter': 'Network Communication',
+    'Bluetooth Adapter': 'Wireless Communication',
+    'Printer': 'Document Printing'
+}
+
+# bDeviceClass / bInterfaceClass codes from usb.org's "Defined Class Codes"
+USB_CLASS_TYPES = {
+    0x01: 'Audio Device',
+    0x02: 'Network Adapter',  # Communications (CDC): modems and CDC Ethernet
+    0x03: 'HID Device',
+    0x07: 'Printer',
+    0x08: 'Mass Storage',
+    0x09: 'USB Hub',
+    0x0E: 'Video Device',
+    0xE0: 'Bluetooth Adapter',  # Wireless Controller
+}
+
+# a composite device (class 0x00 or 0xEF) takes the type of its main interface: a webcam also has an audio
+# interface and a headset a HID one for its buttons, so HID comes last
+INTERFACE_TYPE_RANK = {device_type: rank for rank, device_type in enumerate(
+    ('USB Hub', 'Mass Storage', 'Video Device', 'Audio Device', 'Network Adapter', 'Bluetooth Adapter', 'Printer', 'HID Device'))}
+
+# Win32_PnPEntity.PNPClass -> device type. "USB" covers hubs, controllers and composite parents alike
+WINDOWS_PNP_CLASS_TYPES = {
+    'hidclass': 'HID Device',
+    'keyboard': 'HID Device',
+    'mouse': 'HID Device',
+    'diskdrive': 'Mass Storage',
+    'camera': 'Video Device',
+    'image': 'Video Device',
+    'media': 'Audio Device',
+    'audioendpoint': 'Audio Device',
+    'net': 'Network Adapter',
+    'bluetooth': 'Bluetooth Adapter',
+    'printer': 'Printer',
+}
+
+NAME_KEYWORD_TYPES = {
+    'hub': 'USB Hub',
+    'storage': 'Mass Storage',
+    'disk': 'Mass Storage',
+    'mouse': 'HID Device',
+    'keyboard': 'HID Device',
+    'camera': 'Video Device',
+    'webcam': 'Video Device',
+    'audio': 'Audio Device',
+    'sound': 'Audio Device',
+    'network': 'Network Adapter',
+    'ethernet': 'Network Adapter',
+    'wifi': 'Network Adapter',
+    'bluetooth': 'Bluetooth Adapter',
+    'printer': 'Printer',
+}
+DEVICE_TYPE_RANK = {device_type: rank for rank, device_type in enumerate(DEVICE_TYPES)}
+# every keyword in one alternation, so a name is scanned once instead of once per keyword
+NAME_KEYWORDS = re.compile('|'.join(sorted(NAME_KEYWORD_TYPES, key=len, reverse=True)))
+
+def parse_class_code(value):
+    """A class code as sysfs ("09"), system tools ("0x09") or an int gives it, None if there is none"""
+    if isinstance(value, int):
+        return value
+    try:
+        return int(str(value).strip(), 16)
+    except (TypeError, ValueError):
+        return None
+
+@lru_cache(maxsize=1024)
+def classify_device_name(device_name):
+    """Classify device type from keywords in its name, for devices without a usable class code"""
+    best = None
+    for keyword in NAME_KEYWORDS.findall(device_name.lower()):
+        rank = DEVICE_TYPE_RANK[NAME_KEYWORD_TYPES[keyword]]
+        if best is None or rank < best:
+            best = rank
+    return DEVICE_TYPES[best] if best is not None else 'Generic USB Device'
+
+def classify_device_linux(device_name, device_class=None, interface_classes=()):
+    """Classify device type from its bDeviceClass, then its interfaces' bInterfaceClass, then its name for Linux"""
+    device_type = USB_CLASS_TYPES.get(parse_class_code(device_class))
+    if device_type:
+        return device_type
+    
+    interface_types = [USB_CLASS_TYPES[code] for code in map(parse_class_code, interface_classes) if code in USB_CLASS_TYPES]
+    if interface_types:
+        return min(interface_types, key=INTERFACE_TYPE_RANK.get)
+    
+    return classify_device_name(device_name)
 
 def classify_device_macos(device_name):
-    """Classify device type based on name for macOS"""
-    return classify_device_linux(device_name)  # Same logic works for macOS
+    """Classify device type based on name for macOS (system_profiler does not report class codes)"""
+    return classify_device_name(device_name)
+
+def classify_device_windows(device_name, pnp_class=None):
+    """Classify device type from its PNPClass, then its name for Windows"""
+    device_type = WINDOWS_PNP_CLASS_TYPES.get((pnp_class or '').lower())
+    return device_type or classify_device_name(device_name)
+
+def device_function(device_type):
+    """Device function of a device type"""
+    return DEVICE_FUNCTIONS.get(device_type, 'Unknown')
 
 def get_device_function(device_name):
     """Get device function based on its type"""
-    device_type = classify_device_linux(device_name)
-    
-    function_map = {
-        'USB Hub': 'Port Expansion',
-        'Mass Storage': 'Data Storage',
-        'HID Device': 'Human Interface',
-        'Video Device': 'Video Capture',
-        'Audio Device': 'Audio Processing',
-        'Network Adapter': 'Network Communication',
-        'Bluetooth Adapter': 'Wireless Communication',
-        'Printer': 'Document Printing'
-    }
+    return device_function(classify_device_name(device_name))
+
+WMIC_USB_COMMAND = ['wmic', 'path', 'Win32_PnPEntity', 'where', 
+                    'PNPDeviceID like "USB%"', 'get', 
+                    'Name,Manufacturer,DeviceID,Status,PNPClass', '/format:csv']
+
+def parse_wmic_output(output):
+    """Parse the CSV output of WMIC_USB_COMMAND into device dicts"""
+    devices = []
+    
+    lines = output.strip().split('\n')
+    for line in lines[1:]:  # Skip header
+        if line.strip() and ',' in line:
+            parts = [p.strip() for p in line.split(',')]
+            if len(parts) >= 6 and parts[1]:  # Has device ID
+                device_info = {
+                    'device_id': parts[1],
+                    'name': parts[5] if parts[5] else 'Unknown Device',
+                    'manufacturer': parts[4] if parts[4] else 'Unknown Manufacturer',
+                    'status': parts[6] if len(parts) > 6 and parts[6] else 'Unknown',
+                    'device_class': parts[3] if parts[3] else 'USB Device',
+                    'connection_type': 'USB',
+                    'specs': parse_usb_specs_windows(parts[1], parts[5] if parts[5] else '', parts[3])
+                }
+                devices.append(device_info)
     
-    return function_map.get(device_type, 'Unknown')
+    return devices
 
 def get_usb_devices_windows():
     """Get USB devices on Windows using WMI and PowerShell"""
@@ -301,36 +490,23 @@ def get_usb_devices_windows():
     
     try:
         # Method 1: Use WMI via wmic command
-        cmd = ['wmic', 'path', 'Win32_PnPEntity', 'where', 
-               'PNPDeviceID like "USB%"', 'get', 
-               'Name,Manufacturer,DeviceID,Status,PNPClass', '/format:csv']
-        
-        result = subprocess.run(cmd, capture_output=True, text=True, 
-                              creationflags=subprocess.CREATE_NO_WINDOW)
+        with _stage("wmic"):
+            result = subprocess.run(WMIC_USB_COMMAND, capture_output=True, text=True, 
+                                  creationflags=subprocess.CREATE_NO_WINDOW)
         
         if result.returncode == 0:
-            lines = result.stdout.strip().split('\n')
-            for line in lines[1:]:  # Skip header
-                if line.strip() and ',' in line:
-                    parts = [p.strip() for p in line.split(',')]
-                    if len(parts) >= 6 and parts[1]:  # Has device ID
-                        device_info = {
-                            'device_id': parts[1],
-                            'name': parts[5] if parts[5] else 'Unknown Device',
-                            'manufacturer': parts[4] if parts[4] else 'Unknown Manufacturer',
-                            'status': parts[6] if len(parts) > 6 and parts[6] else 'Unknown',
-                            'device_class': parts[3] if parts[3] else 'USB Device',
-                            'connection_type': 'USB',
-                            'specs': parse_usb_specs_windows(parts[1], parts[5] if parts[5] else '')
-                        }
-                        devices.append(device_info)
+            devices = parse_wmic_output(result.stdout)
         
         # Method 2: Fallback to PowerShell if WMI fails
         if not devices:
+            _fallback("powershell")
             devices = get_usb_devices_powershell()
+        else:
+            _fallback("wmic")
     
     except Exception as e:
-        # Final fallback to PowerShell
+        # Final fallback to PowerShell (wmic is gone from recent Windows builds)
+        _fallback("powershell")
         try:
             devices = get_usb_devices_powershell()
         except:
@@ -338,7 +514,7 @@ def get_usb_devices_windows():
     
     return devices
 
-def parse_usb_specs_windows(device_id, device_name):
+def parse_usb_specs_windows(device_id, device_name, pnp_class=None):
     """Parse USB device specifications from Windows device ID and name"""
     specs = {
         'interface_version': 'Unknown',
@@ -378,84 +554,330 @@ def parse_usb_specs_windows(device_id, device_name):
                 specs['interface_version'] = 'USB (Version Unknown)'
         
         # Classify device type
-        specs['device_type'] = classify_device_linux(device_name)  # Same logic works
-        specs['function'] = get_device_function(device_name)
+        specs['device_type'] = classify_device_windows(device_name, pnp_class)
+        specs['function'] = device_function(specs['device_type'])
     
     except Exception as e:
         pass
     
     return specs
 
+POWERSHELL_USB_SCRIPT = '''
+Get-WmiObject -Class Win32_PnPEntity | Where-Object {$_.DeviceID -like "USB*"} | ForEach-Object {
+    $props = @{
+        DeviceID = $_.DeviceID
+        Name = $_.Name
+        Manufacturer = $_.Manufacturer
+        Status = $_.Status
+        PNPClass = $_.PNPClass
+    }
+    $props | ConvertTo-Json -Compress
+}
+'''
+POWERSHELL_USB_COMMAND = ['powershell', '-Command', POWERSHELL_USB_SCRIPT]
+
+def parse_powershell_output(output):
+    """Parse the one-JSON-object-per-line output of POWERSHELL_USB_COMMAND into device dicts"""
+    devices = []
+    
+    for line in output.strip().split('\n'):
+        if line.strip():
+            try:
+                device_data = json.loads(line)
+                device_info = {
+                    'device_id': device_data.get('DeviceID', 'Unknown'),
+                    'name': device_data.get('Name', 'Unknown Device'),
+                    'manufacturer': device_data.get('Manufacturer', 'Unknown Manufacturer'),
+                    'status': device_data.get('Status', 'Unknown'),
+                    'device_class': device_data.get('PNPClass', 'USB Device'),
+                    'connection_type': 'USB',
+                    'specs': parse_usb_specs_windows(
+                        device_data.get('DeviceID', ''), 
+                        device_data.get('Name', ''),
+                        device_data.get('PNPClass')
+                    )
+                }
+                devices.append(device_info)
+            except json.JSONDecodeError:
+                continue
+    
+    return devices
+
 def get_usb_devices_powershell():
     """Get USB devices using PowerShell as Windows fallback method"""
     devices = []
     
     try:
-        powershell_cmd = '''
-        Get-WmiObject -Class Win32_PnPEntity | Where-Object {$_.DeviceID -like "USB*"} | ForEach-Object {
-            $props = @{
-                DeviceID = $_.DeviceID
-                Name = $_.Name
-                Manufacturer = $_.Manufacturer
-                Status = $_.Status
-                PNPClass = $_.PNPClass
-            }
-            $props | ConvertTo-Json -Compress
-        }
-        '''
-        
-        result = subprocess.run(['powershell', '-Command', powershell_cmd], 
-                              capture_output=True, text=True, 
-                              creationflags=subprocess.CREATE_NO_WINDOW)
+        with _stage("powershell"):
+            result = subprocess.run(POWERSHELL_USB_COMMAND, 
+                                  capture_output=True, text=True, 
+                                  creationflags=subprocess.CREATE_NO_WINDOW)
         
         if result.returncode == 0 and result.stdout.strip():
-            lines = result.stdout.strip().split('\n')
-            for line in lines:
-                if line.strip():
-                    try:
-                        device_data = json.loads(line)
-                        device_info = {
-                            'device_id': device_data.get('DeviceID', 'Unknown'),
-                            'name': device_data.get('Name', 'Unknown Device'),
-                            'manufacturer': device_data.get('Manufacturer', 'Unknown Manufacturer'),
-                            'status': device_data.get('Status', 'Unknown'),
-                            'device_class': device_data.get('PNPClass', 'USB Device'),
-                            'connection_type': 'USB',
-                            'specs': parse_usb_specs_windows(
-                                device_data.get('DeviceID', ''), 
-                                device_data.get('Name', '')
-                            )
-                        }
-                        devices.append(device_info)
-                    except json.JSONDecodeError:
-                        continue
+            devices = parse_powershell_output(result.stdout)
     
     except Exception as e:
         pass
     
     return devices
 
+SUMMARY_KEYS = ('hubs', 'storage_devices', 'input_devices', 'audio_devices', 'network_devices', 'other_devices')
+
+def summary_keys(device):
+    """The summary counters of get_connected_usb_devices that a device counts towards"""
+    return type_summary_keys(device.get('specs', {}).get('device_type', ''))
+
+@lru_cache(maxsize=None)
+def type_summary_keys(device_type):
+    """The summary counters that devices of a type count towards"""
+    lowered = device_type.lower()
+    keys = []
+    if 'hub' in lowered:
+        keys.append('hubs')
+    if 'storage' in lowered:
+        keys.append('storage_devices')
+    if 'hid' in lowered:
+        keys.append('input_devices')
+    if 'audio' in lowered:
+        keys.append('audio_devices')
+    if 'network' in lowered:
+        keys.append('network_devices')
+    if device_type == 'Generic USB Device':
+        keys.append('other_devices')
+    return tuple(keys)
+
+def summarize_usb_devices(devices, method_used):
+    """Remove duplicate devices, sort them by name and build the result dict of get_connected_usb_devices"""
+    # Remove duplicates and sort
+    unique_devices = {}
+    for device in devices:
+        device_id = device.get('device_id', 'Unknown')
+        if device_id not in unique_devices:
+            unique_devices[device_id] = device
+    
+    devices_list = list(unique_devices.values())
+    devices_list.sort(key=lambda x: x.get('name', 'Unknown'))
+    
+    # one pass over the devices for every counter
+    summary = dict.fromkeys(SUMMARY_KEYS, 0)
+    for device in devices_list:
+        for key in summary_keys(device):
+            summary[key] += 1
+    
+    return {
+        'total_usb_devices': len(devices_list),
+        'devices': devices_list,
+        'summary': summary,
+        'method_used': method_used,
+        'platform': CURRENT_OS
+    }
+
+NAME_TOKEN = re.compile(r'[a-z0-9]+')
+USB_ID = re.compile(r'(?:0x)?([0-9a-f]{1,4})\b')
+
+def name_tokens(text):
+    """Lowercase words of a device name, the keys of DeviceIndex's name index"""
+    return NAME_TOKEN.findall(text.lower()) if text else []
+
+def normalize_usb_id(value):
+    """A vendor or product id as lowercase 4 digit hex ('046D', '0x046d  (Logitech Inc.)' -> '046d'), None if there is none"""
+    if isinstance(value, int):
+        return f"{value:04x}"
+    match = USB_ID.match(str(value or '').strip().lower())
+    return match.group(1).zfill(4) if match else None
+
+class DeviceIndex:
+    """
+    USB devices keyed by device_id, with hash indexes by vendor:product (and vendor alone), by every word
+    of the name, and by device type. Adding or removing a device updates the indexes, so lookups don't
+    scan the inventory. Not thread safe, the USB watcher guards it with its lock.
+    """
+    def __init__(self, devices=()):
+        self._by_id = {}
+        self._by_usb_id = {}
+        self._by_token = {}
+        self._by_type = {}
+        self._sorted = None
+        self._sorted_names = None
+        self._names = {}
+        for device in devices:
+            self.add(device)
+    
+    def __len__(self):
+        return len(self._by_id)
+    
+    def __contains__(self, device_id):
+        return device_id in self._by_id
+    
+    def ids(self):
+        return list(self._by_id)
+    
+    def get(self, device_id):
+        return self._by_id.get(device_id)
+    
+    @staticmethod
+    def _keys(device):
+        specs = device.get('specs', {})
+        vendor_id = normalize_usb_id(specs.get('vendor_id'))
+        product_id = normalize_usb_id(specs.get('product_id'))
+        usb_ids = []
+        if vendor_id:
+            usb_ids.append(vendor_id)
+            if product_id:
+                usb_ids.append(f"{vendor_id}:{product_id}")
+        return usb_ids, set(name_tokens(device.get('name', ''))), specs.get('device_type', '')
+    
+    @staticmethod
+    def _link(index, key, device_id):
+        index.setdefault(key, set()).add(device_id)
+    
+    @staticmethod
+    def _unlink(index, key, device_id):
+        ids = index.get(key)
+        if ids is not None:
+            ids.discard(device_id)
+            if not ids:
+                del index[key]
+    
+    def add(self, device):
+        """Add a device, replacing the one with the same device_id. Returns the replaced device or None"""
+        device_id = device.get('device_id', 'Unknown')
+        previous = self.remove(device_id)
+        self._by_id[device_id] = device
+        usb_ids, tokens, device_type = self._keys(device)
+        for key in usb_ids:
+            self._link(self._by_usb_id, key, device_id)
+        for token in tokens:
+            self._link(self._by_token, token, device_id)
+        self._link(self._by_type, device_type, device_id)
+        self._changed()
+        return previous
+    
+    def remove(self, device_id):
+        """Remove a device. Returns it, or None if it was not in the index"""
+        device = self._by_id.pop(device_id, None)
+        if device is None:
+            return None
+        usb_ids, tokens, device_type = self._keys(device)
+        for key in usb_ids:
+            self._unlink(self._by_usb_id, key, device_id)
+        for token in tokens:
+            self._unlink(self._by_token, token, device_id)
+        self._unlink(self._by_type, device_type, device_id)
+        self._changed()
+        return device
+    
+    def _changed(self):
+        self._sorted = None
+        self._sorted_names = None
+        self._names = {}
+    
+    def _in_name_order(self, device_ids):
+        return sorted((self._by_id[device_id] for device_id in device_ids), key=lambda x: x.get('name', 'Unknown'))
+    
+    def devices(self):
+        """Every device, sorted by name"""
+        if self._sorted is None:
+            self._sorted = self._in_name_order(self._by_id)
+            self._sorted_names = [device.get('name', 'Unknown') for device in self._sorted]
+        return self._sorted
+    
+    def by_usb_id(self, vendor_id, product_id=None):
+        """Devices with a vendor id, and product id if given, sorted by name"""
+        key = normalize_usb_id(vendor_id)
+        if key and product_id is not None:
+            product_key = normalize_usb_id(product_id)
+            key = f"{key}:{product_key}" if product_key else None
+        return self._in_name_order(self._by_usb_id.get(key, ())) if key else []
+    
+    def by_name(self, device_name):
+        """
+        First device (by name order) whose name contains device_name, like find_device_by_name.
+        
+        Whole words are looked up in the name index. A word match is only taken once no name sorted before
+        it contains the query across a word boundary ("MyUSB Hub" for "usb hub"), so only those names are
+        scanned. Parts of words ("logi" for "Logitech") fall back to scanning every name, and every answer
+        is remembered until the inventory changes.
+        """
+        query = device_name.lower()
+        if query in self._names:
+            return self._names[query]
+        
+        match = None
+        tokens = name_tokens(query)
+        if tokens:
+            candidates = [self._by_token.get(token, set()) for token in tokens]
+            candidates.sort(key=len)
+            ids = candidates[0].intersection(*candidates[1:])
+            matches = [device_id for device_id in ids if query in self._by_id[device_id].get('name', '').lower()]
+            if matches:
+                devices = self.devices()
+                # the first device with the candidate's name; every device before it still has to be checked
+                end = bisect.bisect_left(self._sorted_names, self._in_name_order(matches)[0].get('name', 'Unknown'))
+                match = find_device_by_name({'devices': devices[:end + 1]}, device_name)
+        if match is None:
+            match = find_device_by_name({'devices': self.devices()}, device_name)
+        
+        self._names[query] = match
+        return match
+    
+    def by_type(self, device_type):
+        """Devices whose type contains device_type, like filter_devices_by_type, sorted by name"""
+        query = device_type.lower()
+        # a handful of distinct types, however many devices there are
+        ids = [device_id for indexed_type, type_ids in self._by_type.items() if query in indexed_type.lower() for device_id in type_ids]
+        return self._in_name_order(ids)
+    
+    def summary(self):
+        """The summary counters of get_connected_usb_devices, counted per type"""
+        summary = dict.fromkeys(SUMMARY_KEYS, 0)
+        for device_type, ids in self._by_type.items():
+            for key in type_summary_keys(device_type):
+                summary[key] += len(ids)
+        return summary
+
+@_profiled("usb.scan")
+def scan_usb_devices():
+    """
+    Rescan the connected USB devices with the platform's tools
+    
+    Returns:
+        tuple: (list of device dicts, method used)
+    
+    Raises:
+        OSError: If the operating system is unsupported.
+    """
+    if CURRENT_OS == "linux":
+        return get_usb_devices_linux(), "Linux lsusb/sysfs"
+    elif CURRENT_OS == "darwin":  # macOS
+        return get_usb_devices_macos(), "macOS system_profiler"
+    elif CURRENT_OS == "windows":
+        return get_usb_devices_windows(), "Windows Setup API/WMI"
+    raise OSError(f"Unsupported operating system: {CURRENT_OS}")
+
+def _running_watcher():
+    """The USB hotplug watcher if start_usb_monitor is running, otherwise None"""
+    try:
+        from ._usbWatcher import _get_usb_watcher
+    except ImportError:
+        from _usbWatcher import _get_usb_watcher
+    return _get_usb_watcher()
+
 def get_connected_usb_devices():
     """
     Cross-platform function to get connected USB devices
     
+    While the USB hotplug watcher runs the result comes from its inventory, without a rescan.
+    
     Returns:
         dict: Dictionary containing USB device information
     """
     try:
-        devices = []
-        method_used = "Unknown"
+        watcher = _running_watcher()
+        if watcher is not None:
+            return watcher.snapshot()
         
-        if CURRENT_OS == "linux":
-            devices = get_usb_devices_linux()
-            method_used = "Linux lsusb/sysfs"
-        elif CURRENT_OS == "darwin":  # macOS
-            devices = get_usb_devices_macos()
-            method_used = "macOS system_profiler"
-        elif CURRENT_OS == "windows":
-            devices = get_usb_devices_windows()
-            method_used = "Windows Setup API/WMI"
-        else:
+        if CURRENT_OS not in ("linux", "darwin", "windows"):
             return {
                 'total_usb_devices': 0,
                 'devices': [],
@@ -463,30 +885,8 @@ def get_connected_usb_devices():
                 'error': f"Unsupported operating system: {CURRENT_OS}"
             }
         
-        # Remove duplicates and sort
-        unique_devices = {}
-        for device in devices:
-            device_id = device.get('device_id', 'Unknown')
-            if device_id not in unique_devices:
-                unique_devices[device_id] = device
-        
-        devices_list = list(unique_devices.values())
-        devices_list.sort(key=lambda x: x.get('name', 'Unknown'))
-        
-        return {
-            'total_usb_devices': len(devices_list),
-            'devices': devices_list,
-            'summary': {
-                'hubs': len([d for d in devices_list if 'hub' in d.get('specs', {}).get('device_type', '').lower()]),
-                'storage_devices': len([d for d in devices_list if 'storage' in d.get('specs', {}).get('device_type', '').lower()]),
-                'input_devices': len([d for d in devices_list if 'hid' in d.get('specs', {}).get('device_type', '').lower()]),
-                'audio_devices': len([d for d in devices_list if 'audio' in d.get('specs', {}).get('device_type', '').lower()]),
-                'network_devices': len([d for d in devices_list if 'network' in d.get('specs', {}).get('device_type', '').lower()]),
-                'other_devices': len([d for d in devices_list if d.get('specs', {}).get('device_type', '') == 'Generic USB Device'])
-            },
-            'method_used': method_used,
-            'platform': CURRENT_OS
-        }
+        devices, method_used = scan_usb_devices()
+        return summarize_usb_devices(devices, method_used)
     
     except Exception as e:
         return {
@@ -497,38 +897,71 @@ def get_connected_usb_devices():
             'platform': CURRENT_OS
         }
 
+def filter_devices_by_usb_id(all_devices, vendor_id, product_id=None):
+    """Filter a get_connected_usb_devices result by vendor id and optionally product id"""
+    devices = DeviceIndex(all_devices.get('devices', [])).by_usb_id(vendor_id, product_id)
+    return {
+        'vendor_id': vendor_id,
+        'product_id': product_id,
+        'count': len(devices),
+        'devices': devices,
+        'platform': CURRENT_OS
+    }
+
+def find_device_by_name(all_devices, device_name):
+    """Find the first device in a get_connected_usb_devices result whose name contains device_name"""
+    for device in all_devices.get('devices', []):
+        if device_name.lower() in device.get('name', '').lower():
+            return device
+    return None
+
+def filter_devices_by_type(all_devices, device_type):
+    """Filter a get_connected_usb_devices result by device type"""
+    filtered_devices = []
+    
+    for device in all_devices.get('devices', []):
+        device_specs = device.get('specs', {})
+        if device_type.lower() in device_specs.get('device_type', '').lower():
+            filtered_devices.append(device)
+    
+    return {
+        'device_type': device_type,
+        'count': len(filtered_devices),
+        'devices': filtered_devices,
+        'platform': CURRENT_OS
+    }
+
 # Keep the existing helper functions for backwards compatibility
 def get_device_by_name(device_name):
     """Get specific USB device by name (cross-platform)"""
     try:
-        all_devices = get_connected_usb_devices()
-        for device in all_devices.get('devices', []):
-            if device_name.lower() in device.get('name', '').lower():
-                return device
-        return None
+        watcher = _running_watcher()
+        if watcher is not None:
+            return watcher.find_by_name(device_name)
+        return find_device_by_name(get_connected_usb_devices(), device_name)
     except Exception as e:
         return None
 
 def get_devices_by_type(device_type):
     """Get USB devices filtered by type (cross-platform)"""
     try:
-        all_devices = get_connected_usb_devices()
-        filtered_devices = []
-        
-        for device in all_devices.get('devices', []):
-            device_specs = device.get('specs', {})
-            if device_type.lower() in device_specs.get('device_type', '').lower():
-                filtered_devices.append(device)
-        
-        return {
-            'device_type': device_type,
-            'count': len(filtered_devices),
-            'devices': filtered_devices,
-            'platform': CURRENT_OS
-        }
+        watcher = _running_watcher()
+        if watcher is not None:
+            return watcher.filter_by_type(device_type)
+        return filter_devices_by_type(get_connected_usb_devices(), device_type)
     except Exception as e:
         return {'device_type': device_type, 'count': 0, 'devices': [], 'error': str(e), 'platform': CURRENT_OS}
 
+def get_devices_by_usb_id(vendor_id, product_id=None):
+    """Get USB devices by vendor id and optionally product id (cross-platform)"""
+    try:
+        watcher = _running_watcher()
+        if watcher is not None:
+            return watcher.filter_by_usb_id(vendor_id, product_id)
+        return filter_devices_by_usb_id(get_connected_usb_devices(), vendor_id, product_id)
+    except Exception as e:
+        return {'vendor_id': vendor_id, 'product_id': product_id, 'count': 0, 'devices': [], 'error': str(e), 'platform': CURRENT_OS}
+
 # Example usage and testing
 if __name__ == "__main__":
     print(f"USB Connected Devices Monitor - {platform.system()}")
@@ -0,0 +1,186 @@
+'''
+CPU benchmark kernels.
+Each kernel spends its time in native code (the optional _nativeBench extension, CPython's
+big integer arithmetic, hashlib and zlib), so the result depends on the processor rather than on
+interpreter overhead. Without _nativeBench the integer and float kernels fall back to Python loops,
+which is reported as backend "python".
+'''
+
+import hashlib
+import operator
+import os
+import random
+import time
+import zlib
+
+try:
+    from ._benchmarkRunner import _measure, _measure_scaling, _score
+except ImportError:
+    from _benchmarkRunner import _measure, _measure_scaling, _score
+
+try:
+    from . import _nativeBench
+except ImportError:
+    try:
+        import _nativeBench
+    except ImportError:
+        _nativeBench = None
+
+NATIVE_AVAILABLE = _nativeBench is not None
+
+MASK_64 = (1 << 64) - 1
+FLOAT_LENGTH = 4096
+BLOCK_BYTES = 1024 * 1024
+
+class _IntegerKernel:
+    '''64-bit shifts, xors and multiplies in four independent streams (xorshift64*).'''
+    unit = "Mops/s"
+    scale = 1_000_000
+
+    def __init__(self):
+        self.size = 100_000 if NATIVE_AVAILABLE else 1_000
+
+    def run(self, size):
+        if NATIVE_AVAILABLE:
+            _nativeBench.integer_kernel(size)
+            return size * 4
+
+        s0, s1 = 0x9E3779B97F4A7C15, 0xD1B54A32D192ED03
+        for _ in range(size):
+            s0 ^= s0 >> 12; s0 ^= (s0 << 25) & MASK_64; s0 ^= s0 >> 27; s0 = (s0 * 0x2545F4914F6CDD1D) & MASK_64
+            s1 ^= s1 >> 12; s1 ^= (s1 << 25) & MASK_64; s1 ^= s1 >> 27; s1 = (s1 * 0x2545F4914F6CDD1D) & MASK_64
+        return size * 2
+
+class _BigIntKernel:
+    '''2048-bit modular exponentiation, the core operation of RSA.'''
+    unit = "modexp/s"
+    scale = 1
+
+    def __init__(self):
+        generator = random.Random(2048)
+        self.modulus = generator.getrandbits(2048) | (1 << 2047) | 1
+        self.base = generator.getrandbits(2040)
+        self.exponent = generator.getrandbits(2048)
+        self.size = 1
+
+    def run(self, size):
+        for _ in range(size):
+            pow(self.base, self.exponent, self.modulus)
+        return size
+
+class _FloatKernel:
+    '''y = a * x + y over arrays that fit in the L2 cache, 2 floating point operations per element.'''
+    unit = "MFLOP/s"
+    scale = 1_000_000
+
+    def __init__(self):
+        self.size = 16
+        if not NATIVE_AVAILABLE:
+            self.x = [(i % 1024) * 1e-6 for i in range(FLOAT_LENGTH)]
+            self.y = [1.0000001] * FLOAT_LENGTH
+
+    def run(self, size):
+        if NATIVE_AVAILABLE:
+            _nativeBench.float_kernel(FLOAT_LENGTH, size)
+        else:
+            for _ in range(size):
+                sum(map(operator.mul, self.x, self.y))
+        return 2 * FLOAT_LENGTH * size
+
+class _HashKernel:
+    '''SHA-256 over 1 MiB blocks of random data.'''
+    unit = "MB/s"
+    scale = 1_000_000
+
+    def __init__(self):
+        self.data = os.urandom(BLOCK_BYTES)
+        self.size = 1
+
+    def run(self, size):
+        digest = hashlib.sha256()
+        for _ in range(size):
+            digest.update(self.data)
+        digest.digest()
+        return size * BLOCK_BYTES
+
+def _text_block(size):
+    '''Deterministic, text-like data that compresses about as well as logs or JSON.'''
+    generator = random.Random(1234)
+    words = ["".join(generator.choice("abcdefghijklmnopqrstuvwxyz") for _ in range(generator.randint(2, 10))) for _ in range(2000)]
+    text = " ".join(generator.choice(words) for _ in range(size // 5))
+    return text.encode("ascii")[:size]
+
+class _CompressionKernel:
+    '''zlib level 6 compression of 1 MiB of text-like data.'''
+    unit = "MB/s"
+    scale = 1_000_000
+
+    def __init__(self):
+        self.data = _text_block(BLOCK_BYTES)
+        self.size = 1
+
+    def run(self, size):
+        for _ in range(size):
+            zlib.compress(self.data, 6)
+        return size * len(self.data)
+
+KERNELS = {
+    "integer": _IntegerKernel,
+    "bigint": _BigIntKernel,
+    "float": _FloatKernel,
+    "hash": _HashKernel,
+    "compression": _CompressionKernel,
+}
+
+# single-core throughput that scores 100, roughly a 2020 desktop core with the native kernels built
+REFERENCE_THROUGHPUT = {
+    "integer": 1000.0,
+    "bigint": 40.0,
+    "float": 10000.0,
+    "hash": 1500.0,
+    "compression": 40.0,
+}
+
+def _cpu_benchmark(duration=1.0, warmup=0.25, multicore=False, max_processes=None, kernels=None):
+    '''
+    Run the CPU benchmark suite.
+
+    Args:
+        duration (float): Seconds of timed runs per kernel. Defaults to 1.
+        warmup (float): Seconds of untimed runs per kernel before timing. Defaults to 0.25.
+        multicore (bool): Also run every kernel in 1, 2, 4 ... N processes at once and report the scaling.
+        max_processes (int): Largest process count for multicore. Defaults to the number of logical CPUs.
+        kernels (list): Subset of "integer", "bigint", "float", "hash" and "compression". Defaults to all.
+
+    Returns:
+        dict: {
+            "execution_time": seconds the whole suite took,
+            "backend": "native" or "python" (whether the _nativeBench kernels were used),
+            "score": geometric mean of single-core throughput against the reference, times 100 (higher is better),
+            "kernels": { name: {"throughput", "unit", "median_ms", "p95_ms", "runs", "size"} },
+            "scaling": [ {"processes", "throughput", "speedup", "efficiency"}, ... ] (only with multicore)
+        }
+    '''
+    names = list(kernels) if kernels else list(KERNELS)
+    for name in names:
+        if name not in KERNELS:
+            raise ValueError(f"Unknown CPU kernel {name}, expected one of {', '.join(KERNELS)}")
+    if duration <= 0:
+        raise ValueError(f"duration must be positive, not {duration}")
+
+    start_time = time.time()
+    results = {name: _measure(KERNELS[name](), duration, warmup) for name in names}
+
+    benchmark = {
+        "execution_time": None,
+        "backend": "native" if NATIVE_AVAILABLE else "python",
+        "score": _score(results, {name: REFERENCE_THROUGHPUT[name] for name in names}),
+        "kernels": results,
+    }
+    if multicore:
+        benchmark["scaling"] = _measure_scaling({name: KERNELS[name] for name in names},
+                                                {name: results[name]["size"] for name in names},
+                                                duration, warmup, max_processes)
+
+    benchmark["execution_time"] = round(time.time() - start_time, 3)
+    return benchmark
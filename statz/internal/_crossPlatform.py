@@ -1,89 +1,147 @@
 import psutil
 import time
 import platform
-import math
-import gc
-import os
-import tempfile
 
-# Import platform-specific temperature functions
 try:
-    from ._getMacInfo import _get_mac_temps
-    from ._getWindowsInfo import _get_windows_temps
-    from ._getLinuxInfo import _get_linux_temps
+    from ._processTracker import _get_process_tracker
+    from ._profiler import _profiled, _stage, _fallback
+    from ._gpuCollectors import _get_gpu_usage
+    from ._cgroupCollector import _get_cgroup_tracker, LEVELS as CGROUP_LEVELS
+    from . import _nativeCollectors
 except ImportError:
-    from _getMacInfo import _get_mac_temps
-    from _getWindowsInfo import _get_windows_temps
-    from _getLinuxInfo import _get_linux_temps
+    from _processTracker import _get_process_tracker
+    from _profiler import _profiled, _stage, _fallback
+    from _gpuCollectors import _get_gpu_usage
+    from _cgroupCollector import _get_cgroup_tracker, LEVELS as CGROUP_LEVELS
+    import _nativeCollectors
 
-def _get_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu=False):
+# Use the native /proc collectors when they are built, otherwise psutil
+_counters = _nativeCollectors if _nativeCollectors.NATIVE_AVAILABLE else psutil
+
+def _cpu_times_busy(times):
     '''
-    Get real-time usage data for specified system components. 
+    Split a psutil cpu_times entry into total and busy seconds, the same way psutil.cpu_percent does.
 
-    This function allows you to specify which components to fetch data for, improving performance by avoiding unnecessary computations.
+    Args:
+        times (namedtuple): An entry returned by psutil.cpu_times().
+
+    Returns:
+        tuple: (total_seconds, busy_seconds)
+    '''
+    total = sum(times)
+    # guest time is already counted inside user/nice on Linux
+    total -= getattr(times, "guest", 0) + getattr(times, "guest_nice", 0)
+    busy = total - times.idle - getattr(times, "iowait", 0)
+    return total, busy
+
+def _cpu_percent_between(times_1, times_2):
+    '''
+    Calculate the CPU usage percent between two psutil cpu_times snapshots.
 
     Args:
-        get_cpu (bool): Whether to fetch CPU usage data.
-        get_ram (bool): Whether to fetch RAM usage data.
-        get_disk (bool): Whether to fetch disk usage data.
-        get_network (bool): Whether to fetch network usage data.
-        get_battery (bool): Whether to fetch battery usage data.
+        times_1 (namedtuple): The earlier snapshot.
+        times_2 (namedtuple): The later snapshot.
 
     Returns:
-        list: A list containing usage data for the specified components in the following order:
-        [cpu_usage (dict), ram_usage (dict), disk_usages (list of dicts), network_usage (dict), battery_usage (dict)]
+        float: Usage percent between 0 and 100, rounded to one decimal place.
+    '''
+    total_1, busy_1 = _cpu_times_busy(times_1)
+    total_2, busy_2 = _cpu_times_busy(times_2)
 
-    ### Structure of returned data:
-    - cpu_usage (dict):
-        { "core1": usage percent, "core2": usage percent, ... }
-    - ram_usage (dict):
-        { "total": MB, "used": MB, "free": MB, "percent": percent_used }
-    - disk_usages (list of dicts):
-        [
-            {
-                "device": device_name,
-                "readSpeed": current_read_speed_MBps,
-                "writeSpeed": current_write_speed_MBps,
-            },
-            ...
-        ]
-    - network_usage (dict):
-        { "up": upload_speed_mbps, "down": download_speed_mbps }
-    - battery_usage (dict):
-        { "percent": percent_left, "pluggedIn": is_plugged_in, "timeLeftMins": minutes_left (2147483640 = unlimited) }
+    total_delta = total_2 - total_1
+    if total_delta <= 0:
+        return 0.0
 
-    Note:
-        Specify `False` for components you do not need to fetch to improve performance.
-    ''' 
+    percent = (busy_2 - busy_1) / total_delta * 100
+    return round(min(100.0, max(0.0, percent)), 1)
+
+@_profiled("snapshot")
+def _take_usage_snapshot(get_cpu, get_disk, get_network, get_totcpu=False):
+    '''
+    Read the raw counters that the usage rates are calculated from.
+
+    Args:
+        get_cpu (bool): Whether to read per-core CPU times.
+        get_disk (bool): Whether to read per-disk I/O counters.
+        get_network (bool): Whether to read network I/O counters.
+        get_totcpu (bool): Whether to read total CPU times.
+
+    Returns:
+        dict: { "cpu": per-core cpu_times, "totcpu": total cpu_times, "disk": (counters, timestamp), "network": (counters, timestamp) }
+        Components that were not requested (or could not be read) are None.
+    '''
+    snapshot = {"cpu": None, "totcpu": None, "disk": None, "network": None}
+    _fallback("native" if _counters is _nativeCollectors else "psutil")
+
+    if get_cpu:
+        try:
+            with _stage("cpu_times"):
+                snapshot["cpu"] = _counters.cpu_times(percpu=True)
+        except:
+            pass
+
+    if get_totcpu:
+        try:
+            with _stage("cpu_times_total"):
+                snapshot["totcpu"] = _counters.cpu_times(percpu=False)
+        except:
+            pass
+
+    if get_disk:
+        try:
+            with _stage("disk_io_counters"):
+                snapshot["disk"] = (_counters.disk_io_counters(perdisk=True), time.perf_counter())
+        except:
+            pass
+
+    if get_network:
+        try:
+            with _stage("net_io_counters"):
+                snapshot["network"] = (_counters.net_io_counters(), time.perf_counter())
+        except:
+            pass
+
+    return snapshot
+
+def _usage_from_snapshots(before, after, get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu=False, get_gpu=False):
+    '''
+    Build the usage list returned by _get_usage from two counter snapshots.
+
+    RAM, battery and GPU are point-in-time values, so they are read when this function is called.
+    Disk and network rates are divided by the time actually measured between their snapshots.
+
+    Args:
+        before (dict): Snapshot from _take_usage_snapshot taken at the start of the window.
+        after (dict): Snapshot from _take_usage_snapshot taken at the end of the window.
+        get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu, get_gpu (bool): Components to include.
+
+    Returns:
+        list: [cpu_usage (dict), ram_usage (dict), disk_usages (list of dicts), network_usage (dict), battery_usage (dict)],
+        plus gpu_usages (list of dicts) as a sixth element when get_gpu is True.
+    '''
     stats = []
 
     if get_cpu or get_totcpu:
         try:
-            # Initialize psutil measurements
-            if get_cpu:
-                psutil.cpu_percent(percpu=True)
-            if get_totcpu:
-                psutil.cpu_percent(percpu=False)
-                psutil.cpu_times_percent(percpu=False)
-                
-            time.sleep(0.1)
-            
             cpu_usage = {}
-            
+
             # Append per-core data if requested
             if get_cpu:
-                cpu_usage_list = psutil.cpu_percent(percpu=True)
-                for i, core in enumerate(cpu_usage_list, 1):
-                    cpu_usage[f"core{i}"] = core
-                    
+                for i, (core_1, core_2) in enumerate(zip(before["cpu"], after["cpu"]), 1):
+                    cpu_usage[f"core{i}"] = _cpu_percent_between(core_1, core_2)
+
             # Append total/user/system data if requested
             if get_totcpu:
-                tot_percent = psutil.cpu_percent(percpu=False)
-                cpu_times = psutil.cpu_times_percent(percpu=False)
-                cpu_usage["total_usage"] = tot_percent
-                cpu_usage["user_usage"] = cpu_times.user
-                cpu_usage["system_usage"] = cpu_times.system
-                
+                tot_1, tot_2 = before["totcpu"], after["totcpu"]
+                total_delta = _cpu_times_busy(tot_2)[0] - _cpu_times_busy(tot_1)[0]
+                cpu_usage["total_usage"] = _cpu_percent_between(tot_1, tot_2)
+                if total_delta > 0:
+                    cpu_usage["user_usage"] = round((tot_2.user - tot_1.user) / total_delta * 100, 1)
+                    cpu_usage["system_usage"] = round((tot_2.system - tot_1.system) / total_delta * 100, 1)
+                else:
+                    cpu_usage["user_usage"] = 0.0
+                    cpu_usage["system_usage"] = 0.0
+
             stats.append(cpu_usage)
         except:
             stats.append(None)
@@ -93,7 +151,8 @@ def _get_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu=
     if get_ram:
         try:
             # ram usage
-            ram = psutil.virtual_memory()
+            with _stage("virtual_memory"):
+                ram = _counters.virtual_memory()
 
             ram_usage = {
                 "total": round(ram.total / (1024 ** 2), 1),
@@ -111,18 +170,20 @@ def _get_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu=
         try:
             # disk usage
             disk_usages = []
-            disk_counters_1 = psutil.disk_io_counters(perdisk=True)
-            time.sleep(1)
-            disk_counters_2 = psutil.disk_io_counters(perdisk=True)
+            disk_counters_1, disk_time_1 = before["disk"]
+            disk_counters_2, disk_time_2 = after["disk"]
+            elapsed = disk_time_2 - disk_time_1
 
             for device in disk_counters_1:
-                read_bytes_1 = disk_counters_1[device].read_bytes
-                write_bytes_1 = disk_counters_1[device].write_bytes
-                read_bytes_2 = disk_counters_2[device].read_bytes
-                write_bytes_2 = disk_counters_2[device].write_bytes
+                # skip devices that disappeared during the window
+                if device not in disk_counters_2:
+                    continue
+
+                read_bytes = disk_counters_2[device].read_bytes - disk_counters_1[device].read_bytes
+                write_bytes = disk_counters_2[device].write_bytes - disk_counters_1[device].write_bytes
 
-                read_speed = (read_bytes_2 - read_bytes_1) / (1024 * 1024)
-                write_speed = (write_bytes_2 - write_bytes_1) / (1024 * 1024)
+                read_speed = read_bytes / (1024 * 1024) / elapsed
+                write_speed = write_bytes / (1024 * 1024) / elapsed
 
                 disk_usages.append({
                     "device": device,
@@ -138,12 +199,12 @@ def _get_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu=
     if get_network:
         try:
             # network usage
-            net1 = psutil.net_io_counters()
-            time.sleep(1)
-            net2 = psutil.net_io_counters()
+            net1, net_time_1 = before["network"]
+            net2, net_time_2 = after["network"]
+            elapsed = net_time_2 - net_time_1
 
-            upload_speed = round((net2.bytes_sent - net1.bytes_sent) / 1024 ** 2, 2)
-            download_speed = round((net2.bytes_recv - net1.bytes_recv) / 1024 ** 2, 2)
+            upload_speed = round((net2.bytes_sent - net1.bytes_sent) / 1024 ** 2 / elapsed, 2)
+            download_speed = round((net2.bytes_recv - net1.bytes_recv) / 1024 ** 2 / elapsed, 2)
 
             network_usage = {
                 "up": upload_speed,
@@ -158,7 +219,8 @@ def _get_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu=
     if get_battery:
         try:
             # battery stats
-            battery = psutil.sensors_battery()
+            with _stage("sensors_battery"):
+                battery = psutil.sensors_battery()
             battery_usage = {
                 "percent": battery.percent,
                 "pluggedIn": battery.power_plugged,
@@ -170,8 +232,166 @@ def _get_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu=
     else:
         stats.append(None)
 
+    # only appended on request, so the five-element list everything else unpacks keeps its shape
+    if get_gpu:
+        try:
+            stats.append(_get_gpu_usage())
+        except:
+            stats.append(None)
+
     return stats
 
+@_profiled("usage")
+def _get_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu=False, interval=None, get_gpu=False):
+    '''
+    Get real-time usage data for specified system components. 
+
+    This function allows you to specify which components to fetch data for, improving performance by avoiding unnecessary computations.
+    All rate-based components (CPU, disk, network) share a single sampling window: every "before" snapshot is
+    taken at once, the function sleeps for `interval` seconds, and then every "after" snapshot is taken.
+
+    Args:
+        get_cpu (bool): Whether to fetch CPU usage data.
+        get_ram (bool): Whether to fetch RAM usage data.
+        get_disk (bool): Whether to fetch disk usage data.
+        get_network (bool): Whether to fetch network usage data.
+        get_battery (bool): Whether to fetch battery usage data.
+        get_totcpu (bool): Whether to fetch total/user/system CPU usage data.
+        interval (float): Length of the sampling window in seconds. Defaults to 1 second when disk or network
+                          data is requested and 0.1 seconds otherwise.
+        get_gpu (bool): Whether to fetch per-GPU usage data.
+
+    Returns:
+        list: A list containing usage data for the specified components in the following order:
+        [cpu_usage (dict), ram_usage (dict), disk_usages (list of dicts), network_usage (dict), battery_usage (dict)],
+        followed by gpu_usages (list of dicts) when get_gpu is True.
+
+    ### Structure of returned data:
+    - cpu_usage (dict):
+        { "core1": usage percent, "core2": usage percent, ... }
+    - ram_usage (dict):
+        { "total": MB, "used": MB, "free": MB, "percent": percent_used }
+    - disk_usages (list of dicts):
+        [
+            {
+                "device": device_name,
+                "readSpeed": current_read_speed_MBps,
+                "writeSpeed": current_write_speed_MBps,
+            },
+            ...
+        ]
+    - network_usage (dict):
+        { "up": upload_speed_mbps, "down": download_speed_mbps }
+    - battery_usage (dict):
+        { "percent": percent_left, "pluggedIn": is_plugged_in, "timeLeftMins": minutes_left (2147483640 = unlimited) }
+    - gpu_usages (list of dicts), empty without a supported GPU:
+        [
+            {
+                "index": n, "name": model, "vendor": "NVIDIA" / "AMD" / "Apple" / "Intel",
+                "usage": busy_percent, "memoryUsed": MB, "memoryTotal": MB, "memoryPercent": percent,
+                "power": watts, "temperature": celsius   (None where the backend cannot read them)
+            },
+            ...
+        ]
+
+    Note:
+        Specify `False` for components you do not need to fetch to improve performance.
+    ''' 
+    if interval is None:
+        interval = 1 if (get_disk or get_network) else 0.1
+
+    before = _take_usage_snapshot(get_cpu, get_disk, get_network, get_totcpu)
+
+    if get_cpu or get_totcpu or get_disk or get_network:
+        with _stage("sleep"):
+            time.sleep(interval)
+
+    after = _take_usage_snapshot(get_cpu, get_disk, get_network, get_totcpu)
+
+    return _usage_from_snapshots(before, after, get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu, get_gpu)
+
+def _iter_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu=False, interval=1.0, count=None, get_gpu=False):
+    '''
+    Yield usage data continuously, one list per interval, in the same format _get_usage returns.
+
+    Each sample reuses the previous sample's counters as its "before" snapshot, so counters are read
+    once per interval and samples are back to back. Ticks are scheduled on a fixed clock, so a slow
+    consumer does not make the stream drift.
+
+    Args:
+        get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu, get_gpu (bool): Components to sample.
+        interval (float): Seconds between samples. Defaults to 1.
+        count (int): Number of samples to yield. Defaults to None (forever).
+
+    Yields:
+        list: [cpu_usage (dict), ram_usage (dict), disk_usages (list of dicts), network_usage (dict), battery_usage (dict)]
+    '''
+    if interval <= 0:
+        raise ValueError(f"interval must be positive, not {interval}")
+    if count is not None and count < 1:
+        raise ValueError(f"count must be positive int, not {count}")
+
+    before = _take_usage_snapshot(get_cpu, get_disk, get_network, get_totcpu)
+    next_tick = time.monotonic()
+    produced = 0
+
+    while count is None or produced < count:
+        next_tick += interval
+        delay = next_tick - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+        else:
+            # fell behind (slow consumer or suspended machine), restart the clock instead of bursting
+            next_tick = time.monotonic()
+
+        after = _take_usage_snapshot(get_cpu, get_disk, get_network, get_totcpu)
+        usage = _usage_from_snapshots(before, after, get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu, get_gpu)
+        before = after
+        produced += 1
+        yield usage
+
+def _format_top_value(value, type):
+    '''
+    Format a ranking value the way the top-N functions return it.
+    '''
+    if type in ("cpu", "pressure"):
+        return round(float(value), 2)
+    if type == "mem":
+        # Format memory usage for display
+        if value >= 1024:  # If >= 1GB, show in GB
+            return f"{value / 1024:.1f} GB"
+        return f"{value:.0f} MB"
+    # I/O rate in bytes per second
+    if value >= 1024 * 1024:
+        return f"{value / (1024 * 1024):.1f} MB/s"
+    return f"{value / 1024:.1f} KB/s"
+
+def _format_top_processes(entries, type):
+    '''
+    Format (pid, name, value) tuples from the process tracker into the dicts returned by the top-N functions.
+    '''
+    return [{'pid': pid, 'name': name, 'usage': _format_top_value(value, type)} for pid, name, value in entries]
+
+def _refresh_process_tracker(keys):
+    '''
+    Refresh the shared process tracker once for all of the requested ranking keys.
+
+    The tracker keeps process handles between calls, so CPU and I/O usage are measured
+    since the previous call. Only the first call needs a short priming window.
+    '''
+    tracker = _get_process_tracker()
+    with_io = "io" in keys
+    if ("cpu" in keys or with_io) and tracker.needs_priming(with_io):
+        with _stage("prime"):
+            tracker.refresh(with_io)
+        # Wait a bit for accurate CPU readings
+        with _stage("sleep"):
+            time.sleep(0.1)
+    with _stage("refresh"):
+        tracker.refresh(with_io)
+    return tracker
+
+@_profiled("processes")
 def _get_top_n_processes(n=5, type="cpu"):
     try:
         try:
@@ -181,443 +401,128 @@ def _get_top_n_processes(n=5, type="cpu"):
     
         if n < 1:
             raise ValueError(f"n must be positive int, not {n}")
-        
-        # First, initialize CPU monitoring for all processes
-        if type == "cpu":
-            for proc in psutil.process_iter():
-                try:
-                    proc.cpu_percent()  # Initialize CPU monitoring
-                except (psutil.NoSuchProcess, psutil.AccessDenied, psutil.ZombieProcess):
-                    pass
-            # Wait a bit for accurate CPU readings
-            time.sleep(0.1)
-        
-        processes = []
-        # List of process names to exclude (system processes that report incorrect usage)
-        excluded_processes = {
-            'System Idle Process',
-            'Idle',
-            'idle',
-            'System',  # Sometimes the main System process also reports weird values
-        }
-        
-        for proc in psutil.process_iter(['pid', 'name', 'cpu_percent', 'memory_percent', 'memory_info']):
-            try:
-                proc_info = proc.info
-                
-                # Skip excluded system processes
-                if proc_info['name'] in excluded_processes:
-                    continue
-                    
-                # Skip processes with PID 0 (usually system idle)
-                if proc_info['pid'] == 0:
-                    continue
-                
-                # Filter out processes with None values and very low usage
-                if type == "cpu" and proc_info['cpu_percent'] is not None and proc_info['cpu_percent'] > 0:
-                    # Cap CPU usage at reasonable levels (no single process should use more than 100% per core)
-                    cpu_percent = min(proc_info['cpu_percent'], 100.0)
-                    if cpu_percent > 0.1:  # Only include processes using more than 0.1% CPU
-                        proc_info['cpu_percent'] = cpu_percent
-                        processes.append(proc_info)
-                elif type == "mem" and proc_info['memory_percent'] is not None and proc_info['memory_percent'] > 0:
-                    # Add absolute memory usage in MB for better reporting
-                    if proc_info['memory_info'] is not None:
-                        memory_mb = proc_info['memory_info'].rss / 1024 / 1024  # Convert bytes to MB
-                        proc_info['memory_mb'] = memory_mb
-                        # Only include processes using at least 1MB of RAM
-                        if memory_mb >= 1.0:
-                            processes.append(proc_info)
-            except (psutil.NoSuchProcess, psutil.AccessDenied, psutil.ZombieProcess):
-                pass
-        
-        if type == "cpu":
-            top_processes = sorted(processes, key=lambda p: p['cpu_percent'] or 0, reverse=True)[:n]
-            top_processes_list = []
-            for p in top_processes:
-                top_processes_list.append({
-                    'pid': p['pid'],
-                    'name': p['name'],
-                    'usage': round(float(p['cpu_percent'] or 0), 2)
-                })
-            return top_processes_list
-        elif type == "mem":
-            # Sort by absolute memory usage (MB) for more meaningful results
-            top_processes = sorted(processes, key=lambda p: p.get('memory_mb', 0), reverse=True)[:n]
-            top_processes_list = []
-            for p in top_processes:
-                memory_mb = p.get('memory_mb', 0)
-                # Format memory usage for display
-                if memory_mb >= 1024:  # If >= 1GB, show in GB
-                    usage_display = f"{memory_mb / 1024:.1f} GB"
-                else:  # Show in MB
-                    usage_display = f"{memory_mb:.0f} MB"
-                
-                top_processes_list.append({
-                    'pid': p['pid'],
-                    'name': p['name'],
-                    'usage': usage_display
-                    # Note: Removed usage_mb and usage_percent for cleaner output
-                })
-            return top_processes_list
-        else:
-            raise TypeError(f"Type must be cpu or mem, not {type}")
-    except Exception as e:
-        return {"error": str(e)}
-
-def _cpu_health_score(cpu_usage_dict):
-    """
-    Calculate CPU health score based on usage percentages.
-    
-    Args:
-        cpu_usage_dict (dict): Dictionary with CPU core usage percentages.
-    
-    Returns:
-        int: Health score from 0 to 100, where 100 is optimal.
-    """
-    if not cpu_usage_dict:
-        return 0
-    
-    # Average CPU usage across all cores
-    average_usage = sum(cpu_usage_dict.values()) / len(cpu_usage_dict)
-    
-    if average_usage < 50:
-        return 100
-    elif average_usage < 70:
-        return 100 - (average_usage - 50) * 2
-    elif average_usage < 85:
-        return 60 - (average_usage - 70) * 2
-    else:
-        return max(0, 30 - (average_usage - 85) * 2)
 
-def _memory_health_score(memory_percent):
-    """
-    Calculate memory health score based on usage percentage.
-    
-    Args:
-        memory_percent (float): Memory usage percentage (0-100).
-    
-    Returns:
-        int: Health score from 0 to 100, where 100 is optimal.
-    """
-    if memory_percent < 50:
-        return 100
-    elif memory_percent < 70:
-        return 100 - (memory_percent - 50) * 2
-    elif memory_percent < 85:
-        return 60 - (memory_percent - 70) * 2
-    else:
-        return max(0, 30 - (memory_percent - 85) * 2)
+        if type not in ("cpu", "mem", "io"):
+            raise TypeError(f"Type must be cpu, mem or io, not {type}")
 
-def _disk_health_score(disk_usage_percent):
-    """
-    Calculate disk health score based on usage percentage.
-    
-    Args:
-        disk_usage_percent (float): Disk usage percentage (0-100).
-    
-    Returns:
-        int: Health score from 0 to 100, where 100 is optimal.
-    """
-    if disk_usage_percent < 60:
-        return 100
-    elif disk_usage_percent < 80:
-        return 100 - (disk_usage_percent - 60) * 2
-    elif disk_usage_percent < 95:
-        return 60 - (disk_usage_percent - 80) * 3
-    else:
-        return max(0, 15 - (disk_usage_percent - 95) * 3)
-
-def _temp_health_score(cpu_temp):
-    """
-    Calculate temperature health score based on CPU temperature.
-    
-    Args:
-        cpu_temp (float): CPU temperature in degrees Celsius.
-    
-    Returns:
-        int: Health score from 0 to 100, where 100 is optimal.
-    """
-    if cpu_temp < 50:
-        return 100
-    elif cpu_temp < 70:
-        return 100 - (cpu_temp - 50) * 2
-    elif cpu_temp < 80:
-        return 60 - (cpu_temp - 70) * 4
-    else:
-        return max(0, 20 - (cpu_temp - 80) * 2)
+        tracker = _refresh_process_tracker((type,))
+        return _format_top_processes(tracker.top(n, type), type)
+    except Exception as e:
+        return {"error": str(e)}
 
-def _battery_health_score(battery_percent, is_plugged):
-    """
-    Calculate battery health score based on percentage and charging status.
+@_profiled("processes")
+def _get_top_n_processes_multi(n=5, keys=("cpu", "mem")):
+    '''
+    Rank the top N processes by several metrics from a single scan of the process list.
 
     Args:
-        battery_percent (float): Battery percentage (0-100).
-        is_plugged (bool): Whether the device is plugged in.
+        n (int): Number of processes per ranking.
+        keys (tuple): Metrics to rank by. Any of "cpu", "mem" and "io".
 
     Returns:
-        int: Health score from 0 to 100, where 100 is optimal.
-    """
-    if is_plugged:
-        return 100 if battery_percent == 100 else 80
-    else:
-        if battery_percent > 50:
-            return 100
-        elif battery_percent > 20:
-            return 100 - (50 - battery_percent) * 2
-        else:
-            return 0
-
-def _system_health_score(cliVersion=False):
+        dict: { key: list of process dicts (same format as _get_top_n_processes) } for each requested key, or { "error": message }.
+    '''
     try:
-        weights = {
-            "cpu": 0.3,
-            "memory": 0.25,
-            "disk": 0.25,
-            "temperature": 0.1,
-            "battery": 0.1
-        }
-        
-        # Get usage data
-        usage = _get_usage(True, True, True, False, True)
-        
-        # Get CPU usage
-        cpu_usage_dict = usage[0] if usage[0] else {}
-        
-        # Get memory usage
-        memory_percent = usage[1]['percent'] if usage[1] else 0
-        
-        # Get disk usage (space, not I/O speed)
         try:
-            disk_usage = psutil.disk_usage('/')  # Linux/Mac
-            disk_usage_percent = disk_usage.percent
+            int(n)
         except:
-            try:
-                disk_usage = psutil.disk_usage('C:\\')  # Windows
-                disk_usage_percent = disk_usage.percent
-            except:
-                disk_usage_percent = 0
-        
-        # Get temperature using platform-specific functions
-        cpu_temp = 50  # Default safe temperature
-        try:
-            operatingSystem = platform.system()
-            
-            if operatingSystem == "Darwin":  # macOS
-                temps = _get_mac_temps()
-                if temps and isinstance(temps, dict):
-                    # Get CPU temperature from macOS temp data
-                    cpu_temp = temps.get('CPU', temps.get('cpu', 50))
-                    if isinstance(cpu_temp, str):
-                        cpu_temp = float(cpu_temp.replace('°C', '').strip())
-                        
-            elif operatingSystem == "Linux":  # Linux
-                temps = _get_linux_temps()
-                if temps and isinstance(temps, dict):
-                    # Get CPU temperature from Linux temp data
-                    for key, value in temps.items():
-                        if 'core' in key.lower() or 'cpu' in key.lower():
-                            cpu_temp = value
-                            break
-                    else:
-                        # If no CPU-specific temp, use first available
-                        cpu_temp = next(iter(temps.values()), 50)
-                        
-            elif operatingSystem == "Windows":  # Windows
-                temps = _get_windows_temps()
-                if temps and isinstance(temps, dict):
-                    # Get CPU temperature from Windows temp data
-                    cpu_temp = next(iter(temps.values()), 50)
-                    
-        except Exception as temp_error:
-            cpu_temp = 50  # Default safe temperature on error
-        
-        # Get battery data
-        battery_percent = usage[4]['percent'] if usage[4] else 100
-        is_plugged = usage[4]['pluggedIn'] if usage[4] else True
-        
-        # Calculate component scores
-        cpu_score = _cpu_health_score(cpu_usage_dict)
-        memory_score = _memory_health_score(memory_percent)
-        disk_score = _disk_health_score(disk_usage_percent)
-        temp_score = _temp_health_score(cpu_temp)
-        battery_score = _battery_health_score(battery_percent, is_plugged)
-        
-        # Calculate weighted total score
-        total_score = (
-            cpu_score * weights['cpu'] +
-            memory_score * weights['memory'] +
-            disk_score * weights['disk'] +
-            temp_score * weights['temperature'] +
-            battery_score * weights['battery']
-        )
-        
-        if not cliVersion:
-            return round(total_score, 2)
-        else:
-            return {
-                "cpu": round(cpu_score, 2),
-                "memory": round(memory_score, 2),
-                "disk": round(disk_score, 2),
-                "temperature": round(temp_score, 2),
-                "battery": round(battery_score, 2),
-                "total": round(total_score, 2)
-            }
-            
+            raise TypeError(f"n must be int, not {type(n)}")
+
+        if n < 1:
+            raise ValueError(f"n must be positive int, not {n}")
+
+        for key in keys:
+            if key not in ("cpu", "mem", "io"):
+                raise TypeError(f"Keys must be cpu, mem or io, not {key}")
+
+        tracker = _refresh_process_tracker(keys)
+        return {key: _format_top_processes(tracker.top(n, key), key) for key in keys}
     except Exception as e:
-        if cliVersion:
-            return {"error": str(e)}
-        return 0
+        return {"error": str(e)}
 
-def _cpu_benchmark():
+def _refresh_cgroup_tracker():
     '''
-    Get CPU performance with some computational tasks, such as:\n
-    - Calculating large Fibonacci numbers\n
-    - Calculating large primes\n
-
-    Returns:
-     dict: {\n
-     "execution_time": time taken to execute (lower is better),\n
-     "fibonacci_10000th": fibonacci number computed,\n
-     "prime_count": prime number calculated in benchmark,\n
-     "score": score calculated (higher is better)\n
-     }
+    Refresh the shared cgroup tracker. Like the process tracker, only the first call needs a priming window.
     '''
-    # start the clock
-    start_time = time.time()
-
-    # compute the first 10000 fib numbers
-    n = 10000
-    count = 0
-    a, b = 0, 1
-    while count < n:
-        count += 1
-        a, b = b, a + b
-    
-    # calculate prime numbers up to 10000
-    def is_prime(n):
-        if n < 2:
-            return False
-        for i in range(2, int(math.sqrt(n)) + 1):
-            if n % i == 0:
-                return False
-        return True
-    
-    prime_count = sum(1 for i in range(2, 10000) if is_prime(i))
+    tracker = _get_cgroup_tracker()
+    if not tracker.available:
+        raise RuntimeError("Per-cgroup usage needs the cgroup v2 (unified) hierarchy, which is not mounted on this system")
+    if tracker.needs_priming():
+        with _stage("prime"):
+            tracker.refresh()
+        with _stage("sleep"):
+            time.sleep(0.1)
+    with _stage("refresh"):
+        tracker.refresh()
+    return tracker
 
-    # end the clock
-    end_time = time.time()
-    time_taken = end_time - start_time
-    
-    # calculate score (higher is better)
-    baseline_time = .05
-    score = max(0, (baseline_time / time_taken) * 100)
-    
-    return {
-        "execution_time": round(time_taken, 3),
-        "fibonacci_10000th": str(a)[:50] + "..." if len(str(a)) > 50 else str(a),
-        "prime_count": prime_count,
-        "score": round(score, 1)
-    }
-
-def _mem_benchmark():
-    '''Benchmark memory allocation and access speed using large lists
-    Returns:
-     dict: {\n
-     "execution_time": time taken to execute the program (lower is better),\n
-     "sum_calculated": total sum calculated during the test,\n
-     "score": the performance score on your ram (higher is better)\n
-     }
+@_profiled("cgroups")
+def _get_cgroup_usage(level="all"):
     '''
+    Usage of every cgroup v2 cgroup (containers, systemd services and slices) since the previous call.
 
-    # start clock
-    start_time = time.time()
+    Args:
+        level (str): "leaf", "slice" or "all". Defaults to "all".
 
-    large_list = []
-    for i in range(1000000):
-        large_list.append(i * 2)
-    
-    total = sum(large_list)
+    Returns:
+        list: One dict per cgroup, sorted by name: {
+            "name": path below the cgroup root, "container": 12 digit container ID or None,
+            "cpu": percent of one core, "throttled": percent of the time the CPU quota throttled it,
+            "memory", "memoryLimit" (MB, None without a limit), "memoryPercent",
+            "readSpeed", "writeSpeed" (MB/s), "readIops", "writeIops",
+            "cpuPressure", "memoryPressure", "ioPressure": percent of the time some task was stalled
+        }, or { "error": message }. Values the kernel does not report (disabled controllers, no PSI) are None.
+    '''
+    try:
+        if level not in CGROUP_LEVELS:
+            raise ValueError(f"level must be leaf, slice or all, not {level}")
+        return _refresh_cgroup_tracker().usage(level)
+    except Exception as e:
+        return {"error": str(e)}
 
-    copied_list = large_list.copy()
+@_profiled("cgroups")
+def _get_top_n_cgroups(n=5, type="cpu", level="leaf"):
+    try:
+        try:
+            int(n)
+        except:
+            raise TypeError(f"n must be int, not {type(n)}")
 
-    del large_list, copied_list
-    gc.collect()
+        if n < 1:
+            raise ValueError(f"n must be positive int, not {n}")
 
-    end_time = time.time()
-    time_taken = end_time - start_time
+        if type not in ("cpu", "mem", "io", "pressure"):
+            raise TypeError(f"Type must be cpu, mem, io or pressure, not {type}")
 
-    # calculate score
-    baseline = 1.0
-    score = max(0, (baseline / time_taken) * 100)
+        if level not in CGROUP_LEVELS:
+            raise ValueError(f"level must be leaf, slice or all, not {level}")
 
-    return {
-        "execution_time": round(time_taken, 3),
-        "sum_calculated": total,
-        "score": round(score, 1)
-    }
+        tracker = _refresh_cgroup_tracker()
+        return [{'name': name, 'container': container, 'usage': _format_top_value(value, type)}
+                for name, container, value in tracker.top(n, type, level)]
+    except Exception as e:
+        return {"error": str(e)}
 
-def _disk_benchmark():
+@_profiled("health")
+def _system_health_score(cliVersion=False, usage=None, temps=None, weights=None, thresholds=None):
     '''
-    Benchmark disk I/O performance by writing and reading a 10MB test file.
-    
-    Returns:
-     dict: {
-     "write_speed": Write speed in MB/s,
-     "read_speed": Read speed in MB/s, 
-     "write_score": Write performance score (higher is better),
-     "read_score": Read performance score (higher is better),
-     "overall_score": Overall disk performance score (higher is better)
-     }
+    Args:
+        cliVersion (bool): Return every sub-score instead of only the total.
+        usage (list): Usage list with at least cpu, ram and battery, already measured by the caller.
+                      Defaults to None (the health monitor's scores, the background sampler's latest sample, or a new one second sample).
+        temps (dict): Temperature readings already taken by the caller. Defaults to None (read them when the cached score is stale).
+        weights (dict): Weight per component, merged over the defaults. Defaults to None.
+        thresholds (dict): (value, score) breakpoints per component, merged over the defaults. Defaults to None.
     '''
-    
-    # create tempfile
-    with tempfile.NamedTemporaryFile(delete=False) as temp_file:
-        temp_path = temp_file.name
-    
     try:
-        # write test
-        start_time = time.time()
-        test_data = b"0" * (10 * 1024 * 1024) # 10mb
-
-        with open(temp_path, 'wb') as f:
-            f.write(test_data)
-            f.flush()
-            os.fsync(f.fileno())
-        
-        write_time = time.time() - start_time
-
-        # read test
-        start_time = time.time()
-        with open(temp_path, 'rb') as f:
-            read_data = f.read()
-
-        read_time = time.time() - start_time
-
-        # calc speed
-        file_size_mb = len(test_data) / (1024 * 1024)
-        write_speed = file_size_mb / write_time
-        read_speed = file_size_mb / read_time
-
-        # scoring (higher is better)
-        write_baseline = 100
-        read_baseline = 100
-        
-        write_score = max(0, (write_speed / write_baseline) * 100)
-        read_score = max(0, (read_speed / read_baseline) * 100)
-        overall_score = (write_score + read_score) / 2
-
-        return {
-            "write_speed": round(write_speed, 1),
-            "read_speed": round(read_speed, 1),
-            "write_score": round(write_score, 1),
-            "read_score": round(read_score, 1),
-            "overall_score": round(overall_score, 1)
-        }
-
-    finally:
-        # cleanup
         try:
-            os.unlink(temp_path)
-        except:
-            pass
+            from ._healthEngine import _health_scores
+        except ImportError:
+            from _healthEngine import _health_scores
+
+        return _health_scores(cliVersion, usage, temps, weights, thresholds)
+            
+    except Exception as e:
+        if cliVersion:
+            return {"error": str(e)}
+        return 0
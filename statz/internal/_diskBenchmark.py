@@ -0,0 +1,301 @@
+'''
+Disk benchmark.
+A test file is written sequentially, then read sequentially, read at random offsets and written at
+random offsets. Reads bypass the page cache (O_DIRECT on Linux, F_NOCACHE on macOS, or dropping the
+file's cached pages with posix_fadvise where O_DIRECT is refused), otherwise they would measure RAM.
+Several I/Os are kept outstanding by running one thread per queue slot; os.pread and os.pwrite
+release the GIL, so the threads really wait on the device at the same time.
+'''
+
+import errno
+import mmap
+import os
+import platform
+import random
+import tempfile
+import threading
+import time
+
+try:
+    from ._benchmarkRunner import _percentile, _score
+except ImportError:
+    from _benchmarkRunner import _percentile, _score
+
+KIB = 1024
+MIB = 1024 * 1024
+
+TESTS = ("seq_write", "seq_read", "rand_read", "rand_write")
+
+# throughput that scores 100, roughly a 2020 SATA SSD
+REFERENCE_THROUGHPUT = {
+    "seq_write": 450.0,
+    "seq_read": 500.0,
+    "rand_read": 150.0,
+    "rand_write": 120.0,
+}
+
+def _page_cache_mode(direct):
+    '''How the benchmark tries to keep reads off the page cache on this platform.'''
+    if not direct:
+        return None
+    if hasattr(os, "O_DIRECT"):
+        return "O_DIRECT"
+    if platform.system() == "Darwin":
+        return "F_NOCACHE"
+    if hasattr(os, "posix_fadvise"):
+        return "fadvise"
+    return None
+
+def _open(path, write, mode):
+    '''
+    Open the test file for one worker.
+
+    Returns:
+        tuple: (fd, mode actually used). O_DIRECT falls back to "fadvise" on file systems that refuse it (tmpfs, some FUSE).
+    '''
+    flags = (os.O_RDWR if write else os.O_RDONLY) | getattr(os, "O_BINARY", 0)
+    if mode == "O_DIRECT":
+        try:
+            return os.open(path, flags | os.O_DIRECT), mode
+        except OSError as e:
+            if e.errno != errno.EINVAL:
+                raise
+            mode = "fadvise" if hasattr(os, "posix_fadvise") else None
+
+    fd = os.open(path, flags)
+    if mode == "F_NOCACHE":
+        try:
+            import fcntl
+            fcntl.fcntl(fd, getattr(fcntl, "F_NOCACHE", 48), 1)
+        except:
+            mode = None
+    return fd, mode
+
+def _drop_cache(path, mode):
+    '''Evict the file's clean pages so the next reads come from the device.'''
+    if mode != "fadvise":
+        return
+    fd = os.open(path, os.O_RDONLY)
+    try:
+        os.fdatasync(fd)
+        os.posix_fadvise(fd, 0, 0, os.POSIX_FADV_DONTNEED)
+    finally:
+        os.close(fd)
+
+def _read_at(fd, buffer, offset):
+    if hasattr(os, "preadv"):
+        return os.preadv(fd, [buffer], offset)
+    # Windows has neither pread nor preadv, but every worker has its own descriptor
+    os.lseek(fd, offset, os.SEEK_SET)
+    return len(os.read(fd, len(buffer)))
+
+def _write_at(fd, buffer, offset):
+    if hasattr(os, "pwrite"):
+        return os.pwrite(fd, buffer, offset)
+    os.lseek(fd, offset, os.SEEK_SET)
+    return os.write(fd, buffer)
+
+def _aligned_buffer(size, fill=True):
+    '''Page aligned buffer (mmap), which O_DIRECT needs, filled with random bytes so compressing SSDs do not cheat.'''
+    buffer = mmap.mmap(-1, size)
+    if fill:
+        chunk = os.urandom(min(size, MIB))
+        for offset in range(0, size, len(chunk)):
+            buffer[offset:offset + len(chunk)] = chunk[:size - offset]
+    return buffer
+
+def _summarize(latencies, total_bytes, seconds, block_size, queue_depth, mode):
+    '''Throughput, IOPS and latency percentiles of one test.'''
+    return {
+        "throughput": round(total_bytes / seconds / 1_000_000, 1) if seconds else 0.0,
+        "unit": "MB/s",
+        "iops": round(len(latencies) / seconds) if seconds else 0,
+        "p50_ms": round(_percentile(latencies, 50) * 1000, 3) if latencies else None,
+        "p99_ms": round(_percentile(latencies, 99) * 1000, 3) if latencies else None,
+        "block_kb": block_size // KIB,
+        "queue_depth": queue_depth,
+        "ops": len(latencies),
+        "seconds": round(seconds, 3),
+        "cache_bypass": mode,
+    }
+
+def _sequential(path, write, file_size, block_size, duration, mode):
+    '''One pass over the file in block_size I/Os at queue depth 1 (stops early after `duration` seconds for reads).'''
+    fd, mode = _open(path, write, mode)
+    buffer = _aligned_buffer(block_size, fill=write)
+    latencies = []
+    done = 0
+    try:
+        start = time.perf_counter()
+        for offset in range(0, file_size, block_size):
+            io_start = time.perf_counter()
+            if write:
+                _write_at(fd, buffer, offset)
+            else:
+                _read_at(fd, buffer, offset)
+            now = time.perf_counter()
+            latencies.append(now - io_start)
+            done += block_size
+            if not write and now - start >= duration:
+                break
+        if write:
+            # the data is not written until it is on the device
+            os.fsync(fd)
+        seconds = time.perf_counter() - start
+    finally:
+        os.close(fd)
+        buffer.close()
+    return _summarize(latencies, done, seconds, block_size, 1, mode)
+
+def _random(path, write, file_size, block_size, queue_depth, duration, mode):
+    '''block_size I/Os at random aligned offsets from queue_depth threads for `duration` seconds.'''
+    blocks = file_size // block_size
+    results = [None] * queue_depth
+    modes = [mode] * queue_depth
+    errors = []
+    barrier = threading.Barrier(queue_depth + 1)
+
+    def worker(index):
+        latencies = []
+        fd = buffer = None
+        started = False
+        try:
+            fd, modes[index] = _open(path, write, mode)
+            buffer = _aligned_buffer(block_size, fill=write)
+            generator = random.Random(index)
+            operation = _write_at if write else _read_at
+            started = True
+            barrier.wait()
+            deadline = time.perf_counter() + duration
+            while True:
+                offset = generator.randrange(blocks) * block_size
+                io_start = time.perf_counter()
+                operation(fd, buffer, offset)
+                now = time.perf_counter()
+                latencies.append(now - io_start)
+                if now >= deadline:
+                    break
+        except Exception as e:
+            errors.append(e)
+            if not started:
+                # everyone else waits at the barrier for this worker, release them so the test fails instead of hanging
+                barrier.abort()
+        finally:
+            results[index] = latencies
+            if fd is not None:
+                os.close(fd)
+            if buffer is not None:
+                buffer.close()
+
+    threads = [threading.Thread(target=worker, args=(index,), name=f"statz-diskbench-{index}", daemon=True) for index in range(queue_depth)]
+    for thread in threads:
+        thread.start()
+    try:
+        barrier.wait()
+    except threading.BrokenBarrierError:
+        pass  # a worker could not start, its error is raised below
+    start = time.perf_counter()
+    for thread in threads:
+        thread.join()
+    if write:
+        fd = os.open(path, os.O_RDWR | getattr(os, "O_BINARY", 0))
+        try:
+            os.fsync(fd)
+        finally:
+            os.close(fd)
+    seconds = time.perf_counter() - start
+
+    if errors:
+        # the other workers only saw the broken barrier, report the error that broke it
+        raise next((e for e in errors if not isinstance(e, threading.BrokenBarrierError)), errors[0])
+    latencies = [latency for thread_latencies in results for latency in (thread_latencies or [])]
+    return _summarize(latencies, len(latencies) * block_size, seconds, block_size, queue_depth, modes[0])
+
+def _disk_benchmark(path=None, size_mb=256, block_kb=4, seq_block_kb=1024, queue_depth=16, duration=3.0, direct=True, tests=None):
+    '''
+    Run the disk benchmark against a test file.
+
+    Args:
+        path (str): Directory to put the test file in, to benchmark a specific mount. Defaults to the temp directory.
+        size_mb (int): Size of the test file in MiB. Defaults to 256, use more than the drive's cache for steady-state numbers.
+        block_kb (int): Block size of the random tests in KiB. Defaults to 4.
+        seq_block_kb (int): Block size of the sequential tests in KiB. Defaults to 1024.
+        queue_depth (int): Outstanding I/Os in the random tests. Defaults to 16.
+        duration (float): Seconds per random test, and the limit of the sequential read. Defaults to 3.
+        direct (bool): Bypass the page cache. Defaults to True.
+        tests (list): Subset of "seq_write", "seq_read", "rand_read" and "rand_write". The file is always written first.
+
+    Returns:
+        dict: {
+            "execution_time", "path", "size_mb", "cache_bypass": "O_DIRECT", "F_NOCACHE", "fadvise" or None,
+            "tests": { test: {"throughput", "unit", "iops", "p50_ms", "p99_ms", "block_kb", "queue_depth", "ops", "seconds", "cache_bypass"} },
+            "write_speed", "read_speed": sequential MB/s,
+            "write_score", "read_score": sequential scores,
+            "score": geometric mean of every test against the reference, times 100 (higher is better)
+        }
+    '''
+    names = list(tests) if tests else list(TESTS)
+    for name in names:
+        if name not in TESTS:
+            raise ValueError(f"Unknown disk test {name}, expected one of {', '.join(TESTS)}")
+    if size_mb <= 0 or block_kb <= 0 or seq_block_kb <= 0:
+        raise ValueError("size_mb, block_kb and seq_block_kb must be positive")
+    if queue_depth < 1:
+        raise ValueError(f"queue_depth must be positive int, not {queue_depth}")
+    if duration <= 0:
+        raise ValueError(f"duration must be positive, not {duration}")
+
+    directory = path or tempfile.gettempdir()
+    if not os.path.isdir(directory):
+        raise ValueError(f"Benchmark path {directory} is not a directory")
+
+    block_size = int(block_kb * KIB)
+    seq_block_size = int(seq_block_kb * KIB)
+    # O_DIRECT needs sizes and offsets aligned to the logical block size, so keep everything a multiple of 4 KiB
+    for size in (block_size, seq_block_size):
+        if size % (4 * KIB):
+            raise ValueError(f"Block sizes must be a multiple of 4 KiB, not {size // KIB} KiB")
+    file_size = int(size_mb * MIB) // seq_block_size * seq_block_size
+    if file_size < max(block_size, seq_block_size):
+        raise ValueError("size_mb must be at least one block")
+
+    start_time = time.time()
+    mode = _page_cache_mode(direct)
+    fd, temp_path = tempfile.mkstemp(prefix="statz-bench-", dir=directory)
+    os.close(fd)
+
+    results = {}
+    try:
+        # the sequential write also lays the file out for the other tests
+        results["seq_write"] = _sequential(temp_path, True, file_size, seq_block_size, duration, mode)
+        mode = results["seq_write"]["cache_bypass"]
+        _drop_cache(temp_path, mode)
+
+        if "seq_read" in names:
+            results["seq_read"] = _sequential(temp_path, False, file_size, seq_block_size, duration, mode)
+        if "rand_read" in names:
+            _drop_cache(temp_path, mode)
+            results["rand_read"] = _random(temp_path, False, file_size, block_size, queue_depth, duration, mode)
+        if "rand_write" in names:
+            results["rand_write"] = _random(temp_path, True, file_size, block_size, queue_depth, duration, mode)
+    finally:
+        try:
+            os.unlink(temp_path)
+        except:
+            pass
+
+    results = {name: results[name] for name in names}
+    write = results.get("seq_write")
+    read = results.get("seq_read")
+    return {
+        "execution_time": round(time.time() - start_time, 3),
+        "path": directory,
+        "size_mb": round(file_size / MIB, 1),
+        "cache_bypass": mode,
+        "tests": results,
+        "write_speed": write["throughput"] if write else None,
+        "read_speed": read["throughput"] if read else None,
+        "write_score": round(write["throughput"] / REFERENCE_THROUGHPUT["seq_write"] * 100, 1) if write else None,
+        "read_score": round(read["throughput"] / REFERENCE_THROUGHPUT["seq_read"] * 100, 1) if read else None,
+        "score": _score(results, {name: REFERENCE_THROUGHPUT[name] for name in names}),
+    }
@@ -0,0 +1,441 @@
+'''
+Streaming export writers.
+Every collector declares the schema of its result: typed columns and a function that turns one result
+into rows. A writer streams those rows through a buffered file as JSON Lines, CSV, or Parquet / Arrow IPC
+record batches (the last two need pyarrow), so an hours-long --watch session or a large process table
+is written as it is produced instead of being built into one document first.
+'''
+
+import csv
+import json
+import platform
+import sys
+import time
+
+BUFFER_SIZE = 1024 * 1024
+# rows per Parquet row group / Arrow record batch
+BATCH_ROWS = 8192
+
+FORMATS = {
+    "json": ".json",
+    "jsonl": ".jsonl",
+    "csv": ".csv",
+    "parquet": ".parquet",
+    "arrow": ".arrow",
+}
+
+class _Schema:
+    '''
+    Typed columns of an export and how one collector result becomes rows.
+
+    Args:
+        name (str): Name collectors declare with _export_schema.
+        columns (tuple): (column name, "str", "int", "float" or "bool") pairs.
+        rows (callable): rows(result, timestamp) yielding one tuple per row, in column order.
+    '''
+    def __init__(self, name, columns, rows):
+        self.name = name
+        self.columns = tuple(columns)
+        self.names = tuple(column for column, _ in self.columns)
+        self._rows = rows
+
+    def rows(self, result, timestamp=None):
+        return self._rows(result, round(time.time(), 3) if timestamp is None else timestamp)
+
+SCHEMAS = {}
+
+def _register(name, columns, rows):
+    SCHEMAS[name] = _Schema(name, columns, rows)
+
+def _export_schema(name):
+    '''Decorator for collectors: declare the schema their result is exported with.'''
+    def declare(function):
+        function.export_schema = name
+        return function
+    return declare
+
+def _schema_for(function, name=None):
+    '''The schema named `name`, or the one `function` declared. None if neither is known.'''
+    name = name or getattr(function, "export_schema", None)
+    if name is None:
+        return None
+    if name not in SCHEMAS:
+        raise ValueError(f"Unknown export schema {name}, expected one of {', '.join(SCHEMAS)}")
+    return SCHEMAS[name]
+
+# ---------- value helpers ----------
+
+def _number(value):
+    '''float for numbers and bools, None for anything else.'''
+    if isinstance(value, bool):
+        return 1.0 if value else 0.0
+    if isinstance(value, (int, float)):
+        return float(value)
+    return None
+
+def _quantity(value):
+    '''(number, unit) for 15.2, "512 MB" or "3.2 MB/s", (None, "") when there is no number.'''
+    number = _number(value)
+    if number is not None or not isinstance(value, str):
+        return number, ""
+    amount, _, unit = value.strip().partition(" ")
+    try:
+        return float(amount), unit
+    except ValueError:
+        return None, ""
+
+def _text(value):
+    '''Scalar as text, containers as compact JSON.'''
+    if isinstance(value, (dict, list, tuple)):
+        return json.dumps(value, separators=(",", ":"), default=str)
+    return "" if value is None else str(value)
+
+# ---------- usage ----------
+
+USAGE_COLUMNS = (("timestamp", "float"), ("component", "str"), ("metric", "str"), ("value", "float"), ("unit", "str"))
+USAGE_COMPONENTS = ("cpu", "ram", "disk", "network", "battery", "gpu")
+
+RAM_UNITS = {"total": "MB", "used": "MB", "free": "MB", "percent": "%"}
+NETWORK_UNITS = {"up": "MB/s", "down": "MB/s"}
+DISK_UNITS = {"readSpeed": "MB/s", "writeSpeed": "MB/s"}
+BATTERY_UNITS = {"percent": "%", "timeLeftMins": "minutes", "pluggedIn": ""}
+GPU_UNITS = {"usage": "%", "memoryUsed": "MB", "memoryTotal": "MB", "memoryPercent": "%", "power": "W", "temperature": "°C"}
+# record key -> (component column, units of its metrics or None if they are all percentages)
+USAGE_METRICS = {
+    "cpu": ("CPU", None),
+    "totcpu": ("CPU", None),
+    "ram": ("RAM", RAM_UNITS),
+    "network": ("Network", NETWORK_UNITS),
+    "battery": ("Battery", BATTERY_UNITS),
+}
+
+def _sample_rows(record, timestamp):
+    '''Rows of one usage record ({"cpu", "totcpu", "ram", "disk", "network", "battery", "gpu", "processes"}, as --watch builds).'''
+    timestamp = record.get("timestamp", timestamp)
+    for key, (name, units) in USAGE_METRICS.items():
+        values = record.get(key)
+        if not isinstance(values, dict):
+            continue
+        for metric, value in values.items():
+            yield (timestamp, name, metric, _number(value), units.get(metric, "") if units else "%")
+
+    for index, disk in enumerate(record.get("disk") or ()):
+        device = disk.get("device", f"Disk{index + 1}")
+        for metric, value in disk.items():
+            if metric != "device":
+                yield (timestamp, "Disk", f"{device}.{metric}", _number(value), DISK_UNITS.get(metric, ""))
+
+    for gpu in record.get("gpu") or ():
+        for metric, unit in GPU_UNITS.items():
+            if gpu.get(metric) is not None:
+                yield (timestamp, "GPU", f"{gpu.get('index')}.{metric}", _number(gpu[metric]), unit)
+
+    processes = record.get("processes")
+    if isinstance(processes, dict):
+        for ranking, entries in processes.items():
+            for process in entries if isinstance(entries, list) else ():
+                value, unit = _quantity(process.get("usage"))
+                yield (timestamp, "Processes", f"{ranking}.{process.get('name')}[{process.get('pid')}]", value, unit or "%")
+
+def _usage_rows(usage, timestamp):
+    '''Rows of a get_hardware_usage list. Cached lists carry the time they were sampled.'''
+    record = dict(zip(USAGE_COMPONENTS, usage))
+    return _sample_rows(record, getattr(usage, "timestamp", timestamp))
+
+_register("usage", USAGE_COLUMNS, _usage_rows)
+_register("usage_sample", USAGE_COLUMNS, _sample_rows)
+
+# ---------- specs ----------
+
+SPECS_COMPONENTS = {
+    "Windows": ("OS", "CPU", "GPU", "Memory", "Storage", "Network", "Battery"),
+    "default": ("OS", "CPU", "Memory", "Disk"),
+}
+
+def _specs_rows(specs, timestamp):
+    components = SPECS_COMPONENTS.get(platform.system(), SPECS_COMPONENTS["default"])
+    for component, data in zip(components, specs):
+        if isinstance(data, dict):
+            for prop, value in data.items():
+                yield (component, prop, _text(value))
+        elif isinstance(data, list):
+            for index, item in enumerate(data, 1):
+                if isinstance(item, dict):
+                    for prop, value in item.items():
+                        yield (f"{component} {index}", prop, _text(value))
+                else:
+                    yield (f"{component} {index}", "value", _text(item))
+        elif data is not None:
+            yield (component, "value", _text(data))
+
+_register("specs", (("component", "str"), ("property", "str"), ("value", "str")), _specs_rows)
+
+# ---------- processes ----------
+
+def _process_row(process):
+    value, unit = _quantity(process.get("usage"))
+    return (process.get("pid"), _text(process.get("name")), value, unit or "%")
+
+def _processes_rows(processes, timestamp):
+    for process in processes:
+        yield _process_row(process)
+
+def _processes_multi_rows(rankings, timestamp):
+    for ranking, processes in rankings.items():
+        for process in processes if isinstance(processes, list) else ():
+            yield (ranking,) + _process_row(process)
+
+PROCESS_COLUMNS = (("pid", "int"), ("name", "str"), ("usage", "float"), ("unit", "str"))
+_register("processes", PROCESS_COLUMNS, _processes_rows)
+_register("processes_multi", (("ranking", "str"),) + PROCESS_COLUMNS, _processes_multi_rows)
+
+# ---------- cgroups ----------
+
+CGROUP_METRICS = ("cpu", "throttled", "memory", "memoryLimit", "memoryPercent", "readSpeed", "writeSpeed",
+                  "readIops", "writeIops", "cpuPressure", "memoryPressure", "ioPressure")
+
+def _cgroups_rows(cgroups, timestamp):
+    for cgroup in cgroups:
+        value, unit = _quantity(cgroup.get("usage"))
+        yield (_text(cgroup.get("name")), _text(cgroup.get("container")), value, unit or "%")
+
+def _cgroup_usage_rows(cgroups, timestamp):
+    for cgroup in cgroups:
+        yield (timestamp, _text(cgroup.get("name")), _text(cgroup.get("container"))) + tuple(_number(cgroup.get(metric)) for metric in CGROUP_METRICS)
+
+_register("cgroups", (("name", "str"), ("container", "str"), ("usage", "float"), ("unit", "str")), _cgroups_rows)
+_register("cgroup_usage", (("timestamp", "float"), ("name", "str"), ("container", "str")) + tuple((metric, "float") for metric in CGROUP_METRICS),
+          _cgroup_usage_rows)
+
+# ---------- temperatures and health ----------
+
+def _temps_rows(temps, timestamp):
+    for sensor, value in (temps or {}).items():
+        if isinstance(value, str) and "°C" in value:
+            value = value.replace("°C", "").strip()
+        number, _ = _quantity(value)
+        yield (timestamp, sensor, number, "°C" if number is not None else "")
+
+def _health_rows(health, timestamp):
+    if isinstance(health, dict):
+        for metric, score in health.items():
+            yield (timestamp, metric, _number(score))
+    else:
+        yield (timestamp, "total", _number(health))
+
+_register("temps", (("timestamp", "float"), ("sensor", "str"), ("value", "float"), ("unit", "str")), _temps_rows)
+_register("health", (("timestamp", "float"), ("metric", "str"), ("score", "float")), _health_rows)
+
+# ---------- results without a declared schema ----------
+
+def _flatten(data, prefix=""):
+    '''(key, value) pairs of nested dicts and lists, keyed like "cpu.core1" or "disk[0].device".'''
+    if isinstance(data, dict):
+        for key, value in data.items():
+            yield from _flatten(value, f"{prefix}.{key}" if prefix else str(key))
+    elif isinstance(data, (list, tuple)):
+        for index, item in enumerate(data):
+            yield from _flatten(item, f"{prefix}[{index}]" if prefix else f"item_{index}")
+    else:
+        yield (prefix or "value", _text(data))
+
+_register("key_value", (("key", "str"), ("value", "str")), lambda result, timestamp: _flatten(result))
+
+def _record_schema(first):
+    '''Schema for a list of flat dicts (a user function's records), typed from the first one.'''
+    types = {bool: "bool", int: "int", float: "float"}
+    columns = [(str(key), types.get(type(value), "str")) for key, value in first.items()]
+    keys = list(first)
+
+    def rows(records, timestamp):
+        for record in records:
+            yield tuple(record.get(key) if kind != "str" else _text(record.get(key)) for key, (_, kind) in zip(keys, columns))
+    return _Schema("records", columns, rows)
+
+def _fallback_schema(result):
+    '''Schema for the result of a function that declares none.'''
+    if isinstance(result, list) and result and all(isinstance(item, dict) for item in result):
+        return _record_schema(result[0])
+    return SCHEMAS["key_value"]
+
+# ---------- writers ----------
+
+class _RecordWriter:
+    '''
+    Base class of the streaming writers.
+
+    Args:
+        schema (_Schema): Columns and row function.
+        flush_interval (float): Flush buffered rows at most this often in seconds; 0 flushes after every
+                                write, None only when the buffer fills and at close. Defaults to None.
+    '''
+    def __init__(self, schema, flush_interval=None):
+        self.schema = schema
+        self.rows_written = 0
+        self.flush_interval = flush_interval
+        self._last_flush = time.monotonic()
+
+    def write(self, result, timestamp=None):
+        '''Write the rows of one collector result. Returns the number of rows.'''
+        count = self._write_rows(self.schema.rows(result, timestamp))
+        self.rows_written += count
+        if self.flush_interval is not None and time.monotonic() - self._last_flush >= self.flush_interval:
+            self.flush()
+        return count
+
+    def flush(self):
+        self._last_flush = time.monotonic()
+
+    def close(self):
+        pass
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+class _TextWriter(_RecordWriter):
+    def __init__(self, path, schema, append=False, flush_interval=None):
+        super().__init__(schema, flush_interval)
+        if path is None:
+            self._file, self._owned = sys.stdout, False
+            self._empty = True
+        else:
+            self._file = open(path, "a" if append else "w", newline="", encoding="utf-8", buffering=BUFFER_SIZE)
+            self._owned = True
+            self._empty = self._file.tell() == 0
+
+    def flush(self):
+        self._file.flush()
+        super().flush()
+
+    def close(self):
+        if self._owned:
+            self._file.close()
+        else:
+            self._file.flush()
+
+class _CsvWriter(_TextWriter):
+    def __init__(self, path, schema, append=False, flush_interval=None):
+        super().__init__(path, schema, append, flush_interval)
+        self._writer = csv.writer(self._file)
+        # appending to an existing export keeps its header
+        if self._empty:
+            self._writer.writerow(schema.names)
+
+    def _write_rows(self, rows):
+        count = 0
+        for row in rows:
+            self._writer.writerow(["" if value is None else value for value in row])
+            count += 1
+        return count
+
+class _JsonLinesWriter(_TextWriter):
+    def __init__(self, path, schema, append=False, flush_interval=None):
+        super().__init__(path, schema, append, flush_interval)
+        self._encode = json.JSONEncoder(separators=(",", ":"), ensure_ascii=False, default=str).encode
+
+    def _write_rows(self, rows):
+        names = self.schema.names
+        count = 0
+        for row in rows:
+            self._file.write(self._encode(dict(zip(names, row))))
+            self._file.write("\n")
+            count += 1
+        return count
+
+class _ArrowWriter(_RecordWriter):
+    '''Collects up to BATCH_ROWS rows per column, then writes them as one Parquet row group or Arrow record batch.'''
+    def __init__(self, path, schema, file_format, flush_interval=None):
+        if path is None:
+            raise ValueError(f"{file_format} export needs a path")
+        super().__init__(schema, flush_interval)
+        try:
+            import pyarrow
+        except ImportError:
+            raise ImportError(f"{file_format} export needs pyarrow (pip install pyarrow)")
+        self._pa = pyarrow
+        types = {"str": pyarrow.string(), "int": pyarrow.int64(), "float": pyarrow.float64(), "bool": pyarrow.bool_()}
+        self._arrow_schema = pyarrow.schema([pyarrow.field(name, types[kind]) for name, kind in schema.columns])
+        self._columns = [[] for _ in schema.columns]
+        self._pending = 0
+
+        if file_format == "parquet":
+            import pyarrow.parquet
+            self._writer = pyarrow.parquet.ParquetWriter(path, self._arrow_schema)
+            self._write_batch = lambda batch: self._writer.write_table(pyarrow.Table.from_batches([batch]))
+        else:
+            import pyarrow.ipc
+            self._writer = pyarrow.ipc.new_file(path, self._arrow_schema)
+            self._write_batch = self._writer.write_batch
+
+    def _write_rows(self, rows):
+        count = 0
+        for row in rows:
+            for column, value in zip(self._columns, row):
+                column.append(value)
+            count += 1
+            self._pending += 1
+            if self._pending >= BATCH_ROWS:
+                self._write_pending()
+        return count
+
+    def _write_pending(self):
+        if not self._pending:
+            return
+        arrays = [self._pa.array(column, type=field.type) for column, field in zip(self._columns, self._arrow_schema)]
+        self._write_batch(self._pa.record_batch(arrays, schema=self._arrow_schema))
+        for column in self._columns:
+            column.clear()
+        self._pending = 0
+
+    def flush(self):
+        # small batches make poor row groups, so only full batches are written before close
+        super().flush()
+
+    def close(self):
+        self._write_pending()
+        self._writer.close()
+
+def _open_writer(path, schema, file_format, append=False, flush_interval=None):
+    '''
+    Open a streaming writer.
+
+    Args:
+        path (str): File to write, or None for stdout (JSON Lines and CSV only).
+        schema (_Schema): Schema of the results that will be written.
+        file_format (str): "jsonl", "csv", "parquet" or "arrow".
+        append (bool): Append to an existing JSON Lines or CSV file. Defaults to False.
+        flush_interval (float): See _RecordWriter.
+
+    Returns:
+        _RecordWriter: Call write(result) for every result and close() at the end (or use it as a context manager).
+    '''
+    if file_format == "csv":
+        return _CsvWriter(path, schema, append, flush_interval)
+    if file_format == "jsonl":
+        return _JsonLinesWriter(path, schema, append, flush_interval)
+    if file_format in ("parquet", "arrow"):
+        return _ArrowWriter(path, schema, file_format, flush_interval)
+    raise ValueError(f"Unknown streaming export format {file_format}, expected jsonl, csv, parquet or arrow")
+
+def _write_json_document(path, result):
+    '''Write a result as one indented JSON document, encoded chunk by chunk into a buffered file.'''
+    with open(path, "w", encoding="utf-8", buffering=BUFFER_SIZE) as f:
+        for chunk in json.JSONEncoder(indent=2, default=str).iterencode(result):
+            f.write(chunk)
+
+def _export(result, path, file_format, schema=None):
+    '''
+    Write one collector result to path.
+
+    Returns:
+        int: Rows written (1 for a JSON document).
+    '''
+    if file_format == "json":
+        _write_json_document(path, result)
+        return 1
+    with _open_writer(path, schema or _fallback_schema(result), file_format) as writer:
+        writer.write(result)
+        return writer.rows_written
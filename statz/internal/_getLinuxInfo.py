@@ -1,8 +1,17 @@
+import glob
+import os
 import platform
 import psutil
 import subprocess
 import re
+import threading
 
+try:
+    from ._profiler import _profiled, _stage, _fallback
+except ImportError:
+    from _profiler import _profiled, _stage, _fallback
+
+@_profiled("specs.linux")
 def _get_linux_specs(get_os, get_cpu, get_ram, get_disk):
     '''
     Get system specifications for Linux systems with selective fetching.
@@ -58,7 +67,7 @@ def _get_linux_specs(get_os, get_cpu, get_ram, get_disk):
             
             # get cpu name from /proc/cpuinfo
             try:
-                with open('/proc/cpuinfo', 'r') as f:
+                with _stage("cpuinfo"), open('/proc/cpuinfo', 'r') as f:
                     for line in f:
                         if 'model name' in line:
                             cpu_info["cpuName"] = line.split(':')[1].strip()
@@ -70,7 +79,7 @@ def _get_linux_specs(get_os, get_cpu, get_ram, get_disk):
             
             # get cpu frequency from /proc/cpuinfo
             try:
-                with open('/proc/cpuinfo', 'r') as f:
+                with _stage("cpuinfo"), open('/proc/cpuinfo', 'r') as f:
                     for line in f:
                         if 'cpu MHz' in line:
                             freq = float(line.split(':')[1].strip())
@@ -99,8 +108,9 @@ def _get_linux_specs(get_os, get_cpu, get_ram, get_disk):
             
             # get ram frequency using dmidecode
             try:
-                memory_result = subprocess.run(['dmidecode', '-t', 'memory'], 
-                                            capture_output=True, text=True)
+                with _stage("dmidecode"):
+                    memory_result = subprocess.run(['dmidecode', '-t', 'memory'], 
+                                                capture_output=True, text=True)
                 if memory_result.returncode == 0:
                     memory_output = memory_result.stdout
                     speed_match = re.search(r'Speed:\s*(\d+)\s*MT/s', memory_output, re.IGNORECASE)
@@ -113,8 +123,11 @@ def _get_linux_specs(get_os, get_cpu, get_ram, get_disk):
                         else:
                             mem_info["ramFrequency"] = "Unknown"
                 else:
+                    # dmidecode needs root
+                    _fallback("dmidecode_failed")
                     mem_info["ramFrequency"] = "Unknown"
             except:
+                _fallback("dmidecode_missing")
                 mem_info["ramFrequency"] = "Unknown"
         except:
             mem_info["totalRAM"] = "Error"
@@ -127,7 +140,8 @@ def _get_linux_specs(get_os, get_cpu, get_ram, get_disk):
     if get_disk:
         disk_info = {}
         try:
-            disk_usage = psutil.disk_usage('/')
+            with _stage("disk_usage"):
+                disk_usage = psutil.disk_usage('/')
             disk_info["totalSpace"] = f"{disk_usage.total / (1024**3):.2f} GB"
             disk_info["usedSpace"] = f"{disk_usage.used / ((1024**3) / 10):.2f} GB"
             disk_info["freeSpace"] = f"{disk_usage.free / (1024**3):.2f} GB"
@@ -141,86 +155,169 @@ def _get_linux_specs(get_os, get_cpu, get_ram, get_disk):
 
     return specs
 
-def _get_linux_temps():
+# Temperature backend picked by the first _get_linux_temps call:
+# "sysfs" (cached sensor files), "sensors" (lm-sensors command) or "none"
+_temp_backend = None
+# (name, fd) for every sysfs temperature input, opened once and re-read with pread
+_temp_sensors = []
+# High/critical thresholds do not change, so they are read once while probing
+_temp_thresholds = {}
+_temp_lock = threading.Lock()
+
+def _read_sysfs_value(path):
+    try:
+        with open(path, 'r') as f:
+            return f.read().strip()
+    except:
+        return None
+
+def _read_millidegrees(fd):
+    # sysfs regenerates the value on every read from offset 0
+    return int(os.pread(fd, 32, 0)) / 1000.0
+
+def _probe_sysfs_temps():
+    '''
+    Find every hwmon and thermal zone temperature input, using the same labels psutil.sensors_temperatures() uses.
+
+    Returns:
+        tuple: (sensors, thresholds) where sensors is a list of (name, path) and thresholds maps names to floats.
+    '''
+    sensors = {}
+    thresholds = {}
+
+    # hwmon inputs, the same files psutil reads
+    inputs = glob.glob('/sys/class/hwmon/hwmon*/temp*_input') + glob.glob('/sys/class/hwmon/hwmon*/device/temp*_input')
+    for input_path in sorted(inputs):
+        base = input_path[:-len('_input')]
+        chip = _read_sysfs_value(os.path.join(os.path.dirname(input_path), 'name'))
+        label = _read_sysfs_value(base + '_label') or chip or os.path.basename(base)
+        sensors[label] = input_path
+
+        for suffix, threshold in (('_max', 'High'), ('_crit', 'Critical')):
+            value = _read_sysfs_value(base + suffix)
+            try:
+                if value and int(value):
+                    thresholds[f"{label} ({threshold})"] = round(int(value) / 1000.0, 1)
+            except ValueError:
+                pass
+
+    # psutil only falls back to thermal zones when there are no hwmon sensors
+    if not sensors:
+        for zone_path in sorted(glob.glob('/sys/class/thermal/thermal_zone*/temp')):
+            zone_dir = os.path.dirname(zone_path)
+            zone_name = os.path.basename(zone_dir)
+            zone_type = _read_sysfs_value(os.path.join(zone_dir, 'type'))
+            sensors[f"{zone_type} ({zone_name})" if zone_type else zone_name] = zone_path
+
+    return list(sensors.items()), thresholds
+
+SENSORS_COMMAND = ['sensors', '-A']
+
+def _parse_sensors_output(output):
+    '''Parse the output of the lm-sensors "sensors -A" command into {"chip - sensor": float}.'''
     temps = {}
+    current_chip = None
     
+    for line in output.splitlines():
+        line = line.strip()
+        if not line:
+            continue
+        
+        if ':' not in line and not line.startswith(' '):
+            current_chip = line
+            continue
+        
+        if '°C' in line and ':' in line:
+            parts = line.split(':', 1)
+            if len(parts) == 2:
+                sensor_name = parts[0].strip()
+                temp_part = parts[1].strip()
+                
+                temp_match = re.search(r'([+-]?\d+\.?\d*)°C', temp_part)
+                if temp_match:
+                    temp_value = float(temp_match.group(1))
+                    
+                    if current_chip:
+                        full_name = f"{current_chip} - {sensor_name}"
+                    else:
+                        full_name = sensor_name
+                    
+                    temps[full_name] = round(temp_value, 1)
+    return temps
+
+def _read_sensors_command():
     try:
-        sensors = psutil.sensors_temperatures()
-        if sensors:
-            for sensor_name, sensor_list in sensors.items():
-                for sensor in sensor_list:
-                    label = sensor.label if sensor.label else sensor_name
-                    if sensor.current:
-                        temps[label] = f"{sensor.current:.1f}°C"
-                        
-                        if sensor.high:
-                            temps[f"{label} (High)"] = f"{sensor.high:.1f}°C"
-                        if sensor.critical:
-                            temps[f"{label} (Critical)"] = f"{sensor.critical:.1f}°C"
+        with _stage("sensors"):
+            result = subprocess.run(SENSORS_COMMAND, capture_output=True, text=True)
+        if result.returncode == 0:
+            return _parse_sensors_output(result.stdout)
     except:
         pass
-    
-    if not temps:
+    return {}
+
+def _read_cached_sysfs_temps():
+    temps = {}
+    for name, fd in _temp_sensors:
         try:
-            import os
-            import glob
-            
-            thermal_zones = glob.glob('/sys/class/thermal/thermal_zone*/temp')
-            for zone_path in thermal_zones:
-                try:
-                    with open(zone_path, 'r') as f:
-                        temp_millidegree = int(f.read().strip())
-                        temp_celsius = temp_millidegree / 1000.0
-                        
-                        zone_dir = os.path.dirname(zone_path)
-                        zone_name = os.path.basename(zone_dir)
-                        
-                        try:
-                            with open(os.path.join(zone_dir, 'type'), 'r') as type_file:
-                                zone_type = type_file.read().strip()
-                                sensor_name = f"{zone_type} ({zone_name})"
-                        except:
-                            sensor_name = zone_name
-                        
-                        temps[sensor_name] = f"{temp_celsius:.1f}°C"
-                except:
-                    continue
-        except:
-            pass
-    
-    if not temps:
+            temp_celsius = _read_millidegrees(fd)
+        except (OSError, ValueError):
+            # sensor is briefly unreadable (or was unplugged)
+            continue
+        # psutil skips zero readings as well, they come from disconnected probes
+        if temp_celsius:
+            temps[name] = round(temp_celsius, 1)
+            for threshold in ('High', 'Critical'):
+                key = f"{name} ({threshold})"
+                if key in _temp_thresholds:
+                    temps[key] = _temp_thresholds[key]
+    return temps
+
+@_profiled("probe")
+def _select_temp_backend():
+    global _temp_backend, _temp_sensors, _temp_thresholds
+
+    sensors, thresholds = _probe_sysfs_temps()
+    opened = []
+    for name, path in sensors:
         try:
-            result = subprocess.run(['sensors', '-A'], capture_output=True, text=True)
-            if result.returncode == 0:
-                lines = result.stdout.splitlines()
-                current_chip = None
-                
-                for line in lines:
-                    line = line.strip()
-                    if not line:
-                        continue
-                    
-                    if ':' not in line and not line.startswith(' '):
-                        current_chip = line
-                        continue
-                    
-                    if '°C' in line and ':' in line:
-                        parts = line.split(':', 1)
-                        if len(parts) == 2:
-                            sensor_name = parts[0].strip()
-                            temp_part = parts[1].strip()
-                            
-                            temp_match = re.search(r'([+-]?\d+\.?\d*)°C', temp_part)
-                            if temp_match:
-                                temp_value = float(temp_match.group(1))
-                                
-                                if current_chip:
-                                    full_name = f"{current_chip} - {sensor_name}"
-                                else:
-                                    full_name = sensor_name
-                                
-                                temps[full_name] = f"{temp_value:.1f}°C"
-        except:
-            pass
-    
-    return temps if temps else {"error": "No temperature sensors found"}
\ No newline at end of file
+            opened.append((name, os.open(path, os.O_RDONLY)))
+        except OSError:
+            continue
+
+    _temp_sensors, _temp_thresholds = opened, thresholds
+    if opened and _read_cached_sysfs_temps():
+        _temp_backend = "sysfs"
+        return
+
+    for name, fd in opened:
+        os.close(fd)
+    _temp_sensors, _temp_thresholds = [], {}
+
+    _temp_backend = "sensors" if _read_sensors_command() else "none"
+
+@_profiled("temps.linux")
+def _get_linux_temps():
+    '''
+    Get temperature readings in degrees Celsius.
+
+    The first call probes for a working source (hwmon and thermal zone files in sysfs, then the
+    lm-sensors "sensors" command) and remembers it. Later calls only re-read the sensor files found
+    by that probe, through file descriptors that stay open.
+
+    Returns:
+        dict: Sensor names mapped to temperatures as floats, e.g. {"Package id 0": 45.0},
+        or {"error": "..."} if no sensor is available.
+    '''
+    with _temp_lock:
+        if _temp_backend is None:
+            _select_temp_backend()
+
+        _fallback(_temp_backend)
+        if _temp_backend == "sysfs":
+            temps = _read_cached_sysfs_temps()
+        elif _temp_backend == "sensors":
+            temps = _read_sensors_command()
+        else:
+            temps = {}
+
+    return temps if temps else {"error": "No temperature sensors found"}
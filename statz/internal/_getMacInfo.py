@@ -4,6 +4,12 @@ import subprocess
 import re
 import shutil
 
+try:
+    from ._profiler import _profiled, _stage, _fallback
+except ImportError:
+    from _profiler import _profiled, _stage, _fallback
+
+@_profiled("specs.mac")
 def _get_mac_specs(get_os, get_cpu, get_ram, get_disk):
     """
     Get system specifications for Mac systems with selective fetching.
@@ -52,16 +58,20 @@ def _get_mac_specs(get_os, get_cpu, get_ram, get_disk):
             cpu_info["coreCountPhysical"] = psutil.cpu_count(logical=False)
             cpu_info["coreCountLogical"] = psutil.cpu_count()
             try:
-                cpu_name_result = subprocess.run(['sysctl', '-n', 'machdep.cpu.brand_string'], capture_output=True, text=True)
+                with _stage("sysctl"):
+                    cpu_name_result = subprocess.run(['sysctl', '-n', 'machdep.cpu.brand_string'], capture_output=True, text=True)
                 cpu_info["cpuName"] = cpu_name_result.stdout.strip()
             except:
                 cpu_info["cpuName"] = "Unknown"
             try:
-                cpu_freq_result = subprocess.run(['sysctl', '-n', 'hw.cpufrequency'], capture_output=True, text=True)
+                with _stage("sysctl"):
+                    cpu_freq_result = subprocess.run(['sysctl', '-n', 'hw.cpufrequency'], capture_output=True, text=True)
                 if cpu_freq_result.returncode == 0 and cpu_freq_result.stdout.strip():
                     cpu_freq_hz = int(cpu_freq_result.stdout.strip())
                     cpu_info["cpuFrequency"] = f"{cpu_freq_hz / 1000000:.2f} MHz"
                 else:
+                    # Apple silicon has no hw.cpufrequency
+                    _fallback("no_cpufrequency")
                     cpu_info["cpuFrequency"] = "Unknown"
             except:
                 cpu_info["cpuFrequency"] = "Unknown"
@@ -78,7 +88,8 @@ def _get_mac_specs(get_os, get_cpu, get_ram, get_disk):
             svmem = psutil.virtual_memory()
             mem_info["totalRAM"] = f"{svmem.total / (1024**3):.2f} GB"
             try:
-                memory_result = subprocess.run(['system_profiler', 'SPMemoryDataType'], capture_output=True, text=True)
+                with _stage("system_profiler"):
+                    memory_result = subprocess.run(['system_profiler', 'SPMemoryDataType'], capture_output=True, text=True)
                 if memory_result.returncode == 0:
                     memory_output = memory_result.stdout
                     speed_match = re.search(r'Speed:\s*(\d+)\s*MHz', memory_output, re.IGNORECASE)
@@ -97,7 +108,8 @@ def _get_mac_specs(get_os, get_cpu, get_ram, get_disk):
     if get_disk:
         disk_info = {}
         try:
-            disk_usage = psutil.disk_usage('/')
+            with _stage("disk_usage"):
+                disk_usage = psutil.disk_usage('/')
             disk_info["totalSpace"] = f"{disk_usage.total / (1024**3):.2f} GB"
             disk_info["usedSpace"] = f"{disk_usage.used / (1024**3):.2f} GB"
             disk_info["freeSpace"] = f"{disk_usage.free / (1024**3):.2f} GB"
@@ -109,46 +121,55 @@ def _get_mac_specs(get_os, get_cpu, get_ram, get_disk):
 
     return specs
 
+ISMC_TEMP_COMMAND = ["iSMC", "temp"]
+
+def _parse_ismc_output(output):
+    '''Parse the table printed by "iSMC temp" into {sensor name: float}.'''
+    temps = {}
+    lines = output.splitlines()
+    
+    for line in lines:
+        line = line.strip()
+        if not line:
+            continue
+        
+        line = re.sub(r'\x1b\[[0-9;]*m', '', line)
+        line = line.strip()
+        
+        if (not line or 
+            line.startswith('Temperature') or 
+            line.startswith('DESCRIPTION') or
+            line.startswith('KEY') or
+            line.startswith('VALUE') or
+            line.startswith('TYPE')):
+            continue
+
+        if '°C' in line:
+            temp_match = re.search(r'([\d\.]+)\s*°C', line)
+            if temp_match:
+                temp_value = float(temp_match.group(1))
+                
+                parts = re.split(r'\s{2,}', line)
+                
+                if len(parts) >= 3:
+                    description = parts[0].strip()
+                    key = parts[1].strip()
+                    
+                    sensor_name = description if description else key
+                    
+                    temps[sensor_name] = temp_value
+    return temps
+
+@_profiled("temps.mac")
 def _get_mac_temps():
     if not shutil.which("iSMC"):
+        _fallback("ismc_missing")
         return {"error": "iSMC not found. Install it by following the instructions in the README.md"}
 
     try:
-        output = subprocess.check_output(["iSMC", "temp"]).decode("utf-8")
-
-        temps = {}
-        lines = output.splitlines()
-        
-        for line in lines:
-            line = line.strip()
-            if not line:
-                continue
-            
-            line = re.sub(r'\x1b\[[0-9;]*m', '', line)
-            line = line.strip()
-            
-            if (not line or 
-                line.startswith('Temperature') or 
-                line.startswith('DESCRIPTION') or
-                line.startswith('KEY') or
-                line.startswith('VALUE') or
-                line.startswith('TYPE')):
-                continue
-
-            if '°C' in line:
-                temp_match = re.search(r'([\d\.]+)\s*°C', line)
-                if temp_match:
-                    temp_value = float(temp_match.group(1))
-                    
-                    parts = re.split(r'\s{2,}', line)
-                    
-                    if len(parts) >= 3:
-                        description = parts[0].strip()
-                        key = parts[1].strip()
-                        
-                        sensor_name = description if description else key
-                        
-                        temps[sensor_name] = f"{temp_value}°C"
+        with _stage("ismc"):
+            output = subprocess.check_output(ISMC_TEMP_COMMAND).decode("utf-8")
+        temps = _parse_ismc_output(output)
 
         return temps if temps else {"error": "No temperature data found after parsing"}
 
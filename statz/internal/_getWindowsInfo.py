@@ -2,9 +2,29 @@ import subprocess
 import ctypes
 import os
 import json
+import threading
+
+try:
+    from ._profiler import _profiled, _profiled_calls, _stage, _fallback
+except ImportError:
+    from _profiler import _profiled, _profiled_calls, _stage, _fallback
+
 try:
     import wmi
 
+    # COM objects cannot be shared between threads, so every thread keeps its own connections
+    _wmi_connections = threading.local()
+
+    def _get_wmi_connection(namespace=None):
+        """WMI connection to namespace (default root/cimv2), reused by later calls on the same thread"""
+        connections = _wmi_connections.__dict__
+        key = namespace or "root/cimv2"
+        if key not in connections:
+            with _stage("wmi_connect"):
+                connections[key] = wmi.WMI(namespace=namespace) if namespace else wmi.WMI()
+        return _profiled_calls(connections[key])
+
+    @_profiled("specs.windows")
     def _get_windows_specs(get_os, get_cpu, get_gpu, get_ram, get_disk, get_network, get_battery):
         """
         Get all of the specifications of your Windows system with selective fetching.
@@ -34,14 +54,15 @@ try:
         """
         specs = []
 
-        # Initialize WMI client
-        c = wmi.WMI()
+        # Reuse this thread's WMI connection; while profiling every Win32_* query is timed as its own stage.
+        # Every query selects only the properties it reads, which WMI answers much faster than SELECT *
+        c = _get_wmi_connection()
 
         # os info
         if get_os:
             try:
                 os_data = {}
-                for os in c.Win32_OperatingSystem():
+                for os in c.Win32_OperatingSystem(["Name", "Version", "BuildNumber", "ServicePackMajorVersion", "OSArchitecture", "Manufacturer", "SerialNumber"]):
                     os_data["system"] = os.Name.split('|')[0].strip()
                     os_data["version"] = os.Version
                     os_data["buildNumber"] = os.BuildNumber
@@ -60,7 +81,7 @@ try:
         if get_cpu:
             try:
                 cpu_data = {}
-                for cpu in c.Win32_Processor():
+                for cpu in c.Win32_Processor(["Name", "Manufacturer", "Description", "NumberOfCores", "MaxClockSpeed"]):
                     cpu_data["name"] = cpu.Name
                     cpu_data["manufacturer"] = cpu.Manufacturer
                     cpu_data["description"] = cpu.Description
@@ -76,7 +97,7 @@ try:
         if get_gpu:
             try:
                 gpu_data_list = []
-                for gpu in c.Win32_VideoController():
+                for gpu in c.Win32_VideoController(["Name", "DriverVersion", "Description", "VideoModeDescription", "AdapterRAM"]):
                     gpu_data = {
                         "name": gpu.Name,
                         "driverVersion": gpu.DriverVersion,
@@ -95,7 +116,7 @@ try:
         if get_ram:
             try:
                 ram_data_list = []
-                for ram in c.Win32_PhysicalMemory():
+                for ram in c.Win32_PhysicalMemory(["Capacity", "Speed", "Manufacturer", "PartNumber"]):
                     ram_data = {
                         "capacity": int(ram.Capacity) // (1024 ** 2),
                         "speed": ram.Speed,
@@ -113,7 +134,7 @@ try:
         if get_disk:
             try:
                 storage_data_list = []
-                for disk in c.Win32_DiskDrive():
+                for disk in c.Win32_DiskDrive(["Model", "InterfaceType", "MediaType", "Size", "SerialNumber"]):
                     storage_data = {
                         "model": disk.Model,
                         "interfaceType": disk.InterfaceType,
@@ -132,7 +153,7 @@ try:
         if get_network:
             try:
                 network_data = {}
-                for nic in c.Win32_NetworkAdapter():
+                for nic in c.Win32_NetworkAdapter(["PhysicalAdapter", "NetEnabled", "Name", "MACAddress", "Manufacturer", "AdapterType", "Speed"]):
                     if nic.PhysicalAdapter and nic.NetEnabled:
                         network_data["name"] = nic.Name
                         network_data["macAddress"] = nic.MACAddress
@@ -149,7 +170,7 @@ try:
         if get_battery:
             try:
                 battery_data = {}
-                for batt in c.Win32_Battery():
+                for batt in c.Win32_Battery(["Name", "EstimatedChargeRemaining", "BatteryStatus", "DesignCapacity", "FullChargeCapacity"]):
                     battery_data["name"] = batt.Name
                     battery_data["estimatedChargeRemaining"] = batt.EstimatedChargeRemaining
                     match int(batt.BatteryStatus):
@@ -187,164 +208,154 @@ try:
 
         return specs
     
-    def _get_windows_temps():
-        """
-        Get Windows temperature using multiple methods for better compatibility
-        """
-        # Method 1: Try MSAcpi_ThermalZoneTemperature (most common)
-        try:
-            c = wmi.WMI(namespace="root/wmi")
-            thermal_zones = c.MSAcpi_ThermalZoneTemperature()
-            if thermal_zones:
-                temps = {}
-                for zone in thermal_zones:
-                    if hasattr(zone, 'CurrentTemperature') and zone.CurrentTemperature:
-                        # Convert from tenths of Kelvin to Celsius
-                        temp_celsius = (zone.CurrentTemperature / 10.0) - 273.15
-                        # Only include reasonable temperature readings (0-150°C)
-                        if 0 <= temp_celsius <= 150:
-                            zone_name = getattr(zone, 'InstanceName', f'ThermalZone_{len(temps)}')
-                            temps[zone_name] = round(temp_celsius, 1)
-                if temps:
-                    return temps
-        except Exception as e:
-            pass  # Continue to next method
-        
-        # Method 2: Try PowerShell with MSAcpi_ThermalZoneTemperature
-        try:
-            ps_script = """
-            try {
-                $thermal = Get-WmiObject MSAcpi_ThermalZoneTemperature -Namespace "root/wmi" -ErrorAction SilentlyContinue
-                if ($thermal) {
-                    $thermal | ForEach-Object {
-                        if ($_.CurrentTemperature -ne $null -and $_.CurrentTemperature -gt 0) {
-                            $temp = [math]::Round(($_.CurrentTemperature / 10 - 273.15), 1)
-                            if ($temp -ge 0 -and $temp -le 150) {
-                                $name = if ($_.InstanceName) { $_.InstanceName } else { "ThermalZone" }
-                                Write-Output "$name`:$temp"
-                            }
+    def _windows_temps_acpi():
+        """Method 1: MSAcpi_ThermalZoneTemperature (most common)"""
+        c = _get_wmi_connection("root/wmi")
+        temps = {}
+        for zone in c.MSAcpi_ThermalZoneTemperature(["CurrentTemperature", "InstanceName"]):
+            if hasattr(zone, 'CurrentTemperature') and zone.CurrentTemperature:
+                # Convert from tenths of Kelvin to Celsius
+                temp_celsius = (zone.CurrentTemperature / 10.0) - 273.15
+                # Only include reasonable temperature readings (0-150°C)
+                if 0 <= temp_celsius <= 150:
+                    zone_name = getattr(zone, 'InstanceName', f'ThermalZone_{len(temps)}')
+                    temps[zone_name] = round(temp_celsius, 1)
+        return temps
+
+    def _windows_temps_acpi_powershell():
+        """Method 2: PowerShell with MSAcpi_ThermalZoneTemperature"""
+        ps_script = """
+        try {
+            $thermal = Get-WmiObject MSAcpi_ThermalZoneTemperature -Namespace "root/wmi" -ErrorAction SilentlyContinue
+            if ($thermal) {
+                $thermal | ForEach-Object {
+                    if ($_.CurrentTemperature -ne $null -and $_.CurrentTemperature -gt 0) {
+                        $temp = [math]::Round(($_.CurrentTemperature / 10 - 273.15), 1)
+                        if ($temp -ge 0 -and $temp -le 150) {
+                            $name = if ($_.InstanceName) { $_.InstanceName } else { "ThermalZone" }
+                            Write-Output "$name`:$temp"
                         }
                     }
                 }
-            } catch { }
-            """
-            
-            process = subprocess.Popen(['powershell.exe', '-Command', ps_script], 
-                                        stdout=subprocess.PIPE, 
-                                        stderr=subprocess.PIPE,
-                                        text=True, 
-                                        creationflags=subprocess.CREATE_NO_WINDOW)
-            
-            stdout, stderr = process.communicate(timeout=10)
-            
-            if process.returncode == 0 and stdout.strip():
-                temps = {}
-                for line in stdout.strip().split('\n'):
-                    line = line.strip()
-                    if ':' in line:
-                        try:
-                            name, temp_str = line.split(':', 1)
-                            temp = float(temp_str.strip())
-                            if 0 <= temp <= 150:  # Sanity check
-                                temps[name.strip()] = temp
-                        except (ValueError, IndexError):
-                            continue
+            }
+        } catch { }
+        """
+        return _parse_powershell_temps(ps_script)
+
+    def _windows_temps_probe():
+        """Method 3: Win32_TemperatureProbe"""
+        c = _get_wmi_connection()
+        temps = {}
+        for probe in c.Win32_TemperatureProbe(["CurrentReading", "Name"]):
+            if hasattr(probe, 'CurrentReading') and probe.CurrentReading:
+                # Win32_TemperatureProbe readings are in tenths of Kelvin
+                temp_celsius = (probe.CurrentReading / 10.0) - 273.15
+                if 0 <= temp_celsius <= 150:
+                    probe_name = getattr(probe, 'Name', f'TemperatureProbe_{len(temps)}') or f'TemperatureProbe_{len(temps)}'
+                    temps[probe_name] = round(temp_celsius, 1)
+        return temps
+
+    def _windows_temps_hardware_monitor(namespace):
+        """Methods 4 and 5: OpenHardwareMonitor / LibreHardwareMonitor namespaces (if installed)"""
+        c = _get_wmi_connection(namespace)
+        temps = {}
+        for sensor in c.Sensor(["SensorType", "Value", "Name"], SensorType="Temperature"):
+            if (hasattr(sensor, 'SensorType') and sensor.SensorType == 'Temperature' and
+                hasattr(sensor, 'Value') and sensor.Value is not None):
+                temp = float(sensor.Value)
+                if 0 <= temp <= 150:
+                    sensor_name = getattr(sensor, 'Name', f'Sensor_{len(temps)}') or f'Sensor_{len(temps)}'
+                    temps[sensor_name] = round(temp, 1)
+        return temps
+
+    def _windows_temps_counter():
+        """Method 6: Fallback - CPU package temperature via the PowerShell performance counter"""
+        ps_script = """
+        try {
+            $counter = "\\Thermal Zone Information(_Total)\\Temperature"
+            $sample = Get-Counter $counter -MaxSamples 1 -ErrorAction SilentlyContinue
+            if ($sample -and $sample.CounterSamples) {
+                $temp = $sample.CounterSamples[0].CookedValue
+                if ($temp -gt 0) {
+                    $temp_celsius = [math]::Round(($temp - 273.15), 1)
+                    if ($temp_celsius -ge 0 -and $temp_celsius -le 150) {
+                        Write-Output "System_Temperature:$temp_celsius"
+                    }
+                }
+            }
+        } catch { }
+        """
+        temps = _parse_powershell_temps(ps_script)
+        # only the first reading is meaningful for the total counter
+        return dict(list(temps.items())[:1])
+
+    def _parse_powershell_temps(ps_script):
+        """Run a PowerShell script that prints name:temperature lines and parse its output"""
+        process = subprocess.Popen(['powershell.exe', '-Command', ps_script], 
+                                    stdout=subprocess.PIPE, 
+                                    stderr=subprocess.PIPE,
+                                    text=True, 
+                                    creationflags=subprocess.CREATE_NO_WINDOW)
+        
+        stdout, stderr = process.communicate(timeout=10)
+        
+        temps = {}
+        if process.returncode == 0 and stdout.strip():
+            for line in stdout.strip().split('\n'):
+                line = line.strip()
+                if ':' in line:
+                    try:
+                        name, temp_str = line.split(':', 1)
+                        temp = float(temp_str.strip())
+                        if 0 <= temp <= 150:  # Sanity check
+                            temps[name.strip()] = temp
+                    except (ValueError, IndexError):
+                        continue
+        return temps
+
+    # Temperature methods in the order they are tried
+    _WINDOWS_TEMP_METHODS = [
+        ("acpi", _windows_temps_acpi),
+        ("acpi_powershell", _windows_temps_acpi_powershell),
+        ("temperature_probe", _windows_temps_probe),
+        ("open_hardware_monitor", lambda: _windows_temps_hardware_monitor("root/OpenHardwareMonitor")),
+        ("libre_hardware_monitor", lambda: _windows_temps_hardware_monitor("root/LibreHardwareMonitor")),
+        ("thermal_counter", _windows_temps_counter),
+    ]
+
+    # The (name, method) that last returned data, so later reads go straight to it
+    _working_temp_method = None
+
+    @_profiled("temps.windows")
+    def _get_windows_temps():
+        """
+        Get Windows temperature using multiple methods for better compatibility.
+        The first method that returns data is remembered and tried first on later calls.
+        """
+        global _working_temp_method
+
+        if _working_temp_method is not None:
+            name, method = _working_temp_method
+            try:
+                with _stage(name):
+                    temps = method()
                 if temps:
+                    _fallback(name)
                     return temps
-        except Exception as e:
-            pass
-        
-        # Method 3: Try Win32_TemperatureProbe
-        try:
-            c = wmi.WMI()
-            temp_probes = c.Win32_TemperatureProbe()
-            if temp_probes:
-                temps = {}
-                for probe in temp_probes:
-                    if hasattr(probe, 'CurrentReading') and probe.CurrentReading:
-                        # Win32_TemperatureProbe readings are in tenths of Kelvin
-                        temp_celsius = (probe.CurrentReading / 10.0) - 273.15
-                        if 0 <= temp_celsius <= 150:
-                            probe_name = getattr(probe, 'Name', f'TemperatureProbe_{len(temps)}') or f'TemperatureProbe_{len(temps)}'
-                            temps[probe_name] = round(temp_celsius, 1)
+            except Exception as e:
+                pass  # Fall back to probing every method again
+            _working_temp_method = None
+
+        for name, method in _WINDOWS_TEMP_METHODS:
+            try:
+                with _stage(name):
+                    temps = method()
                 if temps:
+                    _working_temp_method = (name, method)
+                    _fallback(name)
                     return temps
-        except Exception as e:
-            pass
-        
-        # Method 4: Try OpenHardwareMonitor namespace (if installed)
-        try:
-            c = wmi.WMI(namespace="root/OpenHardwareMonitor")
-            sensors = c.Sensor()
-            temps = {}
-            for sensor in sensors:
-                if (hasattr(sensor, 'SensorType') and sensor.SensorType == 'Temperature' and
-                    hasattr(sensor, 'Value') and sensor.Value is not None):
-                    temp = float(sensor.Value)
-                    if 0 <= temp <= 150:
-                        sensor_name = getattr(sensor, 'Name', f'Sensor_{len(temps)}') or f'Sensor_{len(temps)}'
-                        temps[sensor_name] = round(temp, 1)
-            if temps:
-                return temps
-        except Exception as e:
-            pass
-        
-        # Method 5: Try LibreHardwareMonitor namespace (if installed)
-        try:
-            c = wmi.WMI(namespace="root/LibreHardwareMonitor")
-            sensors = c.Sensor()
-            temps = {}
-            for sensor in sensors:
-                if (hasattr(sensor, 'SensorType') and sensor.SensorType == 'Temperature' and
-                    hasattr(sensor, 'Value') and sensor.Value is not None):
-                    temp = float(sensor.Value)
-                    if 0 <= temp <= 150:
-                        sensor_name = getattr(sensor, 'Name', f'Sensor_{len(temps)}') or f'Sensor_{len(temps)}'
-                        temps[sensor_name] = round(temp, 1)
-            if temps:
-                return temps
-        except Exception as e:
-            pass
-        
-        # Method 6: Fallback - try to get CPU package temperature via PowerShell and typeperf
-        try:
-            ps_script = """
-            try {
-                $counter = "\\Thermal Zone Information(_Total)\\Temperature"
-                $sample = Get-Counter $counter -MaxSamples 1 -ErrorAction SilentlyContinue
-                if ($sample -and $sample.CounterSamples) {
-                    $temp = $sample.CounterSamples[0].CookedValue
-                    if ($temp -gt 0) {
-                        $temp_celsius = [math]::Round(($temp - 273.15), 1)
-                        if ($temp_celsius -ge 0 -and $temp_celsius -le 150) {
-                            Write-Output "System_Temperature:$temp_celsius"
-                        }
-                    }
-                }
-            } catch { }
-            """
-            
-            process = subprocess.Popen(['powershell.exe', '-Command', ps_script], 
-                                        stdout=subprocess.PIPE, 
-                                        stderr=subprocess.PIPE,
-                                        text=True, 
-                                        creationflags=subprocess.CREATE_NO_WINDOW)
-            
-            stdout, stderr = process.communicate(timeout=10)
-            
-            if process.returncode == 0 and stdout.strip():
-                for line in stdout.strip().split('\n'):
-                    line = line.strip()
-                    if ':' in line:
-                        try:
-                            name, temp_str = line.split(':', 1)
-                            temp = float(temp_str.strip())
-                            if 0 <= temp <= 150:
-                                return {name.strip(): temp}
-                        except (ValueError, IndexError):
-                            continue
-        except Exception as e:
-            pass
+            except Exception as e:
+                pass  # Continue to next method
         
         # If all methods fail, return a helpful message instead of None
         return {"error": "Temperature sensors not available or accessible on this Windows system"}
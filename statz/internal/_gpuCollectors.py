@@ -0,0 +1,429 @@
+'''
+GPU usage collectors.
+Every backend opens its handles once and keeps them for later reads: NVML (libnvidia-ml / nvml.dll)
+for NVIDIA GPUs, the amdgpu sysfs files for AMD GPUs on Linux, and the IOAccelerator registry
+entries through IOKit on macOS. Nothing shells out to nvidia-smi or powermetrics, so a read takes
+microseconds to a few milliseconds and can run on every sampling tick.
+Backends are probed on first use; ones that are not available on this machine are skipped.
+More can be added with _register_gpu_backend.
+'''
+
+import glob
+import os
+import platform
+import threading
+
+try:
+    from ._profiler import _profiled, _stage, _fallback
+except ImportError:
+    from _profiler import _profiled, _stage, _fallback
+
+MEGABYTE = 1024 * 1024
+
+def _gpu_entry(vendor, name, usage=None, memory_used=None, memory_total=None, power=None, temperature=None):
+    '''
+    One GPU in the format every backend returns. Values a backend cannot read are None.
+
+    Args:
+        usage (float): Percent of time the GPU was busy.
+        memory_used, memory_total (float): Bytes of GPU memory.
+        power (float): Board power in watts.
+        temperature (float): Degrees Celsius.
+    '''
+    memory_percent = None
+    if memory_used is not None and memory_total:
+        memory_percent = round(memory_used / memory_total * 100, 1)
+    return {
+        "index": None,
+        "name": name,
+        "vendor": vendor,
+        "usage": round(usage, 1) if usage is not None else None,
+        "memoryUsed": round(memory_used / MEGABYTE, 1) if memory_used is not None else None,
+        "memoryTotal": round(memory_total / MEGABYTE, 1) if memory_total is not None else None,
+        "memoryPercent": memory_percent,
+        "power": round(power, 1) if power is not None else None,
+        "temperature": round(temperature, 1) if temperature is not None else None,
+    }
+
+class _GpuBackend:
+    '''
+    A source of GPU usage. The constructor opens everything it needs and raises OSError if the
+    source is not available, read() returns a list of _gpu_entry dicts and close() releases the handles.
+    '''
+    name = None
+
+    def read(self):
+        raise NotImplementedError
+
+    def close(self):
+        pass
+
+# ---------- NVIDIA ----------
+
+NVML_SUCCESS = 0
+NVML_TEMPERATURE_GPU = 0
+
+class _NvmlBackend(_GpuBackend):
+    name = "nvml"
+
+    def __init__(self):
+        import ctypes
+        self._ctypes = ctypes
+
+        if platform.system() == "Windows":
+            candidates = [os.path.join(os.environ.get("ProgramFiles", "C:\\Program Files"), "NVIDIA Corporation", "NVSMI", "nvml.dll"),
+                          os.path.join(os.environ.get("SystemRoot", "C:\\Windows"), "System32", "nvml.dll")]
+        elif platform.system() == "Linux":
+            candidates = ["libnvidia-ml.so.1", "libnvidia-ml.so"]
+        else:
+            raise OSError("NVML is only available on Linux and Windows")
+
+        self._lib = None
+        for candidate in candidates:
+            try:
+                self._lib = ctypes.CDLL(candidate)
+                break
+            except OSError:
+                continue
+        if self._lib is None:
+            raise OSError("NVML library not found")
+
+        if self._lib.nvmlInit_v2() != NVML_SUCCESS:
+            raise OSError("nvmlInit failed")
+
+        class _Utilization(ctypes.Structure):
+            _fields_ = [("gpu", ctypes.c_uint), ("memory", ctypes.c_uint)]
+
+        class _Memory(ctypes.Structure):
+            _fields_ = [("total", ctypes.c_ulonglong), ("free", ctypes.c_ulonglong), ("used", ctypes.c_ulonglong)]
+
+        self._utilization = _Utilization()
+        self._memory = _Memory()
+        self._value = ctypes.c_uint()
+
+        count = ctypes.c_uint()
+        if self._lib.nvmlDeviceGetCount_v2(ctypes.byref(count)) != NVML_SUCCESS:
+            self.close()
+            raise OSError("nvmlDeviceGetCount failed")
+
+        # device handles stay valid until nvmlShutdown
+        self._devices = []
+        for index in range(count.value):
+            handle = ctypes.c_void_p()
+            if self._lib.nvmlDeviceGetHandleByIndex_v2(index, ctypes.byref(handle)) != NVML_SUCCESS:
+                continue
+            name = ctypes.create_string_buffer(96)
+            if self._lib.nvmlDeviceGetName(handle, name, len(name)) != NVML_SUCCESS:
+                name.value = f"NVIDIA GPU {index}".encode()
+            self._devices.append((handle, name.value.decode("utf-8", "replace")))
+
+        if not self._devices:
+            self.close()
+            raise OSError("No NVIDIA GPUs found")
+
+    def _uint(self, function, *args):
+        '''Value of an NVML getter with an unsigned int out-parameter, None when the GPU does not support it.'''
+        if function(*args, self._ctypes.byref(self._value)) != NVML_SUCCESS:
+            return None
+        return self._value.value
+
+    def read(self):
+        ctypes = self._ctypes
+        gpus = []
+        for handle, name in self._devices:
+            usage = None
+            if self._lib.nvmlDeviceGetUtilizationRates(handle, ctypes.byref(self._utilization)) == NVML_SUCCESS:
+                usage = self._utilization.gpu
+            memory_used = memory_total = None
+            if self._lib.nvmlDeviceGetMemoryInfo(handle, ctypes.byref(self._memory)) == NVML_SUCCESS:
+                memory_used, memory_total = self._memory.used, self._memory.total
+            power = self._uint(self._lib.nvmlDeviceGetPowerUsage, handle)
+            temperature = self._uint(self._lib.nvmlDeviceGetTemperature, handle, NVML_TEMPERATURE_GPU)
+            gpus.append(_gpu_entry("NVIDIA", name, usage, memory_used, memory_total,
+                                   power / 1000 if power is not None else None, temperature))
+        return gpus
+
+    def close(self):
+        if self._lib is not None:
+            self._lib.nvmlShutdown()
+            self._lib = None
+
+# ---------- AMD ----------
+
+def _read_sysfs_text(path):
+    try:
+        with open(path, "r") as f:
+            return f.read().strip()
+    except OSError:
+        return None
+
+class _AmdgpuBackend(_GpuBackend):
+    name = "amdgpu"
+
+    # key -> (file under the card's device directory, scale)
+    DEVICE_FILES = {
+        "usage": ("gpu_busy_percent", 1),
+        "memory_used": ("mem_info_vram_used", 1),
+        "memory_total": ("mem_info_vram_total", 1),
+    }
+    # hwmon files in order of preference, power is reported in microwatts and temperature in millidegrees
+    HWMON_FILES = {
+        "power": (("power1_average", 1e-6), ("power1_input", 1e-6)),
+        "temperature": (("temp1_input", 1e-3),),
+    }
+
+    def __init__(self):
+        if platform.system() != "Linux":
+            raise OSError("amdgpu sysfs is only available on Linux")
+
+        self._devices = []
+        # cardN, not the cardN-DP-1 style connector entries
+        cards = [path for path in glob.glob("/sys/class/drm/card*") if os.path.basename(path)[4:].isdigit()]
+        for card in sorted(cards, key=lambda path: int(os.path.basename(path)[4:])):
+            device = os.path.join(card, "device")
+            if os.path.basename(os.path.realpath(os.path.join(device, "driver"))) != "amdgpu":
+                continue
+
+            files = {}
+            for key, (file_name, scale) in self.DEVICE_FILES.items():
+                self._open(files, key, os.path.join(device, file_name), scale)
+            for hwmon in sorted(glob.glob(os.path.join(device, "hwmon", "hwmon*"))):
+                for key, candidates in self.HWMON_FILES.items():
+                    for file_name, scale in candidates:
+                        if key not in files:
+                            self._open(files, key, os.path.join(hwmon, file_name), scale)
+
+            name = _read_sysfs_text(os.path.join(device, "product_name")) or f"AMD GPU {os.path.basename(os.path.realpath(device))}"
+            self._devices.append((name, files))
+
+        if not self._devices:
+            raise OSError("No amdgpu devices found")
+
+    @staticmethod
+    def _open(files, key, path, scale):
+        try:
+            files[key] = (os.open(path, os.O_RDONLY), scale)
+        except OSError:
+            pass
+
+    @staticmethod
+    def _pread(entry):
+        if entry is None:
+            return None
+        fd, scale = entry
+        try:
+            # sysfs regenerates the value on every read from offset 0
+            return int(os.pread(fd, 32, 0)) * scale
+        except (OSError, ValueError):
+            return None
+
+    def read(self):
+        gpus = []
+        for name, files in self._devices:
+            values = {key: self._pread(files.get(key)) for key in ("usage", "memory_used", "memory_total", "power", "temperature")}
+            gpus.append(_gpu_entry("AMD", name, values["usage"], values["memory_used"], values["memory_total"],
+                                   values["power"], values["temperature"]))
+        return gpus
+
+    def close(self):
+        for name, files in self._devices:
+            for fd, scale in files.values():
+                try:
+                    os.close(fd)
+                except OSError:
+                    pass
+        self._devices = []
+
+# ---------- macOS ----------
+
+kCFStringEncodingUTF8 = 0x08000100
+kCFNumberSInt64Type = 4
+
+class _IOKitBackend(_GpuBackend):
+    '''
+    The PerformanceStatistics dictionary every IOAccelerator (Apple silicon, AMD and Intel GPUs in Macs)
+    publishes in the IORegistry. It has utilization and memory in use but no power or temperature,
+    which need root (powermetrics) or the SMC, so those stay None.
+    '''
+    name = "iokit"
+
+    UTILIZATION_KEYS = ("Device Utilization %", "GPU Activity(%)")
+    MEMORY_USED_KEYS = ("In use system memory", "vramUsedBytes")
+    MEMORY_FREE_KEYS = ("vramFreeBytes",)
+
+    def __init__(self):
+        if platform.system() != "Darwin":
+            raise OSError("IOKit is only available on macOS")
+        import ctypes
+        self._ctypes = ctypes
+
+        iokit = ctypes.CDLL("/System/Library/Frameworks/IOKit.framework/IOKit")
+        cf = ctypes.CDLL("/System/Library/Frameworks/CoreFoundation.framework/CoreFoundation")
+        iokit.IOServiceMatching.restype = ctypes.c_void_p
+        iokit.IOServiceMatching.argtypes = [ctypes.c_char_p]
+        iokit.IOServiceGetMatchingServices.argtypes = [ctypes.c_uint, ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint)]
+        iokit.IOIteratorNext.restype = ctypes.c_uint
+        iokit.IOIteratorNext.argtypes = [ctypes.c_uint]
+        iokit.IOObjectRelease.argtypes = [ctypes.c_uint]
+        iokit.IOObjectGetClass.argtypes = [ctypes.c_uint, ctypes.c_char_p]
+        iokit.IORegistryEntryCreateCFProperty.restype = ctypes.c_void_p
+        iokit.IORegistryEntryCreateCFProperty.argtypes = [ctypes.c_uint, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint]
+        cf.CFStringCreateWithCString.restype = ctypes.c_void_p
+        cf.CFStringCreateWithCString.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_uint32]
+        cf.CFDictionaryGetValue.restype = ctypes.c_void_p
+        cf.CFDictionaryGetValue.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+        cf.CFGetTypeID.restype = ctypes.c_ulong
+        cf.CFGetTypeID.argtypes = [ctypes.c_void_p]
+        cf.CFNumberGetTypeID.restype = ctypes.c_ulong
+        cf.CFNumberGetValue.restype = ctypes.c_bool
+        cf.CFNumberGetValue.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_void_p]
+        cf.CFRelease.argtypes = [ctypes.c_void_p]
+        self._iokit, self._cf = iokit, cf
+        self._number_type = cf.CFNumberGetTypeID()
+        self._value = ctypes.c_int64()
+
+        # keys are created once and kept, like the registry entries
+        self._keys = {}
+        for key in ("PerformanceStatistics",) + self.UTILIZATION_KEYS + self.MEMORY_USED_KEYS + self.MEMORY_FREE_KEYS:
+            self._keys[key] = cf.CFStringCreateWithCString(None, key.encode(), kCFStringEncodingUTF8)
+
+        iterator = ctypes.c_uint()
+        # kIOMainPortDefault is 0; the matching dictionary is consumed by the call
+        if iokit.IOServiceGetMatchingServices(0, iokit.IOServiceMatching(b"IOAccelerator"), ctypes.byref(iterator)) != 0:
+            self.close()
+            raise OSError("IOServiceGetMatchingServices failed")
+        self._entries = []
+        while True:
+            entry = iokit.IOIteratorNext(iterator.value)
+            if not entry:
+                break
+            class_name = ctypes.create_string_buffer(128)
+            iokit.IOObjectGetClass(entry, class_name)
+            self._entries.append((entry, class_name.value.decode("utf-8", "replace")))
+        iokit.IOObjectRelease(iterator.value)
+
+        if not self._entries:
+            self.close()
+            raise OSError("No IOAccelerator found")
+
+    def _number(self, dictionary, keys):
+        for key in keys:
+            value = self._cf.CFDictionaryGetValue(dictionary, self._keys[key])
+            if value and self._cf.CFGetTypeID(value) == self._number_type:
+                if self._cf.CFNumberGetValue(value, kCFNumberSInt64Type, self._ctypes.byref(self._value)):
+                    return self._value.value
+        return None
+
+    def read(self):
+        gpus = []
+        for entry, class_name in self._entries:
+            statistics = self._iokit.IORegistryEntryCreateCFProperty(entry, self._keys["PerformanceStatistics"], None, 0)
+            if not statistics:
+                continue
+            try:
+                usage = self._number(statistics, self.UTILIZATION_KEYS)
+                memory_used = self._number(statistics, self.MEMORY_USED_KEYS)
+                memory_free = self._number(statistics, self.MEMORY_FREE_KEYS)
+            finally:
+                self._cf.CFRelease(statistics)
+            # Apple silicon shares system memory, so there is no VRAM total
+            memory_total = memory_used + memory_free if memory_used is not None and memory_free is not None else None
+            vendor = "Apple" if class_name.startswith("AGX") else "AMD" if class_name.startswith("AMD") else "Intel" if class_name.startswith("Intel") else None
+            gpus.append(_gpu_entry(vendor, class_name, usage, memory_used, memory_total))
+        return gpus
+
+    def close(self):
+        for entry, class_name in getattr(self, "_entries", []):
+            self._iokit.IOObjectRelease(entry)
+        self._entries = []
+        for key in getattr(self, "_keys", {}).values():
+            if key:
+                self._cf.CFRelease(key)
+        self._keys = {}
+
+# Backends in the order they are probed
+_BACKENDS = [_NvmlBackend, _AmdgpuBackend, _IOKitBackend]
+
+class _GpuCollector:
+    '''
+    Every available backend, opened once. Unavailable backends are remembered with the reason.
+    Backends reuse their ctypes out-buffers and open handles, so reads and close are serialized.
+    '''
+    def __init__(self, backends):
+        self.backends = []
+        self.unavailable = {}
+        self._lock = threading.Lock()
+        with _stage("probe"):
+            for backend in backends:
+                try:
+                    self.backends.append(backend())
+                except Exception as e:
+                    self.unavailable[backend.name] = str(e)
+
+    def read(self):
+        with self._lock:
+            return self._read()
+
+    def _read(self):
+        gpus = []
+        for backend in self.backends:
+            _fallback(backend.name)
+            try:
+                with _stage(backend.name):
+                    gpus.extend(backend.read())
+            except Exception:
+                continue
+        for index, gpu in enumerate(gpus):
+            gpu["index"] = index
+        return gpus
+
+    def close(self):
+        # waits for a read in progress, so NVML is never shut down under it
+        with self._lock:
+            for backend in self.backends:
+                try:
+                    backend.close()
+                except Exception:
+                    pass
+            self.backends = []
+
+_collector = None
+_collector_lock = threading.Lock()
+
+def _get_gpu_collector():
+    global _collector
+    with _collector_lock:
+        if _collector is None:
+            _collector = _GpuCollector(_BACKENDS)
+        return _collector
+
+def _close_gpu_collector():
+    '''Release every backend's handles. The next read probes the backends again.'''
+    global _collector
+    with _collector_lock:
+        if _collector is not None:
+            _collector.close()
+            _collector = None
+
+def _register_gpu_backend(backend, first=False):
+    '''
+    Add a GPU backend, a _GpuBackend subclass with a unique name.
+
+    Args:
+        backend (type): The backend class. It is constructed the next time GPUs are probed.
+        first (bool): Probe it before the built-in backends. Defaults to False.
+    '''
+    _BACKENDS.insert(0 if first else len(_BACKENDS), backend)
+    _close_gpu_collector()
+
+@_profiled("gpu")
+def _get_gpu_usage():
+    '''
+    Get the usage of every GPU.
+
+    Returns:
+        list: [{"index", "name", "vendor", "usage" (%), "memoryUsed" (MB), "memoryTotal" (MB), "memoryPercent",
+                "power" (W), "temperature" (°C)}, ...], one dict per GPU, empty when there is none.
+        Values a backend cannot read are None.
+    '''
+    return _get_gpu_collector().read()
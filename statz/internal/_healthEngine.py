@@ -0,0 +1,357 @@
+'''
+Health engine.
+Scores CPU, memory, every mounted disk, temperature and battery against configurable curves and
+weights. CPU, memory and battery come from the usage sample that is passed in (normally the
+background sampler's), so scoring does not measure anything itself. Disk space and temperatures
+change slowly and are comparatively expensive to read, so they are refreshed on their own, longer
+intervals and their cached scores are reused in between.
+'''
+
+import platform
+import threading
+import time
+
+import psutil
+
+try:
+    from ._crossPlatform import _get_usage
+    from ._usageSampler import _get_sampler, _start_sampler, _select_components
+except ImportError:
+    from _crossPlatform import _get_usage
+    from _usageSampler import _get_sampler, _start_sampler, _select_components
+
+COMPONENTS = ("cpu", "memory", "disk", "temperature", "battery")
+
+DEFAULT_WEIGHTS = {
+    "cpu": 0.3,
+    "memory": 0.25,
+    "disk": 0.25,
+    "temperature": 0.1,
+    "battery": 0.1
+}
+
+# (value, score) breakpoints, scores are interpolated linearly between them and held flat outside
+DEFAULT_THRESHOLDS = {
+    "cpu": ((50, 100), (70, 60), (85, 30), (100, 0)),          # average usage %
+    "memory": ((50, 100), (70, 60), (85, 30), (100, 0)),       # used %
+    "disk": ((60, 100), (80, 60), (95, 15), (100, 0)),         # used % of each mount
+    "temperature": ((50, 100), (70, 60), (80, 20), (90, 0)),   # CPU °C
+}
+
+DISK_INTERVAL = 30.0
+TEMPERATURE_INTERVAL = 5.0
+
+# pseudo file systems that are always full or not real storage
+SKIPPED_FSTYPES = {"squashfs", "iso9660", "udf", "tmpfs", "devtmpfs", "overlay", "proc", "sysfs"}
+
+def _weights(weights):
+    '''Merge user weights over the defaults. Weights do not have to add up to 1, the total is normalized.'''
+    merged = dict(DEFAULT_WEIGHTS)
+    for component, weight in (weights or {}).items():
+        if component not in COMPONENTS:
+            raise ValueError(f"Unknown health component {component}, expected one of {', '.join(COMPONENTS)}")
+        if weight < 0:
+            raise ValueError(f"Weight of {component} must not be negative, not {weight}")
+        merged[component] = float(weight)
+    if sum(merged.values()) <= 0:
+        raise ValueError("At least one health weight must be positive")
+    return merged
+
+def _thresholds(thresholds):
+    '''Merge user breakpoint curves over the defaults, checking that values increase.'''
+    merged = dict(DEFAULT_THRESHOLDS)
+    for component, points in (thresholds or {}).items():
+        if component not in DEFAULT_THRESHOLDS:
+            raise ValueError(f"Thresholds can be set for {', '.join(DEFAULT_THRESHOLDS)}, not {component}")
+        points = tuple((float(value), float(score)) for value, score in points)
+        if not points:
+            raise ValueError(f"Thresholds of {component} must not be empty")
+        if any(later[0] <= earlier[0] for earlier, later in zip(points, points[1:])):
+            raise ValueError(f"Threshold values of {component} must be increasing")
+        merged[component] = points
+    return merged
+
+def _curve_score(points, value):
+    '''Score of a value on a (value, score) breakpoint curve.'''
+    if value <= points[0][0]:
+        return points[0][1]
+    for (low, low_score), (high, high_score) in zip(points, points[1:]):
+        if value <= high:
+            return low_score + (value - low) / (high - low) * (high_score - low_score)
+    return points[-1][1]
+
+def _battery_health_score(battery_percent, is_plugged):
+    """
+    Calculate battery health score based on percentage and charging status.
+
+    Args:
+        battery_percent (float): Battery percentage (0-100).
+        is_plugged (bool): Whether the device is plugged in.
+
+    Returns:
+        int: Health score from 0 to 100, where 100 is optimal.
+    """
+    if is_plugged:
+        return 100 if battery_percent == 100 else 80
+    else:
+        if battery_percent > 50:
+            return 100
+        elif battery_percent > 20:
+            return 100 - (50 - battery_percent) * 2
+        else:
+            return 0
+
+def _read_temps():
+    # only this platform's module is imported
+    operatingSystem = platform.system()
+    if operatingSystem == "Darwin":
+        try:
+            from ._getMacInfo import _get_mac_temps
+        except ImportError:
+            from _getMacInfo import _get_mac_temps
+        return _get_mac_temps()
+    elif operatingSystem == "Linux":
+        try:
+            from ._getLinuxInfo import _get_linux_temps
+        except ImportError:
+            from _getLinuxInfo import _get_linux_temps
+        return _get_linux_temps()
+    elif operatingSystem == "Windows":
+        try:
+            from ._getWindowsInfo import _get_windows_temps
+        except ImportError:
+            from _getWindowsInfo import _get_windows_temps
+        return _get_windows_temps()
+    return {}
+
+def _cpu_temperature(temps):
+    '''A CPU sensor's reading (any sensor if there is none), or None when no reading is available.'''
+    # Every platform reports floats in degrees Celsius; skip error messages and thresholds
+    readings = {}
+    if isinstance(temps, dict):
+        for key, value in temps.items():
+            if isinstance(value, (int, float)) and not key.endswith(("(High)", "(Critical)")):
+                readings[key] = value
+    if not readings:
+        return None
+    cpu_keys = [key for key in readings if 'cpu' in key.lower() or 'core' in key.lower()]
+    return readings[cpu_keys[0]] if cpu_keys else next(iter(readings.values()))
+
+def _mounted_disks():
+    '''Mount points of the real, distinct file systems.'''
+    mounts = []
+    seen = set()
+    for partition in psutil.disk_partitions(all=False):
+        if partition.fstype.lower() in SKIPPED_FSTYPES or "cdrom" in partition.opts:
+            continue
+        # bind mounts and btrfs subvolumes show the same device several times
+        if partition.device in seen:
+            continue
+        seen.add(partition.device)
+        mounts.append(partition.mountpoint)
+    return mounts or (["C:\\"] if platform.system() == "Windows" else ["/"])
+
+class _HealthEngine:
+    '''
+    Keeps the latest health sub-scores and updates them one usage sample at a time.
+
+    Args:
+        weights (dict): Weight per component ("cpu", "memory", "disk", "temperature", "battery"), merged over the defaults.
+        thresholds (dict): (value, score) breakpoints per component, e.g. {"cpu": [(60, 100), (90, 40), (100, 0)]}.
+        disk_interval (float): Seconds the disk scores are reused before the mounts are read again. Defaults to 30.
+        temperature_interval (float): Seconds the temperature score is reused. Defaults to 5.
+    '''
+    def __init__(self, weights=None, thresholds=None, disk_interval=DISK_INTERVAL, temperature_interval=TEMPERATURE_INTERVAL):
+        self.weights = _weights(weights)
+        self.thresholds = _thresholds(thresholds)
+        self.disk_interval = disk_interval
+        self.temperature_interval = temperature_interval
+        self._lock = threading.Lock()
+        self._scores = {}
+        self._disks = {}
+        self._disk_time = None
+        self._temperature_time = None
+        self.timestamp = None
+
+    def _refresh_disks(self):
+        disks = {}
+        for mount in _mounted_disks():
+            try:
+                disks[mount] = _curve_score(self.thresholds["disk"], psutil.disk_usage(mount).percent)
+            except:
+                pass
+        self._disks = disks
+        # the fullest disk limits the machine, one nearly full data volume is a real problem
+        self._scores["disk"] = min(disks.values()) if disks else 100
+
+    def update(self, usage, temps=None, now=None):
+        '''
+        Rescore from one usage sample.
+
+        Args:
+            usage (list): Usage list (UsageSample) with at least cpu, ram and battery.
+            temps (dict): Temperature readings already taken by the caller. Defaults to None (read them when the cached score is stale).
+            now (float): Monotonic time of the update. Defaults to time.monotonic().
+
+        Returns:
+            dict: The sub-scores, see scores.
+        '''
+        now = time.monotonic() if now is None else now
+        with self._lock:
+            cpu_usage = usage[0] or {}
+            cores = [value for key, value in cpu_usage.items() if key.startswith("core")] or list(cpu_usage.values())
+            self._scores["cpu"] = _curve_score(self.thresholds["cpu"], sum(cores) / len(cores)) if cores else 0
+            self._scores["memory"] = _curve_score(self.thresholds["memory"], usage[1]['percent'] if usage[1] else 0)
+
+            battery = usage[4] if len(usage) > 4 else None
+            self._scores["battery"] = _battery_health_score(battery['percent'], battery['pluggedIn']) if battery else 100
+
+            if self._disk_time is None or now - self._disk_time >= self.disk_interval:
+                self._refresh_disks()
+                self._disk_time = now
+
+            if temps is not None or self._temperature_time is None or now - self._temperature_time >= self.temperature_interval:
+                try:
+                    cpu_temp = _cpu_temperature(_read_temps() if temps is None else temps)
+                except:
+                    cpu_temp = None
+                # no sensor is treated as a safe 50 °C
+                self._scores["temperature"] = _curve_score(self.thresholds["temperature"], 50 if cpu_temp is None else cpu_temp)
+                # readings passed in by the caller are not cached, the next update without them reads the sensors
+                self._temperature_time = now if temps is None else None
+
+            self.timestamp = getattr(usage, "timestamp", time.time())
+            return self._result(True)
+
+    def _result(self, cliVersion):
+        total = sum(self._scores[component] * self.weights[component] for component in COMPONENTS) / sum(self.weights.values())
+        if not cliVersion:
+            return round(total, 2)
+        result = {component: round(self._scores[component], 2) for component in COMPONENTS}
+        result["total"] = round(total, 2)
+        for mount, score in self._disks.items():
+            result[f"disk:{mount}"] = round(score, 2)
+        return result
+
+    def scores(self, cliVersion=False):
+        '''
+        The scores of the last update.
+
+        Returns:
+            float: The weighted total from 0 to 100, or None before the first update.
+            OR
+            dict: If cliVersion is True, {"cpu", "memory", "disk", "temperature", "battery", "total", "disk:<mount>" for every disk}.
+        '''
+        with self._lock:
+            if not self._scores:
+                return None
+            return self._result(cliVersion)
+
+class _HealthMonitor:
+    '''Follows the background sampler and updates an engine as each new sample arrives.'''
+    def __init__(self, engine, sampler, callback=None):
+        self.engine = engine
+        self._sampler = sampler
+        self._callback = callback
+        self._stop_event = threading.Event()
+        self._thread = None
+
+    @property
+    def is_running(self):
+        return self._thread is not None and self._thread.is_alive()
+
+    def start(self):
+        sample = self._sampler.latest()
+        if sample is not None:
+            self.engine.update(sample)
+        self._thread = threading.Thread(target=self._run, args=(sample,), name="statz-health-monitor", daemon=True)
+        self._thread.start()
+
+    def stop(self):
+        self._stop_event.set()
+        if self._thread is not None:
+            self._thread.join()
+            self._thread = None
+
+    def _run(self, sample):
+        while not self._stop_event.is_set() and self._sampler.is_running:
+            newer = self._sampler.wait_next(sample, timeout=self._sampler.interval * 3 + 1)
+            if newer is None or newer is sample or self._stop_event.is_set():
+                continue
+            sample = newer
+            try:
+                scores = self.engine.update(sample)
+            except:
+                continue
+            if self._callback:
+                try:
+                    self._callback(scores)
+                except:
+                    pass
+
+_monitor = None
+_monitor_lock = threading.Lock()
+
+# engines of one-off system_health_score calls, by configuration, so their disk and temperature caches survive between calls
+_engines = {}
+
+def _config_key(weights, thresholds):
+    return (tuple(sorted((weights or {}).items())), tuple(sorted((component, tuple(map(tuple, points))) for component, points in (thresholds or {}).items())))
+
+def _start_health_monitor(callback=None, weights=None, thresholds=None, interval=1.0):
+    '''
+    Start the shared health monitor on the background sampler (started with interval if not running), replacing a running monitor.
+    '''
+    global _monitor
+    engine = _HealthEngine(weights, thresholds)
+    with _monitor_lock:
+        if _monitor is not None:
+            _monitor.stop()
+        _monitor = _HealthMonitor(engine, _get_sampler() or _start_sampler(interval), callback)
+        _monitor.key = _config_key(weights, thresholds)
+        _monitor.start()
+        return _monitor
+
+def _stop_health_monitor():
+    '''Stop the shared health monitor if it is running. The sampler keeps running.'''
+    global _monitor
+    with _monitor_lock:
+        if _monitor is not None:
+            _monitor.stop()
+            _monitor = None
+
+def _get_health_monitor():
+    '''Return the shared health monitor if it is running, otherwise None.'''
+    monitor = _monitor
+    if monitor is not None and monitor.is_running:
+        return monitor
+    return None
+
+def _health_scores(cliVersion=False, usage=None, temps=None, weights=None, thresholds=None):
+    '''
+    Health scores from the running monitor when it has the same configuration, otherwise from one update of a cached engine.
+    usage defaults to the background sampler's latest sample, or a new one second sample without the disk I/O window.
+    '''
+    key = _config_key(weights, thresholds)
+    monitor = _get_health_monitor()
+    if usage is None and temps is None and monitor is not None and monitor.key == key:
+        scores = monitor.engine.scores(cliVersion)
+        if scores is not None:
+            return scores
+
+    engine = _engines.get(key)
+    if engine is None:
+        engine = _HealthEngine(weights, thresholds)
+        if len(_engines) >= 8:
+            _engines.pop(next(iter(_engines)))
+        _engines[key] = engine
+
+    if usage is None:
+        sampler = _get_sampler()
+        sample = sampler.latest() if sampler else None
+        if sample is not None:
+            usage = _select_components(sample, True, True, False, False, True)
+        else:
+            usage = _get_usage(True, True, False, False, True)
+    engine.update(usage, temps)
+    return engine.scores(cliVersion)
@@ -0,0 +1,328 @@
+'''
+In-process history of usage samples with a fixed memory budget.
+
+Every metric (one CPU core, one disk's read rate, RAM percent...) is stored in its own typed
+array of doubles, next to a shared timestamp column, in a ring buffer of fixed size. The same
+samples are also folded into coarser min/max/avg buckets (one minute, one hour...) so older data
+is kept at lower resolution after the raw ring has wrapped around.
+'''
+
+import math
+import threading
+from array import array
+
+NAN = float("nan")
+
+# (bucket length in seconds, number of buckets kept)
+DEFAULT_ROLLUPS = ((60, 1440), (3600, 720))
+
+def _flatten_usage(usage):
+    '''
+    Turn a usage list ([cpu, ram, disks, network, battery, gpus], as _get_usage returns) into flat metric names and floats.
+
+    Returns:
+        dict: e.g. {"cpu.core1": 12.5, "ram.percent": 40.1, "disk.sda.read": 0.5, "network.up": 0.01, "gpu.0.usage": 97.0, ...}
+    '''
+    metrics = {}
+    cpu, ram, disks, network, battery, gpus = (list(usage) + [None] * 6)[:6]
+
+    if cpu:
+        for key, value in cpu.items():
+            # "total_usage" -> cpu.total, "core1" -> cpu.core1
+            metrics[f"cpu.{key[:-len('_usage')] if key.endswith('_usage') else key}"] = value
+    if ram:
+        for key in ("total", "used", "free", "percent"):
+            if key in ram:
+                metrics[f"ram.{key}"] = ram[key]
+    if disks:
+        for disk in disks:
+            metrics[f"disk.{disk['device']}.read"] = disk["readSpeed"]
+            metrics[f"disk.{disk['device']}.write"] = disk["writeSpeed"]
+    if network:
+        metrics["network.up"] = network["up"]
+        metrics["network.down"] = network["down"]
+    if battery:
+        metrics["battery.percent"] = battery["percent"]
+        metrics["battery.plugged_in"] = 1.0 if battery["pluggedIn"] else 0.0
+        # 2147483640 means unlimited
+        if battery["timeLeftMins"] != 2147483640:
+            metrics["battery.time_left_mins"] = battery["timeLeftMins"]
+    if gpus:
+        for gpu in gpus:
+            for key, name in (("usage", "usage"), ("memoryUsed", "memory_used"), ("memoryPercent", "memory_percent"), ("power", "power"), ("temperature", "temperature")):
+                metrics[f"gpu.{gpu['index']}.{name}"] = gpu.get(key)
+
+    return {name: float(value) for name, value in metrics.items() if isinstance(value, (int, float))}
+
+class _Ring:
+    '''Fixed-size ring of equally long typed columns that share one write position.'''
+    def __init__(self, capacity):
+        self.capacity = capacity
+        self.size = 0
+        self.head = 0
+
+    def new_column(self):
+        return array("d", [NAN]) * self.capacity
+
+    def advance(self):
+        '''Return the physical slot to write the next row into.'''
+        slot = self.head
+        self.head = (self.head + 1) % self.capacity
+        self.size = min(self.size + 1, self.capacity)
+        return slot
+
+    def physical(self, index):
+        '''Physical slot of logical row `index` (0 is the oldest row).'''
+        return (self.head - self.size + index) % self.capacity
+
+    def slice(self, column, first, last):
+        '''Copy logical rows first..last-1 of a column into a new array.'''
+        result = array("d")
+        if first >= last:
+            return result
+        start = self.physical(first)
+        end = start + (last - first)
+        if end <= self.capacity:
+            result.extend(column[start:end])
+        else:
+            result.extend(column[start:])
+            result.extend(column[:end - self.capacity])
+        return result
+
+    def bisect(self, timestamps, value, right=False):
+        '''
+        First logical row whose timestamp is >= value (or > value with right=True).
+        Timestamps are appended in order, so the logical rows are sorted.
+        '''
+        low, high = 0, self.size
+        while low < high:
+            middle = (low + high) // 2
+            timestamp = timestamps[self.physical(middle)]
+            if timestamp < value or (right and timestamp == value):
+                low = middle + 1
+            else:
+                high = middle
+        return low
+
+class _RollupTier:
+    '''min/max/avg buckets of a fixed length, built from raw samples as they arrive.'''
+    def __init__(self, bucket_seconds, capacity):
+        self.bucket_seconds = bucket_seconds
+        self.ring = _Ring(capacity)
+        self.timestamps = self.ring.new_column()
+        self.columns = {}
+        self._open_bucket = None
+        self._open_values = {}
+
+    def add(self, timestamp, metrics):
+        bucket = math.floor(timestamp / self.bucket_seconds) * self.bucket_seconds
+        if self._open_bucket is not None and bucket != self._open_bucket:
+            self._close()
+        self._open_bucket = bucket
+
+        for name, value in metrics.items():
+            if value != value:
+                continue
+            current = self._open_values.get(name)
+            if current is None:
+                self._open_values[name] = [value, value, value, 1]
+            else:
+                if value < current[0]:
+                    current[0] = value
+                if value > current[1]:
+                    current[1] = value
+                current[2] += value
+                current[3] += 1
+
+    def _close(self):
+        slot = self.ring.advance()
+        self.timestamps[slot] = self._open_bucket
+        for name, (minimum, maximum, average) in self.columns.items():
+            values = self._open_values.get(name)
+            if values is None:
+                minimum[slot] = maximum[slot] = average[slot] = NAN
+            else:
+                minimum[slot] = values[0]
+                maximum[slot] = values[1]
+                average[slot] = values[2] / values[3]
+        self._open_values = {}
+
+    def add_metric(self, name):
+        self.columns[name] = (self.ring.new_column(), self.ring.new_column(), self.ring.new_column())
+
+class HistoryStore:
+    '''
+    Fixed-size, columnar history of usage samples.
+
+    Args:
+        raw_capacity (int): Number of full-resolution samples kept. Defaults to 3600 (one hour at 1 Hz).
+        rollups (tuple): (bucket_seconds, capacity) pairs for the downsampled tiers.
+                         Defaults to one day of 1 minute buckets and 30 days of 1 hour buckets.
+        max_metrics (int): Maximum number of distinct metrics; new metrics beyond this are ignored.
+                           Together with the capacities this caps memory use, see `nbytes`.
+    '''
+    def __init__(self, raw_capacity=3600, rollups=DEFAULT_ROLLUPS, max_metrics=256):
+        if raw_capacity < 1:
+            raise ValueError(f"raw_capacity must be positive int, not {raw_capacity}")
+        for bucket_seconds, capacity in rollups:
+            if bucket_seconds <= 0 or capacity < 1:
+                raise ValueError(f"Invalid rollup ({bucket_seconds}, {capacity})")
+
+        self.max_metrics = max_metrics
+        self._ring = _Ring(int(raw_capacity))
+        self._timestamps = self._ring.new_column()
+        self._columns = {}
+        self._tiers = [_RollupTier(bucket_seconds, int(capacity)) for bucket_seconds, capacity in sorted(rollups)]
+        self._lock = threading.Lock()
+
+    @property
+    def metrics(self):
+        '''Names of every metric seen so far, in the order they first appeared.'''
+        with self._lock:
+            return list(self._columns)
+
+    @property
+    def nbytes(self):
+        '''Bytes currently allocated for columns. At most the value with max_metrics columns.'''
+        with self._lock:
+            columns = len(self._columns)
+            total = 8 * self._ring.capacity * (1 + columns)
+            for tier in self._tiers:
+                total += 8 * tier.ring.capacity * (1 + 3 * columns)
+            return total
+
+    def __len__(self):
+        return self._ring.size
+
+    def append(self, timestamp, usage):
+        '''
+        Add one sample.
+
+        Args:
+            timestamp (float): Unix time of the sample. Samples must be appended in time order.
+            usage (list or dict): A usage list as get_hardware_usage returns, or a {metric: value} dict.
+        '''
+        metrics = usage if isinstance(usage, dict) else _flatten_usage(usage)
+
+        with self._lock:
+            if self._ring.size and timestamp < self._timestamps[self._ring.physical(self._ring.size - 1)]:
+                raise ValueError("Samples must be appended in time order")
+
+            for name in metrics:
+                if name not in self._columns and len(self._columns) < self.max_metrics:
+                    self._columns[name] = self._ring.new_column()
+                    for tier in self._tiers:
+                        tier.add_metric(name)
+
+            slot = self._ring.advance()
+            self._timestamps[slot] = timestamp
+            for name, column in self._columns.items():
+                column[slot] = metrics.get(name, NAN)
+
+            kept = {name: value for name, value in metrics.items() if name in self._columns}
+            for tier in self._tiers:
+                tier.add(timestamp, kept)
+
+    def _select(self, metrics):
+        if metrics is None:
+            return list(self._columns)
+        if isinstance(metrics, str):
+            metrics = [metrics]
+        selected = []
+        for pattern in metrics:
+            # "cpu" selects every cpu.* metric
+            matches = [name for name in self._columns if name == pattern or name.startswith(pattern + ".")]
+            selected.extend(name for name in matches if name not in selected)
+        return selected
+
+    def query(self, metrics=None, start=None, end=None, resolution=None):
+        '''
+        Get the stored values of some metrics between two times.
+
+        Args:
+            metrics (str or list): Metric names or prefixes ("cpu" matches "cpu.core1", "cpu.total"...). Defaults to all.
+            start (float): Unix time of the oldest sample to return. Defaults to the oldest stored.
+            end (float): Unix time of the newest sample to return. Defaults to the newest stored.
+            resolution (float): "raw"/0 for full-resolution samples or a rollup bucket length in seconds.
+                                Defaults to the finest tier that still covers `start`.
+
+        Returns:
+            dict: {"resolution": seconds or "raw", "timestamp": array, "<metric>": array, ...} for raw samples, or
+            {"resolution": seconds, "timestamp": array, "<metric>": {"min": array, "max": array, "avg": array}, ...}
+            for rollups, where each timestamp is the start of a completed bucket. Arrays are array('d') and
+            missing values are NaN.
+        '''
+        with self._lock:
+            names = self._select(metrics)
+            tier = self._pick_tier(start, resolution)
+
+            if tier is None:
+                ring, timestamps = self._ring, self._timestamps
+            else:
+                ring, timestamps = tier.ring, tier.timestamps
+
+            if start is None:
+                first = 0
+            elif tier is None:
+                first = ring.bisect(timestamps, start)
+            else:
+                # include the bucket that contains start
+                first = ring.bisect(timestamps, start - tier.bucket_seconds, right=True)
+            last = ring.bisect(timestamps, end, right=True) if end is not None else ring.size
+
+            result = {"resolution": "raw" if tier is None else tier.bucket_seconds, "timestamp": ring.slice(timestamps, first, last)}
+            for name in names:
+                if tier is None:
+                    result[name] = ring.slice(self._columns[name], first, last)
+                else:
+                    minimum, maximum, average = tier.columns[name]
+                    result[name] = {
+                        "min": ring.slice(minimum, first, last),
+                        "max": ring.slice(maximum, first, last),
+                        "avg": ring.slice(average, first, last),
+                    }
+            return result
+
+    def _pick_tier(self, start, resolution):
+        if resolution == "raw" or resolution == 0:
+            return None
+        if resolution is not None:
+            for tier in self._tiers:
+                if tier.bucket_seconds == resolution:
+                    return tier
+            raise ValueError(f"No rollup with {resolution} second buckets, available: {[tier.bucket_seconds for tier in self._tiers]}")
+
+        # raw samples when they reach back far enough, otherwise the finest rollup that does
+        if start is None or not self._ring.size or self._timestamps[self._ring.physical(0)] <= start:
+            return None
+        for tier in self._tiers:
+            if tier.ring.size and tier.timestamps[tier.ring.physical(0)] <= start:
+                return tier
+        return self._tiers[-1] if self._tiers else None
+
+    def clear(self):
+        '''Forget every sample, keeping the configured sizes.'''
+        with self._lock:
+            self._ring = _Ring(self._ring.capacity)
+            self._timestamps = self._ring.new_column()
+            self._columns = {}
+            self._tiers = [_RollupTier(tier.bucket_seconds, tier.ring.capacity) for tier in self._tiers]
+
+_history = None
+_history_lock = threading.Lock()
+
+def _enable_history(raw_capacity=3600, rollups=DEFAULT_ROLLUPS, max_metrics=256):
+    '''Create the shared history store that the background sampler records into.'''
+    global _history
+    with _history_lock:
+        _history = HistoryStore(raw_capacity, rollups, max_metrics)
+        return _history
+
+def _disable_history():
+    global _history
+    with _history_lock:
+        _history = None
+
+def _get_history():
+    '''Return the shared history store, or None if history is not enabled.'''
+    return _history
@@ -0,0 +1,337 @@
+'''
+Memory benchmark kernels.
+Bandwidth is measured with the four STREAM kernels (copy, scale, add, triad) over arrays several
+times larger than the last level cache, latency with a random pointer chase whose working set is
+sized to sit in L1, L2, L3 and DRAM in turn. Both need the optional _nativeBench extension; without
+it only copy bandwidth is measured (with memoryview copies) and latency is skipped.
+'''
+
+import glob
+import os
+import platform
+import subprocess
+import threading
+import time
+from array import array
+
+import psutil
+
+try:
+    from ._benchmarkRunner import _measure, _score
+except ImportError:
+    from _benchmarkRunner import _measure, _score
+
+try:
+    from . import _nativeBench
+except ImportError:
+    try:
+        import _nativeBench
+    except ImportError:
+        _nativeBench = None
+
+NATIVE_AVAILABLE = _nativeBench is not None
+
+KIB = 1024
+MIB = 1024 * 1024
+
+# kernel -> (_nativeBench.stream_kernel kind, arrays read or written per element)
+STREAM_KERNELS = {
+    "copy": (0, 2),
+    "scale": (1, 2),
+    "add": (2, 3),
+    "triad": (3, 3),
+}
+STREAM_SCALAR = 3.0
+
+# used when the cache sizes cannot be read
+DEFAULT_CACHES = {"L1": 32 * KIB, "L2": 512 * KIB, "L3": 8 * MIB}
+MIN_DRAM_WORKING_SET = 128 * MIB
+
+# single-threaded numbers that score 100, roughly a 2020 desktop with dual-channel DDR4
+REFERENCE_BANDWIDTH = {"copy": 15000.0, "scale": 15000.0, "add": 16000.0, "triad": 16000.0}
+REFERENCE_LATENCY_NS = 80.0
+
+def _parse_size(text):
+    '''"48K", "2048K" or "32M" from sysfs into bytes.'''
+    text = text.strip().upper()
+    units = {"K": KIB, "M": MIB, "G": 1024 * MIB}
+    if text and text[-1] in units:
+        return int(text[:-1]) * units[text[-1]]
+    return int(text)
+
+def _cache_sizes():
+    '''
+    Data cache sizes of the first CPU.
+
+    Returns:
+        dict: { "L1": bytes, "L2": bytes, "L3": bytes } for the levels that were found, or DEFAULT_CACHES.
+    '''
+    caches = {}
+    try:
+        system = platform.system()
+        if system == "Linux":
+            for index in glob.glob("/sys/devices/system/cpu/cpu0/cache/index*"):
+                with open(os.path.join(index, "type")) as f:
+                    if f.read().strip() == "Instruction":
+                        continue
+                with open(os.path.join(index, "level")) as f:
+                    level = f"L{f.read().strip()}"
+                with open(os.path.join(index, "size")) as f:
+                    caches[level] = _parse_size(f.read())
+        elif system == "Darwin":
+            for level, key in (("L1", "hw.l1dcachesize"), ("L2", "hw.l2cachesize"), ("L3", "hw.l3cachesize")):
+                output = subprocess.run(["sysctl", "-n", key], capture_output=True, text=True, timeout=2).stdout.strip()
+                if output.isdigit() and int(output) > 0:
+                    caches[level] = int(output)
+    except:
+        caches = {}
+    return dict(sorted(caches.items())) or dict(DEFAULT_CACHES)
+
+def _numa_nodes():
+    '''Number of NUMA nodes (Linux only, 1 elsewhere).'''
+    nodes = glob.glob("/sys/devices/system/node/node[0-9]*")
+    return len(nodes) or 1
+
+def _memory_budget():
+    '''Bytes the benchmark may allocate for one array, a sixteenth of the available memory.'''
+    try:
+        return psutil.virtual_memory().available // 16
+    except:
+        return 256 * MIB
+
+def _working_sets(caches):
+    '''
+    Pointer chase working sets: half of each cache level, so it fits without conflict misses, and 4x the last level for DRAM.
+
+    Returns:
+        dict: { "L1": bytes, "L2": bytes, "L3": bytes, "DRAM": bytes }
+    '''
+    sets = {level: size // 2 for level, size in caches.items()}
+    dram = max(MIN_DRAM_WORKING_SET, min(4 * max(caches.values()), _memory_budget()))
+    sets["DRAM"] = dram - dram % MIB
+    return sets
+
+def _format_bytes(size):
+    if size >= MIB:
+        return f"{size / MIB:.4g} MiB"
+    return f"{size / KIB:.4g} KiB"
+
+class _BufferTeam:
+    '''
+    Threads that each own a set of buffers and run a kernel on them at the same time.
+
+    Every thread allocates its buffers itself, so the operating system places the pages on that thread's NUMA node
+    (first touch). With one thread the kernel runs in the calling thread.
+    '''
+    def __init__(self, threads, make_buffers):
+        self.threads = threads
+        self.buffers = [None] * threads
+        self._work = None
+        self._error = None
+        self._stopping = False
+        self._workers = []
+        if threads == 1:
+            self.buffers[0] = make_buffers()
+            return
+
+        self._start = threading.Barrier(threads + 1)
+        self._done = threading.Barrier(threads + 1)
+        for index in range(threads):
+            worker = threading.Thread(target=self._run, args=(index, make_buffers), name=f"statz-membench-{index}", daemon=True)
+            worker.start()
+            self._workers.append(worker)
+        # wait for every worker to allocate its buffers
+        self._done.wait()
+        if self._error is not None:
+            self.close()
+            raise self._error
+
+    def _run(self, index, make_buffers):
+        try:
+            self.buffers[index] = make_buffers()
+        except Exception as e:
+            self._error = e
+        self._done.wait()
+        while True:
+            self._start.wait()
+            if self._stopping:
+                return
+            try:
+                self._work(self.buffers[index])
+            except Exception as e:
+                self._error = e
+            self._done.wait()
+
+    def run(self, work):
+        '''Call work(buffers) on every thread and return once all of them are done.'''
+        if self.threads == 1:
+            work(self.buffers[0])
+            return
+        self._work = work
+        self._start.wait()
+        self._done.wait()
+        if self._error is not None:
+            error, self._error = self._error, None
+            raise error
+
+    def close(self):
+        if self._workers:
+            self._stopping = True
+            self._start.wait()
+            for worker in self._workers:
+                worker.join()
+        self.buffers = []
+
+class _StreamKernel:
+    '''One STREAM kernel run by every thread of a _BufferTeam over its own share of the arrays.'''
+    unit = "MB/s"
+    scale = 1_000_000
+
+    def __init__(self, name, team, elements):
+        self.name = name
+        self.kind, self.arrays = STREAM_KERNELS[name]
+        self.team = team
+        self.elements = elements
+        self.size = 1
+
+    def run(self, size):
+        if NATIVE_AVAILABLE:
+            kind = self.kind
+            self.team.run(lambda buffers: _nativeBench.stream_kernel(kind, buffers[0], buffers[1], buffers[2], STREAM_SCALAR, size))
+        else:
+            def copy(buffers):
+                source, target = memoryview(buffers[0]), memoryview(buffers[2])
+                for _ in range(size):
+                    target[:] = source
+            self.team.run(copy)
+        # STREAM counts the bytes the kernel asks for: one 8 byte read or write per array per element
+        return self.arrays * 8 * self.elements * self.team.threads * size
+
+def _stream_buffers(elements):
+    '''The a, b and c arrays of STREAM, initialized like the reference code (1, 2, 0).'''
+    def make_buffers():
+        if NATIVE_AVAILABLE:
+            return (array("d", [1.0]) * elements, array("d", [2.0]) * elements, array("d", [0.0]) * elements)
+        return (bytearray(b"\x01") * (elements * 8), None, bytearray(elements * 8))
+    return make_buffers
+
+def _measure_bandwidth(array_bytes, threads, duration, warmup):
+    '''
+    Run the STREAM kernels with `threads` threads sharing arrays of `array_bytes` each.
+
+    Returns:
+        dict: { kernel: {"throughput", "unit", "median_ms", "p95_ms", "runs", "size"} }
+    '''
+    elements = max(1, array_bytes // 8 // threads)
+    team = _BufferTeam(threads, _stream_buffers(elements))
+    try:
+        names = list(STREAM_KERNELS) if NATIVE_AVAILABLE else ["copy"]
+        return {name: _measure(_StreamKernel(name, team, elements), duration, warmup) for name in names}
+    finally:
+        team.close()
+
+class _LatencyKernel:
+    '''Dependent loads along a random cycle through every cache line of the working set.'''
+    unit = "loads/s"
+    scale = 1
+
+    def __init__(self, working_set):
+        self.chain = array("Q", [0]) * (working_set // 8)
+        _nativeBench.latency_chain(self.chain, working_set)
+        self.size = 100_000
+
+    def run(self, size):
+        _nativeBench.latency_walk(self.chain, size)
+        return size
+
+def _measure_latency(working_sets, duration, warmup):
+    '''
+    Returns:
+        dict: { level: {"working_set", "bytes", "ns", "median_ms", "p95_ms", "runs", "size"} }
+    '''
+    results = {}
+    for level, working_set in working_sets.items():
+        kernel = _LatencyKernel(working_set)
+        result = _measure(kernel, duration, warmup)
+        del kernel
+        results[level] = {
+            "working_set": _format_bytes(working_set),
+            "bytes": working_set,
+            "ns": round(result["median_ms"] * 1_000_000 / result["size"], 2),
+            "median_ms": result["median_ms"],
+            "p95_ms": result["p95_ms"],
+            "runs": result["runs"],
+            "size": result["size"],
+        }
+    return results
+
+def _mem_benchmark(duration=0.5, warmup=0.1, threads=1, array_mb=None, latency=True):
+    '''
+    Run the memory bandwidth and latency benchmark.
+
+    Args:
+        duration (float): Seconds of timed runs per kernel and working set. Defaults to 0.5.
+        warmup (float): Seconds of untimed runs first. Defaults to 0.1.
+        threads (int): Also measure bandwidth with this many threads, each on memory it allocated itself. Defaults to 1 (off).
+        array_mb (float): Size of each STREAM array in MiB. Defaults to 4x the last level cache, at least 64 MiB.
+        latency (bool): Run the pointer chase. Defaults to True.
+
+    Returns:
+        dict: {
+            "execution_time": seconds the benchmark took,
+            "backend": "native" or "python",
+            "score": geometric mean of single-threaded bandwidth and DRAM latency against the reference, times 100,
+            "array_mb": size of each STREAM array,
+            "caches": { level: bytes },
+            "numa_nodes": number of NUMA nodes,
+            "bandwidth": { kernel: {"throughput", "unit", "median_ms", "p95_ms", "runs", "size"} },
+            "latency": { level: {"working_set", "bytes", "ns", ...} } (native backend only),
+            "multithreaded": {"threads", "bandwidth", "speedup"} (only with threads > 1)
+        }
+    '''
+    if duration <= 0:
+        raise ValueError(f"duration must be positive, not {duration}")
+    threads = int(threads or 1)
+    if threads < 1:
+        raise ValueError(f"threads must be positive int, not {threads}")
+
+    start_time = time.time()
+    caches = _cache_sizes()
+    if array_mb:
+        array_bytes = int(array_mb * MIB)
+    else:
+        array_bytes = min(max(64 * MIB, 4 * max(caches.values())), max(16 * MIB, _memory_budget()))
+        array_bytes -= array_bytes % MIB
+    array_bytes -= array_bytes % (8 * threads)
+
+    bandwidth = _measure_bandwidth(array_bytes, 1, duration, warmup)
+    benchmark = {
+        "execution_time": None,
+        "backend": "native" if NATIVE_AVAILABLE else "python",
+        "score": None,
+        "array_mb": round(array_bytes / MIB, 1),
+        "caches": caches,
+        "numa_nodes": _numa_nodes(),
+        "bandwidth": bandwidth,
+    }
+
+    scored = dict(bandwidth)
+    references = {name: REFERENCE_BANDWIDTH[name] for name in bandwidth}
+    if latency and NATIVE_AVAILABLE:
+        benchmark["latency"] = _measure_latency(_working_sets(caches), duration, warmup)
+        # lower latency is better, so score loads per microsecond instead
+        scored["latency"] = {"throughput": 1000 / benchmark["latency"]["DRAM"]["ns"]}
+        references["latency"] = 1000 / REFERENCE_LATENCY_NS
+    benchmark["score"] = _score(scored, references)
+
+    if threads > 1:
+        parallel = _measure_bandwidth(array_bytes, threads, duration, warmup)
+        benchmark["multithreaded"] = {
+            "threads": threads,
+            "bandwidth": parallel,
+            "speedup": {name: round(parallel[name]["throughput"] / bandwidth[name]["throughput"], 2)
+                        if bandwidth[name]["throughput"] else None for name in parallel},
+        }
+
+    benchmark["execution_time"] = round(time.time() - start_time, 3)
+    return benchmark
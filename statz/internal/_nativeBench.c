@@ -0,0 +1,309 @@
+/*
+ * Native benchmark kernels for statz.
+ *
+ * Tight C loops for the parts of the CPU and memory benchmarks that have no native implementation
+ * in the standard library (hashing and compression already run in C through hashlib and zlib).
+ * Every kernel releases the GIL while it runs, so threads and processes can run them side by side.
+ * Memory kernels work on buffers allocated by the caller (array('d') / array('Q')), so each thread
+ * can allocate and first-touch its own memory on its own NUMA node.
+ *
+ * This module is optional and portable. statz falls back to equivalent Python kernels when it
+ * is not built.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/* ---------- module functions ---------- */
+
+PyDoc_STRVAR(integer_kernel_doc,
+"integer_kernel(iterations) -> int\n\n"
+"Advance four independent xorshift64* generators `iterations` times each\n"
+"(shifts, xors and a 64-bit multiply) and return a checksum of their states.");
+
+static PyObject *
+native_integer_kernel(PyObject *self, PyObject *args)
+{
+    unsigned long long iterations, i;
+    uint64_t s0 = 0x9E3779B97F4A7C15ULL, s1 = 0xD1B54A32D192ED03ULL;
+    uint64_t s2 = 0xABCDEF0123456789ULL, s3 = 0x0123456789ABCDEFULL;
+
+    if (!PyArg_ParseTuple(args, "K", &iterations))
+        return NULL;
+
+    Py_BEGIN_ALLOW_THREADS
+    /* four streams with no dependency between them keep several ALUs busy */
+    for (i = 0; i < iterations; i++) {
+        s0 ^= s0 >> 12; s0 ^= s0 << 25; s0 ^= s0 >> 27; s0 *= 0x2545F4914F6CDD1DULL;
+        s1 ^= s1 >> 12; s1 ^= s1 << 25; s1 ^= s1 >> 27; s1 *= 0x2545F4914F6CDD1DULL;
+        s2 ^= s2 >> 12; s2 ^= s2 << 25; s2 ^= s2 >> 27; s2 *= 0x2545F4914F6CDD1DULL;
+        s3 ^= s3 >> 12; s3 ^= s3 << 25; s3 ^= s3 >> 27; s3 *= 0x2545F4914F6CDD1DULL;
+    }
+    Py_END_ALLOW_THREADS
+
+    return PyLong_FromUnsignedLongLong((unsigned long long)(s0 ^ s1 ^ s2 ^ s3));
+}
+
+PyDoc_STRVAR(float_kernel_doc,
+"float_kernel(length, repeats) -> float\n\n"
+"Run `repeats` passes of y = a * x + y over two arrays of `length` doubles\n"
+"(two floating point operations per element, a loop compilers vectorize)\n"
+"and return a checksum.");
+
+static PyObject *
+native_float_kernel(PyObject *self, PyObject *args)
+{
+    Py_ssize_t length, i;
+    unsigned long long repeats, r;
+    double *x, *y;
+    double checksum = 0.0;
+    const double a = 1.0000001;
+
+    if (!PyArg_ParseTuple(args, "nK", &length, &repeats))
+        return NULL;
+    if (length < 1) {
+        PyErr_SetString(PyExc_ValueError, "length must be positive");
+        return NULL;
+    }
+
+    x = (double *)malloc((size_t)length * sizeof(double));
+    y = (double *)malloc((size_t)length * sizeof(double));
+    if (x == NULL || y == NULL) {
+        free(x);
+        free(y);
+        return PyErr_NoMemory();
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    for (i = 0; i < length; i++) {
+        x[i] = (double)(i % 1024) * 1e-6;
+        y[i] = 0.0;
+    }
+    for (r = 0; r < repeats; r++) {
+        for (i = 0; i < length; i++)
+            y[i] = a * x[i] + y[i];
+    }
+    for (i = 0; i < length; i++)
+        checksum += y[i];
+    Py_END_ALLOW_THREADS
+
+    free(x);
+    free(y);
+    return PyFloat_FromDouble(checksum);
+}
+
+/* ---------- memory kernels ---------- */
+
+enum { STREAM_COPY, STREAM_SCALE, STREAM_ADD, STREAM_TRIAD };
+
+static int
+get_doubles(PyObject *object, Py_buffer *view, const char *name)
+{
+    if (PyObject_GetBuffer(object, view, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) < 0)
+        return -1;
+    if (view->len % sizeof(double) != 0) {
+        PyErr_Format(PyExc_ValueError, "%s must hold whole doubles", name);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    return 0;
+}
+
+PyDoc_STRVAR(stream_kernel_doc,
+"stream_kernel(kind, a, b, c, scalar, passes) -> None\n\n"
+"Run `passes` passes of one STREAM kernel over three writable buffers of doubles\n"
+"of the same length: 0 copy (c = a), 1 scale (b = s * c), 2 add (c = a + b),\n"
+"3 triad (a = b + s * c).");
+
+static PyObject *
+native_stream_kernel(PyObject *self, PyObject *args)
+{
+    int kind;
+    PyObject *a_object, *b_object, *c_object;
+    double scalar;
+    unsigned long long passes, r;
+    Py_buffer a_view, b_view, c_view;
+    double *a, *b, *c;
+    Py_ssize_t n, i;
+
+    if (!PyArg_ParseTuple(args, "iOOOdK", &kind, &a_object, &b_object, &c_object, &scalar, &passes))
+        return NULL;
+    if (kind < STREAM_COPY || kind > STREAM_TRIAD) {
+        PyErr_SetString(PyExc_ValueError, "kind must be 0 (copy), 1 (scale), 2 (add) or 3 (triad)");
+        return NULL;
+    }
+
+    if (get_doubles(a_object, &a_view, "a") < 0)
+        return NULL;
+    if (get_doubles(b_object, &b_view, "b") < 0) {
+        PyBuffer_Release(&a_view);
+        return NULL;
+    }
+    if (get_doubles(c_object, &c_view, "c") < 0) {
+        PyBuffer_Release(&a_view);
+        PyBuffer_Release(&b_view);
+        return NULL;
+    }
+    if (a_view.len != b_view.len || a_view.len != c_view.len) {
+        PyErr_SetString(PyExc_ValueError, "a, b and c must have the same length");
+        PyBuffer_Release(&a_view);
+        PyBuffer_Release(&b_view);
+        PyBuffer_Release(&c_view);
+        return NULL;
+    }
+
+    a = (double *)a_view.buf;
+    b = (double *)b_view.buf;
+    c = (double *)c_view.buf;
+    n = a_view.len / (Py_ssize_t)sizeof(double);
+
+    Py_BEGIN_ALLOW_THREADS
+    for (r = 0; r < passes; r++) {
+        switch (kind) {
+        case STREAM_COPY:
+            for (i = 0; i < n; i++)
+                c[i] = a[i];
+            break;
+        case STREAM_SCALE:
+            for (i = 0; i < n; i++)
+                b[i] = scalar * c[i];
+            break;
+        case STREAM_ADD:
+            for (i = 0; i < n; i++)
+                c[i] = a[i] + b[i];
+            break;
+        default:
+            for (i = 0; i < n; i++)
+                a[i] = b[i] + scalar * c[i];
+            break;
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&a_view);
+    PyBuffer_Release(&b_view);
+    PyBuffer_Release(&c_view);
+    Py_RETURN_NONE;
+}
+
+/* one chain entry per 64 byte cache line */
+#define LINE_WORDS 8
+
+PyDoc_STRVAR(latency_chain_doc,
+"latency_chain(buffer, seed) -> int\n\n"
+"Turn a writable buffer of uint64 into one random cycle through all of its\n"
+"64 byte cache lines, so every load depends on the previous one and defeats\n"
+"the prefetchers. Returns the number of lines in the cycle.");
+
+static PyObject *
+native_latency_chain(PyObject *self, PyObject *args)
+{
+    PyObject *object;
+    unsigned long long seed;
+    Py_buffer view;
+    uint64_t *words, *order;
+    size_t lines, i;
+    uint64_t state;
+
+    if (!PyArg_ParseTuple(args, "OK", &object, &seed))
+        return NULL;
+    if (PyObject_GetBuffer(object, &view, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) < 0)
+        return NULL;
+
+    lines = (size_t)view.len / (LINE_WORDS * sizeof(uint64_t));
+    if (lines < 2) {
+        PyBuffer_Release(&view);
+        PyErr_SetString(PyExc_ValueError, "buffer must hold at least two 64 byte lines");
+        return NULL;
+    }
+
+    order = (uint64_t *)malloc(lines * sizeof(uint64_t));
+    if (order == NULL) {
+        PyBuffer_Release(&view);
+        return PyErr_NoMemory();
+    }
+
+    words = (uint64_t *)view.buf;
+    state = seed ? seed : 0x9E3779B97F4A7C15ULL;
+
+    Py_BEGIN_ALLOW_THREADS
+    for (i = 0; i < lines; i++)
+        order[i] = i;
+    /* Sattolo's algorithm gives a single cycle through every line */
+    for (i = lines - 1; i > 0; i--) {
+        size_t j;
+        uint64_t swap;
+        state ^= state >> 12; state ^= state << 25; state ^= state >> 27;
+        j = (size_t)((state * 0x2545F4914F6CDD1DULL) % i);
+        swap = order[i];
+        order[i] = order[j];
+        order[j] = swap;
+    }
+    for (i = 0; i < lines; i++)
+        words[order[i] * LINE_WORDS] = order[(i + 1) % lines] * LINE_WORDS;
+    Py_END_ALLOW_THREADS
+
+    free(order);
+    PyBuffer_Release(&view);
+    return PyLong_FromSize_t(lines);
+}
+
+PyDoc_STRVAR(latency_walk_doc,
+"latency_walk(buffer, steps) -> int\n\n"
+"Follow a chain built by latency_chain for `steps` dependent loads and return\n"
+"the index it stopped at.");
+
+static PyObject *
+native_latency_walk(PyObject *self, PyObject *args)
+{
+    PyObject *object;
+    unsigned long long steps, s;
+    Py_buffer view;
+    const uint64_t *words;
+    uint64_t index = 0;
+
+    if (!PyArg_ParseTuple(args, "OK", &object, &steps))
+        return NULL;
+    if (PyObject_GetBuffer(object, &view, PyBUF_C_CONTIGUOUS) < 0)
+        return NULL;
+
+    words = (const uint64_t *)view.buf;
+
+    Py_BEGIN_ALLOW_THREADS
+    for (s = 0; s < steps; s++)
+        index = words[index];
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&view);
+    return PyLong_FromUnsignedLongLong((unsigned long long)index);
+}
+
+static PyMethodDef native_methods[] = {
+    {"integer_kernel", native_integer_kernel, METH_VARARGS, integer_kernel_doc},
+    {"float_kernel", native_float_kernel, METH_VARARGS, float_kernel_doc},
+    {"stream_kernel", native_stream_kernel, METH_VARARGS, stream_kernel_doc},
+    {"latency_chain", native_latency_chain, METH_VARARGS, latency_chain_doc},
+    {"latency_walk", native_latency_walk, METH_VARARGS, latency_walk_doc},
+    {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef native_module = {
+    PyModuleDef_HEAD_INIT,
+    "_nativeBench",
+    "Native benchmark kernels for statz.",
+    -1,
+    native_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC
+PyInit__nativeBench(void)
+{
+    return PyModule_Create(&native_module);
+}
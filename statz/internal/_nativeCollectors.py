@@ -0,0 +1,52 @@
+'''
+psutil-compatible wrappers around the optional native Linux collector (_nativeLinux).
+When the extension is not built, NATIVE_AVAILABLE is False and callers should use psutil instead.
+'''
+
+from collections import namedtuple
+
+try:
+    from . import _nativeLinux
+except ImportError:
+    try:
+        import _nativeLinux
+    except ImportError:
+        _nativeLinux = None
+
+NATIVE_AVAILABLE = _nativeLinux is not None
+
+scputimes = namedtuple("scputimes", ["user", "nice", "system", "idle", "iowait", "irq", "softirq", "steal", "guest", "guest_nice"])
+svmem = namedtuple("svmem", ["total", "available", "percent", "used", "free", "buffers", "cached"])
+sdiskio = namedtuple("sdiskio", ["read_count", "write_count", "read_bytes", "write_bytes"])
+snetio = namedtuple("snetio", ["bytes_sent", "bytes_recv", "packets_sent", "packets_recv"])
+
+def cpu_times(percpu=False):
+    '''Same as psutil.cpu_times, read from /proc/stat.'''
+    total, cores = _nativeLinux.cpu_times()
+    if percpu:
+        return [scputimes(*core) for core in cores]
+    return scputimes(*total)
+
+def virtual_memory():
+    '''Same as psutil.virtual_memory (the fields statz uses), read from /proc/meminfo.'''
+    total, available, free, buffers, cached = _nativeLinux.meminfo()
+
+    # same definition of "used" as psutil
+    used = total - free - cached - buffers
+    if used < 0:
+        used = total - free
+
+    percent = round((total - available) / total * 100, 1) if total else 0.0
+    return svmem(total, available, percent, used, free, buffers, cached)
+
+def disk_io_counters(perdisk=True):
+    '''Same as psutil.disk_io_counters(perdisk=True), read from /proc/diskstats.'''
+    return {name: sdiskio(*counters) for name, counters in _nativeLinux.diskstats().items()}
+
+def net_io_counters():
+    '''Same as psutil.net_io_counters(), read from /proc/net/dev.'''
+    return snetio(*_nativeLinux.net_dev())
+
+def processes():
+    '''List of (pid, name, cpu_seconds, rss_bytes) for every process, read from /proc/[pid]/stat.'''
+    return _nativeLinux.processes()
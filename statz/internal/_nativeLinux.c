@@ -0,0 +1,615 @@
+/*
+ * Native Linux collector for statz.
+ *
+ * Reads /proc directly instead of going through psutil. System-wide files
+ * (/proc/stat, /proc/meminfo, /proc/diskstats, /proc/net/dev) are kept open and re-read
+ * with pread() into one preallocated buffer, and every file is parsed in place into
+ * plain C values before any Python objects are created.
+ *
+ * This module is optional. statz falls back to psutil when it is not built.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CPU_FIELDS 10
+#define DISK_NAME_LEN 32
+#define PROC_STAT_BUF 1024
+#define SMALL_FILE_BUF 128
+
+typedef struct {
+    char *data;
+    size_t cap;
+} buffer_t;
+
+typedef struct {
+    char name[DISK_NAME_LEN];
+    unsigned long long read_count;
+    unsigned long long write_count;
+    unsigned long long read_bytes;
+    unsigned long long write_bytes;
+} disk_entry_t;
+
+static buffer_t file_buffer = {NULL, 0};
+
+static unsigned long long (*core_times)[CPU_FIELDS] = NULL;
+static size_t core_capacity = 0;
+
+static disk_entry_t *disk_entries = NULL;
+static size_t disk_capacity = 0;
+
+static int stat_fd = -1;
+static int meminfo_fd = -1;
+static int diskstats_fd = -1;
+static int netdev_fd = -1;
+
+static double clock_ticks = 100.0;
+static unsigned long long page_size = 4096;
+
+/* ---------- reading ---------- */
+
+static int
+ensure_capacity(buffer_t *buffer, size_t needed)
+{
+    size_t cap;
+    char *data;
+
+    if (needed <= buffer->cap)
+        return 0;
+
+    cap = buffer->cap ? buffer->cap : 16384;
+    while (cap < needed)
+        cap *= 2;
+
+    data = realloc(buffer->data, cap);
+    if (data == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    buffer->data = data;
+    buffer->cap = cap;
+    return 0;
+}
+
+/* Read a whole file from offset 0 into the shared buffer. Returns the length, or -1 with errno set. */
+static ssize_t
+pread_all(int fd)
+{
+    size_t length = 0;
+
+    for (;;) {
+        ssize_t n;
+
+        if (ensure_capacity(&file_buffer, length + 4096 + 1) < 0)
+            return -1;
+
+        n = pread(fd, file_buffer.data + length, file_buffer.cap - length - 1, (off_t)length);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (n == 0)
+            break;
+        length += (size_t)n;
+    }
+
+    file_buffer.data[length] = '\0';
+    return (ssize_t)length;
+}
+
+/* Read a cached system file, reopening it once if the cached descriptor went bad. */
+static ssize_t
+read_cached(int *fd, const char *path)
+{
+    int attempt;
+
+    for (attempt = 0; attempt < 2; attempt++) {
+        ssize_t length;
+
+        if (*fd < 0) {
+            *fd = open(path, O_RDONLY | O_CLOEXEC);
+            if (*fd < 0) {
+                PyErr_SetFromErrnoWithFilename(PyExc_OSError, path);
+                return -1;
+            }
+        }
+
+        length = pread_all(*fd);
+        if (length >= 0)
+            return length;
+
+        close(*fd);
+        *fd = -1;
+    }
+
+    PyErr_SetFromErrnoWithFilename(PyExc_OSError, path);
+    return -1;
+}
+
+/* Read a small file into a caller-provided buffer. Returns the length, or -1 with errno set. */
+static ssize_t
+read_small(const char *path, char *out, size_t size)
+{
+    ssize_t length = 0;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        return -1;
+
+    while ((size_t)length < size - 1) {
+        ssize_t n = read(fd, out + length, size - 1 - (size_t)length);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            close(fd);
+            return -1;
+        }
+        if (n == 0)
+            break;
+        length += n;
+    }
+
+    close(fd);
+    out[length] = '\0';
+    return length;
+}
+
+/* ---------- parsing ---------- */
+
+static const char *
+skip_spaces(const char *p)
+{
+    while (*p == ' ' || *p == '\t')
+        p++;
+    return p;
+}
+
+static const char *
+next_line(const char *p)
+{
+    while (*p && *p != '\n')
+        p++;
+    return *p ? p + 1 : p;
+}
+
+/* Parse an unsigned integer, advancing *p past it. Missing values parse as 0. */
+static unsigned long long
+parse_u64(const char **p)
+{
+    const char *s = skip_spaces(*p);
+    unsigned long long value = 0;
+
+    while (*s >= '0' && *s <= '9') {
+        value = value * 10 + (unsigned long long)(*s - '0');
+        s++;
+    }
+    *p = s;
+    return value;
+}
+
+static long long
+parse_i64(const char **p)
+{
+    const char *s = skip_spaces(*p);
+    int negative = 0;
+    unsigned long long value;
+
+    if (*s == '-') {
+        negative = 1;
+        s++;
+    }
+    value = parse_u64(&s);
+    *p = s;
+    return negative ? -(long long)value : (long long)value;
+}
+
+/* Parse up to CPU_FIELDS counters from the rest of a /proc/stat "cpu" line. */
+static const char *
+parse_cpu_line(const char *p, unsigned long long *fields)
+{
+    int i;
+
+    for (i = 0; i < CPU_FIELDS; i++) {
+        p = skip_spaces(p);
+        if (*p < '0' || *p > '9') {
+            fields[i] = 0;
+            continue;
+        }
+        fields[i] = parse_u64(&p);
+    }
+    return next_line(p);
+}
+
+static PyObject *
+cpu_fields_to_tuple(const unsigned long long *fields)
+{
+    PyObject *tuple = PyTuple_New(CPU_FIELDS);
+    int i;
+
+    if (tuple == NULL)
+        return NULL;
+
+    for (i = 0; i < CPU_FIELDS; i++) {
+        PyObject *value = PyFloat_FromDouble((double)fields[i] / clock_ticks);
+        if (value == NULL) {
+            Py_DECREF(tuple);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(tuple, i, value);
+    }
+    return tuple;
+}
+
+/* ---------- module functions ---------- */
+
+PyDoc_STRVAR(cpu_times_doc,
+"cpu_times() -> (total, [core, ...])\n\n"
+"Read /proc/stat. Each entry is a tuple of seconds:\n"
+"(user, nice, system, idle, iowait, irq, softirq, steal, guest, guest_nice).");
+
+static PyObject *
+native_cpu_times(PyObject *self, PyObject *args)
+{
+    unsigned long long total[CPU_FIELDS];
+    size_t cores = 0;
+    size_t i;
+    const char *p;
+    PyObject *total_tuple, *core_list, *result;
+
+    if (read_cached(&stat_fd, "/proc/stat") < 0)
+        return NULL;
+
+    memset(total, 0, sizeof(total));
+    p = file_buffer.data;
+    while (*p) {
+        if (strncmp(p, "cpu", 3) != 0)
+            break;
+
+        if (p[3] == ' ') {
+            p = parse_cpu_line(p + 3, total);
+            continue;
+        }
+
+        if (cores == core_capacity) {
+            size_t capacity = core_capacity ? core_capacity * 2 : 64;
+            void *grown = realloc(core_times, capacity * sizeof(*core_times));
+            if (grown == NULL)
+                return PyErr_NoMemory();
+            core_times = grown;
+            core_capacity = capacity;
+        }
+
+        /* skip the core number */
+        p += 3;
+        while (*p >= '0' && *p <= '9')
+            p++;
+        p = parse_cpu_line(p, core_times[cores]);
+        cores++;
+    }
+
+    total_tuple = cpu_fields_to_tuple(total);
+    if (total_tuple == NULL)
+        return NULL;
+
+    core_list = PyList_New((Py_ssize_t)cores);
+    if (core_list == NULL) {
+        Py_DECREF(total_tuple);
+        return NULL;
+    }
+    for (i = 0; i < cores; i++) {
+        PyObject *core = cpu_fields_to_tuple(core_times[i]);
+        if (core == NULL) {
+            Py_DECREF(total_tuple);
+            Py_DECREF(core_list);
+            return NULL;
+        }
+        PyList_SET_ITEM(core_list, (Py_ssize_t)i, core);
+    }
+
+    result = PyTuple_Pack(2, total_tuple, core_list);
+    Py_DECREF(total_tuple);
+    Py_DECREF(core_list);
+    return result;
+}
+
+PyDoc_STRVAR(meminfo_doc,
+"meminfo() -> (total, available, free, buffers, cached)\n\n"
+"Read /proc/meminfo. All values are bytes. cached includes SReclaimable, like psutil.");
+
+static PyObject *
+native_meminfo(PyObject *self, PyObject *args)
+{
+    unsigned long long total = 0, available = 0, free_mem = 0, buffers = 0, cached = 0, reclaimable = 0;
+    int have_available = 0;
+    const char *p;
+
+    if (read_cached(&meminfo_fd, "/proc/meminfo") < 0)
+        return NULL;
+
+    p = file_buffer.data;
+    while (*p) {
+        unsigned long long *target = NULL;
+
+        if (strncmp(p, "MemTotal:", 9) == 0) {
+            target = &total;
+            p += 9;
+        } else if (strncmp(p, "MemFree:", 8) == 0) {
+            target = &free_mem;
+            p += 8;
+        } else if (strncmp(p, "MemAvailable:", 13) == 0) {
+            target = &available;
+            have_available = 1;
+            p += 13;
+        } else if (strncmp(p, "Buffers:", 8) == 0) {
+            target = &buffers;
+            p += 8;
+        } else if (strncmp(p, "Cached:", 7) == 0) {
+            target = &cached;
+            p += 7;
+        } else if (strncmp(p, "SReclaimable:", 13) == 0) {
+            target = &reclaimable;
+            p += 13;
+        }
+
+        if (target != NULL)
+            *target = parse_u64(&p) * 1024;
+        p = next_line(p);
+    }
+
+    cached += reclaimable;
+    if (!have_available)
+        available = free_mem + buffers + cached;
+
+    return Py_BuildValue("(KKKKK)", total, available, free_mem, buffers, cached);
+}
+
+PyDoc_STRVAR(diskstats_doc,
+"diskstats() -> {name: (read_count, write_count, read_bytes, write_bytes)}\n\n"
+"Read /proc/diskstats.");
+
+static PyObject *
+native_diskstats(PyObject *self, PyObject *args)
+{
+    size_t count = 0;
+    size_t i;
+    const char *p;
+    PyObject *result;
+
+    if (read_cached(&diskstats_fd, "/proc/diskstats") < 0)
+        return NULL;
+
+    p = file_buffer.data;
+    while (*p) {
+        disk_entry_t *entry;
+        size_t name_length = 0;
+
+        if (count == disk_capacity) {
+            size_t capacity = disk_capacity ? disk_capacity * 2 : 64;
+            void *grown = realloc(disk_entries, capacity * sizeof(*disk_entries));
+            if (grown == NULL)
+                return PyErr_NoMemory();
+            disk_entries = grown;
+            disk_capacity = capacity;
+        }
+        entry = &disk_entries[count];
+
+        /* major and minor numbers */
+        parse_u64(&p);
+        parse_u64(&p);
+
+        p = skip_spaces(p);
+        while (*p && *p != ' ' && *p != '\n') {
+            if (name_length < DISK_NAME_LEN - 1)
+                entry->name[name_length++] = *p;
+            p++;
+        }
+        entry->name[name_length] = '\0';
+
+        if (name_length > 0) {
+            unsigned long long read_sectors, write_sectors;
+
+            entry->read_count = parse_u64(&p);
+            parse_u64(&p);                      /* reads merged */
+            read_sectors = parse_u64(&p);
+            parse_u64(&p);                      /* time reading */
+            entry->write_count = parse_u64(&p);
+            parse_u64(&p);                      /* writes merged */
+            write_sectors = parse_u64(&p);
+
+            /* /proc/diskstats always counts 512 byte sectors */
+            entry->read_bytes = read_sectors * 512;
+            entry->write_bytes = write_sectors * 512;
+            count++;
+        }
+        p = next_line(p);
+    }
+
+    result = PyDict_New();
+    if (result == NULL)
+        return NULL;
+
+    for (i = 0; i < count; i++) {
+        disk_entry_t *entry = &disk_entries[i];
+        PyObject *value = Py_BuildValue("(KKKK)", entry->read_count, entry->write_count,
+                                        entry->read_bytes, entry->write_bytes);
+        if (value == NULL || PyDict_SetItemString(result, entry->name, value) < 0) {
+            Py_XDECREF(value);
+            Py_DECREF(result);
+            return NULL;
+        }
+        Py_DECREF(value);
+    }
+    return result;
+}
+
+PyDoc_STRVAR(net_dev_doc,
+"net_dev() -> (bytes_sent, bytes_recv, packets_sent, packets_recv)\n\n"
+"Read /proc/net/dev and sum every interface, like psutil.net_io_counters().");
+
+static PyObject *
+native_net_dev(PyObject *self, PyObject *args)
+{
+    unsigned long long bytes_sent = 0, bytes_recv = 0, packets_sent = 0, packets_recv = 0;
+    const char *p;
+
+    if (read_cached(&netdev_fd, "/proc/net/dev") < 0)
+        return NULL;
+
+    /* the first two lines are headers */
+    p = next_line(next_line(file_buffer.data));
+    while (*p) {
+        const char *colon = p;
+        unsigned long long fields[10];
+        int i;
+
+        while (*colon && *colon != ':' && *colon != '\n')
+            colon++;
+        if (*colon != ':') {
+            p = next_line(p);
+            continue;
+        }
+
+        p = colon + 1;
+        for (i = 0; i < 10; i++)
+            fields[i] = parse_u64(&p);
+
+        bytes_recv += fields[0];
+        packets_recv += fields[1];
+        bytes_sent += fields[8];
+        packets_sent += fields[9];
+        p = next_line(p);
+    }
+
+    return Py_BuildValue("(KKKK)", bytes_sent, bytes_recv, packets_sent, packets_recv);
+}
+
+PyDoc_STRVAR(processes_doc,
+"processes() -> [(pid, name, cpu_seconds, rss_bytes), ...]\n\n"
+"Read /proc/[pid]/stat for every running process. cpu_seconds is user + system time.\n"
+"Processes that exit while being read are skipped.");
+
+static PyObject *
+native_processes(PyObject *self, PyObject *args)
+{
+    char path[64];
+    char stat[PROC_STAT_BUF];
+    DIR *proc;
+    struct dirent *dirent;
+    PyObject *result = PyList_New(0);
+
+    if (result == NULL)
+        return NULL;
+
+    proc = opendir("/proc");
+    if (proc == NULL) {
+        Py_DECREF(result);
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, "/proc");
+    }
+
+    while ((dirent = readdir(proc)) != NULL) {
+        const char *p, *name_start, *name_end;
+        unsigned long long utime, stime;
+        long long rss;
+        long pid;
+        int field;
+        PyObject *name, *entry;
+
+        if (!isdigit((unsigned char)dirent->d_name[0]))
+            continue;
+
+        pid = strtol(dirent->d_name, NULL, 10);
+        snprintf(path, sizeof(path), "/proc/%ld/stat", pid);
+        if (read_small(path, stat, sizeof(stat)) <= 0)
+            continue;
+
+        /* the name is wrapped in parentheses and may itself contain spaces or ')' */
+        name_start = strchr(stat, '(');
+        name_end = strrchr(stat, ')');
+        if (name_start == NULL || name_end == NULL || name_end < name_start)
+            continue;
+
+        /* fields after the name start at field 3 (state); utime is 14, stime 15, rss 24 */
+        p = name_end + 2;
+        for (field = 3; field < 14 && *p; field++) {
+            while (*p && *p != ' ')
+                p++;
+            if (*p)
+                p++;
+        }
+        utime = parse_u64(&p);
+        stime = parse_u64(&p);
+        for (field = 16; field < 24 && *p; field++) {
+            p = skip_spaces(p);
+            while (*p && *p != ' ')
+                p++;
+        }
+        rss = parse_i64(&p);
+        if (rss < 0)
+            rss = 0;
+
+        /* process names are raw bytes, decode them the same way os.fsdecode() does */
+        name = PyUnicode_DecodeFSDefaultAndSize(name_start + 1, (Py_ssize_t)(name_end - name_start - 1));
+        if (name == NULL) {
+            Py_DECREF(result);
+            closedir(proc);
+            return NULL;
+        }
+        entry = Py_BuildValue("(lNdK)", pid, name, (double)(utime + stime) / clock_ticks,
+                              (unsigned long long)rss * page_size);
+        if (entry == NULL || PyList_Append(result, entry) < 0) {
+            Py_XDECREF(entry);
+            Py_DECREF(result);
+            closedir(proc);
+            return NULL;
+        }
+        Py_DECREF(entry);
+    }
+
+    closedir(proc);
+    return result;
+}
+
+static PyMethodDef native_methods[] = {
+    {"cpu_times", native_cpu_times, METH_NOARGS, cpu_times_doc},
+    {"meminfo", native_meminfo, METH_NOARGS, meminfo_doc},
+    {"diskstats", native_diskstats, METH_NOARGS, diskstats_doc},
+    {"net_dev", native_net_dev, METH_NOARGS, net_dev_doc},
+    {"processes", native_processes, METH_NOARGS, processes_doc},
+    {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef native_module = {
+    PyModuleDef_HEAD_INIT,
+    "_nativeLinux",
+    "Native /proc collectors for statz on Linux.",
+    -1,
+    native_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC
+PyInit__nativeLinux(void)
+{
+    long ticks = sysconf(_SC_CLK_TCK);
+    long page = sysconf(_SC_PAGESIZE);
+
+    if (ticks > 0)
+        clock_ticks = (double)ticks;
+    if (page > 0)
+        page_size = (unsigned long long)page;
+
+    return PyModule_Create(&native_module);
+}
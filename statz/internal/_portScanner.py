@@ -0,0 +1,194 @@
+'''
+TCP connect scanner.
+Many non-blocking connects are kept in flight at once and driven by one selector, so a scan takes
+about (ports / concurrency) round trips instead of one timeout per port. The timeout of each host
+adapts to the round trip times measured on it, the same way TCP computes its retransmission timeout.
+'''
+
+import errno
+import ipaddress
+import selectors
+import socket
+import time
+
+# connect_ex results that mean "still connecting" (EINPROGRESS on unix, WSAEWOULDBLOCK on Windows)
+_IN_PROGRESS = {errno.EINPROGRESS, errno.EWOULDBLOCK, errno.EALREADY, getattr(errno, "WSAEWOULDBLOCK", 10035)}
+
+# most addresses one scan accepts (a /16), so a typo like "10.0.0.0/8" or an IPv6 /64 fails
+# right away instead of building a list and a timeout estimator for every address
+MAX_TARGETS = 65536
+
+def _expand_targets(targets):
+    '''
+    Turn an IP, hostname, CIDR range ("192.168.1.0/24") or a list of those into a list of IP strings.
+
+    Raises:
+        ValueError: If a target is not an IP, CIDR range or resolvable hostname, or the targets add up to
+                    more than MAX_TARGETS addresses.
+    '''
+    if isinstance(targets, str):
+        targets = [targets]
+
+    hosts = []
+    for target in targets:
+        target = str(target).strip()
+        try:
+            network = ipaddress.ip_network(target, strict=False)
+        except ValueError:
+            try:
+                hosts.append(socket.getaddrinfo(target, None, proto=socket.IPPROTO_TCP)[0][4][0])
+            except socket.gaierror:
+                raise ValueError(f"Invalid target {target}, expected an IP, CIDR range or hostname")
+            continue
+
+        if len(hosts) + network.num_addresses > MAX_TARGETS:
+            raise ValueError(f"Too many targets, {target} brings the scan over {MAX_TARGETS} addresses")
+
+        # hosts() skips the network and broadcast addresses, and is empty for single addresses
+        addresses = [network.network_address] if network.num_addresses == 1 else list(network.hosts()) or list(network)
+        hosts.extend(str(address) for address in addresses)
+
+    # keep the given order but scan each address once
+    return list(dict.fromkeys(hosts))
+
+def _is_self_connect(sock):
+    '''
+    On loopback, a connect to a free port in the ephemeral range can pick that same port as its source
+    and connect to itself (TCP simultaneous open). That port is not actually open.
+    '''
+    try:
+        return sock.getsockname() == sock.getpeername()
+    except OSError:
+        return False
+
+def _max_concurrency(requested):
+    '''Keep the number of sockets in flight below the open file limit.'''
+    try:
+        import resource
+        soft, _ = resource.getrlimit(resource.RLIMIT_NOFILE)
+        if soft != resource.RLIM_INFINITY:
+            return max(1, min(requested, soft - 32))
+    except:
+        pass
+    # select() on Windows handles at most 512 sockets per call
+    return min(requested, 500)
+
+class _RttEstimator:
+    '''Smoothed round trip time of one host, RFC 6298 style.'''
+    def __init__(self, initial_timeout, min_timeout, max_timeout):
+        self.srtt = None
+        self.rttvar = None
+        self.timeout = initial_timeout
+        self.min_timeout = min_timeout
+        self.max_timeout = max_timeout
+
+    def sample(self, rtt):
+        if self.srtt is None:
+            self.srtt = rtt
+            self.rttvar = rtt / 2
+        else:
+            self.rttvar = 0.75 * self.rttvar + 0.25 * abs(self.srtt - rtt)
+            self.srtt = 0.875 * self.srtt + 0.125 * rtt
+        self.timeout = min(self.max_timeout, max(self.min_timeout, self.srtt + 4 * self.rttvar))
+
+def _iter_scan(hosts, ports, concurrency=256, timeout=1.0, adaptive=True, min_timeout=0.05, stop_event=None):
+    '''
+    Scan every (host, port) pair and yield the open ones as soon as they answer.
+
+    Probes are interleaved across hosts, so each host's round trip time is measured early and no single
+    host receives a burst of `concurrency` connections.
+
+    Args:
+        hosts (list): IP strings, as _expand_targets returns.
+        ports (iterable): Ports to try on every host.
+        concurrency (int): Maximum number of connections in flight.
+        timeout (float): Seconds to wait for an answer. With adaptive=True this is the upper bound and the starting value.
+        adaptive (bool): Shrink each host's timeout to its measured round trip time.
+        min_timeout (float): Lower bound of the adaptive timeout.
+        stop_event (threading.Event): Stop the scan soon after this is set, for callers on another thread.
+
+    Yields:
+        tuple: (host, port) for every port that accepted a connection.
+    '''
+    if concurrency < 1:
+        raise ValueError(f"concurrency must be positive int, not {concurrency}")
+    if timeout <= 0:
+        raise ValueError(f"timeout must be positive, not {timeout}")
+
+    ports = list(ports)
+    estimators = {host: _RttEstimator(timeout, min(min_timeout, timeout), timeout) for host in hosts}
+    families = {host: socket.AF_INET6 if ":" in host else socket.AF_INET for host in hosts}
+    probes = ((host, port) for port in ports for host in hosts)
+    concurrency = _max_concurrency(concurrency)
+
+    selector = selectors.DefaultSelector()
+    # socket -> (host, port, start time)
+    pending = {}
+    exhausted = False
+
+    try:
+        while stop_event is None or not stop_event.is_set():
+            while not exhausted and len(pending) < concurrency:
+                try:
+                    host, port = next(probes)
+                except StopIteration:
+                    exhausted = True
+                    break
+
+                sock = socket.socket(families[host], socket.SOCK_STREAM)
+                sock.setblocking(False)
+                started = time.monotonic()
+                result = sock.connect_ex((host, port))
+                if result == 0:
+                    # loopback connects can finish immediately
+                    self_connect = _is_self_connect(sock)
+                    sock.close()
+                    if not self_connect:
+                        yield host, port
+                elif result in _IN_PROGRESS:
+                    selector.register(sock, selectors.EVENT_WRITE)
+                    pending[sock] = (host, port, started)
+                else:
+                    # refused or unreachable right away
+                    sock.close()
+
+            if not pending:
+                break
+
+            now = time.monotonic()
+            next_deadline = min(started + estimators[host].timeout for host, _, started in pending.values())
+            wait = max(0.0, next_deadline - now)
+            if stop_event is not None:
+                # wake up regularly to notice the stop request
+                wait = min(wait, 0.1)
+            events = selector.select(wait)
+            now = time.monotonic()
+
+            for key, _ in events:
+                sock = key.fileobj
+                host, port, started = pending.pop(sock)
+                selector.unregister(sock)
+                error = sock.getsockopt(socket.SOL_SOCKET, socket.SO_ERROR)
+                if error == 0 and _is_self_connect(sock):
+                    error = errno.ECONNREFUSED
+                sock.close()
+                # both an accept and a refusal (RST) are a full round trip
+                if adaptive and error in (0, errno.ECONNREFUSED, getattr(errno, "WSAECONNREFUSED", 10061)):
+                    estimators[host].sample(now - started)
+                if error == 0:
+                    yield host, port
+
+            for sock, (host, port, started) in list(pending.items()):
+                if now - started >= estimators[host].timeout:
+                    # filtered (dropped) port
+                    del pending[sock]
+                    selector.unregister(sock)
+                    sock.close()
+    finally:
+        for sock in pending:
+            try:
+                selector.unregister(sock)
+            except:
+                pass
+            sock.close()
+        selector.close()
@@ -0,0 +1,215 @@
+'''
+Long-lived process table used by the top-N process functions.
+Process handles are cached by PID so that repeated calls only create handles for new processes,
+drop handles for processes that exited, and compute CPU usage from the previous refresh.
+'''
+
+import heapq
+import threading
+import time
+
+import psutil
+
+try:
+    from . import _nativeCollectors
+except ImportError:
+    import _nativeCollectors
+
+# List of process names to exclude (system processes that report incorrect usage)
+EXCLUDED_PROCESSES = {
+    'System Idle Process',
+    'Idle',
+    'idle',
+    'System',  # Sometimes the main System process also reports weird values
+}
+
+class _TrackedProcess:
+    '''Cached handle and last-seen counters for one PID.'''
+    __slots__ = ("process", "name", "excluded", "cpu_time", "cpu_percent", "rss", "io_bytes", "io_rate")
+
+    def __init__(self, process, name, excluded):
+        self.process = process
+        self.name = name
+        self.excluded = excluded
+        self.cpu_time = None
+        self.cpu_percent = None
+        self.rss = None
+        self.io_bytes = None
+        self.io_rate = None
+
+class _ProcessTracker:
+    '''
+    Incrementally maintained table of running processes.
+
+    Each refresh lists the current PIDs, creates handles only for PIDs that appeared since the last
+    refresh and forgets PIDs that exited. CPU usage is the CPU time each process used since the previous
+    refresh divided by the wall time between refreshes, as a percentage of one core.
+    '''
+    def __init__(self):
+        self._processes = {}
+        self._last_refresh = None
+        self._last_refresh_had_io = False
+        self._lock = threading.Lock()
+
+    def refresh(self, with_io=False):
+        '''
+        Update the table with the current set of processes and their counters.
+
+        Args:
+            with_io (bool): Whether to also read per-process I/O counters. Defaults to False.
+        '''
+        with self._lock:
+            self._refresh(with_io)
+
+    def _refresh(self, with_io):
+        now = time.monotonic()
+        elapsed = now - self._last_refresh if self._last_refresh is not None else None
+        had_io = self._last_refresh_had_io
+        self._last_refresh = now
+        self._last_refresh_had_io = with_io
+
+        # The native collector reads every /proc/[pid]/stat in one call, but it does not read I/O counters
+        if _nativeCollectors.NATIVE_AVAILABLE and not with_io:
+            self._refresh_native(elapsed)
+        else:
+            self._refresh_psutil(elapsed, with_io, had_io)
+
+    def _refresh_native(self, elapsed):
+        processes = self._processes
+        seen = set()
+
+        for pid, name, cpu_time, rss in _nativeCollectors.processes():
+            seen.add(pid)
+            entry = processes.get(pid)
+            if entry is None:
+                # Skip processes with PID 0 (usually system idle) and excluded system processes
+                entry = processes[pid] = _TrackedProcess(None, name, pid == 0 or name in EXCLUDED_PROCESSES)
+            if not entry.excluded:
+                self._update_counters(entry, cpu_time, rss, elapsed)
+
+        # forget processes that exited
+        for pid in processes.keys() - seen:
+            del processes[pid]
+
+    def _refresh_psutil(self, elapsed, with_io, had_io):
+        current_pids = set(psutil.pids())
+        processes = self._processes
+
+        # forget processes that exited
+        for pid in processes.keys() - current_pids:
+            del processes[pid]
+
+        # create handles for new processes
+        for pid in current_pids - processes.keys():
+            try:
+                process = psutil.Process(pid)
+                name = process.name()
+            except (psutil.NoSuchProcess, psutil.AccessDenied, psutil.ZombieProcess):
+                continue
+            # Skip processes with PID 0 (usually system idle) and excluded system processes
+            processes[pid] = _TrackedProcess(process, name, pid == 0 or name in EXCLUDED_PROCESSES)
+
+        dead = []
+        for pid, entry in processes.items():
+            if entry.excluded:
+                continue
+            try:
+                # entries first seen by the native collector have no handle yet
+                if entry.process is None:
+                    entry.process = psutil.Process(pid)
+                with entry.process.oneshot():
+                    cpu_times = entry.process.cpu_times()
+                    memory_info = entry.process.memory_info()
+                    io_counters = self._read_io_counters(entry.process) if with_io else None
+            except (psutil.NoSuchProcess, psutil.ZombieProcess):
+                dead.append(pid)
+                continue
+            except psutil.AccessDenied:
+                entry.cpu_percent = None
+                entry.rss = None
+                continue
+
+            self._update_counters(entry, cpu_times.user + cpu_times.system, memory_info.rss, elapsed)
+
+            if io_counters is not None:
+                io_bytes = io_counters.read_bytes + io_counters.write_bytes
+                if had_io and entry.io_bytes is not None and elapsed and io_bytes >= entry.io_bytes:
+                    entry.io_rate = (io_bytes - entry.io_bytes) / elapsed
+                else:
+                    entry.io_rate = None
+                entry.io_bytes = io_bytes
+            elif with_io:
+                entry.io_rate = None
+
+        for pid in dead:
+            del processes[pid]
+
+    @staticmethod
+    def _update_counters(entry, cpu_time, rss, elapsed):
+        if entry.cpu_time is not None and elapsed:
+            delta = cpu_time - entry.cpu_time
+            # a negative delta means the PID was reused by a new process
+            entry.cpu_percent = delta / elapsed * 100 if delta >= 0 else None
+        else:
+            entry.cpu_percent = None
+        entry.cpu_time = cpu_time
+        entry.rss = rss
+
+    @staticmethod
+    def _read_io_counters(process):
+        # I/O counters are missing on macOS and often need more privileges than CPU/memory counters
+        if not hasattr(process, "io_counters"):
+            return None
+        try:
+            return process.io_counters()
+        except psutil.AccessDenied:
+            return None
+
+    def top(self, n, type="cpu"):
+        '''
+        Get the top N processes from the last refresh.
+
+        Args:
+            n (int): Number of processes to return.
+            type (str): "cpu" (percent of one core, capped at 100), "mem" (RSS in MB) or "io" (bytes per second).
+
+        Returns:
+            list: List of (pid, name, value) tuples, highest value first.
+        '''
+        with self._lock:
+            return self._top(n, type)
+
+    def _top(self, n, type):
+        candidates = []
+        for pid, entry in self._processes.items():
+            if entry.excluded:
+                continue
+            if type == "cpu":
+                # Only include processes using more than 0.1% CPU
+                if entry.cpu_percent is not None and entry.cpu_percent > 0.1:
+                    # Cap CPU usage at reasonable levels (no single process should use more than 100% per core)
+                    candidates.append((min(entry.cpu_percent, 100.0), pid, entry.name))
+            elif type == "mem":
+                # Only include processes using at least 1MB of RAM
+                if entry.rss is not None and entry.rss >= 1024 * 1024:
+                    candidates.append((entry.rss / 1024 / 1024, pid, entry.name))
+            elif type == "io":
+                if entry.io_rate:
+                    candidates.append((entry.io_rate, pid, entry.name))
+
+        return [(pid, name, value) for value, pid, name in heapq.nlargest(n, candidates)]
+
+    def needs_priming(self, with_io=False):
+        '''
+        Whether the table has no previous refresh to compute deltas against.
+
+        Args:
+            with_io (bool): Also require the previous refresh to have read I/O counters.
+        '''
+        return self._last_refresh is None or (with_io and not self._last_refresh_had_io)
+
+_tracker = _ProcessTracker()
+
+def _get_process_tracker():
+    '''Return the shared process tracker.'''
+    return _tracker
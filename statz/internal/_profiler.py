@@ -0,0 +1,291 @@
+'''
+Collector profiling.
+Opt-in instrumentation around the collectors, for finding out where a slow call spends its time.
+While profiling is enabled every stage records its wall time, CPU time, the read/write syscalls of the
+calling thread (from /proc/thread-self/io on Linux), the subprocesses it started and which fallback
+path ran. While it is disabled a stage costs a single flag check.
+Stages nest: a stage entered inside another one is recorded as "outer/inner", and its syscalls and
+subprocesses count towards the outer stage as well.
+'''
+
+import contextlib
+import functools
+import os
+import subprocess
+import threading
+import time
+
+# upper bounds of the histogram buckets in milliseconds, slower calls go into "+Inf"
+BUCKETS_MS = (0.1, 0.5, 1, 2.5, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000)
+# durations kept per stage for the percentiles; the histogram counts every call
+SAMPLES = 1024
+
+IO_PATH = "/proc/thread-self/io"
+
+_enabled = False
+_lock = threading.Lock()
+_stages = {}
+_local = threading.local()
+_popen_init = None
+# syscalls that reading IO_PATH itself makes, subtracted from every stage
+_syscall_overhead = 0
+
+def _syscalls():
+    '''Read and write syscalls the calling thread has made so far, None where the kernel does not report them.'''
+    try:
+        with open(IO_PATH, "rb") as f:
+            data = f.read()
+    except OSError:
+        return None
+    count = 0
+    for line in data.splitlines():
+        if line.startswith(b"syscr:") or line.startswith(b"syscw:"):
+            count += int(line.split(b":", 1)[1])
+    return count
+
+def _command_name(args):
+    if isinstance(args, (str, bytes)):
+        args = args.split()
+    try:
+        name = args[0]
+    except (IndexError, TypeError):
+        return "unknown"
+    name = os.fsdecode(name)
+    return os.path.basename(name) or name
+
+def _counting_popen_init(self, args, *rest, **kwargs):
+    '''subprocess.Popen.__init__ while profiling: charges the subprocess to every open stage of this thread.'''
+    stack = getattr(_local, "stack", None)
+    if stack:
+        command = _command_name(args)
+        for frame in stack:
+            frame.subprocesses += 1
+            frame.commands[command] = frame.commands.get(command, 0) + 1
+    return _popen_init(self, args, *rest, **kwargs)
+
+class _Frame:
+    '''A stage that is running on the current thread.'''
+    __slots__ = ("path", "start", "cpu_start", "syscalls_start", "subprocesses", "commands", "fallbacks")
+
+    def __init__(self, path):
+        self.path = path
+        self.subprocesses = 0
+        self.commands = {}
+        self.fallbacks = {}
+        self.syscalls_start = _syscalls()
+        self.cpu_start = time.thread_time()
+        self.start = time.perf_counter()
+
+class _StageStats:
+    '''Everything recorded for one stage path.'''
+    def __init__(self):
+        self.calls = 0
+        self.errors = 0
+        self.total_ms = 0.0
+        self.max_ms = 0.0
+        self.cpu_ms = 0.0
+        self.samples = []
+        self.buckets = [0] * (len(BUCKETS_MS) + 1)
+        self.syscalls = None
+        self.subprocesses = 0
+        self.commands = {}
+        self.fallbacks = {}
+
+    def add(self, frame, wall_ms, cpu_ms, syscalls, failed):
+        self.calls += 1
+        self.errors += failed
+        self.total_ms += wall_ms
+        self.max_ms = max(self.max_ms, wall_ms)
+        self.cpu_ms += cpu_ms
+        if len(self.samples) < SAMPLES:
+            self.samples.append(wall_ms)
+        else:
+            # keep a uniform sample of every call, like a reservoir
+            import random
+            index = random.randrange(self.calls)
+            if index < SAMPLES:
+                self.samples[index] = wall_ms
+        bucket = 0
+        while bucket < len(BUCKETS_MS) and wall_ms > BUCKETS_MS[bucket]:
+            bucket += 1
+        self.buckets[bucket] += 1
+        if syscalls is not None:
+            self.syscalls = (self.syscalls or 0) + syscalls
+        self.subprocesses += frame.subprocesses
+        for name, count in frame.commands.items():
+            self.commands[name] = self.commands.get(name, 0) + count
+        for name, count in frame.fallbacks.items():
+            self.fallbacks[name] = self.fallbacks.get(name, 0) + count
+
+    def report(self):
+        try:
+            from ._benchmarkRunner import _percentile
+        except ImportError:
+            from _benchmarkRunner import _percentile
+        histogram = {f"{bound:g}": count for bound, count in zip(BUCKETS_MS, self.buckets)}
+        histogram["+Inf"] = self.buckets[-1]
+        return {
+            "calls": self.calls,
+            "errors": self.errors,
+            "total_ms": round(self.total_ms, 3),
+            "mean_ms": round(self.total_ms / self.calls, 3),
+            "p50_ms": round(_percentile(self.samples, 50), 3),
+            "p90_ms": round(_percentile(self.samples, 90), 3),
+            "p99_ms": round(_percentile(self.samples, 99), 3),
+            "max_ms": round(self.max_ms, 3),
+            "cpu_ms": round(self.cpu_ms, 3),
+            "syscalls": self.syscalls,
+            "subprocesses": self.subprocesses,
+            "commands": dict(self.commands),
+            "fallbacks": dict(self.fallbacks),
+            "histogram": histogram,
+        }
+
+def _push(name):
+    stack = getattr(_local, "stack", None)
+    if stack is None:
+        stack = _local.stack = []
+    frame = _Frame(f"{stack[-1].path}/{name}" if stack else name)
+    stack.append(frame)
+    return frame
+
+def _pop(frame, failed):
+    wall_ms = (time.perf_counter() - frame.start) * 1000
+    cpu_ms = (time.thread_time() - frame.cpu_start) * 1000
+    syscalls = None
+    if frame.syscalls_start is not None:
+        end = _syscalls()
+        if end is not None:
+            syscalls = max(0, end - frame.syscalls_start - _syscall_overhead)
+    stack = _local.stack
+    if stack and stack[-1] is frame:
+        stack.pop()
+    elif frame in stack:
+        stack.remove(frame)
+    with _lock:
+        stats = _stages.get(frame.path)
+        if stats is None:
+            stats = _stages[frame.path] = _StageStats()
+        stats.add(frame, wall_ms, cpu_ms, syscalls, failed)
+
+class _Stage:
+    __slots__ = ("name", "frame")
+
+    def __init__(self, name):
+        self.name = name
+
+    def __enter__(self):
+        self.frame = _push(self.name)
+        return self
+
+    def __exit__(self, exc_type, exc, traceback):
+        _pop(self.frame, exc_type is not None)
+        return False
+
+# shared by every stage while profiling is disabled
+_NULL_STAGE = contextlib.nullcontext()
+
+def _stage(name):
+    '''
+    Context manager that profiles the block it wraps as one stage.
+
+    Args:
+        name (str): Stage name, e.g. "dmidecode". Nested stages are recorded as "outer/inner".
+    '''
+    return _Stage(name) if _enabled else _NULL_STAGE
+
+def _profiled(name):
+    '''Decorator that profiles every call of a collector as the stage name.'''
+    def decorate(function):
+        @functools.wraps(function)
+        def wrapper(*args, **kwargs):
+            if not _enabled:
+                return function(*args, **kwargs)
+            frame = _push(name)
+            failed = True
+            try:
+                result = function(*args, **kwargs)
+                failed = False
+                return result
+            finally:
+                _pop(frame, failed)
+        return wrapper
+    return decorate
+
+class _ProfiledCalls:
+    '''Proxy that profiles every method call on the wrapped object as a stage named after the method, e.g. WMI queries.'''
+    def __init__(self, target):
+        self._target = target
+
+    def __getattr__(self, name):
+        attribute = getattr(self._target, name)
+        return _profiled(name)(attribute) if callable(attribute) else attribute
+
+def _profiled_calls(target):
+    '''target wrapped in _ProfiledCalls while profiling is enabled, otherwise target itself.'''
+    return _ProfiledCalls(target) if _enabled else target
+
+def _fallback(name):
+    '''Record that the innermost running stage took the path name (e.g. "sysfs" or "sensors").'''
+    if not _enabled:
+        return
+    stack = getattr(_local, "stack", None)
+    if stack:
+        fallbacks = stack[-1].fallbacks
+        fallbacks[name] = fallbacks.get(name, 0) + 1
+
+def _enable_profiling():
+    '''Start recording stages. Data recorded earlier is kept, see _reset_profile.'''
+    global _enabled, _popen_init, _syscall_overhead
+    with _lock:
+        if _enabled:
+            return
+        first = _syscalls()
+        second = _syscalls()
+        _syscall_overhead = second - first if first is not None and second is not None else 0
+        _popen_init = subprocess.Popen.__init__
+        subprocess.Popen.__init__ = _counting_popen_init
+        _enabled = True
+
+def _disable_profiling():
+    '''Stop recording stages and put subprocess.Popen back. The recorded data stays available.'''
+    global _enabled, _popen_init
+    with _lock:
+        if not _enabled:
+            return
+        _enabled = False
+        subprocess.Popen.__init__ = _popen_init
+        _popen_init = None
+
+def _reset_profile():
+    with _lock:
+        _stages.clear()
+
+def _profiling_enabled():
+    return _enabled
+
+def _profile_report(reset=False):
+    '''
+    Everything recorded since profiling was enabled (or last reset).
+
+    Args:
+        reset (bool): Clear the recorded data after reading it. Defaults to False.
+
+    Returns:
+        dict: {
+            "enabled": bool,
+            "stages": { "stage" or "outer/inner": {
+                "calls", "errors", "total_ms", "mean_ms", "p50_ms", "p90_ms", "p99_ms", "max_ms",
+                "cpu_ms": CPU time of the calling thread (wall time minus this is sleeping, waiting on I/O or on subprocesses),
+                "syscalls": read/write syscalls (None where unavailable), "subprocesses", "commands": { command: count },
+                "fallbacks": { path taken: count }, "histogram": { upper bound in ms: calls, ..., "+Inf": calls }
+            } }
+        }
+        Stages are ordered by total wall time, slowest first.
+    '''
+    with _lock:
+        stages = {path: stats.report() for path, stats in _stages.items()}
+        if reset:
+            _stages.clear()
+    ordered = sorted(stages.items(), key=lambda item: item[1]["total_ms"], reverse=True)
+    return {"enabled": _enabled, "stages": dict(ordered)}
@@ -0,0 +1,248 @@
+'''
+Secure delete.
+Files are overwritten in place, a fixed size chunk at a time, so memory stays constant whatever the
+file size, and the old blocks are overwritten instead of new ones being allocated. Each pass is
+fsynced before the next one starts. Random passes come from the kernel CSPRNG, read straight into
+the reused buffer where /dev/urandom exists.
+On SSDs the controller remaps writes, so overwriting cannot reach every old copy of the data. There
+the file's blocks are also discarded (hole punching, which the file system turns into TRIM) before
+the file is removed.
+'''
+
+import ctypes
+import ctypes.util
+import errno
+import os
+import platform
+import random
+import stat
+import string
+from concurrent.futures import ThreadPoolExecutor
+
+MIB = 1024 * 1024
+CHUNK_SIZE = 4 * MIB
+
+PATTERNS = ("random", "zeros", "ones")
+
+# linux/falloc.h
+FALLOC_FL_KEEP_SIZE = 0x01
+FALLOC_FL_PUNCH_HOLE = 0x02
+
+def _passes(passes):
+    '''Pattern names for passes given as a count of random passes or a list of patterns.'''
+    if isinstance(passes, int):
+        if passes < 1:
+            raise ValueError(f"passes must be positive int, not {passes}")
+        return ["random"] * passes
+    patterns = [str(pattern).lower() for pattern in passes]
+    for pattern in patterns:
+        if pattern not in PATTERNS:
+            raise ValueError(f"Unknown pass pattern {pattern}, expected one of {', '.join(PATTERNS)}")
+    if not patterns:
+        raise ValueError("passes must not be empty")
+    return patterns
+
+class _RandomSource:
+    '''Fills a buffer with CSPRNG bytes without allocating a new one per chunk when /dev/urandom is available.'''
+    def __init__(self):
+        try:
+            self._file = open("/dev/urandom", "rb", buffering=0)
+        except OSError:
+            self._file = None
+
+    def fill(self, view):
+        if self._file is None:
+            view[:] = os.urandom(len(view))
+            return
+        filled = 0
+        while filled < len(view):
+            filled += self._file.readinto(view[filled:])
+
+    def close(self):
+        if self._file is not None:
+            self._file.close()
+
+def _write_at(fd, data, offset):
+    if hasattr(os, "pwrite"):
+        return os.pwrite(fd, data, offset)
+    os.lseek(fd, offset, os.SEEK_SET)
+    return os.write(fd, data)
+
+def _is_ssd(path):
+    '''True when the file lives on a non-rotational Linux block device, None when that cannot be told.'''
+    if platform.system() != "Linux":
+        return None
+    try:
+        device = os.stat(path).st_dev
+        block = os.path.realpath(f"/sys/dev/block/{os.major(device)}:{os.minor(device)}")
+        # partitions have no queue directory, their parent disk does
+        for directory in (block, os.path.dirname(block)):
+            rotational = os.path.join(directory, "queue", "rotational")
+            if os.path.exists(rotational):
+                with open(rotational) as f:
+                    return f.read().strip() == "0"
+    except:
+        pass
+    return None
+
+_libc = None
+
+def _discard(fd, size):
+    '''Punch the file's blocks out so the file system discards (TRIMs) them. Returns False where unsupported.'''
+    global _libc
+    if platform.system() != "Linux" or size == 0:
+        return False
+    try:
+        if _libc is None:
+            _libc = ctypes.CDLL(ctypes.util.find_library("c"), use_errno=True)
+            _libc.fallocate.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_longlong, ctypes.c_longlong]
+        return _libc.fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, 0, size) == 0
+    except:
+        return False
+
+def _overwrite(fd, size, patterns, chunk_size, progress, path):
+    '''Overwrite size bytes of fd in place once per pattern, fsyncing after every pass.'''
+    buffer = bytearray(chunk_size)
+    view = memoryview(buffer)
+    source = _RandomSource()
+    total = size * len(patterns)
+    done = 0
+    try:
+        for index, pattern in enumerate(patterns):
+            if pattern != "random":
+                view[:] = (b"\x00" if pattern == "zeros" else b"\xff") * chunk_size
+            for offset in range(0, size, chunk_size):
+                length = min(chunk_size, size - offset)
+                if pattern == "random":
+                    source.fill(view[:length])
+                written = 0
+                while written < length:
+                    written += _write_at(fd, view[written:length], offset + written)
+                done += length
+                if progress:
+                    progress(path, done, total, index + 1, len(patterns))
+            os.fsync(fd)
+    finally:
+        view.release()
+        source.close()
+
+def _random_name(directory):
+    characters = string.ascii_letters + string.digits
+    while True:
+        path = os.path.join(directory, ''.join(random.SystemRandom().choice(characters) for _ in range(16)))
+        if not os.path.exists(path):
+            return path
+
+def _secure_delete_file(path, passes=5, chunk_size=CHUNK_SIZE, progress=None, trim="auto"):
+    '''
+    Overwrite a file in place, discard its blocks on SSDs, then rename and remove it.
+
+    Args:
+        path (str): File to delete.
+        passes (int or list): Number of random passes, or patterns ("random", "zeros", "ones") in order. Defaults to 5 random passes.
+        chunk_size (int): Bytes written per call, the only buffer allocated. Defaults to 4 MiB.
+        progress (callable): Called with (path, bytes written, total bytes, pass, passes) after every chunk.
+        trim (bool or "auto"): Discard the file's blocks after overwriting. "auto" does it on SSDs. Defaults to "auto".
+
+    Returns:
+        dict: {"path", "size", "passes", "trimmed"}
+    '''
+    patterns = _passes(passes)
+    if chunk_size <= 0:
+        raise ValueError(f"chunk_size must be positive int, not {chunk_size}")
+    path = os.path.abspath(path)
+
+    # no O_TRUNC: truncating would let the file system hand out new blocks and leave the old data behind.
+    # The type is checked on the opened fd, so the path cannot be swapped for a symlink after the check,
+    # O_NOFOLLOW refuses a symlink and O_NONBLOCK keeps a FIFO from blocking the open
+    flags = os.O_WRONLY | getattr(os, "O_BINARY", 0) | getattr(os, "O_NOFOLLOW", 0) | getattr(os, "O_NONBLOCK", 0)
+    if not hasattr(os, "O_NOFOLLOW") and (os.path.islink(path) or not os.path.isfile(path)):
+        # Windows: no O_NOFOLLOW, and opening a directory fails with PermissionError
+        raise ValueError(f"{path} is not a regular file")
+    try:
+        fd = os.open(path, flags)
+    except OSError as e:
+        if isinstance(e, FileNotFoundError) or e.errno in (errno.ELOOP, errno.ENXIO, errno.EISDIR):
+            raise ValueError(f"{path} is not a regular file")
+        raise
+    trimmed = False
+    try:
+        info = os.fstat(fd)
+        if not stat.S_ISREG(info.st_mode):
+            raise ValueError(f"{path} is not a regular file")
+        size = info.st_size
+        _overwrite(fd, size, patterns, chunk_size, progress, path)
+        if trim is True or (trim == "auto" and _is_ssd(path)):
+            trimmed = _discard(fd, size)
+        os.ftruncate(fd, 0)
+        os.fsync(fd)
+    finally:
+        os.close(fd)
+
+    # the directory entry is renamed as well, so the old name does not survive in it
+    random_path = _random_name(os.path.dirname(path))
+    os.rename(path, random_path)
+    os.remove(random_path)
+    return {"path": path, "size": size, "passes": len(patterns), "trimmed": trimmed}
+
+def _secure_delete_tree(path, passes=5, chunk_size=CHUNK_SIZE, progress=None, trim="auto", workers=None):
+    '''
+    Securely delete every file under a directory with a pool of worker threads, then remove the directories.
+
+    Args:
+        path (str): Directory to delete.
+        workers (int): Files deleted at the same time. Defaults to 4. os.pwrite and fsync release the GIL, so threads overlap the I/O.
+        passes, chunk_size, progress, trim: See _secure_delete_file.
+
+    Returns:
+        dict: {"path", "files", "deleted", "failed", "bytes", "trimmed", "errors": {file: message}}
+    '''
+    _passes(passes)
+    if workers is not None and workers < 1:
+        raise ValueError(f"workers must be positive int, not {workers}")
+    path = os.path.abspath(path)
+    if os.path.islink(path) or not os.path.isdir(path):
+        raise ValueError(f"{path} is not a directory")
+
+    files = []
+    others = []
+    directories = []
+    for root, names, file_names in os.walk(path):
+        directories.append(root)
+        for name in names:
+            if os.path.islink(os.path.join(root, name)):
+                others.append(os.path.join(root, name))
+        for name in file_names:
+            file_path = os.path.join(root, name)
+            (files if os.path.isfile(file_path) and not os.path.islink(file_path) else others).append(file_path)
+
+    def delete(file_path):
+        try:
+            return file_path, _secure_delete_file(file_path, passes, chunk_size, progress, trim), None
+        except Exception as e:
+            return file_path, None, str(e)
+
+    result = {"path": path, "files": len(files), "deleted": 0, "failed": 0, "bytes": 0, "trimmed": 0, "errors": {}}
+    with ThreadPoolExecutor(max_workers=workers or 4, thread_name_prefix="statz-securedelete") as pool:
+        for file_path, deleted, error in pool.map(delete, files):
+            if error is not None:
+                result["failed"] += 1
+                result["errors"][file_path] = error
+                continue
+            result["deleted"] += 1
+            result["bytes"] += deleted["size"]
+            result["trimmed"] += deleted["trimmed"]
+
+    # symlinks and special files are removed, never followed or written, so nothing outside the tree is overwritten
+    for other in others:
+        try:
+            os.remove(other)
+        except Exception as e:
+            result["errors"][other] = str(e)
+    for directory in reversed(directories):
+        try:
+            os.rmdir(directory)
+        except OSError as e:
+            if not result["failed"]:
+                result["errors"][directory] = str(e)
+    return result
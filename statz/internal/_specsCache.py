@@ -0,0 +1,169 @@
+'''
+Cache for the parts of get_system_specs that do not change while a machine is running.
+Static components (CPU model, core counts, memory layout, OS release...) are kept in memory and,
+optionally, in a JSON file keyed by hostname and boot ID so they survive across runs until the next reboot.
+Volatile components (disk free space, battery...) are always fetched again.
+'''
+
+import copy
+import json
+import os
+import platform
+import threading
+
+import psutil
+
+# Components of the specs list that are safe to cache, per platform
+STATIC_COMPONENTS = {
+    "Linux": {"os", "cpu", "ram"},
+    "Darwin": {"os", "cpu", "ram"},
+    "Windows": {"os", "cpu", "gpu", "ram", "disk"},
+}
+
+_memory_cache = {}
+_cache_file = None
+_cache_file_loaded = False
+_lock = threading.Lock()
+
+def _default_cache_path():
+    '''Return the default on-disk cache location for this platform.'''
+    if platform.system() == "Windows":
+        base = os.environ.get("LOCALAPPDATA") or os.path.expanduser("~")
+    elif platform.system() == "Darwin":
+        base = os.path.expanduser("~/Library/Caches")
+    else:
+        base = os.environ.get("XDG_CACHE_HOME") or os.path.expanduser("~/.cache")
+    return os.path.join(base, "statz", "specs.json")
+
+def _boot_key():
+    '''
+    Identify the current boot of this machine, so a cache file written before a reboot
+    (or on another host sharing the same home directory) is ignored.
+    '''
+    boot_id = None
+    try:
+        with open("/proc/sys/kernel/random/boot_id", "r") as f:
+            boot_id = f.read().strip()
+    except:
+        try:
+            boot_id = str(int(psutil.boot_time()))
+        except:
+            boot_id = "unknown"
+    return f"{platform.node()}|{boot_id}"
+
+def _is_cacheable(value):
+    '''Only cache components that were read successfully.'''
+    if value is None:
+        return False
+    if isinstance(value, dict):
+        return "Error" not in value.values() and "error" not in value
+    if isinstance(value, list):
+        return all(_is_cacheable(item) for item in value)
+    return True
+
+def _load_cache_file():
+    '''
+    Merge the cache file into the in-memory cache.
+
+    Returns:
+        bool: True if memory holds components the file does not, so the file should be rewritten.
+    '''
+    global _cache_file_loaded
+    _cache_file_loaded = True
+    file_specs = {}
+    try:
+        with open(_cache_file, "r") as f:
+            data = json.load(f)
+        if data.get("key") == _boot_key():
+            file_specs = data.get("specs", {})
+    except:
+        pass
+
+    stale = any(component not in file_specs for component in _memory_cache)
+    for component, value in file_specs.items():
+        _memory_cache.setdefault(component, value)
+    return stale
+
+def _save_cache_file():
+    try:
+        os.makedirs(os.path.dirname(_cache_file), exist_ok=True)
+        temp_path = f"{_cache_file}.{os.getpid()}.tmp"
+        with open(temp_path, "w") as f:
+            json.dump({"key": _boot_key(), "specs": _memory_cache}, f)
+        # replace in one step so readers never see a half-written file
+        os.replace(temp_path, _cache_file)
+    except:
+        pass
+
+def _set_cache_file(path):
+    '''
+    Enable (or with None, disable) the on-disk specs cache.
+
+    Args:
+        path (str): Path of the JSON cache file. "default" uses the per-user cache directory.
+    '''
+    global _cache_file, _cache_file_loaded
+    with _lock:
+        _cache_file = _default_cache_path() if path == "default" else path
+        _cache_file_loaded = False
+
+def _clear_cache():
+    '''Forget every cached component, in memory and on disk.'''
+    global _cache_file_loaded
+    with _lock:
+        _memory_cache.clear()
+        _cache_file_loaded = True
+        if _cache_file:
+            try:
+                os.remove(_cache_file)
+            except:
+                pass
+
+def _cached_specs(fetch, components, requested, use_cache=True):
+    '''
+    Build a specs list, fetching only the components that are not already cached.
+
+    Args:
+        fetch (callable): Platform specs function that takes one bool per component and returns a list aligned with components.
+        components (list): Names of each position in the specs list, e.g. ["os", "cpu", "ram", "disk"].
+        requested (list): One bool per component, whether the caller asked for it.
+        use_cache (bool): If False, fetch everything and refresh the cache with the result.
+
+    Returns:
+        list: The specs list, in the same shape the platform function returns.
+    '''
+    static = STATIC_COMPONENTS.get(platform.system(), set())
+
+    with _lock:
+        if _cache_file and not _cache_file_loaded and _load_cache_file():
+            _save_cache_file()
+
+        result = [None] * len(components)
+        to_fetch = [False] * len(components)
+        for i, (component, wanted) in enumerate(zip(components, requested)):
+            if not wanted:
+                continue
+            if use_cache and component in static and component in _memory_cache:
+                result[i] = copy.deepcopy(_memory_cache[component])
+            else:
+                to_fetch[i] = True
+
+    if not any(to_fetch):
+        return result
+
+    fetched = fetch(*to_fetch)
+
+    changed = False
+    with _lock:
+        for i, component in enumerate(components):
+            if not to_fetch[i]:
+                continue
+            result[i] = fetched[i]
+            if component in static and _is_cacheable(fetched[i]):
+                _memory_cache[component] = copy.deepcopy(fetched[i])
+                changed = True
+
+        if changed and _cache_file:
+            _save_cache_file()
+
+    return result
@@ -0,0 +1,191 @@
+'''
+Internet throughput test built on speedtest-cli.
+Adds thread/duration control, reuses the chosen server between calls, samples the interface
+byte counters once per second while each direction runs, and measures jitter and loss with a
+series of latency probes against the chosen server.
+'''
+
+import math
+import os
+import threading
+import time
+import urllib.request
+
+import psutil
+import speedtest
+
+_pinned_server = None
+_server_lock = threading.Lock()
+
+class _ThroughputSampler:
+    '''
+    Reads one network byte counter once per interval on a worker thread while a test phase runs.
+
+    Args:
+        counter (str): "bytes_recv" for downloads or "bytes_sent" for uploads.
+        interval (float): Seconds between samples. Defaults to 1.
+    '''
+    def __init__(self, counter, interval=1.0):
+        self.counter = counter
+        self.interval = interval
+        self.series = []
+        self.total_bytes = 0
+        self._stop_event = threading.Event()
+        self._thread = None
+
+    def _read(self):
+        return getattr(psutil.net_io_counters(), self.counter)
+
+    def __enter__(self):
+        self._first = self._read()
+        self._thread = threading.Thread(target=self._run, name="statz-speedtest-sampler", daemon=True)
+        self._thread.start()
+        return self
+
+    def __exit__(self, *exc):
+        self._stop_event.set()
+        self._thread.join()
+        return False
+
+    def _run(self):
+        previous, previous_time = self._first, time.monotonic()
+        while True:
+            stopped = self._stop_event.wait(self.interval)
+            current, current_time = self._read(), time.monotonic()
+            elapsed = current_time - previous_time
+            # keep the last partial interval only if it is long enough to mean something
+            if not stopped or elapsed >= self.interval / 4:
+                self.series.append((current - previous) * 8 / 1_000_000 / elapsed)
+            previous, previous_time = current, current_time
+            if stopped:
+                self.total_bytes = current - self._first
+                return
+
+def _latency_url(server, secure=True):
+    url = os.path.dirname(server["url"]) + "/latency.txt"
+    if secure and url.startswith("http:"):
+        url = "https:" + url[len("http:"):]
+    return url
+
+def _measure_latency(server, samples=10, timeout=2.0, secure=True):
+    '''
+    Time a series of small requests to the server.
+
+    Returns:
+        tuple: (average ms, jitter ms, loss percent). Jitter is the mean difference between consecutive
+        round trips and loss is the share of probes that failed or timed out. Both are None when no probe answered.
+    '''
+    url = _latency_url(server, secure)
+    round_trips = []
+    for i in range(samples):
+        start = time.perf_counter()
+        try:
+            # the query string keeps caches along the way from answering
+            with urllib.request.urlopen(f"{url}?x={time.time()}.{i}", timeout=timeout) as response:
+                response.read()
+            round_trips.append((time.perf_counter() - start) * 1000)
+        except:
+            continue
+
+    loss = (samples - len(round_trips)) / samples * 100 if samples else 0.0
+    if not round_trips:
+        return None, None, loss
+    jitter = sum(abs(b - a) for a, b in zip(round_trips, round_trips[1:])) / (len(round_trips) - 1) if len(round_trips) > 1 else 0.0
+    return sum(round_trips) / len(round_trips), jitter, loss
+
+def _select_server(st, server_id=None, refresh_server=False):
+    '''
+    Pick the test server, reusing the one chosen by an earlier call unless asked otherwise.
+
+    The full server list download and latency ranking only run on the first call (or with refresh_server),
+    later calls only re-measure the pinned server's latency.
+    '''
+    global _pinned_server
+    with _server_lock:
+        pinned = _pinned_server
+        if server_id is not None and (pinned is None or str(pinned.get("id")) != str(server_id)):
+            pinned = None
+        if refresh_server:
+            pinned = None
+
+        if pinned is None:
+            st.get_servers([int(server_id)] if server_id is not None else None)
+            pinned = st.get_best_server()
+        else:
+            st.get_best_server([pinned])
+
+        _pinned_server = pinned
+        return pinned
+
+def _configure(st, threads=None, duration=None):
+    '''
+    Apply the thread count and per-direction duration to a Speedtest instance.
+
+    Returns:
+        dict: { "download": threads, "upload": threads } actually used.
+    '''
+    config = st.config
+    if duration is not None:
+        config["length"]["download"] = duration
+        config["length"]["upload"] = duration
+
+    used = dict(config.get("threads", {}))
+    if threads is not None:
+        for direction in ("download", "upload"):
+            default = used.get(direction) or threads
+            # keep the library's number of requests per thread, otherwise extra threads go idle on fast links
+            scale = math.ceil(threads / default)
+            if scale > 1:
+                config["counts"][direction] = config["counts"][direction] * scale
+                if direction == "upload" and "upload_max" in config:
+                    config["upload_max"] = config["upload_max"] * scale
+            used[direction] = threads
+    return used
+
+def _run_speed_test(threads=None, duration=None, server_id=None, refresh_server=False, latency_samples=10, sample_interval=1.0):
+    '''
+    Run a full download, upload and latency test.
+
+    Returns:
+        dict: download/upload in Mbps, ping/jitter in ms, probe_loss in percent, the server used, the thread counts,
+        and download_series/upload_series with the interface throughput in Mbps once per sample_interval.
+    '''
+    st = speedtest.Speedtest(secure=True)
+    used_threads = _configure(st, threads, duration)
+    server = _select_server(st, server_id, refresh_server)
+
+    with _ThroughputSampler("bytes_recv", sample_interval) as download_sampler:
+        download_speed = st.download(threads=threads) / 1_000_000
+    with _ThroughputSampler("bytes_sent", sample_interval) as upload_sampler:
+        upload_speed = st.upload(threads=threads) / 1_000_000
+
+    ping, jitter, loss = _measure_latency(server, latency_samples) if latency_samples else (None, None, None)
+    if ping is None:
+        ping = st.results.ping
+
+    return {
+        "download": download_speed,
+        "upload": upload_speed,
+        "ping": ping,
+        "jitter": jitter,
+        "probe_loss": loss,
+        "server": {
+            "id": server.get("id"),
+            "name": server.get("name"),
+            "sponsor": server.get("sponsor"),
+            "country": server.get("country"),
+            "host": server.get("host"),
+            "distance_km": server.get("d"),
+        },
+        "threads": used_threads,
+        "download_series": download_sampler.series,
+        "upload_series": upload_sampler.series,
+        "bytes_received": download_sampler.total_bytes,
+        "bytes_sent": upload_sampler.total_bytes,
+        "timestamp": time.time(),
+    }
+
+def _reset_pinned_server():
+    global _pinned_server
+    with _server_lock:
+        _pinned_server = None
@@ -0,0 +1,126 @@
+'''
+Start-up benchmark.
+Runs the statz CLI in fresh interpreters, the way cron jobs and scripts pay for it, and times every
+run from process start to exit. A bare `python -c pass` is timed the same way, so the part statz
+adds on top of the interpreter can be told apart from the interpreter itself. `python -X importtime`
+also shows which modules the CLI imports and which of them are the slowest.
+'''
+
+import math
+import os
+import subprocess
+import sys
+import time
+
+try:
+    from ._benchmarkRunner import _percentile
+except ImportError:
+    from _benchmarkRunner import _percentile
+
+# what the `statz` console script runs
+LAUNCHER = "import sys; from statz.cli import main; sys.exit(main())"
+
+COMMANDS = {
+    "version": ["--version"],
+    "usage_json": ["--usage", "--ram", "--json"],
+}
+
+# cold start that scores 100
+TARGET_MS = 50.0
+
+def _environment():
+    '''The child processes import this copy of statz, also when it is not the installed one.'''
+    package_root = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+    path = os.environ.get("PYTHONPATH")
+    return dict(os.environ, PYTHONPATH=package_root + (os.pathsep + path if path else ""))
+
+def _time_process(arguments, environment):
+    '''Wall-clock milliseconds from starting a Python process with arguments until it exits.'''
+    start = time.perf_counter()
+    subprocess.run([sys.executable] + arguments, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, env=environment, check=True)
+    return (time.perf_counter() - start) * 1000
+
+def _import_profile(environment, top=10):
+    '''
+    Import `statz.cli` with -X importtime.
+
+    Returns:
+        tuple: (cumulative milliseconds of statz.cli, [(module, self milliseconds)] of the `top` slowest modules)
+    '''
+    output = subprocess.run([sys.executable, "-X", "importtime", "-c", "import statz.cli"],
+                            stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, env=environment, text=True, check=True).stderr
+    total = None
+    modules = []
+    for line in output.splitlines():
+        # "import time:   self [us] | cumulative | imported package"
+        fields = line.split("|")
+        if len(fields) != 3 or not line.startswith("import time:"):
+            continue
+        try:
+            own = int(fields[0].rsplit(":", 1)[1])
+            cumulative = int(fields[1])
+        except ValueError:
+            continue
+        name = fields[2].strip()
+        modules.append((name, round(own / 1000, 2)))
+        if name == "statz.cli":
+            total = round(cumulative / 1000, 2)
+    modules.sort(key=lambda module: module[1], reverse=True)
+    return total, modules[:top]
+
+def _summary(samples, interpreter_ms):
+    median = _percentile(samples, 50)
+    return {
+        "median_ms": round(median, 2),
+        "p90_ms": round(_percentile(samples, 90), 2),
+        "min_ms": round(min(samples), 2),
+        "overhead_ms": round(median - interpreter_ms, 2),
+        "runs": len(samples),
+    }
+
+def _startup_benchmark(runs=10, commands=None):
+    '''
+    Time CLI start-up in fresh interpreters.
+
+    Args:
+        runs (int): Processes started per command. Defaults to 10.
+        commands (dict): { name: CLI arguments }. Defaults to `statz --version` and `statz --usage --ram --json`.
+
+    Returns:
+        dict: {
+            "execution_time", "python": interpreter path, "interpreter_ms": median of a bare `python -c pass`,
+            "commands": { name: {"arguments", "median_ms", "p90_ms", "min_ms", "overhead_ms" (over the bare interpreter), "runs"} },
+            "import_ms": cumulative import time of statz.cli, "slowest_imports": [(module, self ms)],
+            "target_ms": 50, "score": geometric mean of target_ms / median_ms, times 100 (higher is better)
+        }
+    '''
+    if runs < 1:
+        raise ValueError(f"runs must be positive int, not {runs}")
+    commands = commands or COMMANDS
+    environment = _environment()
+    start_time = time.time()
+
+    # one untimed start of each, so the first timed run does not also compile the bytecode cache
+    _time_process(["-c", "pass"], environment)
+    for arguments in commands.values():
+        _time_process(["-c", LAUNCHER] + list(arguments), environment)
+
+    interpreter_ms = _percentile([_time_process(["-c", "pass"], environment) for _ in range(runs)], 50)
+    results = {}
+    for name, arguments in commands.items():
+        samples = [_time_process(["-c", LAUNCHER] + list(arguments), environment) for _ in range(runs)]
+        results[name] = {"arguments": " ".join(arguments), **_summary(samples, interpreter_ms)}
+
+    import_ms, slowest = _import_profile(environment)
+    # faster than the target scores above 100, like the throughput scores of the other benchmarks
+    ratios = [TARGET_MS / result["median_ms"] for result in results.values() if result["median_ms"] > 0]
+    return {
+        "execution_time": round(time.time() - start_time, 3),
+        "python": os.path.realpath(sys.executable),
+        "interpreter_ms": round(interpreter_ms, 2),
+        "commands": results,
+        "import_ms": import_ms,
+        "slowest_imports": slowest,
+        "target_ms": TARGET_MS,
+        "score": round(math.exp(sum(math.log(ratio) for ratio in ratios) / len(ratios)) * 100, 1) if ratios else 0.0,
+    }
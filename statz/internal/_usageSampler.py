@@ -0,0 +1,223 @@
+'''
+Background usage sampler.
+Keeps the latest CPU, RAM, disk I/O, network, battery and GPU values in a ring buffer so callers
+can read usage data without blocking on a sampling window of their own.
+'''
+
+import threading
+import time
+from collections import deque
+
+try:
+    from ._crossPlatform import _take_usage_snapshot, _usage_from_snapshots
+    from ._historyStore import _get_history
+except ImportError:
+    from _crossPlatform import _take_usage_snapshot, _usage_from_snapshots
+    from _historyStore import _get_history
+
+class UsageSample(list):
+    '''
+    A usage list in the same format _get_usage returns, with the time it was sampled attached.
+
+    Attributes:
+        timestamp (float): Wall-clock time (time.time()) the sample window ended.
+        interval (float): Length of the window the rates were measured over, in seconds.
+        age (float): Seconds since the sample was taken.
+    '''
+    def __init__(self, usage, timestamp, monotonic, interval):
+        super().__init__(usage)
+        self.timestamp = timestamp
+        self.interval = interval
+        self._monotonic = monotonic
+
+    @property
+    def age(self):
+        return time.monotonic() - self._monotonic
+
+class _UsageSampler:
+    '''
+    Samples every usage component on a background thread at a fixed interval.
+
+    Each tick reuses the previous tick's counters as its "before" snapshot, so the thread only
+    reads counters once per interval and never sleeps inside a measurement.
+    '''
+    def __init__(self, interval=1.0, history=60):
+        if interval <= 0:
+            raise ValueError(f"interval must be positive, not {interval}")
+        if history < 1:
+            raise ValueError(f"history must be positive int, not {history}")
+
+        self.interval = interval
+        self._samples = deque(maxlen=int(history))
+        self._condition = threading.Condition()
+        self._stop_event = threading.Event()
+        self._thread = None
+
+    @property
+    def is_running(self):
+        return self._thread is not None and self._thread.is_alive()
+
+    def start(self):
+        if self.is_running:
+            return
+        self._stop_event.clear()
+        self._thread = threading.Thread(target=self._run, name="statz-usage-sampler", daemon=True)
+        self._thread.start()
+
+    def stop(self):
+        self._stop_event.set()
+        if self._thread is not None:
+            self._thread.join()
+            self._thread = None
+        with self._condition:
+            self._condition.notify_all()
+
+    def latest(self, wait=True, timeout=None):
+        '''
+        Get the newest sample.
+
+        Args:
+            wait (bool): If no sample exists yet, block until the first one arrives.
+            timeout (float): Maximum seconds to wait. Defaults to a few sampling intervals.
+
+        Returns:
+            UsageSample or None: The newest sample, or None if none is available.
+        '''
+        with self._condition:
+            if not self._samples and wait:
+                if timeout is None:
+                    timeout = self.interval * 3 + 1
+                self._condition.wait_for(lambda: self._samples or not self.is_running, timeout)
+            return self._samples[-1] if self._samples else None
+
+    def wait_next(self, previous=None, timeout=None):
+        '''
+        Block until a sample newer than `previous` is available.
+
+        Args:
+            previous (UsageSample): The last sample the caller has seen, or None to wait for any sample.
+            timeout (float): Maximum seconds to wait. Defaults to a few sampling intervals.
+
+        Returns:
+            UsageSample or None: The newest sample (which is `previous` again on timeout), or None if none is available.
+        '''
+        with self._condition:
+            if timeout is None:
+                timeout = self.interval * 3 + 1
+            self._condition.wait_for(lambda: (self._samples and self._samples[-1] is not previous) or not self.is_running, timeout)
+            return self._samples[-1] if self._samples else None
+
+    def history(self):
+        '''
+        Get every sample currently held in the ring buffer, oldest first.
+
+        Returns:
+            list: List of UsageSample objects.
+        '''
+        with self._condition:
+            return list(self._samples)
+
+    def _run(self):
+        before = None
+        while True:
+            try:
+                before = self._sample(before)
+            except Exception:
+                # the exporter, dashboard and cached calls depend on this thread, so a failing collector
+                # only costs this sample; the next one starts from a fresh snapshot
+                before = None
+            if self._stop_event.wait(self.interval):
+                break
+
+    def _sample(self, before):
+        '''Take one snapshot and publish the sample measured since `before`. Returns the new snapshot.'''
+        after = _take_usage_snapshot(True, True, True, True)
+        if before is None:
+            return after
+        usage = _usage_from_snapshots(before, after, True, True, True, True, True, True, True)
+        sample = UsageSample(usage, time.time(), time.monotonic(), self.interval)
+
+        with self._condition:
+            self._samples.append(sample)
+            self._condition.notify_all()
+
+        history = _get_history()
+        if history is not None:
+            try:
+                history.append(sample.timestamp, sample)
+            except ValueError:
+                # the wall clock stepped backwards (NTP, manual change); the history is ordered by time,
+                # so samples stay out of it until the clock passes its newest sample again
+                pass
+        return after
+
+_sampler = None
+_sampler_lock = threading.Lock()
+
+def _start_sampler(interval=1.0, history=60):
+    '''
+    Start the shared background sampler, or return the running one.
+    A running sampler with a different interval or history size is replaced.
+    '''
+    global _sampler
+    with _sampler_lock:
+        if _sampler is not None and _sampler.is_running:
+            if _sampler.interval == interval and _sampler._samples.maxlen == history:
+                return _sampler
+            _sampler.stop()
+
+        _sampler = _UsageSampler(interval, history)
+        _sampler.start()
+        return _sampler
+
+def _stop_sampler():
+    '''Stop the shared background sampler if it is running.'''
+    global _sampler
+    with _sampler_lock:
+        if _sampler is not None:
+            _sampler.stop()
+            _sampler = None
+
+def _get_sampler():
+    '''Return the shared background sampler if it is running, otherwise None.'''
+    sampler = _sampler
+    if sampler is not None and sampler.is_running:
+        return sampler
+    return None
+
+def _select_components(sample, get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu=False, get_gpu=False):
+    '''
+    Blank out the components of a sample that were not requested, matching the shape _get_usage returns.
+    '''
+    cpu_usage = None
+    if (get_cpu or get_totcpu) and sample[0] is not None:
+        cpu_usage = {}
+        for key, value in sample[0].items():
+            is_core = key.startswith("core")
+            if (is_core and get_cpu) or (not is_core and get_totcpu):
+                cpu_usage[key] = value
+
+    usage = [
+        cpu_usage,
+        sample[1] if get_ram else None,
+        sample[2] if get_disk else None,
+        sample[3] if get_network else None,
+        sample[4] if get_battery else None
+    ]
+    if get_gpu:
+        usage.append(sample[5] if len(sample) > 5 else None)
+    return UsageSample(usage, sample.timestamp, sample._monotonic, sample.interval)
+
+def _get_cached_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu=False, get_gpu=False):
+    '''
+    Get usage data from the shared background sampler, starting it first if needed.
+
+    Returns:
+        UsageSample: The newest sample, filtered to the requested components.
+        Only the very first call after starting the sampler waits for a sampling interval.
+    '''
+    sampler = _get_sampler() or _start_sampler()
+    sample = sampler.latest()
+    if sample is None:
+        return UsageSample([None] * (6 if get_gpu else 5), time.time(), time.monotonic(), sampler.interval)
+    return _select_components(sample, get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu, get_gpu)
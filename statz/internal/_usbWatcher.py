@@ -0,0 +1,469 @@
+'''
+USB hotplug watcher.
+Builds the USB inventory once and then keeps it current from the operating system's hotplug events,
+so device queries are answered from memory instead of rescanning with lsusb, system_profiler or WMI:
+- Linux: kernel uevents on a NETLINK_KOBJECT_UEVENT socket. Every add/remove updates one device from sysfs.
+- macOS: IOKit first-match and terminate notifications for USB devices. A burst of notifications triggers one
+  system_profiler rescan on the watcher thread.
+- Windows: Win32_DeviceChangeEvent WMI events from a long-running PowerShell. A burst triggers one rescan.
+When the event source is not available (no netlink in a container, no IOKit, no PowerShell) the watcher
+polls instead: on Linux by diffing the sysfs device list, elsewhere with a full rescan.
+'''
+
+import os
+import select
+import socket
+import subprocess
+import threading
+
+try:
+    from . import _connectedDevicesMonitoring as _devices
+except ImportError:
+    import _connectedDevicesMonitoring as _devices
+
+NETLINK_KOBJECT_UEVENT = 15
+# the kernel's multicast group, as opposed to group 2 where udevd re-broadcasts in its own format
+UEVENT_KERNEL_GROUP = 1
+
+POWERSHELL_EVENT_SCRIPT = (
+    "Register-WmiEvent -Query 'SELECT * FROM Win32_DeviceChangeEvent WHERE EventType = 2 OR EventType = 3' "
+    "-SourceIdentifier statzUsb | Out-Null; "
+    "while ($true) { $e = Wait-Event -SourceIdentifier statzUsb; "
+    "[Console]::WriteLine($e.SourceEventArgs.NewEvent.EventType); [Console]::Out.Flush(); "
+    "Remove-Event -EventIdentifier $e.EventIdentifier }"
+)
+
+def _sysfs_device_id(device_dir):
+    '''device_id that parse_sysfs_device gives the device in /sys/bus/usb/devices/<device_dir>.'''
+    return f"USB\\{device_dir}"
+
+def _parse_uevent(message):
+    '''
+    Split a kernel uevent ("add@/devices/...\\0ACTION=add\\0DEVPATH=...\\0...") into its environment.
+
+    Returns:
+        dict or None: The KEY=value pairs, or None for messages that are not kernel uevents.
+    '''
+    if message.startswith(b"libudev"):
+        return None
+    fields = message.split(b"\0")
+    if b"@" not in fields[0]:
+        return None
+    environment = {}
+    for field in fields[1:]:
+        key, separator, value = field.partition(b"=")
+        if separator:
+            environment[key.decode("ascii", "replace")] = value.decode("utf-8", "replace")
+    return environment
+
+class _UsbWatcher:
+    '''
+    Keeps an inventory of USB devices current from hotplug events.
+
+    Args:
+        callback (callable): Called with ("add" or "remove", device dict) for every change after the first scan.
+        poll_interval (float): Seconds between rescans when no event source is available. Defaults to 5.
+        debounce (float): Seconds to wait after an event before rescanning (macOS and Windows), so one
+                          plug-in that announces several interfaces causes one rescan. Defaults to 0.5.
+    '''
+    def __init__(self, callback=None, poll_interval=5.0, debounce=0.5):
+        if poll_interval <= 0:
+            raise ValueError(f"poll_interval must be positive, not {poll_interval}")
+        self.poll_interval = poll_interval
+        self.debounce = debounce
+        self.method_used = None
+        self.changes = 0
+        self._callbacks = [callback] if callback else []
+        self._index = _devices.DeviceIndex()
+        self._lock = threading.RLock()
+        self._stop_event = threading.Event()
+        self._dirty = threading.Event()
+        self._event_driven = False
+        self._threads = []
+        self._process = None
+
+    @property
+    def is_running(self):
+        return any(thread.is_alive() for thread in self._threads)
+
+    def subscribe(self, callback):
+        '''Also call callback(action, device) for every change.'''
+        with self._lock:
+            self._callbacks.append(callback)
+
+    def start(self):
+        '''Scan once, then start following hotplug events. Returns once the first inventory is available.'''
+        if self.is_running:
+            return
+        self._stop_event.clear()
+
+        if _devices.CURRENT_OS == "linux":
+            sock = self._open_netlink()
+            # sysfs names match the device paths in the uevents, lsusb's would not
+            self._replace(_devices.get_usb_devices_sysfs(), notify=False)
+            if sock is not None:
+                self.method_used = "Linux netlink/sysfs"
+                self._spawn(self._run_netlink, sock)
+            else:
+                self.method_used = "Linux sysfs polling"
+                self._spawn(self._run_sysfs_polling)
+            return
+
+        devices, method_used = _devices.scan_usb_devices()
+        self._replace(devices, notify=False)
+        if _devices.CURRENT_OS == "darwin" and self._start_iokit():
+            self.method_used = f"{method_used}, IOKit notifications"
+            self._event_driven = True
+        elif _devices.CURRENT_OS == "windows" and self._start_wmi_events():
+            self.method_used = f"{method_used}, WMI device events"
+            self._event_driven = True
+        else:
+            self.method_used = f"{method_used} polling"
+        self._spawn(self._run_rescans)
+
+    def stop(self):
+        self._stop_event.set()
+        self._dirty.set()
+        if self._process is not None:
+            try:
+                self._process.kill()
+            except:
+                pass
+            self._process = None
+        for thread in self._threads:
+            thread.join()
+        self._threads = []
+
+    def _spawn(self, target, *args):
+        thread = threading.Thread(target=target, args=args, name="statz-usb-watcher", daemon=True)
+        thread.start()
+        self._threads.append(thread)
+
+    # ---------- inventory ----------
+
+    def _add(self, device, notify=True):
+        with self._lock:
+            previous = self._index.add(device)
+        if notify and previous is None:
+            self._notify("add", device)
+
+    def _remove(self, key, notify=True):
+        with self._lock:
+            device = self._index.remove(key)
+        if device is None:
+            return
+        if notify:
+            self._notify("remove", device)
+
+    def _replace(self, devices, notify=True):
+        '''Make the inventory match a full scan, reporting what was added and removed.'''
+        current = {}
+        for device in devices:
+            current.setdefault(device.get('device_id', 'Unknown'), device)
+        with self._lock:
+            removed = [key for key in self._index.ids() if key not in current]
+        for key in removed:
+            self._remove(key, notify)
+        for device in current.values():
+            self._add(device, notify)
+
+    def _notify(self, action, device):
+        self.changes += 1
+        with self._lock:
+            callbacks = list(self._callbacks)
+        for callback in callbacks:
+            try:
+                callback(action, device)
+            except:
+                pass
+
+    def devices(self):
+        '''Every device in the inventory, sorted by name.'''
+        with self._lock:
+            return list(self._index.devices())
+
+    def snapshot(self):
+        '''The inventory in the format of get_connected_usb_devices.'''
+        with self._lock:
+            devices = self.devices()
+            summary = self._index.summary()
+        return {
+            'total_usb_devices': len(devices),
+            'devices': devices,
+            'summary': summary,
+            'method_used': self.method_used,
+            'platform': _devices.CURRENT_OS
+        }
+
+    def find_by_name(self, device_name):
+        '''First device (by name order) whose name contains device_name, see get_connected_device_by_name.'''
+        with self._lock:
+            return self._index.by_name(device_name)
+
+    def filter_by_type(self, device_type):
+        '''Devices whose type contains device_type, see get_connected_devices_by_type.'''
+        with self._lock:
+            devices = self._index.by_type(device_type)
+        return {
+            'device_type': device_type,
+            'count': len(devices),
+            'devices': devices,
+            'platform': _devices.CURRENT_OS
+        }
+
+    def filter_by_usb_id(self, vendor_id, product_id=None):
+        '''Devices with a vendor id and optionally product id, see get_connected_devices_by_id.'''
+        with self._lock:
+            devices = self._index.by_usb_id(vendor_id, product_id)
+        return {
+            'vendor_id': vendor_id,
+            'product_id': product_id,
+            'count': len(devices),
+            'devices': devices,
+            'platform': _devices.CURRENT_OS
+        }
+
+    # ---------- Linux ----------
+
+    def _open_netlink(self):
+        try:
+            sock = socket.socket(socket.AF_NETLINK, socket.SOCK_DGRAM, NETLINK_KOBJECT_UEVENT)
+            try:
+                sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1024 * 1024)
+            except OSError:
+                pass
+            sock.bind((0, UEVENT_KERNEL_GROUP))
+            return sock
+        except (AttributeError, OSError):
+            return None
+
+    def _handle_uevent(self, environment):
+        if environment.get("SUBSYSTEM") != "usb":
+            return
+        if environment.get("DEVTYPE") == "usb_interface":
+            # the device's "add" arrives before its interface directories exist, so a composite
+            # device is classified from its name until its interfaces show up; parse it again now
+            if environment.get("ACTION") == "add":
+                self._reparse(os.path.dirname(environment.get("DEVPATH", "")))
+            return
+        if environment.get("DEVTYPE") != "usb_device":
+            return
+        device_dir = os.path.basename(environment.get("DEVPATH", ""))
+        if not _devices.is_sysfs_usb_device(device_dir):
+            return
+
+        action = environment.get("ACTION")
+        if action == "add":
+            device = _devices.parse_sysfs_device(f"/sys{environment['DEVPATH']}", device_dir)
+            if device is not None:
+                self._add(device)
+        elif action == "remove":
+            self._remove(_sysfs_device_id(device_dir))
+
+    def _reparse(self, devpath):
+        '''Parse the usb_device at DEVPATH again and replace its inventory entry.'''
+        device_dir = os.path.basename(devpath)
+        if not _devices.is_sysfs_usb_device(device_dir):
+            return
+        with self._lock:
+            known = _sysfs_device_id(device_dir) in self._index
+        if not known:
+            # removed again already, or its own "remove" is still queued
+            return
+        device = _devices.parse_sysfs_device(f"/sys{devpath}", device_dir)
+        if device is not None:
+            self._add(device)
+
+    def _run_netlink(self, sock):
+        try:
+            while not self._stop_event.is_set():
+                readable, _, _ = select.select([sock], [], [], 0.5)
+                if not readable:
+                    continue
+                try:
+                    message = sock.recv(65536)
+                except OSError:
+                    # ENOBUFS: events were dropped, so the inventory may be stale
+                    self._replace(_devices.get_usb_devices_sysfs())
+                    continue
+                environment = _parse_uevent(message)
+                if environment is not None:
+                    self._handle_uevent(environment)
+        finally:
+            sock.close()
+
+    def _run_sysfs_polling(self):
+        known = self._sysfs_names()
+        while not self._stop_event.wait(self.poll_interval):
+            names = self._sysfs_names()
+            for device_dir in known - names:
+                self._remove(_sysfs_device_id(device_dir))
+            for device_dir in names - known:
+                device = _devices.parse_sysfs_device(os.path.join(_devices.SYSFS_USB_DEVICES, device_dir), device_dir)
+                if device is not None:
+                    self._add(device)
+            known = names
+
+    def _sysfs_names(self):
+        try:
+            return {name for name in os.listdir(_devices.SYSFS_USB_DEVICES) if _devices.is_sysfs_usb_device(name)}
+        except OSError:
+            return set()
+
+    # ---------- macOS and Windows ----------
+
+    def _run_rescans(self):
+        '''Rescan after each burst of events (or every poll_interval without an event source).'''
+        while not self._stop_event.is_set():
+            if self._event_driven:
+                if not self._dirty.wait(0.5):
+                    continue
+                if self._stop_event.wait(self.debounce):
+                    return
+                self._dirty.clear()
+            elif self._stop_event.wait(self.poll_interval):
+                return
+            try:
+                devices, _ = _devices.scan_usb_devices()
+                self._replace(devices)
+            except:
+                pass
+
+    def _start_iokit(self):
+        '''Register for USB device arrival and removal with IOKit on a run loop thread. Returns whether it worked.'''
+        registered = threading.Event()
+        state = {"ok": False}
+        self._spawn(self._run_iokit, registered, state)
+        registered.wait(5)
+        return state["ok"]
+
+    def _run_iokit(self, registered, state):
+        try:
+            import ctypes
+            import ctypes.util
+
+            iokit = ctypes.cdll.LoadLibrary(ctypes.util.find_library("IOKit"))
+            cf = ctypes.cdll.LoadLibrary(ctypes.util.find_library("CoreFoundation"))
+
+            callback_type = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_uint32)
+            iokit.IONotificationPortCreate.restype = ctypes.c_void_p
+            iokit.IONotificationPortCreate.argtypes = [ctypes.c_uint32]
+            iokit.IONotificationPortGetRunLoopSource.restype = ctypes.c_void_p
+            iokit.IONotificationPortGetRunLoopSource.argtypes = [ctypes.c_void_p]
+            iokit.IONotificationPortDestroy.argtypes = [ctypes.c_void_p]
+            iokit.IOServiceMatching.restype = ctypes.c_void_p
+            iokit.IOServiceMatching.argtypes = [ctypes.c_char_p]
+            iokit.IOServiceAddMatchingNotification.restype = ctypes.c_int
+            iokit.IOServiceAddMatchingNotification.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_void_p,
+                                                               callback_type, ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint32)]
+            iokit.IOIteratorNext.restype = ctypes.c_uint32
+            iokit.IOIteratorNext.argtypes = [ctypes.c_uint32]
+            iokit.IOObjectRelease.argtypes = [ctypes.c_uint32]
+            cf.CFRunLoopGetCurrent.restype = ctypes.c_void_p
+            cf.CFRunLoopAddSource.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
+            cf.CFRunLoopRunInMode.restype = ctypes.c_int32
+            cf.CFRunLoopRunInMode.argtypes = [ctypes.c_void_p, ctypes.c_double, ctypes.c_bool]
+            default_mode = ctypes.c_void_p.in_dll(cf, "kCFRunLoopDefaultMode")
+
+            def drain(iterator):
+                # the notification only re-arms once its iterator has been emptied
+                while True:
+                    service = iokit.IOIteratorNext(iterator)
+                    if not service:
+                        return
+                    iokit.IOObjectRelease(service)
+
+            def on_change(refcon, iterator):
+                drain(iterator)
+                self._dirty.set()
+
+            # kept referenced for as long as IOKit may call it
+            callback = callback_type(on_change)
+            port = iokit.IONotificationPortCreate(0)
+            cf.CFRunLoopAddSource(cf.CFRunLoopGetCurrent(), iokit.IONotificationPortGetRunLoopSource(port), default_mode)
+
+            iterators = []
+            for class_name in (b"IOUSBHostDevice", b"IOUSBDevice"):
+                for notification in (b"IOServiceFirstMatch", b"IOServiceTerminate"):
+                    iterator = ctypes.c_uint32()
+                    # each call consumes one reference to the matching dictionary
+                    matching = iokit.IOServiceMatching(class_name)
+                    if matching and iokit.IOServiceAddMatchingNotification(port, notification, matching, callback, None, ctypes.byref(iterator)) == 0:
+                        drain(iterator.value)
+                        iterators.append(iterator.value)
+                if iterators:
+                    break
+            if not iterators:
+                iokit.IONotificationPortDestroy(port)
+                return
+
+            state["ok"] = True
+            registered.set()
+            while not self._stop_event.is_set():
+                cf.CFRunLoopRunInMode(default_mode, 0.5, False)
+
+            for iterator in iterators:
+                iokit.IOObjectRelease(iterator)
+            iokit.IONotificationPortDestroy(port)
+        except:
+            pass
+        finally:
+            registered.set()
+
+    def _start_wmi_events(self):
+        '''Start a PowerShell that prints one line per device arrival or removal. Returns whether it worked.'''
+        try:
+            self._process = subprocess.Popen(["powershell", "-NoProfile", "-Command", POWERSHELL_EVENT_SCRIPT],
+                                             stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, stdin=subprocess.DEVNULL,
+                                             text=True, creationflags=getattr(subprocess, "CREATE_NO_WINDOW", 0))
+        except OSError:
+            self._process = None
+            return False
+        self._spawn(self._read_wmi_events, self._process)
+        return True
+
+    def _read_wmi_events(self, process):
+        for line in process.stdout:
+            if self._stop_event.is_set():
+                break
+            if line.strip():
+                self._dirty.set()
+        process.stdout.close()
+        if not self._stop_event.is_set():
+            # PowerShell went away (execution policy, killed...), keep the inventory current by polling
+            self.method_used = self.method_used.replace("WMI device events", "polling")
+            self._event_driven = False
+            self._dirty.set()
+
+_watcher = None
+_watcher_lock = threading.Lock()
+
+def _start_usb_watcher(callback=None, poll_interval=5.0):
+    '''
+    Start the shared USB watcher, or return the running one (adding callback to it).
+    '''
+    global _watcher
+    with _watcher_lock:
+        if _watcher is not None and _watcher.is_running:
+            if callback is not None:
+                _watcher.subscribe(callback)
+            return _watcher
+
+        _watcher = _UsbWatcher(callback, poll_interval)
+        _watcher.start()
+        return _watcher
+
+def _stop_usb_watcher():
+    '''Stop the shared USB watcher if it is running.'''
+    global _watcher
+    with _watcher_lock:
+        if _watcher is not None:
+            _watcher.stop()
+            _watcher = None
+
+def _get_usb_watcher():
+    '''Return the shared USB watcher if it is running, otherwise None.'''
+    watcher = _watcher
+    if watcher is not None and watcher.is_running:
+        return watcher
+    return None
@@ -1,16 +1,29 @@
 """
 Module containing network-related functions for Statz
 """
-import speedtest
-import socket
+# import like this so i can test it easily
+try:
+    from .internal._portScanner import _expand_targets, _iter_scan
+    from .internal._speedTest import _run_speed_test
+except:
+    from internal._portScanner import _expand_targets, _iter_scan
+    from internal._speedTest import _run_speed_test
 
 
-def internet_speed_test(roundResult=True):
+def internet_speed_test(roundResult=True, threads=None, duration=None, server_id=None, refresh_server=False, detailed=False):
     """
     Run an internet speed test using the speedtest-cli library.\n
 
+    The best server is only searched for on the first call and reused after that, so repeated tests
+    skip downloading and ranking the server list.
+
     Args:
      roundResult: whether or not to round the result. defaults to True.
+     threads (int): parallel connections per direction. defaults to the server's recommendation; raise it on fast links.
+     duration (float): seconds to run each of the download and upload tests. defaults to the server's setting.
+     server_id (int): test against this speedtest.net server ID instead of the closest one.
+     refresh_server (bool): search for the best server again instead of reusing the previous one. defaults to False.
+     detailed (bool): return a dict with the throughput time series, jitter and loss. defaults to False.
     
     ## Returns
      **download_speed**\n the download speed in mbps
@@ -18,47 +31,73 @@ def internet_speed_test(roundResult=True):
      **upload_speed**\n the upload speed in mbps
 
      **ping**\n the ping in ms
+
+     OR, with detailed=True, a dict:
+     {"download": mbps, "upload": mbps, "ping": ms, "jitter": ms, "probe_loss": percent,
+      "server": {"id", "name", "sponsor", "country", "host", "distance_km"}, "threads": {"download", "upload"},
+      "download_series": [mbps per second], "upload_series": [mbps per second], "bytes_received", "bytes_sent", "timestamp"}
+
+     The series are read from the network interface counters, so other traffic on the machine is included.
+     Jitter and probe_loss come from 10 HTTP latency requests to the server after the transfer tests. probe_loss is the
+     percentage of those requests that failed or timed out, not IP packet loss (TCP retransmits lost packets, so
+     only a badly broken connection shows up here).
     """
-    # set up the speedtest and get the best server and stuff
-    st = speedtest.Speedtest(secure=True)
+    results = _run_speed_test(threads, duration, server_id, refresh_server)
 
-    st.get_best_server()
+    if roundResult:
+        for key, digits in (("download", 2), ("upload", 2), ("ping", 1), ("jitter", 1), ("probe_loss", 1)):
+            if results[key] is not None:
+                results[key] = round(results[key], digits)
+        results["download_series"] = [round(value, 2) for value in results["download_series"]]
+        results["upload_series"] = [round(value, 2) for value in results["upload_series"]]
 
-    # run the tests
-    download_speed = st.download() / 1_000_000
-    upload_speed = st.upload() / 1_000_000
+    if detailed:
+        return results
+    return results["download"], results["upload"], results["ping"]
 
-    ping = st.results.ping
+def iter_open_ports(starting=1, ending=1024, targetIP="127.0.0.1", concurrency=256, timeout=1.0, adaptive=True):
+    """
+    Scan for open ports and yield each one as soon as it is found.
+    Args:
+     starting (int): Port to start scanning at. (default is 1)
+     ending (int): Last port to scan, inclusive. (default is 1024)
+     targetIP (str or list): IP, hostname or CIDR range such as "192.168.1.0/24", or a list of those, at most 65536 addresses in total. (default is 127.0.0.1)
+     concurrency (int): Maximum number of connection attempts in flight. (default is 256)
+     timeout (float): Seconds to wait for a port to answer. (default is 1)
+     adaptive (bool): Lower each host's timeout to a few round trip times once they are measured. (default is True)
+    Yields:
+     (host, port) (tuple): The IP and port of every open port, in the order they answer.
+    """
+    if starting < 1 or ending > 65535 or starting > ending:
+        raise ValueError(f"Invalid port range {starting}-{ending}")
 
-    # return the results
-    if roundResult:
-        return round(download_speed, 2), round(upload_speed, 2), round(ping, 1)
-    else:
-        return download_speed, upload_speed, ping
+    hosts = _expand_targets(targetIP)
+    return _iter_scan(hosts, range(starting, ending + 1), concurrency, timeout, adaptive)
 
-def scan_open_ports(starting=1, ending=1024, targetIP="127.0.0.1"):
+def scan_open_ports(starting=1, ending=1024, targetIP="127.0.0.1", concurrency=256, timeout=1.0, adaptive=True):
     """
     Scan to find all open ports on the targetIP.
     Args:
      starting (int): Port to start scanning at. (default is 1)
-     ending (int): Port to stop scanning at. (default is 1024)
-     targetIP (str): The target IP to scan. (default is 127.0.0.1)
+     ending (int): Last port to scan, inclusive. (default is 1024)
+     targetIP (str or list): IP, hostname or CIDR range such as "192.168.1.0/24", or a list of those, at most 65536 addresses in total. (default is 127.0.0.1)
+     concurrency (int): Maximum number of connection attempts in flight. (default is 256)
+     timeout (float): Seconds to wait for a port to answer. (default is 1)
+     adaptive (bool): Lower each host's timeout to a few round trip times once they are measured. (default is True)
     Returns:
-     open_ports (list): A list of all open ports found in the range on the target IP.
+     open_ports (list): A sorted list of all open ports found in the range, when targetIP is a single host.
+     open_ports (dict): { host: sorted list of open ports } for every scanned host, when targetIP is a range or list.
     """
+    hosts = _expand_targets(targetIP)
+    open_ports = {host: [] for host in hosts}
+    for host, port in iter_open_ports(starting, ending, hosts, concurrency, timeout, adaptive):
+        open_ports[host].append(port)
 
-    open_ports = []
-    for port in (starting, ending):
-        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-        sock.settimeout(1)
-
-        result = sock.connect_ex((targetIP, port))
-
-        if result == 0:
-            open_ports.append(port)
-        
-        sock.close()
+    for ports in open_ports.values():
+        ports.sort()
 
+    if isinstance(targetIP, str) and "/" not in targetIP:
+        return open_ports[hosts[0]]
     return open_ports
 
 
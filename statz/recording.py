@@ -0,0 +1,412 @@
+'''Binary usage recordings (.statz files).
+Long recordings are written as fixed-width binary records instead of JSON, and read back through
+a memory map so replaying or seeking by time does not parse the whole file.
+
+File layout (little endian):
+    header   32 bytes   magic "STATZREC", version, codec, metric count, record size, interval
+    schema   4 bytes length + metric names (UTF-8, one per line)
+    records  codec "none": back to back, each a float64 timestamp followed by one float32 per metric
+             otherwise:    chunks, each a 24 byte chunk header (payload length, record count,
+                           first and last timestamp) followed by the compressed records
+'''
+
+import mmap
+import os
+import struct
+import time
+import zlib
+from array import array
+
+# import like this so i can test it easily
+try:
+    from .internal._crossPlatform import _iter_usage
+    from .internal._historyStore import _flatten_usage
+except:
+    from internal._crossPlatform import _iter_usage
+    from internal._historyStore import _flatten_usage
+
+try:
+    from compression import zstd as _zstd  # Python 3.14+
+except ImportError:
+    try:
+        import zstandard as _zstd
+    except ImportError:
+        _zstd = None
+
+MAGIC = b"STATZREC"
+VERSION = 1
+HEADER = struct.Struct("<8sHHIId4x")
+SCHEMA_LENGTH = struct.Struct("<I")
+CHUNK_HEADER = struct.Struct("<IIdd")
+TIMESTAMP = struct.Struct("<d")
+
+CODECS = {"none": 0, "zlib": 1, "zstd": 2}
+CODEC_NAMES = {value: key for key, value in CODECS.items()}
+
+# records per compressed chunk
+CHUNK_RECORDS = 256
+
+def _record_struct(metric_count):
+    return struct.Struct(f"<d{metric_count}f")
+
+def _compress(codec, data):
+    if codec == CODECS["zlib"]:
+        return zlib.compress(data, 6)
+    if codec == CODECS["zstd"]:
+        if hasattr(_zstd, "ZstdCompressor"):
+            return _zstd.ZstdCompressor().compress(data)
+        return _zstd.compress(data)
+    return data
+
+def _decompress(codec, data):
+    if codec == CODECS["zlib"]:
+        return zlib.decompress(data)
+    if codec == CODECS["zstd"]:
+        if _zstd is None:
+            raise RuntimeError("This recording is zstd compressed; install the zstandard package to read it")
+        if hasattr(_zstd, "ZstdDecompressor"):
+            return _zstd.ZstdDecompressor().decompress(data)
+        return _zstd.decompress(data)
+    return data
+
+def _read_header(f):
+    '''
+    Read the header and schema of an open recording.
+
+    Returns:
+        tuple: (codec, metrics, interval, data_offset)
+    '''
+    header = f.read(HEADER.size)
+    if len(header) < HEADER.size:
+        raise ValueError("Not a statz recording (file too short)")
+    magic, version, codec, metric_count, record_size, interval = HEADER.unpack(header)
+    if magic != MAGIC:
+        raise ValueError("Not a statz recording (bad magic)")
+    if version != VERSION:
+        raise ValueError(f"Unsupported statz recording version {version}")
+    if codec not in CODEC_NAMES:
+        raise ValueError(f"Unknown compression codec {codec}")
+
+    (schema_length,) = SCHEMA_LENGTH.unpack(f.read(SCHEMA_LENGTH.size))
+    metrics = f.read(schema_length).decode("utf-8").split("\n") if schema_length else []
+    if len(metrics) != metric_count or record_size != _record_struct(metric_count).size:
+        raise ValueError("Corrupt statz recording (schema does not match header)")
+
+    return codec, metrics, interval, HEADER.size + SCHEMA_LENGTH.size + schema_length
+
+class RecordingWriter:
+    '''
+    Append-only writer for .statz recordings.
+
+    The metric schema is fixed when the file is created. Appending to an existing recording keeps its
+    schema and codec; metrics that are not in the schema are not recorded, and missing ones are NaN.
+
+    Args:
+        path (str): File to create or append to.
+        metrics (list): Metric names, used only when the file is created.
+        interval (float): Sampling interval stored in the header. Defaults to 1.
+        compression (str): "none", "zlib" or "zstd" (needs Python 3.14+ or the zstandard package).
+                           Used only when the file is created.
+    '''
+    def __init__(self, path, metrics, interval=1.0, compression="none"):
+        if compression not in CODECS:
+            raise ValueError(f"compression must be none, zlib or zstd, not {compression}")
+        if compression == "zstd" and _zstd is None:
+            raise RuntimeError("zstd compression needs Python 3.14+ or the zstandard package")
+
+        self.path = path
+        self._pending = []
+
+        if os.path.exists(path) and os.path.getsize(path) > 0:
+            with open(path, "rb") as f:
+                self.codec, self.metrics, self.interval, _ = _read_header(f)
+            self._file = open(path, "r+b")
+            self._file.seek(0, os.SEEK_END)
+            self._truncate_partial_tail()
+        else:
+            self.codec, self.metrics, self.interval = CODECS[compression], list(metrics), float(interval)
+            self._file = open(path, "wb")
+            schema = "\n".join(self.metrics).encode("utf-8")
+            record_size = _record_struct(len(self.metrics)).size
+            self._file.write(HEADER.pack(MAGIC, VERSION, self.codec, len(self.metrics), record_size, self.interval))
+            self._file.write(SCHEMA_LENGTH.pack(len(schema)) + schema)
+            self._file.flush()
+
+        self._record = _record_struct(len(self.metrics))
+
+    def _truncate_partial_tail(self):
+        # a crash can leave half a record (or chunk) at the end; cut it off so new data stays aligned
+        recording = Recording(self.path)
+        try:
+            end = recording._data_end
+        finally:
+            recording.close()
+        self._file.truncate(end)
+        self._file.seek(end)
+
+    def write(self, timestamp, metrics):
+        '''
+        Append one sample.
+
+        Args:
+            timestamp (float): Unix time of the sample.
+            metrics (dict): {metric name: value} as returned by _flatten_usage.
+        '''
+        nan = float("nan")
+        packed = self._record.pack(timestamp, *[metrics.get(name, nan) for name in self.metrics])
+        if self.codec == CODECS["none"]:
+            self._file.write(packed)
+            return
+        self._pending.append((timestamp, packed))
+        if len(self._pending) >= CHUNK_RECORDS:
+            self._write_chunk()
+
+    def _write_chunk(self):
+        if not self._pending:
+            return
+        payload = _compress(self.codec, b"".join(packed for _, packed in self._pending))
+        self._file.write(CHUNK_HEADER.pack(len(payload), len(self._pending), self._pending[0][0], self._pending[-1][0]))
+        self._file.write(payload)
+        self._pending = []
+
+    def flush(self):
+        '''Write buffered records (compressed recordings close their current chunk) and flush the file.'''
+        self._write_chunk()
+        self._file.flush()
+
+    def close(self):
+        self.flush()
+        self._file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+class Recording:
+    '''
+    Memory-mapped reader for .statz recordings.
+
+    Args:
+        path (str): Recording to open.
+
+    Attributes:
+        metrics (list): Metric names, in record order.
+        interval (float): Sampling interval the recording was made with.
+        compression (str): "none", "zlib" or "zstd".
+    '''
+    def __init__(self, path):
+        self.path = path
+        self._file = open(path, "rb")
+        try:
+            self.codec, self.metrics, self.interval, self._data_start = _read_header(self._file)
+        except:
+            self._file.close()
+            raise
+        self.compression = CODEC_NAMES[self.codec]
+        self._record = _record_struct(len(self.metrics))
+
+        size = os.path.getsize(path)
+        self._map = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ) if size > self._data_start else None
+
+        if self.codec == CODECS["none"]:
+            self._count = (size - self._data_start) // self._record.size
+            self._data_end = self._data_start + self._count * self._record.size
+            self._chunks = None
+        else:
+            self._index_chunks(size)
+
+    def _index_chunks(self, size):
+        # only chunk headers are read here, payloads are decompressed when they are needed
+        self._chunks = []
+        offset = self._data_start
+        count = 0
+        while offset + CHUNK_HEADER.size <= size:
+            length, records, first, last = CHUNK_HEADER.unpack_from(self._map, offset)
+            if offset + CHUNK_HEADER.size + length > size:
+                break
+            self._chunks.append((offset + CHUNK_HEADER.size, length, records, first, last))
+            offset += CHUNK_HEADER.size + length
+            count += records
+        self._count = count
+        self._data_end = offset
+
+    def __len__(self):
+        return self._count
+
+    def close(self):
+        if self._map is not None:
+            self._map.close()
+            self._map = None
+        self._file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    @property
+    def start_time(self):
+        '''Timestamp of the first record, or None if the recording is empty.'''
+        for timestamp, _ in self.records():
+            return timestamp
+        return None
+
+    @property
+    def end_time(self):
+        '''Timestamp of the last record, or None if the recording is empty.'''
+        if not self._count:
+            return None
+        if self._chunks is None:
+            return TIMESTAMP.unpack_from(self._map, self._data_end - self._record.size)[0]
+        return self._chunks[-1][4]
+
+    def _timestamp_at(self, index):
+        return TIMESTAMP.unpack_from(self._map, self._data_start + index * self._record.size)[0]
+
+    def _first_index(self, start):
+        '''Binary search for the first uncompressed record at or after start.'''
+        low, high = 0, self._count
+        while low < high:
+            middle = (low + high) // 2
+            if self._timestamp_at(middle) < start:
+                low = middle + 1
+            else:
+                high = middle
+        return low
+
+    def _chunk_blocks(self, start):
+        for offset, length, records, first, last in self._chunks:
+            if start is not None and last < start:
+                continue
+            yield _decompress(self.codec, self._map[offset:offset + length])
+
+    def _blocks(self, start):
+        '''Yield buffers of packed records, beginning near start.'''
+        if not self._count:
+            return
+        if self._chunks is None:
+            first = self._first_index(start) if start is not None else 0
+            # hand out the map in slices so huge recordings are never copied at once
+            step = 4096 * self._record.size
+            offset = self._data_start + first * self._record.size
+            while offset < self._data_end:
+                yield self._map[offset:min(offset + step, self._data_end)]
+                offset += step
+        else:
+            yield from self._chunk_blocks(start)
+
+    def records(self, start=None, end=None):
+        '''
+        Stream records between two times.
+
+        Args:
+            start (float): Unix time of the first record to return. Defaults to the beginning.
+            end (float): Unix time of the last record to return. Defaults to the end.
+
+        Yields:
+            tuple: (timestamp, values) where values is a tuple aligned with `metrics`.
+        '''
+        for block in self._blocks(start):
+            for record in self._record.iter_unpack(block):
+                timestamp = record[0]
+                if start is not None and timestamp < start:
+                    continue
+                if end is not None and timestamp > end:
+                    return
+                yield timestamp, record[1:]
+
+    def samples(self, start=None, end=None):
+        '''
+        Stream records as dicts, e.g. {"timestamp": ..., "cpu.core1": 12.5, ...}. NaN (missing) values are left out.
+        '''
+        metrics = self.metrics
+        for timestamp, values in self.records(start, end):
+            sample = {"timestamp": timestamp}
+            for name, value in zip(metrics, values):
+                if value == value:
+                    sample[name] = value
+            yield sample
+
+    def columns(self, metrics=None, start=None, end=None):
+        '''
+        Load a time range as one array('d') per metric, e.g. for plotting.
+
+        Args:
+            metrics (list): Metric names (or prefixes such as "cpu") to load. Defaults to all.
+
+        Returns:
+            dict: {"timestamp": array, metric: array, ...}
+        '''
+        if metrics is None:
+            selected = list(range(len(self.metrics)))
+        else:
+            if isinstance(metrics, str):
+                metrics = [metrics]
+            selected = [i for i, name in enumerate(self.metrics)
+                        if any(name == pattern or name.startswith(pattern + ".") for pattern in metrics)]
+
+        timestamps = array("d")
+        values = [array("d") for _ in selected]
+        for timestamp, record in self.records(start, end):
+            timestamps.append(timestamp)
+            for column, i in zip(values, selected):
+                column.append(record[i])
+
+        result = {"timestamp": timestamps}
+        for column, i in zip(values, selected):
+            result[self.metrics[i]] = column
+        return result
+
+def open_recording(path):
+    '''
+    Open a .statz recording for reading.
+
+    Args:
+        path (str): Path of the recording.
+
+    Returns:
+        Recording: Memory-mapped reader with `records()`, `samples()` and `columns()` for time ranges.
+
+    Raises:
+        ValueError: If the file is not a valid statz recording.
+    '''
+    return Recording(path)
+
+def record_usage(path, interval=1.0, count=None, compression="none", get_cpu=True, get_ram=True, get_disk=True,
+                 get_network=True, get_battery=True, get_totcpu=True):
+    '''
+    Record usage samples into a .statz file until interrupted (or `count` samples were written).
+
+    The schema is taken from the first sample when the file is created. An existing recording is appended to.
+
+    Args:
+        path (str): File to create or append to.
+        interval (float): Seconds between samples. Defaults to 1.
+        count (int): Stop after this many samples. Defaults to None (run until interrupted).
+        compression (str): "none", "zlib" or "zstd" chunks. Defaults to "none".
+        get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu (bool): Components to record.
+
+    Returns:
+        int: Number of samples written.
+    '''
+    writer = None
+    written = 0
+    try:
+        for usage in _iter_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu, interval, count):
+            metrics = _flatten_usage(usage)
+            if writer is None:
+                writer = RecordingWriter(path, sorted(metrics), interval, compression)
+            writer.write(time.time(), metrics)
+            written += 1
+            # uncompressed records reach the disk right away, compressed ones once their chunk is full
+            if writer.codec == CODECS["none"]:
+                writer.flush()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if writer is not None:
+            writer.close()
+    return written
@@ -2,17 +2,20 @@
 This module provides a unified interface to retrieve hardware usage, system specifications,
 top processes, and export data to files in JSON or CSV format.'''
 
-from .internal._getMacInfo import _get_mac_specs
-from .internal._getWindowsInfo import _get_windows_specs
-from .internal._getLinuxInfo import _get_linux_specs
-from .internal._crossPlatform import _get_usage, _get_top_n_processes
+from .internal._crossPlatform import _get_usage, _iter_usage, _get_top_n_processes, _get_top_n_processes_multi, _get_cgroup_usage, _get_top_n_cgroups
+from .internal._usageSampler import _start_sampler, _stop_sampler, _get_cached_usage
+from .internal._specsCache import _cached_specs, _set_cache_file, _clear_cache
+from .internal._historyStore import _enable_history, _disable_history, _get_history, DEFAULT_ROLLUPS
+from .internal._exportWriter import _export_schema
+from .internal._profiler import _enable_profiling, _disable_profiling, _reset_profile, _profile_report
+from .internal._gpuCollectors import _get_gpu_usage
 
 import platform
 
+from . import __version__
 
-__version__ = "2.4.0"
-
-def get_hardware_usage(get_cpu=True, get_ram=True, get_disk=True, get_network=True, get_battery=True, get_totcpu=False, **kwargs):
+@_export_schema("usage")
+def get_hardware_usage(get_cpu=True, get_ram=True, get_disk=True, get_network=True, get_battery=True, get_totcpu=False, interval=None, cached=False, get_gpu=False, **kwargs):
     '''
     Get real-time usage data for specified system components. 
 
@@ -24,21 +27,179 @@ def get_hardware_usage(get_cpu=True, get_ram=True, get_disk=True, get_network=Tr
         get_disk (bool): Whether to fetch disk usage data.
         get_network (bool): Whether to fetch network usage data.
         get_battery (bool): Whether to fetch battery usage data.
+        get_totcpu (bool): Whether to fetch total/user/system CPU usage data.
+        interval (float): Length of the shared sampling window in seconds. CPU, disk and network rates are all
+                          measured over this one window. Defaults to 1 second when disk or network data is
+                          requested and 0.1 seconds otherwise.
+        cached (bool): If True, return the newest values from the background sampler instead of sampling now.
+                       The sampler is started with default settings if it is not already running.
+        get_gpu (bool): Whether to fetch per-GPU usage data (see get_gpu_usage). Defaults to False.
         **kwargs: Additional keyword arguments to ensure compatibility with CLI logic.
 
     Returns:
         list: A list containing usage data for the specified components in the following order:
-        [cpu_usage (dict), ram_usage (dict), disk_usages (list of dicts), network_usage (dict), battery_usage (dict)]
+        [cpu_usage (dict), ram_usage (dict), disk_usages (list of dicts), network_usage (dict), battery_usage (dict)],
+        followed by gpu_usages (list of dicts) when get_gpu is True.
+
+        When cached is True the list also has `timestamp` (when it was sampled) and `age` (seconds since then) attributes.
     ''' 
     operatingSystem = platform.system()
 
     if operatingSystem == "Darwin" or operatingSystem == "Linux" or operatingSystem == "Windows":
-        usage = _get_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu)
+        if cached:
+            return _get_cached_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu, get_gpu)
+        usage = _get_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu, interval, get_gpu)
         return usage
     else:
         raise OSError("Unsupported operating system")
 
-def get_system_specs(get_os=True, get_cpu=True, get_gpu=True, get_ram=True, get_disk=True, get_network=True, get_battery=True):
+def stream_hardware_usage(get_cpu=True, get_ram=True, get_disk=True, get_network=True, get_battery=True, get_totcpu=False, interval=1.0, count=None, get_gpu=False):
+    '''
+    Continuously sample usage data for specified system components.
+
+    Unlike calling get_hardware_usage in a loop, every sample reuses the counters read for the previous one,
+    so there is no extra sampling window per call and samples arrive exactly `interval` seconds apart.
+
+    Args:
+        get_cpu (bool): Whether to fetch CPU usage data.
+        get_ram (bool): Whether to fetch RAM usage data.
+        get_disk (bool): Whether to fetch disk usage data.
+        get_network (bool): Whether to fetch network usage data.
+        get_battery (bool): Whether to fetch battery usage data.
+        get_totcpu (bool): Whether to fetch total/user/system CPU usage data.
+        interval (float): Seconds between samples. Defaults to 1.
+        count (int): Number of samples to produce. Defaults to None (run until the caller stops iterating).
+        get_gpu (bool): Whether to fetch per-GPU usage data. Defaults to False.
+
+    Yields:
+        list: Usage data in the same format get_hardware_usage returns.
+    '''
+    operatingSystem = platform.system()
+
+    if operatingSystem == "Darwin" or operatingSystem == "Linux" or operatingSystem == "Windows":
+        return _iter_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu, interval, count, get_gpu)
+    else:
+        raise OSError("Unsupported operating system")
+
+def get_gpu_usage():
+    '''
+    Get the current utilization, memory, power and temperature of every GPU.
+
+    NVIDIA GPUs are read through NVML, AMD GPUs on Linux through the amdgpu sysfs files and Mac GPUs
+    through IOKit. The libraries and files are opened on the first call and kept open, so later calls
+    take well under a millisecond and can run every second or faster.
+
+    Returns:
+        list: [{"index", "name", "vendor", "usage" (%), "memoryUsed" (MB), "memoryTotal" (MB), "memoryPercent",
+                "power" (W), "temperature" (°C)}, ...], empty without a supported GPU.
+        Values a GPU or backend does not report are None (Mac GPUs report no power or temperature).
+    '''
+    return _get_gpu_usage()
+
+def start_background_sampler(interval=1.0, history=60):
+    '''
+    Start a background thread that samples CPU, RAM, disk I/O, network and battery usage.
+
+    Once it is running, get_hardware_usage(cached=True), system_health_score and the dashboard read
+    the newest sample instead of blocking on their own sampling window.
+
+    Args:
+        interval (float): Seconds between samples. Defaults to 1.
+        history (int): Number of samples kept in the ring buffer. Defaults to 60.
+
+    Returns:
+        _UsageSampler: The running sampler. Use `.latest()` for the newest sample or `.history()` for the ring buffer.
+    '''
+    return _start_sampler(interval, history)
+
+def stop_background_sampler():
+    '''
+    Stop the background sampler started by start_background_sampler.
+    '''
+    _stop_sampler()
+
+def enable_usage_history(raw_capacity=3600, rollups=DEFAULT_ROLLUPS, max_metrics=256):
+    '''
+    Keep a history of every background sampler sample in a fixed-size, columnar store.
+
+    Each metric is kept in its own array of doubles, so an hour of 1 Hz samples for a few dozen metrics
+    takes about a megabyte. Samples older than the raw buffer remain available as min/max/avg buckets.
+    Samples are recorded while the background sampler runs (see start_background_sampler).
+
+    Args:
+        raw_capacity (int): Number of full-resolution samples kept. Defaults to 3600.
+        rollups (tuple): (bucket_seconds, capacity) pairs for the downsampled tiers.
+                         Defaults to one day of 1 minute buckets and 30 days of 1 hour buckets.
+        max_metrics (int): Maximum number of distinct metrics recorded. Defaults to 256.
+
+    Returns:
+        HistoryStore: The new store. Replaces (and forgets) any previous history.
+    '''
+    return _enable_history(raw_capacity, rollups, max_metrics)
+
+def disable_usage_history():
+    '''
+    Stop recording usage history and free the store.
+    '''
+    _disable_history()
+
+def get_usage_history(metrics=None, start=None, end=None, resolution=None):
+    '''
+    Get recorded usage history for a time range.
+
+    Args:
+        metrics (str or list): Metric names or prefixes, e.g. "cpu", "ram.percent" or ["disk.sda", "network"]. Defaults to all.
+        start (float): Unix time of the oldest sample to return. Defaults to the oldest recorded.
+        end (float): Unix time of the newest sample to return. Defaults to the newest recorded.
+        resolution (float): "raw" for full-resolution samples, or a rollup bucket length in seconds.
+                            Defaults to the finest resolution that still covers `start`.
+
+    Returns:
+        dict: {"resolution": ..., "timestamp": array, metric: array (raw) or {"min", "max", "avg"} arrays (rollups)}.
+        Returns None if history is not enabled.
+    '''
+    history = _get_history()
+    if history is None:
+        return None
+    return history.query(metrics, start, end, resolution)
+
+def enable_profiling(reset=True):
+    '''
+    Time every collector stage from now on: psutil and WMI calls, subprocesses such as dmidecode,
+    system_profiler or sensors, sysfs probes and the fixed sleeps, plus which fallback path each one took.
+
+    Profiling is off by default and costs a flag check per stage while off.
+
+    Args:
+        reset (bool): Forget what was recorded before. Defaults to True.
+    '''
+    if reset:
+        _reset_profile()
+    _enable_profiling()
+
+def disable_profiling():
+    '''
+    Stop profiling. What was recorded stays available through get_profile.
+    '''
+    _disable_profiling()
+
+def get_profile(reset=False):
+    '''
+    Get the collector profile recorded since enable_profiling.
+
+    Args:
+        reset (bool): Clear the recorded data after reading it. Defaults to False.
+
+    Returns:
+        dict: {"enabled": bool, "stages": {stage: stats}}, slowest stage first. Nested stages are named "outer/inner",
+        e.g. "specs.linux/dmidecode". Every stage has "calls", "errors", "total_ms", "mean_ms", "p50_ms", "p90_ms",
+        "p99_ms", "max_ms", "cpu_ms", "syscalls" (read/write syscalls, Linux only, otherwise None), "subprocesses",
+        "commands" ({command: count}), "fallbacks" ({path taken: count}) and "histogram" ({bucket upper bound in ms: calls, "+Inf": calls}).
+    '''
+    return _profile_report(reset)
+
+@_export_schema("specs")
+def get_system_specs(get_os=True, get_cpu=True, get_gpu=True, get_ram=True, get_disk=True, get_network=True, get_battery=True, use_cache=True):
     '''
     Get system specs on all platforms with selective fetching.
 
@@ -52,6 +213,8 @@ def get_system_specs(get_os=True, get_cpu=True, get_gpu=True, get_ram=True, get_
         get_disk (bool): Whether to fetch disk specs.
         get_network (bool): Whether to fetch network specs (Windows only).
         get_battery (bool): Whether to fetch battery specs (Windows only).
+        use_cache (bool): Whether to reuse cached static specs (OS, CPU, RAM and, on Windows, GPU and disk drives).
+                          Volatile specs such as free disk space and battery are always fetched again. Defaults to True.
 
     Returns:
         list: A list containing specs data for the specified components. The structure of the list varies by platform:
@@ -72,15 +235,40 @@ def get_system_specs(get_os=True, get_cpu=True, get_gpu=True, get_ram=True, get_
     '''
     operatingSystem = platform.system()
 
+    # only this platform's reader is imported, the others are never needed
     if operatingSystem == "Darwin":  # macOS
-        return _get_mac_specs(get_os, get_cpu, get_ram, get_disk)
+        from .internal._getMacInfo import _get_mac_specs
+        return _cached_specs(_get_mac_specs, ["os", "cpu", "ram", "disk"],
+                             [get_os, get_cpu, get_ram, get_disk], use_cache)
     elif operatingSystem == "Linux":  # Linux
-        return _get_linux_specs(get_os, get_cpu, get_ram, get_disk)
+        from .internal._getLinuxInfo import _get_linux_specs
+        return _cached_specs(_get_linux_specs, ["os", "cpu", "ram", "disk"],
+                             [get_os, get_cpu, get_ram, get_disk], use_cache)
     elif operatingSystem == "Windows":  # Windows
-        return _get_windows_specs(get_os, get_cpu, get_gpu, get_ram, get_disk, get_network, get_battery)
+        from .internal._getWindowsInfo import _get_windows_specs
+        return _cached_specs(_get_windows_specs, ["os", "cpu", "gpu", "ram", "disk", "network", "battery"],
+                             [get_os, get_cpu, get_gpu, get_ram, get_disk, get_network, get_battery], use_cache)
     else:
         raise OSError("Unsupported operating system")
 
+def set_specs_cache_file(path="default"):
+    '''
+    Keep cached static specs in a file as well as in memory, so later runs skip the slow lookups
+    (dmidecode, system_profiler, WMI...). The file is ignored after a reboot or on another host.
+
+    Args:
+        path (str, optional): Path of the cache file. "default" uses the per-user cache directory
+                              (e.g. ~/.cache/statz/specs.json). None turns the on-disk cache off.
+    '''
+    _set_cache_file(path)
+
+def clear_specs_cache():
+    '''
+    Forget all cached static specs, in memory and on disk. The next get_system_specs call fetches everything again.
+    '''
+    _clear_cache()
+
+@_export_schema("processes")
 def get_top_n_processes(n=5, type="cpu"):
     '''
     Get the top N processes sorted by CPU or memory usage.
@@ -90,15 +278,16 @@ def get_top_n_processes(n=5, type="cpu"):
     
     Args:
         n (int, optional): Number of top processes to return. Defaults to 5.
-        type (str, optional): Sort criteria - either "cpu" for CPU usage or "mem" for memory usage. 
-                             Defaults to "cpu".
+        type (str, optional): Sort criteria - "cpu" for CPU usage, "mem" for memory usage or "io" for
+                             disk I/O throughput. Defaults to "cpu".
     
     Returns:
         list: List of dictionaries containing process information, sorted by the specified usage type.
         Each dictionary contains:
         - "pid" (int): Process ID
         - "name" (str): Process name/command
-        - "usage" (float or str): For CPU: percentage (0-100), For memory: formatted string like "512 MB" or "1.2 GB"
+        - "usage" (float or str): For CPU: percentage (0-100), For memory: formatted string like "512 MB" or "1.2 GB",
+          For I/O: formatted string like "3.2 MB/s"
         
         Example (CPU):
         [
@@ -113,16 +302,99 @@ def get_top_n_processes(n=5, type="cpu"):
         ]
     
     Raises:
-        TypeError: If n is not an integer or type is not "cpu" or "mem".
+        TypeError: If n is not an integer or type is not "cpu", "mem" or "io".
         
     Note:
         - CPU usage is measured as a percentage of total CPU capacity
+        - Process handles are kept between calls, so CPU usage is measured since the previous call
+          (the first call samples for 0.1 seconds)
         - Memory usage is shown in absolute values (MB/GB) for better clarity
         - Processes with None values for the requested metric are filtered out
         - Some processes may not be accessible due to permission restrictions
     '''
     return _get_top_n_processes(n, type)
 
+@_export_schema("processes_multi")
+def get_top_n_processes_multi(n=5, keys=("cpu", "mem")):
+    '''
+    Get the top N processes for several metrics at once.
+
+    The process list is scanned a single time and ranked once per key, which is cheaper than
+    calling get_top_n_processes for each metric.
+
+    Args:
+        n (int, optional): Number of top processes per ranking. Defaults to 5.
+        keys (tuple, optional): Metrics to rank by, any of "cpu", "mem" and "io". Defaults to ("cpu", "mem").
+
+    Returns:
+        dict: One list per requested key, in the same format get_top_n_processes returns.
+
+        Example:
+        {
+            "cpu": [{"pid": 1234, "name": "chrome", "usage": 15.2}],
+            "mem": [{"pid": 1234, "name": "chrome", "usage": "1.2 GB"}],
+            "io": [{"pid": 5678, "name": "rsync", "usage": "48.0 MB/s"}]
+        }
+
+    Note:
+        - Per-process I/O counters are not available on macOS, so the "io" ranking is empty there
+    '''
+    return _get_top_n_processes_multi(n, keys)
+
+@_export_schema("cgroup_usage")
+def get_cgroup_usage(level="all"):
+    '''
+    Get the usage of every cgroup (containers, systemd services and slices) on Linux with cgroup v2.
+
+    The cgroup hierarchy and its counter files (cpu.stat, memory.current, io.stat and the pressure files)
+    are kept open between calls, so each call reads every file once and reports CPU, I/O and pressure
+    since the previous call (the first call samples for 0.1 seconds). New and removed cgroups are picked
+    up every 10 seconds.
+
+    Args:
+        level (str, optional): "leaf" for cgroups without children (containers, services), "slice" for systemd
+                               and Kubernetes slices, or "all". Defaults to "all".
+
+    Returns:
+        list: One dictionary per cgroup, sorted by name:
+        - "name" (str): Path below the cgroup root, e.g. "system.slice/docker-<id>.scope"
+        - "container" (str): The first 12 digits of the container ID, None if it is not a container
+        - "cpu" (float): CPU usage in percent of one core (a container busy on 4 cores shows 400)
+        - "throttled" (float): Percent of the time the CPU quota throttled the cgroup
+        - "memory", "memoryLimit" (float): Memory used and the memory.max limit in MB (None without a limit)
+        - "memoryPercent" (float): Memory used in percent of the limit
+        - "readSpeed", "writeSpeed" (float): Disk I/O in MB/s
+        - "readIops", "writeIops" (float): Disk I/O operations per second
+        - "cpuPressure", "memoryPressure", "ioPressure" (float): Percent of the time some task of the cgroup
+          was stalled waiting for CPU, memory or I/O (PSI)
+        Values the kernel does not report, e.g. of controllers that are not enabled, are None.
+        { "error": message } when cgroup v2 is not available.
+    '''
+    return _get_cgroup_usage(level)
+
+@_export_schema("cgroups")
+def get_top_n_cgroups(n=5, type="cpu", level="leaf"):
+    '''
+    Get the top N cgroups sorted by CPU, memory, I/O or pressure, like get_top_n_processes but per container.
+
+    Args:
+        n (int, optional): Number of top cgroups to return. Defaults to 5.
+        type (str, optional): "cpu", "mem", "io" or "pressure" (the highest of CPU, memory and I/O pressure). Defaults to "cpu".
+        level (str, optional): "leaf", "slice" or "all", see get_cgroup_usage. Defaults to "leaf".
+
+    Returns:
+        list: List of {"name", "container", "usage"} dicts, highest usage first. "usage" is formatted like
+        get_top_n_processes does (percent for CPU and pressure, "512 MB" for memory, "3.2 MB/s" for I/O).
+
+        Example:
+        [
+            {"name": "kubepods.slice/kubepods-pod1.slice/cri-containerd-3f2a....scope", "container": "3f2a9c1d0b7e", "usage": 182.4},
+            {"name": "system.slice/sshd.service", "container": None, "usage": 1.2}
+        ]
+        { "error": message } for invalid arguments or when cgroup v2 is not available.
+    '''
+    return _get_top_n_cgroups(n, type, level)
+
 def connected_device_monitoring():
     """
     Get information on connected USB devices across all platforms.
@@ -169,6 +441,7 @@ def connected_device_monitoring():
         - Windows: Uses WMI and PowerShell for device detection
         - Linux: Uses lsusb command and sysfs filesystem
         - macOS: Uses system_profiler command
+        - While start_usb_monitor runs, the result comes from its inventory without a rescan
     """
     try:
         from .internal._connectedDevicesMonitoring import get_connected_usb_devices
@@ -190,6 +463,32 @@ def connected_device_monitoring():
             'platform': platform.system().lower()
         }
 
+def start_usb_monitor(callback=None, poll_interval=5.0):
+    """
+    Start watching for USB devices being plugged in and removed.
+    
+    The device list is scanned once, then kept current from hotplug events (netlink uevents on Linux,
+    IOKit notifications on macOS, WMI device events on Windows). While the monitor runs,
+    connected_device_monitoring, get_connected_device_by_name and get_connected_devices_by_type
+    answer from memory instead of running lsusb, system_profiler or WMI queries.
+    
+    Args:
+        callback (callable): Called with ("add" or "remove", device dict) on every change. Defaults to None.
+        poll_interval (float): Seconds between rescans if the platform's event source is unavailable. Defaults to 5.
+    
+    Returns:
+        _UsbWatcher: The running monitor. `.snapshot()` returns the inventory, `.method_used` how it is kept current.
+    """
+    from .internal._usbWatcher import _start_usb_watcher
+    return _start_usb_watcher(callback, poll_interval)
+
+def stop_usb_monitor():
+    """
+    Stop the USB monitor started by start_usb_monitor.
+    """
+    from .internal._usbWatcher import _stop_usb_watcher
+    _stop_usb_watcher()
+
 def get_connected_device_by_name(device_name):
     """
     Get a specific connected USB device by name.
@@ -244,6 +543,37 @@ def get_connected_devices_by_type(device_type):
             'platform': platform.system().lower()
         }
 
+def get_connected_devices_by_id(vendor_id, product_id=None):
+    """
+    Get connected USB devices by vendor id, and optionally product id.
+    
+    Args:
+        vendor_id (str or int): USB vendor id, e.g. "046d", "0x046D" or 0x046d
+        product_id (str or int): USB product id. Defaults to None (any product of the vendor).
+        
+    Returns:
+        dict: Dictionary containing matching devices with structure:
+        {
+            'vendor_id': vendor_id,
+            'product_id': product_id,
+            'count': int,
+            'devices': [list of matching devices],
+            'platform': str
+        }
+    """
+    try:
+        from .internal._connectedDevicesMonitoring import get_devices_by_usb_id
+        return get_devices_by_usb_id(vendor_id, product_id)
+    except Exception as e:
+        return {
+            'vendor_id': vendor_id,
+            'product_id': product_id,
+            'count': 0,
+            'devices': [],
+            'error': str(e),
+            'platform': platform.system().lower()
+        }
+
 def system_integrity_check():
     """
     Scans your system to check for the existence of critical files.
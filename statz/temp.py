@@ -3,10 +3,9 @@ This module provides a unified interface to retrieve temperature readings'''
 
 import platform
 
-from .internal._getMacInfo import _get_mac_temps
-from .internal._getLinuxInfo import _get_linux_temps
-from .internal._getWindowsInfo import _get_windows_temps
+from .internal._exportWriter import _export_schema
 
+@_export_schema("temps")
 def get_system_temps():
     '''
     Get temperature readings from system sensors across all platforms.
@@ -39,8 +38,11 @@ def get_system_temps():
     operatingSystem = platform.system()
 
     if operatingSystem == "Darwin": # macOS
+        from .internal._getMacInfo import _get_mac_temps
         return _get_mac_temps()
     elif operatingSystem == "Linux":  # Linux
+        from .internal._getLinuxInfo import _get_linux_temps
         return _get_linux_temps()
     elif operatingSystem == "Windows": # Windows:
+        from .internal._getWindowsInfo import _get_windows_temps
         return _get_windows_temps()
\ No newline at end of file
@@ -0,0 +1,125 @@
+'''Streaming watch mode.
+Writes one record per sample to stdout or a file, either as a short status line or as NDJSON
+(one compact JSON object per line) for log shippers, or as typed rows through a streaming
+JSON Lines, CSV, Parquet or Arrow writer.'''
+
+import json
+import os
+import sys
+import time
+from datetime import datetime
+
+# import like this so i can test it easily
+try:
+    from .internal._crossPlatform import _iter_usage, _get_top_n_processes_multi
+    from .internal._exportWriter import SCHEMAS, _open_writer
+except:
+    from internal._crossPlatform import _iter_usage, _get_top_n_processes_multi
+    from internal._exportWriter import SCHEMAS, _open_writer
+
+USAGE_COMPONENTS = ("cpu", "ram", "disk", "network", "battery")
+
+def _sample_record(usage, timestamp, get_totcpu=False, processes=None):
+    '''
+    Turn one usage list into a flat dict with a timestamp and one key per requested component.
+    '''
+    record = {"timestamp": round(timestamp, 3)}
+    for name, value in zip(USAGE_COMPONENTS, usage):
+        if value is not None:
+            record[name] = value
+    if get_totcpu and "cpu" in record:
+        # keep the total/user/system split next to the per-core values, like --usage --totcpu does
+        record["totcpu"] = {key: record["cpu"].pop(key) for key in ("total_usage", "user_usage", "system_usage") if key in record["cpu"]}
+        if not record["cpu"]:
+            del record["cpu"]
+    if processes is not None:
+        record["processes"] = processes
+    return record
+
+def _status_line(record):
+    '''Short, human readable summary of one record.'''
+    parts = [datetime.fromtimestamp(record["timestamp"]).strftime("%H:%M:%S")]
+
+    if "totcpu" in record and "total_usage" in record["totcpu"]:
+        parts.append(f"CPU {record['totcpu']['total_usage']:5.1f}%")
+    elif record.get("cpu"):
+        cores = list(record["cpu"].values())
+        parts.append(f"CPU {sum(cores) / len(cores):5.1f}%")
+    if record.get("ram"):
+        parts.append(f"RAM {record['ram']['percent']:5.1f}%")
+    if "disk" in record:
+        read = sum(disk["readSpeed"] for disk in record["disk"])
+        write = sum(disk["writeSpeed"] for disk in record["disk"])
+        parts.append(f"Disk R {read:.2f} W {write:.2f} MB/s")
+    if record.get("network"):
+        parts.append(f"Net up {record['network']['up']:.2f} down {record['network']['down']:.2f} MB/s")
+    if record.get("battery"):
+        parts.append(f"Battery {record['battery']['percent']}%")
+    if isinstance(record.get("processes"), dict):
+        for key, entries in record["processes"].items():
+            if isinstance(entries, list) and entries:
+                parts.append(f"Top {key}: {entries[0]['name']}")
+
+    return "  ".join(parts)
+
+def run_watch(get_cpu=True, get_ram=True, get_disk=True, get_network=True, get_battery=True, get_totcpu=False,
+              interval=1.0, ndjson=False, path=None, count=None, process_count=0, process_types=("cpu",), export_format=None):
+    '''
+    Continuously sample usage data and write one record per sample until interrupted.
+
+    The output handle is opened once and kept open, counters are carried over from one sample to
+    the next, and nothing is accumulated between samples, so memory use stays flat however long it runs.
+
+    Args:
+        get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu (bool): Components to sample.
+        interval (float): Seconds between samples. Defaults to 1.
+        ndjson (bool): Write one compact JSON object per line instead of a status line.
+        path (str): Append to this file instead of writing to stdout.
+        count (int): Stop after this many samples. Defaults to None (run until interrupted).
+        process_count (int): Include the top N processes in every record. Defaults to 0 (no processes).
+        process_types (tuple): Rankings to include when process_count is set: "cpu", "mem" and/or "io".
+        export_format (str): Write one typed row per metric ("jsonl", "csv", "parquet" or "arrow") instead.
+                             Rows are buffered and flushed about once a second, Parquet and Arrow need a path.
+
+    Returns:
+        int: Number of records written.
+    '''
+    writer = None
+    if export_format:
+        # appending keeps the header of an earlier CSV run, Parquet and Arrow files are rewritten
+        writer = _open_writer(path, SCHEMAS["usage_sample"], export_format, append=True, flush_interval=0 if path is None else 1.0)
+        out = None
+    else:
+        out = open(path, "a", buffering=1, encoding="utf-8") if path else sys.stdout
+    written = 0
+
+    try:
+        for usage in _iter_usage(get_cpu, get_ram, get_disk, get_network, get_battery, get_totcpu, interval, count):
+            processes = _get_top_n_processes_multi(process_count, process_types) if process_count else None
+            record = _sample_record(usage, time.time(), get_totcpu, processes)
+
+            if writer is not None:
+                writer.write(record)
+                written += 1
+                continue
+            if ndjson:
+                out.write(json.dumps(record, separators=(",", ":")) + "\n")
+            else:
+                out.write(_status_line(record) + "\n")
+            # flush every record so whatever reads the stream sees it immediately
+            out.flush()
+            written += 1
+    except KeyboardInterrupt:
+        pass
+    except BrokenPipeError:
+        # the reader went away (e.g. piped into head); point stdout at devnull so the exit flush stays quiet
+        if not path:
+            devnull = os.open(os.devnull, os.O_WRONLY)
+            os.dup2(devnull, sys.stdout.fileno())
+    finally:
+        if writer is not None:
+            writer.close()
+        elif path:
+            out.close()
+
+    return written